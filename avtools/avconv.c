@@ -48,6 +48,7 @@
 #include "libavutil/libm.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/time.h"
+#include "libavutil/trace.h"
 #include "libavformat/os_support.h"
 
 # include "libavfilter/avfilter.h"
@@ -244,6 +245,8 @@ static void avconv_cleanup(int ret)
 
     avformat_network_deinit();
 
+    av_trace_stop();
+
     if (received_sigterm) {
         av_log(NULL, AV_LOG_INFO, "Received signal %d: terminating.\n",
                (int) received_sigterm);
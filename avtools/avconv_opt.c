@@ -40,6 +40,7 @@
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/trace.h"
 
 #define DEFAULT_PASS_LOGFILENAME_PREFIX "av2pass"
 
@@ -2215,6 +2216,16 @@ static int opt_vstats_file(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_trace(void *optctx, const char *opt, const char *arg)
+{
+    int ret = av_trace_start(arg);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "Cannot start tracing to %s.\n", arg);
+        exit_program(1);
+    }
+    return 0;
+}
+
 static int opt_vstats(void *optctx, const char *opt, const char *arg)
 {
     char filename[40];
@@ -2583,6 +2594,8 @@ const OptionDef options[] = {
         "set the number of data frames to record", "number" },
     { "benchmark",      OPT_BOOL | OPT_EXPERT,                       { &do_benchmark },
         "add timings for benchmarking" },
+    { "trace",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_trace },
+        "write a Chrome trace of the processing steps to a file", "filename" },
     { "timelimit",      HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_timelimit },
         "set max runtime in seconds", "limit" },
     { "dump",           OPT_BOOL | OPT_EXPERT,                       { &do_pkt_dump },
@@ -27,6 +27,7 @@
 #include "put_bits.h"
 
 #include "aac.h"
+#include "aacencdsp.h"
 #include "audio_frame_queue.h"
 #include "psymodel.h"
 
@@ -58,6 +59,7 @@ typedef struct AACEncContext {
     FFTContext mdct1024;                         ///< long (1024 samples) frame transform context
     FFTContext mdct128;                          ///< short (128 samples) frame transform context
     AVFloatDSPContext fdsp;
+    AACEncDSPContext aacdsp;
     float *planar_samples[6];                    ///< saved preprocessed input
 
     int samplerate_index;                        ///< MPEG-4 samplerate index
@@ -75,6 +77,13 @@ typedef struct AACEncContext {
     DECLARE_ALIGNED(16, int,   qcoefs)[96];      ///< quantized coefficients
     DECLARE_ALIGNED(32, float, scoefs)[1024];    ///< scaled coefficients
 
+    /**
+     * Copies of this context, one per thread, whose scratch buffers are used
+     * by the channel elements searched in parallel.
+     */
+    struct AACEncContext *thread_ctx;
+    int nb_thread_ctx;
+
     struct {
         float *samples;
     } buffer;
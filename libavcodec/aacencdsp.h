@@ -0,0 +1,48 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_AACENCDSP_H
+#define AVCODEC_AACENCDSP_H
+
+typedef struct AACEncDSPContext {
+    /**
+     * Compute |in[i]|^(3/4) as sqrtf(|in[i]| * sqrtf(|in[i]|)).
+     *
+     * @param size number of coefficients, a multiple of 4
+     */
+    void (*abs_pow34)(float *out, const float *in, int size);
+
+    /**
+     * Quantize scaled coefficients, rounding toward zero after adding
+     * 0.4054 and clipping to maxval. The addition and the clipping are done
+     * in double precision.
+     *
+     * @param in        the unscaled coefficients, only their signs are used
+     * @param scaled    the output of abs_pow34() for in
+     * @param size      number of coefficients, a multiple of 4
+     * @param is_signed if nonzero, the levels of negative coefficients are
+     *                  negated
+     */
+    void (*quant_bands)(int *out, const float *in, const float *scaled,
+                        int size, float Q34, int is_signed, int maxval);
+} AACEncDSPContext;
+
+void ff_aacenc_dsp_init(AACEncDSPContext *s);
+void ff_aacenc_dsp_init_x86(AACEncDSPContext *s);
+
+#endif /* AVCODEC_AACENCDSP_H */
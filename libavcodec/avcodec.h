@@ -866,6 +866,8 @@ typedef struct RcOverride{
 #define AV_CODEC_CAP_CHANNEL_CONF        (1 << 10)
 /**
  * Codec supports frame-level multithreading.
+ * For encoders, this means that every frame is coded independently of the
+ * others, so that several frames can be encoded concurrently.
  */
 #define AV_CODEC_CAP_FRAME_THREADS       (1 << 12)
 /**
@@ -2725,6 +2727,35 @@ typedef struct AVCodecContext {
      *             AVCodecContext.get_format callback)
      */
     int hwaccel_flags;
+
+    /**
+     * A reference to a thread pool created with av_thread_pool_alloc().
+     * If set, slice threading runs its jobs on the workers of this pool
+     * instead of starting threads of its own, so that the number of threads
+     * used by many codec and filter graph instances is bounded by the pool.
+     * thread_count still limits how many jobs of this context run at once.
+     *
+     * Frame threading is not affected: its threads block waiting for each
+     * other's progress, so they cannot share a bounded set of workers.
+     *
+     * The reference is set by the caller before avcodec_open2() and
+     * afterwards owned (and freed) by libavcodec.
+     *
+     * - encoding: Set by user.
+     * - decoding: Set by user.
+     */
+    AVBufferRef *thread_pool;
+
+    /**
+     * Maximum number of bytes of frame data kept in unused buffers by the
+     * default get_buffer2(), so that they can be reused when the frame size
+     * or format changes. 0 means the peak number of bytes of frame data in
+     * use at once.
+     *
+     * - encoding: Set by user.
+     * - decoding: Set by user.
+     */
+    int64_t frame_cache_size;
 } AVCodecContext;
 
 /**
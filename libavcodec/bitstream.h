@@ -34,6 +34,18 @@
 
 #include "mathops.h"
 
+/*
+ * Safe bitstream reading:
+ * The checked reader never loads anything past the end of the input buffer
+ * padding, once the end is reached it keeps returning bits from the padding,
+ * which is zero for properly allocated buffers. Decoders that check the
+ * remaining size themselves can "#define UNCHECKED_BITSTREAM_READER 1"
+ * before including this header, the same setting as for get_bits.h.
+ */
+#ifndef UNCHECKED_BITSTREAM_READER
+#define UNCHECKED_BITSTREAM_READER !CONFIG_SAFE_BITSTREAM_READER
+#endif
+
 typedef struct BitstreamContext {
     uint64_t bits;      // stores bits read from the buffer
     const uint8_t *buffer, *buffer_end;
@@ -42,32 +54,26 @@ typedef struct BitstreamContext {
     unsigned size_in_bits;
 } BitstreamContext;
 
+/* Refill the cache so that it holds at least 56 bits, bits_left has to be
+ * below 64. The cache bits past bits_left are either zero or the following
+ * bits of the buffer, so a whole 64-bit word can be or'ed in without
+ * checking how much of it fits, and the pointer only advances by the
+ * number of bytes that were completely consumed. */
 static inline void refill_64(BitstreamContext *bc)
 {
-    if (bc->ptr >= bc->buffer_end)
-        return;
-
-#ifdef BITSTREAM_READER_LE
-    bc->bits       = AV_RL64(bc->ptr);
+#if UNCHECKED_BITSTREAM_READER
+    const uint8_t *ptr = bc->ptr;
 #else
-    bc->bits       = AV_RB64(bc->ptr);
+    const uint8_t *ptr = FFMIN(bc->ptr, bc->buffer_end);
 #endif
-    bc->ptr       += 8;
-    bc->bits_left  = 64;
-}
-
-static inline void refill_32(BitstreamContext *bc)
-{
-    if (bc->ptr >= bc->buffer_end)
-        return;
 
 #ifdef BITSTREAM_READER_LE
-    bc->bits       = (uint64_t)AV_RL32(bc->ptr) << bc->bits_left | bc->bits;
+    bc->bits      |= AV_RL64(ptr) << bc->bits_left;
 #else
-    bc->bits       = bc->bits | (uint64_t)AV_RB32(bc->ptr) << (32 - bc->bits_left);
+    bc->bits      |= AV_RB64(ptr) >> bc->bits_left;
 #endif
-    bc->ptr       += 4;
-    bc->bits_left += 32;
+    bc->ptr       += (63 - bc->bits_left) >> 3;
+    bc->bits_left |= 56;
 }
 
 /* Initialize BitstreamContext. Input buffer must have an additional zero
@@ -78,9 +84,10 @@ static inline int bitstream_init(BitstreamContext *bc, const uint8_t *buffer,
     unsigned buffer_size;
 
     if (bit_size > INT_MAX - 7 || !buffer) {
-        buffer        =
-        bc->buffer    =
-        bc->ptr       = NULL;
+        buffer         =
+        bc->buffer     =
+        bc->buffer_end =
+        bc->ptr        = NULL;
         bc->bits_left = 0;
         return AVERROR_INVALIDDATA;
     }
@@ -94,8 +101,6 @@ static inline int bitstream_init(BitstreamContext *bc, const uint8_t *buffer,
     bc->bits_left    = 0;
     bc->bits         = 0;
 
-    refill_64(bc);
-
     return 0;
 }
 
@@ -149,48 +154,33 @@ static inline unsigned bitstream_read_bit(BitstreamContext *bc)
     return get_val(bc, 1);
 }
 
-/* Return n bits from the buffer. n has to be in the 0-63 range. */
-static inline uint64_t bitstream_read_63(BitstreamContext *bc, unsigned n)
+/* Return n bits from the buffer. n has to be in the 0-32 range. */
+static inline uint32_t bitstream_read(BitstreamContext *bc, unsigned n)
 {
-    uint64_t ret = 0;
-#ifdef BITSTREAM_READER_LE
-    uint64_t left = 0;
-#endif
-
     if (!n)
         return 0;
 
-    if (n > bc->bits_left) {
-        n -= bc->bits_left;
-#ifdef BITSTREAM_READER_LE
-        left = bc->bits_left;
-#endif
-        ret = get_val(bc, bc->bits_left);
+    if (n > bc->bits_left)
         refill_64(bc);
-    }
-
-#ifdef BITSTREAM_READER_LE
-    ret = get_val(bc, n) << left | ret;
-#else
-    ret = get_val(bc, n) | ret << n;
-#endif
 
-    return ret;
+    return get_val(bc, n);
 }
 
-/* Return n bits from the buffer. n has to be in the 0-32 range. */
-static inline uint32_t bitstream_read(BitstreamContext *bc, unsigned n)
+/* Return n bits from the buffer. n has to be in the 0-63 range. */
+static inline uint64_t bitstream_read_63(BitstreamContext *bc, unsigned n)
 {
-    if (!n)
-        return 0;
+    uint64_t ret;
 
-    if (n > bc->bits_left) {
-        refill_32(bc);
-        if (bc->bits_left < 32)
-            bc->bits_left = n;
-    }
+    if (n <= 32)
+        return bitstream_read(bc, n);
 
-    return get_val(bc, n);
+#ifdef BITSTREAM_READER_LE
+    ret = bitstream_read(bc, 32);
+    return (uint64_t)bitstream_read(bc, n - 32) << 32 | ret;
+#else
+    ret = (uint64_t)bitstream_read(bc, n - 32) << 32;
+    return ret | bitstream_read(bc, 32);
+#endif
 }
 
 /* Return n bits from the buffer as a signed integer.
@@ -214,7 +204,7 @@ static inline unsigned show_val(const BitstreamContext *bc, unsigned n)
 static inline unsigned bitstream_peek(BitstreamContext *bc, unsigned n)
 {
     if (n > bc->bits_left)
-        refill_32(bc);
+        refill_64(bc);
 
     return show_val(bc, n);
 }
@@ -242,17 +232,12 @@ static inline void bitstream_skip(BitstreamContext *bc, unsigned n)
     if (n <= bc->bits_left)
         skip_remaining(bc, n);
     else {
-        n -= bc->bits_left;
-        skip_remaining(bc, bc->bits_left);
-        if (n >= 64) {
-            unsigned skip = n / 8;
-
-            n -= skip * 8;
-            bc->ptr += skip;
-        }
+        n            -= bc->bits_left;
+        bc->ptr      += n >> 3;
+        bc->bits      = 0;
+        bc->bits_left = 0;
         refill_64(bc);
-        if (n)
-            skip_remaining(bc, n);
+        skip_remaining(bc, n & 7);
     }
 }
 
@@ -311,7 +296,7 @@ static inline int bitstream_apply_sign(BitstreamContext *bc, int val)
     return (val ^ sign) - sign;
 }
 
-/* Unwind the cache so a refill_32 can fill it again. */
+/* Give back the last 32 bits of the cache to the buffer. */
 static inline void bitstream_unwind(BitstreamContext *bc)
 {
     int unwind = 4;
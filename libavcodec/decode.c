@@ -30,10 +30,12 @@
 #include "libavutil/hwcontext.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/intmath.h"
+#include "libavutil/trace.h"
 
 #include "avcodec.h"
 #include "bytestream.h"
 #include "decode.h"
+#include "framecache.h"
 #include "internal.h"
 #include "thread.h"
 
@@ -412,6 +414,7 @@ static int decode_receive_frame_internal(AVCodecContext *avctx, AVFrame *frame)
 int attribute_align_arg avcodec_send_packet(AVCodecContext *avctx, const AVPacket *avpkt)
 {
     AVCodecInternal *avci = avctx->internal;
+    int stream_index, frame_number;
     int ret = 0;
 
     if (!avcodec_is_open(avctx) || !av_codec_is_decoder(avctx->codec))
@@ -431,19 +434,29 @@ int attribute_align_arg avcodec_send_packet(AVCodecContext *avctx, const AVPacke
             return ret;
     }
 
+    stream_index = avpkt && (avpkt->data || avpkt->side_data_elems) ?
+                   avpkt->stream_index : -1;
+    /* decoding can bump frame_number, read it once so that both events
+     * of the slice carry the same value */
+    frame_number = avctx->frame_number;
+    av_trace_begin(avctx, "send_packet", stream_index, frame_number);
+
     ret = av_bsf_send_packet(avci->filter.bsfs[0], avci->buffer_pkt);
     if (ret < 0) {
         av_packet_unref(avci->buffer_pkt);
-        return ret;
+        goto end;
     }
 
     if (!avci->buffer_frame->buf[0]) {
         ret = decode_receive_frame_internal(avctx, avci->buffer_frame);
         if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
-            return ret;
+            goto end;
     }
 
-    return 0;
+    ret = 0;
+end:
+    av_trace_end(avctx, "send_packet", stream_index, frame_number);
+    return ret;
 }
 
 static int calc_cropping_offsets(size_t offsets[4], const AVFrame *frame,
@@ -568,7 +581,11 @@ int attribute_align_arg avcodec_receive_frame(AVCodecContext *avctx, AVFrame *fr
     if (avci->buffer_frame->buf[0]) {
         av_frame_move_ref(frame, avci->buffer_frame);
     } else {
+        int frame_number = avctx->frame_number;
+
+        av_trace_begin(avctx, "receive_frame", -1, frame_number);
         ret = decode_receive_frame_internal(avctx, frame);
+        av_trace_end(avctx, "receive_frame", -1, frame_number);
         if (ret < 0)
             return ret;
     }
@@ -818,6 +835,33 @@ int ff_get_format(AVCodecContext *avctx, const enum AVPixelFormat *fmt)
     return ret;
 }
 
+FramePool *ff_frame_pool_alloc(int64_t max_idle_size)
+{
+    FramePool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+
+    pool->cache = ff_frame_buffer_cache_alloc(max_idle_size);
+    if (!pool->cache) {
+        av_free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void ff_frame_pool_free(FramePool **ppool)
+{
+    FramePool *pool = *ppool;
+
+    if (!pool)
+        return;
+
+    ff_frame_buffer_cache_free(&pool->cache);
+    av_freep(ppool);
+}
+
 static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
 {
     FramePool *pool = avctx->internal->pool;
@@ -860,15 +904,8 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
         size[i] = tmpsize - (data[i] - data[0]);
 
         for (i = 0; i < 4; i++) {
-            av_buffer_pool_uninit(&pool->pools[i]);
-            pool->linesize[i] = linesize[i];
-            if (size[i]) {
-                pool->pools[i] = av_buffer_pool_init(size[i] + 16, NULL);
-                if (!pool->pools[i]) {
-                    ret = AVERROR(ENOMEM);
-                    goto fail;
-                }
-            }
+            pool->linesize[i]   = linesize[i];
+            pool->plane_size[i] = size[i] ? size[i] + 16 : 0;
         }
         pool->format = frame->format;
         pool->width  = frame->width;
@@ -885,17 +922,12 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
             pool->channels == ch && frame->nb_samples == pool->samples)
             return 0;
 
-        av_buffer_pool_uninit(&pool->pools[0]);
         ret = av_samples_get_buffer_size(&pool->linesize[0], ch,
                                          frame->nb_samples, frame->format, 0);
         if (ret < 0)
             goto fail;
 
-        pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
-        if (!pool->pools[0]) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
-        }
+        pool->plane_size[0] = pool->linesize[0];
 
         pool->format     = frame->format;
         pool->planes     = planes;
@@ -908,7 +940,7 @@ static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
     return 0;
 fail:
     for (i = 0; i < 4; i++)
-        av_buffer_pool_uninit(&pool->pools[i]);
+        pool->plane_size[i] = 0;
     pool->format = -1;
     pool->planes = pool->channels = pool->samples = 0;
     pool->width  = pool->height = 0;
@@ -937,13 +969,13 @@ static int audio_get_buffer(AVCodecContext *avctx, AVFrame *frame)
         frame->extended_data = frame->data;
 
     for (i = 0; i < FFMIN(planes, AV_NUM_DATA_POINTERS); i++) {
-        frame->buf[i] = av_buffer_pool_get(pool->pools[0]);
+        frame->buf[i] = ff_frame_buffer_cache_get(pool->cache, pool->plane_size[0]);
         if (!frame->buf[i])
             goto fail;
         frame->extended_data[i] = frame->data[i] = frame->buf[i]->data;
     }
     for (i = 0; i < frame->nb_extended_buf; i++) {
-        frame->extended_buf[i] = av_buffer_pool_get(pool->pools[0]);
+        frame->extended_buf[i] = ff_frame_buffer_cache_get(pool->cache, pool->plane_size[0]);
         if (!frame->extended_buf[i])
             goto fail;
         frame->extended_data[i + AV_NUM_DATA_POINTERS] = frame->extended_buf[i]->data;
@@ -971,10 +1003,10 @@ static int video_get_buffer(AVCodecContext *s, AVFrame *pic)
     memset(pic->data, 0, sizeof(pic->data));
     pic->extended_data = pic->data;
 
-    for (i = 0; i < 4 && pool->pools[i]; i++) {
+    for (i = 0; i < 4 && pool->plane_size[i]; i++) {
         pic->linesize[i] = pool->linesize[i];
 
-        pic->buf[i] = av_buffer_pool_get(pool->pools[i]);
+        pic->buf[i] = ff_frame_buffer_cache_get(pool->cache, pool->plane_size[i]);
         if (!pic->buf[i])
             goto fail;
 
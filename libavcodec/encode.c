@@ -27,6 +27,7 @@
 
 #include "avcodec.h"
 #include "internal.h"
+#include "thread.h"
 
 int ff_alloc_packet(AVPacket *avpkt, int size)
 {
@@ -197,6 +198,16 @@ end:
     return ret;
 }
 
+/**
+ * Whether the encoder may still output packets after it has been passed
+ * its last frame.
+ */
+static int encoder_has_delay(AVCodecContext *avctx)
+{
+    return avctx->codec->capabilities & AV_CODEC_CAP_DELAY ||
+           (HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME);
+}
+
 int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
                                               AVPacket *avpkt,
                                               const AVFrame *frame,
@@ -204,6 +215,7 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
 {
     int ret;
     int user_packet = !!avpkt->data;
+    int frame_threaded = HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME;
 
     *got_packet_ptr = 0;
 
@@ -212,7 +224,7 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
         return AVERROR(ENOSYS);
     }
 
-    if (!(avctx->codec->capabilities & AV_CODEC_CAP_DELAY) && !frame) {
+    if (!encoder_has_delay(avctx) && !frame) {
         av_packet_unref(avpkt);
         av_init_packet(avpkt);
         avpkt->size = 0;
@@ -224,11 +236,15 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
 
     av_assert0(avctx->codec->encode2);
 
-    ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
+    if (frame_threaded)
+        ret = ff_thread_encode_frame(avctx, avpkt, frame, got_packet_ptr);
+    else
+        ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
     if (!ret) {
+        /* the encoding threads set the timestamps of their packets */
         if (!*got_packet_ptr)
             avpkt->size = 0;
-        else if (!(avctx->codec->capabilities & AV_CODEC_CAP_DELAY))
+        else if (!(avctx->codec->capabilities & AV_CODEC_CAP_DELAY) && !frame_threaded)
             avpkt->pts = avpkt->dts = frame->pts;
 
         if (!user_packet && avpkt->size) {
@@ -304,7 +320,7 @@ int attribute_align_arg avcodec_send_frame(AVCodecContext *avctx, const AVFrame
     if (!frame) {
         avctx->internal->draining = 1;
 
-        if (!(avctx->codec->capabilities & AV_CODEC_CAP_DELAY))
+        if (!encoder_has_delay(avctx))
             return 0;
     }
 
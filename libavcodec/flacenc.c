@@ -19,6 +19,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+/* the residual is written as long runs of rice codes */
+#define BITSTREAM_WRITER_64
+
 #include "libavutil/crc.h"
 #include "libavutil/intmath.h"
 #include "libavutil/md5.h"
@@ -92,6 +95,15 @@ typedef struct FlacFrame {
     int verbatim_only;
 } FlacFrame;
 
+/**
+ * A frame of a batch encoded in parallel.
+ */
+typedef struct FlacFrameJob {
+    AVFrame *frame;                 ///< input frame, until it has been encoded
+    uint8_t *buf;                   ///< encoded frame
+    int size;                       ///< size of the encoded frame or a negative error code
+} FlacFrameJob;
+
 typedef struct FlacEncodeContext {
     AVClass *class;
     PutBitContext pb;
@@ -118,6 +130,19 @@ typedef struct FlacEncodeContext {
 
     int flushed;
     int64_t next_pts;
+
+    /**
+     * With slice threading, the input frames are queued and encoded in
+     * batches of one frame per thread. The packets of a batch are returned
+     * in order while the next batch is queued.
+     */
+    struct FlacEncodeContext *thread_ctx; ///< encoding context of each thread
+    int nb_thread_ctx;
+    FlacFrameJob *jobs;
+    int nb_jobs;                    ///< number of frames in a batch
+    int nb_queued;                  ///< number of frames queued for the next batch
+    int nb_encoded;                 ///< number of frames in the last encoded batch
+    int next_output;                ///< index of the next packet of the batch to return
 } FlacEncodeContext;
 
 
@@ -228,6 +253,50 @@ static av_cold void dprint_compression_options(FlacEncodeContext *s)
 }
 
 
+static av_cold int init_frame_jobs(FlacEncodeContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, ret;
+
+    s->nb_jobs = avctx->active_thread_type & FF_THREAD_SLICE ?
+                 avctx->thread_count : 1;
+
+    s->jobs = av_mallocz_array(s->nb_jobs, sizeof(*s->jobs));
+    if (!s->jobs)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_jobs; i++) {
+        FlacFrameJob *job = &s->jobs[i];
+
+        job->frame = av_frame_alloc();
+        job->buf   = av_malloc(s->max_framesize);
+        if (!job->frame || !job->buf)
+            return AVERROR(ENOMEM);
+    }
+
+    if (s->nb_jobs == 1)
+        return 0;
+
+    /* the threads only share the settings of the main context */
+    s->thread_ctx = av_malloc_array(avctx->thread_count,
+                                    sizeof(*s->thread_ctx));
+    if (!s->thread_ctx)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < avctx->thread_count; i++) {
+        FlacEncodeContext *t = &s->thread_ctx[i];
+
+        *t = *s;
+        ret = ff_lpc_init(&t->lpc_ctx, avctx->frame_size,
+                          s->options.max_prediction_order,
+                          FF_LPC_TYPE_LEVINSON);
+        if (ret < 0)
+            return ret;
+        s->nb_thread_ctx++;
+    }
+
+    return 0;
+}
+
+
 static av_cold int flac_encode_init(AVCodecContext *avctx)
 {
     int freq = avctx->sample_rate;
@@ -422,6 +491,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     ret = ff_lpc_init(&s->lpc_ctx, avctx->frame_size,
                       s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+    if (ret < 0)
+        return ret;
 
     ff_bswapdsp_init(&s->bdsp);
     ff_flacdsp_init(&s->flac_dsp, avctx->sample_fmt,
@@ -429,7 +500,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     dprint_compression_options(s);
 
-    return ret;
+    return init_frame_jobs(s);
 }
 
 
@@ -1174,9 +1245,9 @@ static void write_frame_footer(FlacEncodeContext *s)
 }
 
 
-static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
+static int write_frame(FlacEncodeContext *s, uint8_t *buf, int size)
 {
-    init_put_bits(&s->pb, avpkt->data, avpkt->size);
+    init_put_bits(&s->pb, buf, size);
     write_frame_header(s);
     write_subframes(s);
     write_frame_footer(s);
@@ -1184,10 +1255,11 @@ static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
 }
 
 
-static int update_md5_sum(FlacEncodeContext *s, const void *samples)
+static int update_md5_sum(FlacEncodeContext *s, const void *samples,
+                          int nb_samples)
 {
     const uint8_t *buf;
-    int buf_size = s->frame.blocksize * s->channels *
+    int buf_size = nb_samples * s->channels *
                    ((s->avctx->bits_per_raw_sample + 7) / 8);
 
     if (s->avctx->bits_per_raw_sample > 16 || HAVE_BIGENDIAN) {
@@ -1208,7 +1280,7 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
         const int32_t *samples0 = samples;
         uint8_t *tmp            = s->md5_buffer;
 
-        for (i = 0; i < s->frame.blocksize * s->channels; i++) {
+        for (i = 0; i < nb_samples * s->channels; i++) {
             int32_t v = samples0[i] >> 8;
             *tmp++    = (v      ) & 0xFF;
             *tmp++    = (v >>  8) & 0xFF;
@@ -1222,16 +1294,114 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
 }
 
 
+/**
+ * Encode one frame of a batch with the context of the thread.
+ */
+static int encode_frame_job(AVCodecContext *avctx, void *arg,
+                            int jobnr, int threadnr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacEncodeContext *t = s->thread_ctx ? &s->thread_ctx[threadnr] : s;
+    FlacFrameJob *job    = &s->jobs[jobnr];
+    const AVFrame *frame = job->frame;
+    int frame_bytes;
+
+    t->frame_count   = s->frame_count + jobnr;
+    t->max_framesize = s->max_framesize;
+
+    /* change max_framesize for small final frame */
+    if (frame->nb_samples < s->max_blocksize) {
+        t->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
+                                                      t->channels,
+                                                      avctx->bits_per_raw_sample);
+    }
+
+    init_frame(t, frame->nb_samples);
+
+    copy_samples(t, frame->data[0]);
+
+    channel_decorrelation(t);
+
+    remove_wasted_bits(t);
+
+    frame_bytes = encode_frame(t);
+
+    /* Fall back on verbatim mode if the compressed frame is larger than it
+       would be if encoded uncompressed. */
+    if (frame_bytes < 0 || frame_bytes > t->max_framesize) {
+        t->frame.verbatim_only = 1;
+        frame_bytes = encode_frame(t);
+        if (frame_bytes < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
+            job->size = frame_bytes;
+            return frame_bytes;
+        }
+    }
+
+    job->size = write_frame(t, job->buf, frame_bytes);
+    return 0;
+}
+
+
+/**
+ * Encode the queued frames in parallel and update the stream information
+ * with them in order.
+ */
+static int encode_batch(FlacEncodeContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, ret;
+
+    avctx->execute2(avctx, encode_frame_job, NULL, NULL, s->nb_queued);
+
+    for (i = 0; i < s->nb_queued; i++) {
+        FlacFrameJob *job = &s->jobs[i];
+
+        if (job->size < 0)
+            return job->size;
+
+        s->frame_count++;
+        s->sample_count += job->frame->nb_samples;
+        if ((ret = update_md5_sum(s, job->frame->data[0],
+                                  job->frame->nb_samples)) < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
+            return ret;
+        }
+        if (job->size > s->max_encoded_framesize)
+            s->max_encoded_framesize = job->size;
+        if (job->size < s->min_framesize)
+            s->min_framesize = job->size;
+    }
+
+    s->nb_encoded  = s->nb_queued;
+    s->nb_queued   = 0;
+    s->next_output = 0;
+    return 0;
+}
+
+
 static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                              const AVFrame *frame, int *got_packet_ptr)
 {
-    FlacEncodeContext *s;
-    int frame_bytes, out_bytes, ret;
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacFrameJob *job;
+    int ret;
+
+    if (frame) {
+        job = &s->jobs[s->nb_queued];
+        if ((ret = av_frame_ref(job->frame, frame)) < 0)
+            return ret;
+        s->nb_queued++;
+    }
 
-    s = avctx->priv_data;
+    if (s->next_output == s->nb_encoded && s->nb_queued &&
+        (s->nb_queued == s->nb_jobs || !frame)) {
+        if ((ret = encode_batch(s)) < 0)
+            return ret;
+    }
 
     /* when the last block is reached, update the header in extradata */
-    if (!frame) {
+    if (!frame && s->next_output == s->nb_encoded) {
         s->max_framesize = s->max_encoded_framesize;
         av_md5_final(s->md5ctx, s->md5sum);
         write_streaminfo(s, avctx->extradata);
@@ -1258,55 +1428,20 @@ FF_ENABLE_DEPRECATION_WARNINGS
         return 0;
     }
 
-    /* change max_framesize for small final frame */
-    if (frame->nb_samples < s->frame.blocksize) {
-        s->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
-                                                      s->channels,
-                                                      avctx->bits_per_raw_sample);
-    }
-
-    init_frame(s, frame->nb_samples);
-
-    copy_samples(s, frame->data[0]);
-
-    channel_decorrelation(s);
-
-    remove_wasted_bits(s);
+    if (s->next_output == s->nb_encoded)
+        return 0;
 
-    frame_bytes = encode_frame(s);
+    job = &s->jobs[s->next_output++];
 
-    /* Fall back on verbatim mode if the compressed frame is larger than it
-       would be if encoded uncompressed. */
-    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
-        s->frame.verbatim_only = 1;
-        frame_bytes = encode_frame(s);
-        if (frame_bytes < 0) {
-            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
-            return frame_bytes;
-        }
-    }
-
-    if ((ret = ff_alloc_packet(avpkt, frame_bytes))) {
+    if ((ret = ff_alloc_packet(avpkt, job->size))) {
         av_log(avctx, AV_LOG_ERROR, "Error getting output packet\n");
         return ret;
     }
+    memcpy(avpkt->data, job->buf, job->size);
 
-    out_bytes = write_frame(s, avpkt);
-
-    s->frame_count++;
-    s->sample_count += frame->nb_samples;
-    if ((ret = update_md5_sum(s, frame->data[0])) < 0) {
-        av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
-        return ret;
-    }
-    if (out_bytes > s->max_encoded_framesize)
-        s->max_encoded_framesize = out_bytes;
-    if (out_bytes < s->min_framesize)
-        s->min_framesize = out_bytes;
-
-    avpkt->pts      = frame->pts;
-    avpkt->duration = ff_samples_to_time_base(avctx, frame->nb_samples);
-    avpkt->size     = out_bytes;
+    avpkt->pts      = job->frame->pts;
+    avpkt->duration = ff_samples_to_time_base(avctx, job->frame->nb_samples);
+    av_frame_unref(job->frame);
 
     s->next_pts = avpkt->pts + avpkt->duration;
 
@@ -1319,9 +1454,22 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 {
     if (avctx->priv_data) {
         FlacEncodeContext *s = avctx->priv_data;
+        int i;
+
         av_freep(&s->md5ctx);
         av_freep(&s->md5_buffer);
         ff_lpc_end(&s->lpc_ctx);
+
+        for (i = 0; i < s->nb_thread_ctx; i++)
+            ff_lpc_end(&s->thread_ctx[i].lpc_ctx);
+        av_freep(&s->thread_ctx);
+        if (s->jobs) {
+            for (i = 0; i < s->nb_jobs; i++) {
+                av_frame_free(&s->jobs[i].frame);
+                av_freep(&s->jobs[i].buf);
+            }
+            av_freep(&s->jobs);
+        }
     }
     av_freep(&avctx->extradata);
     avctx->extradata_size = 0;
@@ -1374,7 +1522,9 @@ AVCodec ff_flac_encoder = {
     .init           = flac_encode_init,
     .encode2        = flac_encode_frame,
     .close          = flac_encode_close,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_S16,
                                                      AV_SAMPLE_FMT_S32,
                                                      AV_SAMPLE_FMT_NONE },
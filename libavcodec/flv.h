@@ -21,7 +21,7 @@
 #ifndef AVCODEC_FLV_H
 #define AVCODEC_FLV_H
 
-#include "get_bits.h"
+#include "bitstream.h"
 #include "mpegvideo.h"
 #include "put_bits.h"
 
@@ -30,6 +30,6 @@ void ff_flv2_encode_ac_esc(PutBitContext *pb, int slevel, int level, int run,
                            int last);
 
 int ff_flv_decode_picture_header(MpegEncContext *s);
-void ff_flv2_decode_ac_esc(GetBitContext *gb, int *level, int *run, int *last);
+void ff_flv2_decode_ac_esc(BitstreamContext *bc, int *level, int *run, int *last);
 
 #endif /* AVCODEC_FLV_H */
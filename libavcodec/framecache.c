@@ -0,0 +1,220 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "framecache.h"
+
+/* number of buffer size classes per power of two */
+#define FRAME_BUFFER_CLASS_STEPS 4
+
+typedef struct FrameBufferEntry {
+    uint8_t *data;
+    int size;
+    unsigned int released;  ///< value of FrameBufferCache.nb_gets at release
+    FrameBufferCache *cache;
+    struct FrameBufferEntry *prev, *next;
+} FrameBufferEntry;
+
+struct FrameBufferCache {
+    AVMutex mutex;
+
+    /*
+     * Idle buffers, most recently released first, so that the buffers to
+     * evict by age or by size are always taken from the tail.
+     */
+    FrameBufferEntry *idle_head;
+    FrameBufferEntry *idle_tail;
+    size_t idle_size;
+    size_t used_size;
+    size_t max_used_size;
+    size_t max_idle_size;   ///< 0 to follow max_used_size
+    unsigned int nb_gets;
+
+    /*
+     * One reference for the owner, plus one for each buffer in use, so that
+     * the cache outlives the codec context while the frames returned to the
+     * caller exist.
+     */
+    atomic_uint refcount;
+};
+
+static void frame_buffer_free(FrameBufferEntry *e)
+{
+    av_free(e->data);
+    av_free(e);
+}
+
+static void idle_remove(FrameBufferCache *cache, FrameBufferEntry *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        cache->idle_head = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        cache->idle_tail = e->prev;
+    cache->idle_size -= e->size;
+}
+
+static void idle_evict_tail(FrameBufferCache *cache)
+{
+    FrameBufferEntry *e = cache->idle_tail;
+
+    idle_remove(cache, e);
+    frame_buffer_free(e);
+}
+
+static void frame_buffer_cache_unref(FrameBufferCache *cache)
+{
+    if (atomic_fetch_add_explicit(&cache->refcount, -1, memory_order_acq_rel) != 1)
+        return;
+
+    while (cache->idle_tail)
+        idle_evict_tail(cache);
+    ff_mutex_destroy(&cache->mutex);
+    av_free(cache);
+}
+
+static void frame_buffer_release(void *opaque, uint8_t *data)
+{
+    FrameBufferEntry *e = opaque;
+    FrameBufferCache *cache = e->cache;
+    size_t max_idle_size;
+
+    ff_mutex_lock(&cache->mutex);
+    cache->used_size -= e->size;
+    cache->idle_size += e->size;
+    e->released = cache->nb_gets;
+    e->prev     = NULL;
+    e->next     = cache->idle_head;
+    if (e->next)
+        e->next->prev = e;
+    else
+        cache->idle_tail = e;
+    cache->idle_head = e;
+
+    max_idle_size = cache->max_idle_size ? cache->max_idle_size
+                                         : cache->max_used_size;
+    while (cache->idle_size > max_idle_size)
+        idle_evict_tail(cache);
+    ff_mutex_unlock(&cache->mutex);
+
+    frame_buffer_cache_unref(cache);
+}
+
+static int frame_buffer_class_size(int size)
+{
+    int shift = FFMAX(av_log2(size) - av_log2(FRAME_BUFFER_CLASS_STEPS), 0);
+    int64_t class_size = ((int64_t)(size - 1 >> shift) + 1) << shift;
+
+    return class_size <= INT_MAX ? class_size : size;
+}
+
+FrameBufferCache *ff_frame_buffer_cache_alloc(int64_t max_idle_size)
+{
+    FrameBufferCache *cache = av_mallocz(sizeof(*cache));
+
+    if (!cache)
+        return NULL;
+
+    cache->max_idle_size = FFMIN(max_idle_size, SIZE_MAX);
+    ff_mutex_init(&cache->mutex, NULL);
+    atomic_init(&cache->refcount, 1);
+
+    return cache;
+}
+
+void ff_frame_buffer_cache_free(FrameBufferCache **pcache)
+{
+    if (!*pcache)
+        return;
+
+    frame_buffer_cache_unref(*pcache);
+    *pcache = NULL;
+}
+
+AVBufferRef *ff_frame_buffer_cache_get(FrameBufferCache *cache, int size)
+{
+    FrameBufferEntry *e, *best = NULL;
+    AVBufferRef *ret;
+
+    ff_mutex_lock(&cache->mutex);
+    cache->nb_gets++;
+    /* the list is in release order, so the stale buffers are at the tail */
+    while (cache->idle_tail &&
+           cache->nb_gets - cache->idle_tail->released > FRAME_BUFFER_MAX_AGE)
+        idle_evict_tail(cache);
+
+    for (e = cache->idle_head; e; e = e->next) {
+        if (e->size >= size && e->size - size <= size &&
+            (!best || e->size < best->size))
+            best = e;
+    }
+    if (best) {
+        idle_remove(cache, best);
+        cache->used_size    += best->size;
+        cache->max_used_size = FFMAX(cache->max_used_size, cache->used_size);
+    }
+    ff_mutex_unlock(&cache->mutex);
+
+    e = best;
+    if (!e) {
+        e = av_mallocz(sizeof(*e));
+        if (!e)
+            return NULL;
+        e->size  = frame_buffer_class_size(size);
+        e->cache = cache;
+        e->data  = av_malloc(e->size);
+        if (!e->data) {
+            av_free(e);
+            return NULL;
+        }
+
+        ff_mutex_lock(&cache->mutex);
+        cache->used_size    += e->size;
+        cache->max_used_size = FFMAX(cache->max_used_size, cache->used_size);
+        ff_mutex_unlock(&cache->mutex);
+    }
+
+    atomic_fetch_add_explicit(&cache->refcount, 1, memory_order_relaxed);
+    ret = av_buffer_create(e->data, size, frame_buffer_release, e, 0);
+    if (!ret)
+        frame_buffer_release(e, e->data);
+
+    return ret;
+}
+
+size_t ff_frame_buffer_cache_idle_size(FrameBufferCache *cache)
+{
+    size_t idle_size;
+
+    ff_mutex_lock(&cache->mutex);
+    idle_size = cache->idle_size;
+    ff_mutex_unlock(&cache->mutex);
+
+    return idle_size;
+}
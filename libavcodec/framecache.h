@@ -0,0 +1,71 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_FRAMECACHE_H
+#define AVCODEC_FRAMECACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/buffer.h"
+
+/*
+ * Buffers of various sizes, released to an idle list instead of being
+ * freed, so that switching between a few frame geometries does not go
+ * through the allocator.
+ *
+ * A request takes the smallest idle buffer which is large enough and at
+ * most twice as large, so smaller frames use the buffers of larger ones.
+ * New buffers are allocated with their size rounded up to a size class, so
+ * that slightly different geometries share buffers. Idle buffers are freed
+ * when they are not reused for FRAME_BUFFER_MAX_AGE requests, and the least
+ * recently released ones are freed when the idle buffers take more memory
+ * than the cap given at allocation.
+ */
+typedef struct FrameBufferCache FrameBufferCache;
+
+/* number of buffer requests after which an idle buffer is freed */
+#define FRAME_BUFFER_MAX_AGE 1024
+
+/**
+ * Allocate a buffer cache.
+ *
+ * @param max_idle_size maximum number of bytes kept in idle buffers, 0 to
+ *                      use the peak number of bytes in use, which bounds the
+ *                      overhead of the cache to twice the memory actually
+ *                      needed by the caller
+ */
+FrameBufferCache *ff_frame_buffer_cache_alloc(int64_t max_idle_size);
+
+/**
+ * Drop the reference of the owner to the cache. The cache is freed once all
+ * the buffers taken from it are released.
+ */
+void ff_frame_buffer_cache_free(FrameBufferCache **cache);
+
+/**
+ * Get a buffer of at least size bytes, reusing an idle buffer if possible.
+ */
+AVBufferRef *ff_frame_buffer_cache_get(FrameBufferCache *cache, int size);
+
+/**
+ * @return the number of bytes currently held in idle buffers
+ */
+size_t ff_frame_buffer_cache_idle_size(FrameBufferCache *cache);
+
+#endif /* AVCODEC_FRAMECACHE_H */
@@ -26,7 +26,7 @@
 
 #include "libavutil/rational.h"
 
-#include "get_bits.h"
+#include "bitstream.h"
 #include "mpegvideo.h"
 #include "h263data.h"
 #include "rl.h"
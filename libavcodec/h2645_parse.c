@@ -35,6 +35,8 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
     int i, si, di;
     uint8_t *dst;
 
+    nal->skipped_bytes = 0;
+
 #define STARTCODE_TEST                                                  \
         if (i + 2 < length && src[i + 1] == 0 && src[i + 2] <= 3) {     \
             if (src[i + 2] != 3) {                                      \
@@ -108,6 +110,21 @@ int ff_h2645_extract_rbsp(const uint8_t *src, int length,
                 dst[di++] = 0;
                 si       += 3;
 
+                if (nal->skipped_bytes_pos) {
+                    if (nal->skipped_bytes >= nal->skipped_bytes_pos_size) {
+                        int new_size = 2 * nal->skipped_bytes_pos_size;
+                        int ret = av_reallocp_array(&nal->skipped_bytes_pos,
+                                                    new_size,
+                                                    sizeof(*nal->skipped_bytes_pos));
+                        if (ret < 0) {
+                            nal->skipped_bytes_pos_size = 0;
+                            return ret;
+                        }
+                        nal->skipped_bytes_pos_size = new_size;
+                    }
+                    nal->skipped_bytes_pos[nal->skipped_bytes++] = di;
+                }
+
                 continue;
             } else // next start code
                 goto nsc;
@@ -283,6 +300,14 @@ int ff_h2645_packet_split(H2645Packet *pkt, const uint8_t *buf, int length,
             pkt->nals = tmp;
             memset(pkt->nals + pkt->nals_allocated, 0,
                    (new_size - pkt->nals_allocated) * sizeof(*tmp));
+
+            nal = &pkt->nals[pkt->nals_allocated];
+            nal->skipped_bytes_pos_size = 64;
+            nal->skipped_bytes_pos = av_malloc_array(nal->skipped_bytes_pos_size,
+                                                     sizeof(*nal->skipped_bytes_pos));
+            if (!nal->skipped_bytes_pos)
+                return AVERROR(ENOMEM);
+
             pkt->nals_allocated = new_size;
         }
         nal = &pkt->nals[pkt->nb_nals++];
@@ -323,8 +348,10 @@ int ff_h2645_packet_split(H2645Packet *pkt, const uint8_t *buf, int length,
 void ff_h2645_packet_uninit(H2645Packet *pkt)
 {
     int i;
-    for (i = 0; i < pkt->nals_allocated; i++)
+    for (i = 0; i < pkt->nals_allocated; i++) {
         av_freep(&pkt->nals[i].rbsp_buffer);
+        av_freep(&pkt->nals[i].skipped_bytes_pos);
+    }
     av_freep(&pkt->nals);
     pkt->nals_allocated = 0;
 }
@@ -42,6 +42,15 @@ typedef struct H2645NAL {
     int raw_size;
     const uint8_t *raw_data;
 
+    /**
+     * Positions in data of the bytes which directly followed a removed
+     * emulation prevention byte. Only filled for the NAL units of an
+     * H2645Packet, NULL otherwise.
+     */
+    int *skipped_bytes_pos;
+    int skipped_bytes_pos_size;
+    int skipped_bytes;
+
     GetBitContext gb;
 
     /**
@@ -69,6 +78,8 @@ typedef struct H2645Packet {
 
 /**
  * Extract the raw (unescaped) bitstream.
+ * If nal->skipped_bytes_pos is allocated, the positions of the removed
+ * emulation prevention bytes are exported as well.
  */
 int ff_h2645_extract_rbsp(const uint8_t *src, int length,
                           H2645NAL *nal);
@@ -32,7 +32,7 @@
 #include "h264dec.h"
 #include "h264_mvpred.h"
 #include "h264data.h"
-#include "golomb_legacy.h"
+#include "golomb.h"
 #include "mpegutils.h"
 
 #include <assert.h>
@@ -412,18 +412,15 @@ av_cold void ff_h264_decode_init_vlc(void){
     }
 }
 
-static inline int get_level_prefix(GetBitContext *gb){
+static inline int get_level_prefix(BitstreamContext *bc){
     unsigned int buf;
     int log;
 
-    OPEN_READER(re, gb);
-    UPDATE_CACHE(re, gb);
-    buf=GET_CACHE(re, gb);
+    buf=bitstream_peek(bc, 32);
 
     log= 32 - av_log2(buf);
 
-    LAST_SKIP_BITS(re, gb, log);
-    CLOSE_READER(re, gb);
+    bitstream_skip(bc, log);
 
     return log-1;
 }
@@ -436,7 +433,7 @@ static inline int get_level_prefix(GetBitContext *gb){
  * @return <0 if an error occurred
  */
 static int decode_residual(const H264Context *h, H264SliceContext *sl,
-                           GetBitContext *gb, int16_t *block, int n,
+                           BitstreamContext *bc, int16_t *block, int n,
                            const uint8_t *scantable, const uint32_t *qmul,
                            int max_coeff)
 {
@@ -448,18 +445,18 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
 
     if(max_coeff <= 8){
         if (max_coeff == 4)
-            coeff_token = get_vlc2(gb, chroma_dc_coeff_token_vlc.table, CHROMA_DC_COEFF_TOKEN_VLC_BITS, 1);
+            coeff_token = bitstream_read_vlc(bc, chroma_dc_coeff_token_vlc.table, CHROMA_DC_COEFF_TOKEN_VLC_BITS, 1);
         else
-            coeff_token = get_vlc2(gb, chroma422_dc_coeff_token_vlc.table, CHROMA422_DC_COEFF_TOKEN_VLC_BITS, 1);
+            coeff_token = bitstream_read_vlc(bc, chroma422_dc_coeff_token_vlc.table, CHROMA422_DC_COEFF_TOKEN_VLC_BITS, 1);
         total_coeff= coeff_token>>2;
     }else{
         if(n >= LUMA_DC_BLOCK_INDEX){
             total_coeff= pred_non_zero_count(h, sl, (n - LUMA_DC_BLOCK_INDEX)*16);
-            coeff_token= get_vlc2(gb, coeff_token_vlc[ coeff_token_table_index[total_coeff] ].table, COEFF_TOKEN_VLC_BITS, 2);
+            coeff_token= bitstream_read_vlc(bc, coeff_token_vlc[ coeff_token_table_index[total_coeff] ].table, COEFF_TOKEN_VLC_BITS, 2);
             total_coeff= coeff_token>>2;
         }else{
             total_coeff= pred_non_zero_count(h, sl, n);
-            coeff_token= get_vlc2(gb, coeff_token_vlc[ coeff_token_table_index[total_coeff] ].table, COEFF_TOKEN_VLC_BITS, 2);
+            coeff_token= bitstream_read_vlc(bc, coeff_token_vlc[ coeff_token_table_index[total_coeff] ].table, COEFF_TOKEN_VLC_BITS, 2);
             total_coeff= coeff_token>>2;
         }
     }
@@ -478,8 +475,8 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
     ff_tlog(h->avctx, "trailing:%d, total:%d\n", trailing_ones, total_coeff);
     assert(total_coeff<=16);
 
-    i = show_bits(gb, 3);
-    skip_bits(gb, trailing_ones);
+    i = bitstream_peek(bc, 3);
+    bitstream_skip(bc, trailing_ones);
     level[0] = 1-((i&4)>>1);
     level[1] = 1-((i&2)   );
     level[2] = 1-((i&1)<<1);
@@ -487,28 +484,28 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
     if(trailing_ones<total_coeff) {
         int mask, prefix;
         int suffix_length = total_coeff > 10 & trailing_ones < 3;
-        int bitsi= show_bits(gb, LEVEL_TAB_BITS);
+        int bitsi= bitstream_peek(bc, LEVEL_TAB_BITS);
         int level_code= cavlc_level_tab[suffix_length][bitsi][0];
 
-        skip_bits(gb, cavlc_level_tab[suffix_length][bitsi][1]);
+        bitstream_skip(bc, cavlc_level_tab[suffix_length][bitsi][1]);
         if(level_code >= 100){
             prefix= level_code - 100;
             if(prefix == LEVEL_TAB_BITS)
-                prefix += get_level_prefix(gb);
+                prefix += get_level_prefix(bc);
 
             //first coefficient has suffix_length equal to 0 or 1
             if(prefix<14){ //FIXME try to build a large unified VLC table for all this
                 if(suffix_length)
-                    level_code= (prefix<<1) + get_bits1(gb); //part
+                    level_code= (prefix<<1) + bitstream_read_bit(bc); //part
                 else
                     level_code= prefix; //part
             }else if(prefix==14){
                 if(suffix_length)
-                    level_code= (prefix<<1) + get_bits1(gb); //part
+                    level_code= (prefix<<1) + bitstream_read_bit(bc); //part
                 else
-                    level_code= prefix + get_bits(gb, 4); //part
+                    level_code= prefix + bitstream_read(bc, 4); //part
             }else{
-                level_code= 30 + get_bits(gb, prefix-3); //part
+                level_code= 30 + bitstream_read(bc, prefix-3); //part
                 if(prefix>=16){
                     if(prefix > 25+3){
                         av_log(h->avctx, AV_LOG_ERROR, "Invalid level prefix\n");
@@ -533,19 +530,19 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
         //remaining coefficients have suffix_length > 0
         for(i=trailing_ones+1;i<total_coeff;i++) {
             static const unsigned int suffix_limit[7] = {0,3,6,12,24,48,INT_MAX };
-            int bitsi= show_bits(gb, LEVEL_TAB_BITS);
+            int bitsi= bitstream_peek(bc, LEVEL_TAB_BITS);
             level_code= cavlc_level_tab[suffix_length][bitsi][0];
 
-            skip_bits(gb, cavlc_level_tab[suffix_length][bitsi][1]);
+            bitstream_skip(bc, cavlc_level_tab[suffix_length][bitsi][1]);
             if(level_code >= 100){
                 prefix= level_code - 100;
                 if(prefix == LEVEL_TAB_BITS){
-                    prefix += get_level_prefix(gb);
+                    prefix += get_level_prefix(bc);
                 }
                 if(prefix<15){
-                    level_code = (prefix<<suffix_length) + get_bits(gb, suffix_length);
+                    level_code = (prefix<<suffix_length) + bitstream_read(bc, suffix_length);
                 }else{
-                    level_code = (15<<suffix_length) + get_bits(gb, prefix-3);
+                    level_code = (15<<suffix_length) + bitstream_read(bc, prefix-3);
                     if(prefix>=16)
                         level_code += (1<<(prefix-3))-4096;
                 }
@@ -562,13 +559,13 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
     else{
         if (max_coeff <= 8) {
             if (max_coeff == 4)
-                zeros_left = get_vlc2(gb, chroma_dc_total_zeros_vlc[total_coeff - 1].table,
+                zeros_left = bitstream_read_vlc(bc, chroma_dc_total_zeros_vlc[total_coeff - 1].table,
                                       CHROMA_DC_TOTAL_ZEROS_VLC_BITS, 1);
             else
-                zeros_left = get_vlc2(gb, chroma422_dc_total_zeros_vlc[total_coeff - 1].table,
+                zeros_left = bitstream_read_vlc(bc, chroma422_dc_total_zeros_vlc[total_coeff - 1].table,
                                       CHROMA422_DC_TOTAL_ZEROS_VLC_BITS, 1);
         } else {
-            zeros_left= get_vlc2(gb, total_zeros_vlc[total_coeff - 1].table, TOTAL_ZEROS_VLC_BITS, 1);
+            zeros_left= bitstream_read_vlc(bc, total_zeros_vlc[total_coeff - 1].table, TOTAL_ZEROS_VLC_BITS, 1);
         }
     }
 
@@ -578,9 +575,9 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
         ((type*)block)[*scantable] = level[0]; \
         for(i=1;i<total_coeff && zeros_left > 0;i++) { \
             if(zeros_left < 7) \
-                run_before= get_vlc2(gb, run_vlc[zeros_left - 1].table, RUN_VLC_BITS, 1); \
+                run_before= bitstream_read_vlc(bc, run_vlc[zeros_left - 1].table, RUN_VLC_BITS, 1); \
             else {\
-                run_before= get_vlc2(gb, run7_vlc.table, RUN7_VLC_BITS, 2); \
+                run_before= bitstream_read_vlc(bc, run7_vlc.table, RUN7_VLC_BITS, 2); \
                 run_before = FFMIN(zeros_left, run_before);\
             }\
             zeros_left -= run_before; \
@@ -595,9 +592,9 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
         ((type*)block)[*scantable] = ((int)(level[0] * qmul[*scantable] + 32))>>6; \
         for(i=1;i<total_coeff && zeros_left > 0;i++) { \
             if(zeros_left < 7) \
-                run_before= get_vlc2(gb, run_vlc[zeros_left - 1].table, RUN_VLC_BITS, 1); \
+                run_before= bitstream_read_vlc(bc, run_vlc[zeros_left - 1].table, RUN_VLC_BITS, 1); \
             else {\
-                run_before= get_vlc2(gb, run7_vlc.table, RUN7_VLC_BITS, 2); \
+                run_before= bitstream_read_vlc(bc, run7_vlc.table, RUN7_VLC_BITS, 2); \
                 run_before = FFMIN(zeros_left, run_before);\
             }\
             zeros_left -= run_before; \
@@ -627,7 +624,7 @@ static int decode_residual(const H264Context *h, H264SliceContext *sl,
 
 static av_always_inline
 int decode_luma_residual(const H264Context *h, H264SliceContext *sl,
-                         GetBitContext *gb, const uint8_t *scan,
+                         BitstreamContext *bc, const uint8_t *scan,
                          const uint8_t *scan8x8, int pixel_shift,
                          int mb_type, int cbp, int p)
 {
@@ -638,7 +635,7 @@ int decode_luma_residual(const H264Context *h, H264SliceContext *sl,
         AV_ZERO128(sl->mb_luma_dc[p]+8);
         AV_ZERO128(sl->mb_luma_dc[p]+16);
         AV_ZERO128(sl->mb_luma_dc[p]+24);
-        if (decode_residual(h, sl, gb, sl->mb_luma_dc[p], LUMA_DC_BLOCK_INDEX + p, scan, NULL, 16) < 0) {
+        if (decode_residual(h, sl, bc, sl->mb_luma_dc[p], LUMA_DC_BLOCK_INDEX + p, scan, NULL, 16) < 0) {
             return -1; //FIXME continue if partitioned and other return -1 too
         }
 
@@ -648,7 +645,7 @@ int decode_luma_residual(const H264Context *h, H264SliceContext *sl,
             for(i8x8=0; i8x8<4; i8x8++){
                 for(i4x4=0; i4x4<4; i4x4++){
                     const int index= i4x4 + 4*i8x8 + p*16;
-                    if( decode_residual(h, sl, gb, sl->mb + (16*index << pixel_shift),
+                    if( decode_residual(h, sl, bc, sl->mb + (16*index << pixel_shift),
                         index, scan + 1, h->ps.pps->dequant4_coeff[p][qscale], 15) < 0 ){
                         return -1;
                     }
@@ -670,7 +667,7 @@ int decode_luma_residual(const H264Context *h, H264SliceContext *sl,
                     uint8_t *nnz;
                     for(i4x4=0; i4x4<4; i4x4++){
                         const int index= i4x4 + 4*i8x8 + p*16;
-                        if( decode_residual(h, sl, gb, buf, index, scan8x8+16*i4x4,
+                        if( decode_residual(h, sl, bc, buf, index, scan8x8+16*i4x4,
                                             h->ps.pps->dequant8_coeff[cqm][qscale], 16) < 0 )
                             return -1;
                     }
@@ -680,7 +677,7 @@ int decode_luma_residual(const H264Context *h, H264SliceContext *sl,
                 }else{
                     for(i4x4=0; i4x4<4; i4x4++){
                         const int index= i4x4 + 4*i8x8 + p*16;
-                        if( decode_residual(h, sl, gb, sl->mb + (16*index << pixel_shift), index,
+                        if( decode_residual(h, sl, bc, sl->mb + (16*index << pixel_shift), index,
                                             scan, h->ps.pps->dequant4_coeff[cqm][qscale], 16) < 0 ){
                             return -1;
                         }
@@ -711,12 +708,12 @@ int ff_h264_decode_mb_cavlc(const H264Context *h, H264SliceContext *sl)
                 down the code */
     if (sl->slice_type_nos != AV_PICTURE_TYPE_I) {
         if (sl->mb_skip_run == -1)
-            sl->mb_skip_run = get_ue_golomb(&sl->gb);
+            sl->mb_skip_run = get_ue_golomb(&sl->bc);
 
         if (sl->mb_skip_run--) {
             if (FRAME_MBAFF(h) && (sl->mb_y & 1) == 0) {
                 if (sl->mb_skip_run == 0)
-                    sl->mb_mbaff = sl->mb_field_decoding_flag = get_bits1(&sl->gb);
+                    sl->mb_mbaff = sl->mb_field_decoding_flag = bitstream_read_bit(&sl->bc);
             }
             decode_mb_skip(h, sl);
             return 0;
@@ -724,12 +721,12 @@ int ff_h264_decode_mb_cavlc(const H264Context *h, H264SliceContext *sl)
     }
     if (FRAME_MBAFF(h)) {
         if ((sl->mb_y & 1) == 0)
-            sl->mb_mbaff = sl->mb_field_decoding_flag = get_bits1(&sl->gb);
+            sl->mb_mbaff = sl->mb_field_decoding_flag = bitstream_read_bit(&sl->bc);
     }
 
     sl->prev_mb_skipped = 0;
 
-    mb_type= get_ue_golomb(&sl->gb);
+    mb_type= get_ue_golomb(&sl->bc);
     if (sl->slice_type_nos == AV_PICTURE_TYPE_B) {
         if(mb_type < 23){
             partition_count = ff_h264_b_mb_type_info[mb_type].partition_count;
@@ -771,12 +768,12 @@ decode_intra_mb:
                             h->ps.sps->bit_depth_luma;
 
         // We assume these blocks are very rare so we do not optimize it.
-        sl->intra_pcm_ptr = align_get_bits(&sl->gb);
-        if (get_bits_left(&sl->gb) < mb_size) {
+        sl->intra_pcm_ptr = bitstream_align(&sl->bc);
+        if (bitstream_bits_left(&sl->bc) < mb_size) {
             av_log(h->avctx, AV_LOG_ERROR, "Not enough data for an intra PCM block.\n");
             return AVERROR_INVALIDDATA;
         }
-        skip_bits_long(&sl->gb, mb_size);
+        bitstream_skip(&sl->bc, mb_size);
 
         // In deblocking, the quantizer is 0
         h->cur_pic.qscale_table[mb_xy] = 0;
@@ -797,7 +794,7 @@ decode_intra_mb:
         if(IS_INTRA4x4(mb_type)){
             int i;
             int di = 1;
-            if(dct8x8_allowed && get_bits1(&sl->gb)){
+            if(dct8x8_allowed && bitstream_read_bit(&sl->bc)){
                 mb_type |= MB_TYPE_8x8DCT;
                 di = 4;
             }
@@ -806,8 +803,8 @@ decode_intra_mb:
             for(i=0; i<16; i+=di){
                 int mode = pred_intra_mode(h, sl, i);
 
-                if(!get_bits1(&sl->gb)){
-                    const int rem_mode= get_bits(&sl->gb, 3);
+                if(!bitstream_read_bit(&sl->bc)){
+                    const int rem_mode= bitstream_read(&sl->bc, 3);
                     mode = rem_mode + (rem_mode >= mode);
                 }
 
@@ -828,7 +825,7 @@ decode_intra_mb:
         }
         if(decode_chroma){
             pred_mode= ff_h264_check_intra_pred_mode(h->avctx, sl->top_samples_available,
-                                                     sl->left_samples_available, get_ue_golomb_31(&sl->gb), 1);
+                                                     sl->left_samples_available, get_ue_golomb_31(&sl->bc), 1);
             if(pred_mode < 0)
                 return -1;
             sl->chroma_pred_mode = pred_mode;
@@ -840,7 +837,7 @@ decode_intra_mb:
 
         if (sl->slice_type_nos == AV_PICTURE_TYPE_B) {
             for(i=0; i<4; i++){
-                sl->sub_mb_type[i]= get_ue_golomb_31(&sl->gb);
+                sl->sub_mb_type[i]= get_ue_golomb_31(&sl->bc);
                 if(sl->sub_mb_type[i] >=13){
                     av_log(h->avctx, AV_LOG_ERROR, "B sub_mb_type %u out of range at %d %d\n", sl->sub_mb_type[i], sl->mb_x, sl->mb_y);
                     return -1;
@@ -858,7 +855,7 @@ decode_intra_mb:
         }else{
             assert(sl->slice_type_nos == AV_PICTURE_TYPE_P); //FIXME SP correct ?
             for(i=0; i<4; i++){
-                sl->sub_mb_type[i]= get_ue_golomb_31(&sl->gb);
+                sl->sub_mb_type[i]= get_ue_golomb_31(&sl->bc);
                 if(sl->sub_mb_type[i] >=4){
                     av_log(h->avctx, AV_LOG_ERROR, "P sub_mb_type %u out of range at %d %d\n", sl->sub_mb_type[i], sl->mb_x, sl->mb_y);
                     return -1;
@@ -877,9 +874,9 @@ decode_intra_mb:
                     if(ref_count == 1){
                         tmp= 0;
                     }else if(ref_count == 2){
-                        tmp= get_bits1(&sl->gb)^1;
+                        tmp= bitstream_read_bit(&sl->bc)^1;
                     }else{
-                        tmp= get_ue_golomb_31(&sl->gb);
+                        tmp= get_ue_golomb_31(&sl->bc);
                         if(tmp>=ref_count){
                             av_log(h->avctx, AV_LOG_ERROR, "ref %u overflow\n", tmp);
                             return -1;
@@ -913,8 +910,8 @@ decode_intra_mb:
                         const int index= 4*i + block_width*j;
                         int16_t (* mv_cache)[2]= &sl->mv_cache[list][ scan8[index] ];
                         pred_motion(h, sl, index, block_width, list, sl->ref_cache[list][ scan8[index] ], &mx, &my);
-                        mx += get_se_golomb(&sl->gb);
-                        my += get_se_golomb(&sl->gb);
+                        mx += get_se_golomb(&sl->bc);
+                        my += get_se_golomb(&sl->bc);
                         ff_tlog(h->avctx, "final mv:%d %d\n", mx, my);
 
                         if(IS_SUB_8X8(sub_mb_type)){
@@ -953,9 +950,9 @@ decode_intra_mb:
                         if (rc == 1) {
                             val= 0;
                         } else if (rc == 2) {
-                            val= get_bits1(&sl->gb)^1;
+                            val= bitstream_read_bit(&sl->bc)^1;
                         }else{
-                            val= get_ue_golomb_31(&sl->gb);
+                            val= get_ue_golomb_31(&sl->bc);
                             if (val >= rc) {
                                 av_log(h->avctx, AV_LOG_ERROR, "ref %u overflow\n", val);
                                 return -1;
@@ -967,8 +964,8 @@ decode_intra_mb:
             for (list = 0; list < sl->list_count; list++) {
                 if(IS_DIR(mb_type, 0, list)){
                     pred_motion(h, sl, 0, 4, list, sl->ref_cache[list][ scan8[0] ], &mx, &my);
-                    mx += get_se_golomb(&sl->gb);
-                    my += get_se_golomb(&sl->gb);
+                    mx += get_se_golomb(&sl->bc);
+                    my += get_se_golomb(&sl->bc);
                     ff_tlog(h->avctx, "final mv:%d %d\n", mx, my);
 
                     fill_rectangle(sl->mv_cache[list][ scan8[0] ], 4, 4, 8, pack16to32(mx,my), 4);
@@ -984,9 +981,9 @@ decode_intra_mb:
                             if (rc == 1) {
                                 val= 0;
                             } else if (rc == 2) {
-                                val= get_bits1(&sl->gb)^1;
+                                val= bitstream_read_bit(&sl->bc)^1;
                             }else{
-                                val= get_ue_golomb_31(&sl->gb);
+                                val= get_ue_golomb_31(&sl->bc);
                                 if (val >= rc) {
                                     av_log(h->avctx, AV_LOG_ERROR, "ref %u overflow\n", val);
                                     return -1;
@@ -1002,8 +999,8 @@ decode_intra_mb:
                     unsigned int val;
                     if(IS_DIR(mb_type, i, list)){
                         pred_16x8_motion(h, sl, 8*i, list, sl->ref_cache[list][scan8[0] + 16*i], &mx, &my);
-                        mx += get_se_golomb(&sl->gb);
-                        my += get_se_golomb(&sl->gb);
+                        mx += get_se_golomb(&sl->bc);
+                        my += get_se_golomb(&sl->bc);
                         ff_tlog(h->avctx, "final mv:%d %d\n", mx, my);
 
                         val= pack16to32(mx,my);
@@ -1022,9 +1019,9 @@ decode_intra_mb:
                             if (rc == 1) {
                                 val= 0;
                             } else if (rc == 2) {
-                                val= get_bits1(&sl->gb)^1;
+                                val= bitstream_read_bit(&sl->bc)^1;
                             }else{
-                                val= get_ue_golomb_31(&sl->gb);
+                                val= get_ue_golomb_31(&sl->bc);
                                 if (val >= rc) {
                                     av_log(h->avctx, AV_LOG_ERROR, "ref %u overflow\n", val);
                                     return -1;
@@ -1040,8 +1037,8 @@ decode_intra_mb:
                     unsigned int val;
                     if(IS_DIR(mb_type, i, list)){
                         pred_8x16_motion(h, sl, i*4, list, sl->ref_cache[list][ scan8[0] + 2*i ], &mx, &my);
-                        mx += get_se_golomb(&sl->gb);
-                        my += get_se_golomb(&sl->gb);
+                        mx += get_se_golomb(&sl->bc);
+                        my += get_se_golomb(&sl->bc);
                         ff_tlog(h->avctx, "final mv:%d %d\n", mx, my);
 
                         val= pack16to32(mx,my);
@@ -1057,7 +1054,7 @@ decode_intra_mb:
         write_back_motion(h, sl, mb_type);
 
     if(!IS_INTRA16x16(mb_type)){
-        cbp= get_ue_golomb(&sl->gb);
+        cbp= get_ue_golomb(&sl->bc);
 
         if(decode_chroma){
             if(cbp > 47){
@@ -1079,7 +1076,7 @@ decode_intra_mb:
     }
 
     if(dct8x8_allowed && (cbp&15) && !IS_INTRA(mb_type)){
-        mb_type |= MB_TYPE_8x8DCT*get_bits1(&sl->gb);
+        mb_type |= MB_TYPE_8x8DCT*bitstream_read_bit(&sl->bc);
     }
     sl->cbp=
     h->cbp_table[mb_xy]= cbp;
@@ -1089,7 +1086,7 @@ decode_intra_mb:
         int i4x4, i8x8, chroma_idx;
         int dquant;
         int ret;
-        GetBitContext *gb = &sl->gb;
+        BitstreamContext *bc = &sl->bc;
         const uint8_t *scan, *scan8x8;
         const int max_qp = 51 + 6 * (h->ps.sps->bit_depth_luma - 8);
 
@@ -1101,7 +1098,7 @@ decode_intra_mb:
             scan    = sl->qscale ? h->zigzag_scan : h->zigzag_scan_q0;
         }
 
-        dquant= get_se_golomb(&sl->gb);
+        dquant= get_se_golomb(&sl->bc);
 
         sl->qscale += dquant;
 
@@ -1117,21 +1114,21 @@ decode_intra_mb:
         sl->chroma_qp[0] = get_chroma_qp(h->ps.pps, 0, sl->qscale);
         sl->chroma_qp[1] = get_chroma_qp(h->ps.pps, 1, sl->qscale);
 
-        if ((ret = decode_luma_residual(h, sl, gb, scan, scan8x8, pixel_shift, mb_type, cbp, 0)) < 0 ) {
+        if ((ret = decode_luma_residual(h, sl, bc, scan, scan8x8, pixel_shift, mb_type, cbp, 0)) < 0 ) {
             return -1;
         }
         h->cbp_table[mb_xy] |= ret << 12;
         if (CHROMA444(h)) {
-            if (decode_luma_residual(h, sl, gb, scan, scan8x8, pixel_shift, mb_type, cbp, 1) < 0 ) {
+            if (decode_luma_residual(h, sl, bc, scan, scan8x8, pixel_shift, mb_type, cbp, 1) < 0 ) {
                 return -1;
             }
-            if (decode_luma_residual(h, sl, gb, scan, scan8x8, pixel_shift, mb_type, cbp, 2) < 0 ) {
+            if (decode_luma_residual(h, sl, bc, scan, scan8x8, pixel_shift, mb_type, cbp, 2) < 0 ) {
                 return -1;
             }
         } else if (CHROMA422(h)) {
             if(cbp&0x30){
                 for(chroma_idx=0; chroma_idx<2; chroma_idx++)
-                    if (decode_residual(h, sl, gb, sl->mb + ((256 + 16*16*chroma_idx) << pixel_shift),
+                    if (decode_residual(h, sl, bc, sl->mb + ((256 + 16*16*chroma_idx) << pixel_shift),
                                         CHROMA_DC_BLOCK_INDEX + chroma_idx, ff_h264_chroma422_dc_scan,
                                         NULL, 8) < 0) {
                         return -1;
@@ -1145,7 +1142,7 @@ decode_intra_mb:
                     for (i8x8 = 0; i8x8 < 2; i8x8++) {
                         for (i4x4 = 0; i4x4 < 4; i4x4++) {
                             const int index = 16 + 16*chroma_idx + 8*i8x8 + i4x4;
-                            if (decode_residual(h, sl, gb, mb, index, scan + 1, qmul, 15) < 0)
+                            if (decode_residual(h, sl, bc, mb, index, scan + 1, qmul, 15) < 0)
                                 return -1;
                             mb += 16 << pixel_shift;
                         }
@@ -1158,7 +1155,7 @@ decode_intra_mb:
         } else /* yuv420 */ {
             if(cbp&0x30){
                 for(chroma_idx=0; chroma_idx<2; chroma_idx++)
-                    if (decode_residual(h, sl, gb, sl->mb + ((256 + 16 * 16 * chroma_idx) << pixel_shift),
+                    if (decode_residual(h, sl, bc, sl->mb + ((256 + 16 * 16 * chroma_idx) << pixel_shift),
                                         CHROMA_DC_BLOCK_INDEX + chroma_idx, ff_h264_chroma_dc_scan, NULL, 4) < 0) {
                         return -1;
                     }
@@ -1169,7 +1166,7 @@ decode_intra_mb:
                     const uint32_t *qmul = h->ps.pps->dequant4_coeff[chroma_idx+1+(IS_INTRA( mb_type ) ? 0:3)][sl->chroma_qp[chroma_idx]];
                     for(i4x4=0; i4x4<4; i4x4++){
                         const int index= 16 + 16*chroma_idx + i4x4;
-                        if( decode_residual(h, sl, gb, sl->mb + (16*index << pixel_shift), index, scan + 1, qmul, 15) < 0){
+                        if( decode_residual(h, sl, bc, sl->mb + (16*index << pixel_shift), index, scan + 1, qmul, 15) < 0){
                             return -1;
                         }
                     }
@@ -36,15 +36,25 @@
 #include "qpeldsp.h"
 #include "thread.h"
 
-static inline int get_lowest_part_list_y(H264SliceContext *sl,
+static inline int get_lowest_part_list_y(const H264Context *h,
+                                         H264SliceContext *sl,
                                          int n, int height, int y_offset, int list)
 {
     int raw_my             = sl->mv_cache[list][scan8[n]][1];
     int filter_height_up   = (raw_my & 3) ? 2 : 0;
     int filter_height_down = (raw_my & 3) ? 3 : 0;
     int full_my            = (raw_my >> 2) + y_offset;
-    int top                = full_my - filter_height_up;
-    int bottom             = full_my + filter_height_down + height;
+    int top, bottom;
+
+    /* the bilinear interpolation of the reduced pictures can read the
+     * reduced row after the block, which spans 2 << lowres rows in the
+     * chroma planes */
+    if (h->lowres) {
+        filter_height_up   = 0;
+        filter_height_down = 2 << h->lowres;
+    }
+    top    = full_my - filter_height_up;
+    bottom = full_my + filter_height_down + height;
 
     return FFMAX(abs(top), bottom);
 }
@@ -67,7 +77,7 @@ static inline void get_lowest_part_y(const H264Context *h, H264SliceContext *sl,
         // Fields can wait on each other, though.
         if (ref->parent->tf.progress->data != h->cur_pic.tf.progress->data ||
             (ref->reference & 3) != h->picture_structure) {
-            my = get_lowest_part_list_y(sl, n, height, y_offset, 0);
+            my = get_lowest_part_list_y(h, sl, n, height, y_offset, 0);
             if (refs[0][ref_n] < 0)
                 nrefs[0] += 1;
             refs[0][ref_n] = FFMAX(refs[0][ref_n], my);
@@ -80,7 +90,7 @@ static inline void get_lowest_part_y(const H264Context *h, H264SliceContext *sl,
 
         if (ref->parent->tf.progress->data != h->cur_pic.tf.progress->data ||
             (ref->reference & 3) != h->picture_structure) {
-            my = get_lowest_part_list_y(sl, n, height, y_offset, 1);
+            my = get_lowest_part_list_y(h, sl, n, height, y_offset, 1);
             if (refs[1][ref_n] < 0)
                 nrefs[1] += 1;
             refs[1][ref_n] = FFMAX(refs[1][ref_n], my);
@@ -93,7 +103,7 @@ static inline void get_lowest_part_y(const H264Context *h, H264SliceContext *sl,
  *
  * @param h the H.264 context
  */
-static void await_references(const H264Context *h, H264SliceContext *sl)
+void ff_h264_await_references(const H264Context *h, H264SliceContext *sl)
 {
     const int mb_xy   = sl->mb_xy;
     const int mb_type = h->cur_pic.mb_type[mb_xy];
@@ -797,6 +807,11 @@ void ff_h264_hl_decode_mb(const H264Context *h, H264SliceContext *sl)
     int is_complex    = CONFIG_SMALL || sl->is_complex ||
                         IS_INTRA_PCM(mb_type) || sl->qscale == 0;
 
+    if (h->lowres) {
+        ff_h264_hl_decode_mb_lowres(h, sl);
+        return;
+    }
+
     if (CHROMA444(h)) {
         if (is_complex || h->pixel_shift)
             hl_decode_mb_444_complex(h, sl);
@@ -0,0 +1,978 @@
+/*
+ * H.264 reduced resolution macroblock reconstruction
+ *
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * H.264 macroblock reconstruction at 1/2, 1/4 or 1/8 of the coded size.
+ *
+ * In the inter macroblocks each output sample gets the average of the
+ * residual over the area it covers, and motion compensation interpolates
+ * bilinearly at the scaled motion vectors. The references are reduced too,
+ * so the pictures drift from the full resolution decode until the next intra
+ * picture.
+ *
+ * The intra macroblocks are reconstructed at full resolution and then
+ * reduced, so the intra pictures only lose the loop filter. Their neighbours
+ * come from the full resolution edges kept for each macroblock, interpolated
+ * from the reduced samples for the inter ones.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "avcodec.h"
+#include "h264dec.h"
+#include "h264_ps.h"
+#include "h264pred.h"
+
+/**
+ * Accumulate the residual of a 4x4 block over the areas of
+ * (1 << shift) x (1 << shift) samples, in the 1/64 units of the inverse
+ * transform, and clear the block.
+ */
+static void idct4_sums(int *sum, int16_t *block, int shift, int dc_only)
+{
+    const int size = 4 >> shift;
+    int tmp[16];
+    int i;
+
+    if (dc_only) {
+        for (i = 0; i < size * size; i++)
+            sum[i] += block[0] * (1 << 2 * shift);
+        block[0] = 0;
+        return;
+    }
+
+    for (i = 0; i < 4; i++) {
+        const int z0 =  block[i + 4 * 0]       +  block[i + 4 * 2];
+        const int z1 =  block[i + 4 * 0]       -  block[i + 4 * 2];
+        const int z2 = (block[i + 4 * 1] >> 1) -  block[i + 4 * 3];
+        const int z3 =  block[i + 4 * 1]       + (block[i + 4 * 3] >> 1);
+
+        tmp[i + 4 * 0] = z0 + z3;
+        tmp[i + 4 * 1] = z1 + z2;
+        tmp[i + 4 * 2] = z1 - z2;
+        tmp[i + 4 * 3] = z0 - z3;
+    }
+
+    for (i = 0; i < 4; i++) {
+        const int z0 =  tmp[0 + 4 * i]       +  tmp[2 + 4 * i];
+        const int z1 =  tmp[0 + 4 * i]       -  tmp[2 + 4 * i];
+        const int z2 = (tmp[1 + 4 * i] >> 1) -  tmp[3 + 4 * i];
+        const int z3 =  tmp[1 + 4 * i]       + (tmp[3 + 4 * i] >> 1);
+        int *s = sum + (i >> shift);
+
+        s[(0 >> shift) * size] += z0 + z3;
+        s[(1 >> shift) * size] += z1 + z2;
+        s[(2 >> shift) * size] += z1 - z2;
+        s[(3 >> shift) * size] += z0 - z3;
+    }
+
+    memset(block, 0, 16 * sizeof(*block));
+}
+
+/**
+ * 8x8 version of idct4_sums().
+ */
+static void idct8_sums(int *sum, int16_t *block, int shift, int dc_only)
+{
+    const int size = 8 >> shift;
+    int tmp[64];
+    int i;
+
+    if (dc_only) {
+        for (i = 0; i < size * size; i++)
+            sum[i] += block[0] * (1 << 2 * shift);
+        block[0] = 0;
+        return;
+    }
+
+    for (i = 0; i < 8; i++) {
+        const int a0 =  block[i + 0 * 8] + block[i + 4 * 8];
+        const int a2 =  block[i + 0 * 8] - block[i + 4 * 8];
+        const int a4 = (block[i + 2 * 8] >> 1) - block[i + 6 * 8];
+        const int a6 = (block[i + 6 * 8] >> 1) + block[i + 2 * 8];
+
+        const int b0 = a0 + a6;
+        const int b2 = a2 + a4;
+        const int b4 = a2 - a4;
+        const int b6 = a0 - a6;
+
+        const int a1 = -block[i + 3 * 8] + block[i + 5 * 8] - block[i + 7 * 8] - (block[i + 7 * 8] >> 1);
+        const int a3 =  block[i + 1 * 8] + block[i + 7 * 8] - block[i + 3 * 8] - (block[i + 3 * 8] >> 1);
+        const int a5 = -block[i + 1 * 8] + block[i + 7 * 8] + block[i + 5 * 8] + (block[i + 5 * 8] >> 1);
+        const int a7 =  block[i + 3 * 8] + block[i + 5 * 8] + block[i + 1 * 8] + (block[i + 1 * 8] >> 1);
+
+        const int b1 = (a7 >> 2) + a1;
+        const int b3 =  a3 + (a5 >> 2);
+        const int b5 = (a3 >> 2) - a5;
+        const int b7 =  a7 - (a1 >> 2);
+
+        tmp[i + 0 * 8] = b0 + b7;
+        tmp[i + 7 * 8] = b0 - b7;
+        tmp[i + 1 * 8] = b2 + b5;
+        tmp[i + 6 * 8] = b2 - b5;
+        tmp[i + 2 * 8] = b4 + b3;
+        tmp[i + 5 * 8] = b4 - b3;
+        tmp[i + 3 * 8] = b6 + b1;
+        tmp[i + 4 * 8] = b6 - b1;
+    }
+
+    for (i = 0; i < 8; i++) {
+        const int a0 =  tmp[0 + i * 8] + tmp[4 + i * 8];
+        const int a2 =  tmp[0 + i * 8] - tmp[4 + i * 8];
+        const int a4 = (tmp[2 + i * 8] >> 1) - tmp[6 + i * 8];
+        const int a6 = (tmp[6 + i * 8] >> 1) + tmp[2 + i * 8];
+
+        const int b0 = a0 + a6;
+        const int b2 = a2 + a4;
+        const int b4 = a2 - a4;
+        const int b6 = a0 - a6;
+
+        const int a1 = -tmp[3 + i * 8] + tmp[5 + i * 8] - tmp[7 + i * 8] - (tmp[7 + i * 8] >> 1);
+        const int a3 =  tmp[1 + i * 8] + tmp[7 + i * 8] - tmp[3 + i * 8] - (tmp[3 + i * 8] >> 1);
+        const int a5 = -tmp[1 + i * 8] + tmp[7 + i * 8] + tmp[5 + i * 8] + (tmp[5 + i * 8] >> 1);
+        const int a7 =  tmp[3 + i * 8] + tmp[5 + i * 8] + tmp[1 + i * 8] + (tmp[1 + i * 8] >> 1);
+
+        const int b1 = (a7 >> 2) + a1;
+        const int b3 =  a3 + (a5 >> 2);
+        const int b5 = (a3 >> 2) - a5;
+        const int b7 =  a7 - (a1 >> 2);
+        int *s = sum + (i >> shift);
+
+        s[(0 >> shift) * size] += b0 + b7;
+        s[(1 >> shift) * size] += b2 + b5;
+        s[(2 >> shift) * size] += b4 + b3;
+        s[(3 >> shift) * size] += b6 + b1;
+        s[(4 >> shift) * size] += b6 - b1;
+        s[(5 >> shift) * size] += b4 - b3;
+        s[(6 >> shift) * size] += b2 - b5;
+        s[(7 >> shift) * size] += b0 - b7;
+    }
+
+    memset(block, 0, 64 * sizeof(*block));
+}
+
+static void add_sums(uint8_t *dst, ptrdiff_t stride, const int *sum,
+                     int size, int shift)
+{
+    int x, y;
+
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x++)
+            dst[x] = av_clip_uint8(dst[x] +
+                                   ((sum[x] + (1 << (shift - 1))) >> shift));
+        dst += stride;
+        sum += size;
+    }
+}
+
+static int block_offset_lowres(int n, ptrdiff_t stride, int lowres)
+{
+    const int x = 4 * ((scan8[n] - scan8[0]) & 7);
+    const int y = 4 * ((scan8[n] - scan8[0]) >> 3);
+
+    return (x >> lowres) + (y >> lowres) * stride;
+}
+
+/**
+ * Add the residual of the 4x4 block n at lowres 1 or 2.
+ *
+ * @param dc_coded whether the DC coefficients are coded separately, in which
+ *                 case the number of non-zero coefficients only counts the
+ *                 AC ones
+ */
+static void idct4_add_lowres(const H264Context *h, H264SliceContext *sl,
+                             uint8_t *dst, ptrdiff_t stride, int n,
+                             int dc_coded)
+{
+    int16_t *block = sl->mb + 16 * n;
+    const int nnz  = sl->non_zero_count_cache[scan8[n]];
+    int sum[4]     = { 0 };
+
+    if (!nnz && !block[0])
+        return;
+
+    idct4_sums(sum, block, h->lowres, dc_coded ? !nnz : nnz == 1 && block[0]);
+    add_sums(dst, stride, sum, 4 >> h->lowres, 6 + 2 * h->lowres);
+}
+
+/**
+ * Add the residual of the four 4x4 blocks forming the 8x8 area starting with
+ * block n, which is a single sample at lowres 3.
+ */
+static void idct4_add8x8_lowres(const H264Context *h, H264SliceContext *sl,
+                                uint8_t *dst, ptrdiff_t stride, int n,
+                                int dc_coded)
+{
+    int sum = 0, coded = 0;
+    int i;
+
+    if (h->lowres < 3) {
+        for (i = 0; i < 4; i++)
+            idct4_add_lowres(h, sl, dst + block_offset_lowres(i, stride, h->lowres),
+                             stride, n + i, dc_coded);
+        return;
+    }
+
+    for (i = 0; i < 4; i++) {
+        int16_t *block = sl->mb + 16 * (n + i);
+        const int nnz  = sl->non_zero_count_cache[scan8[n + i]];
+
+        if (!nnz && !block[0])
+            continue;
+        idct4_sums(&sum, block, 2, dc_coded ? !nnz : nnz == 1 && block[0]);
+        coded = 1;
+    }
+    if (coded)
+        add_sums(dst, stride, &sum, 1, 12);
+}
+
+static void idct8_add_lowres(const H264Context *h, H264SliceContext *sl,
+                             uint8_t *dst, ptrdiff_t stride, int n)
+{
+    int16_t *block = sl->mb + 16 * n;
+    const int nnz  = sl->non_zero_count_cache[scan8[n]];
+    int sum[16]    = { 0 };
+
+    if (!nnz)
+        return;
+
+    idct8_sums(sum, block, h->lowres, nnz == 1 && block[0]);
+    add_sums(dst, stride, sum, 8 >> h->lowres, 6 + 2 * h->lowres);
+}
+
+static void idct_luma_lowres(const H264Context *h, H264SliceContext *sl,
+                             int mb_type, uint8_t *dest_y, int linesize)
+{
+    int i;
+
+    if (!(sl->cbp & 15))
+        return;
+
+    for (i = 0; i < 16; i += 4) {
+        uint8_t *ptr = dest_y + block_offset_lowres(i, linesize, h->lowres);
+
+        if (IS_8x8DCT(mb_type))
+            idct8_add_lowres(h, sl, ptr, linesize, i);
+        else
+            idct4_add8x8_lowres(h, sl, ptr, linesize, i, 0);
+    }
+}
+
+/**
+ * Bilinear interpolation of a block of any size, the DSP functions only
+ * handle widths of 2 to 8 and an even number of lines.
+ */
+static void mc_block_c(uint8_t *dst, const uint8_t *src, ptrdiff_t stride,
+                       int width, int height, int mx, int my, int avg)
+{
+    const int A = (8 - mx) * (8 - my);
+    const int B =      mx  * (8 - my);
+    const int C = (8 - mx) *      my;
+    const int D =      mx  *      my;
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            int v = (A * src[x]          + B * src[x + 1] +
+                     C * src[x + stride] + D * src[x + stride + 1] + 32) >> 6;
+            dst[x] = avg ? (dst[x] + v + 1) >> 1 : v;
+        }
+        dst += stride;
+        src += stride;
+    }
+}
+
+/**
+ * Interpolate a block at a position in 1/8 samples of the reduced picture.
+ */
+static void mc_lowres(const H264Context *h, H264SliceContext *sl,
+                      uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+                      int x, int y, int width, int height,
+                      int pic_width, int pic_height, int avg)
+{
+    const int full_x = x >> 3;
+    const int full_y = y >> 3;
+
+    src += full_x + full_y * stride;
+    if (full_x < 0 || full_x + width  + 1 > pic_width ||
+        full_y < 0 || full_y + height + 1 > pic_height) {
+        h->vdsp.emulated_edge_mc(sl->edge_emu_buffer, src, stride, stride,
+                                 width + 1, height + 1, full_x, full_y,
+                                 pic_width, pic_height);
+        src = sl->edge_emu_buffer;
+    }
+
+    if (width >= 2 && !(height & 1)) {
+        const h264_chroma_mc_func *op = avg ? h->h264chroma.avg_h264_chroma_pixels_tab :
+                                              h->h264chroma.put_h264_chroma_pixels_tab;
+        op[width == 8 ? 0 : width == 4 ? 1 : 2](dst, src, stride, height,
+                                                x & 7, y & 7);
+    } else
+        mc_block_c(dst, src, stride, width, height, x & 7, y & 7, avg);
+}
+
+/* a partition in reduced resolution samples, w (cw) is 0 for partitions
+ * without luma (chroma) samples */
+typedef struct LowresPart {
+    int x, y, w, h;
+    int cx, cy, cw, ch;
+    int full_x, full_y;     ///< position of the partition in the picture
+} LowresPart;
+
+/**
+ * Position and size at reduced resolution of a segment of a partition.
+ * Segments smaller than a sample cover it only if they contain its start.
+ */
+static int lowres_segment(int pos, int size, int lowres, int *lpos, int *lsize)
+{
+    *lpos  = pos  >> lowres;
+    *lsize = size >> lowres;
+    if (!*lsize) {
+        if (pos & ((1 << lowres) - 1))
+            return 0;
+        *lsize = 1;
+    }
+    return 1;
+}
+
+static void mc_dir_part_lowres(const H264Context *h, H264SliceContext *sl,
+                               H264Ref *pic, int n, int list,
+                               const LowresPart *part,
+                               uint8_t *dest_y, uint8_t *dest_cb,
+                               uint8_t *dest_cr, int avg)
+{
+    const int lowres     = h->lowres;
+    const int mx         = sl->mv_cache[list][scan8[n]][0] + 4 * part->full_x;
+    int my               = sl->mv_cache[list][scan8[n]][1] + 4 * part->full_y;
+    const int pic_width  = 16 * h->mb_width >> lowres;
+    const int pic_height = (16 * h->mb_height >> MB_FIELD(sl)) >> lowres;
+
+    /* 1/4 sample luma and 1/8 sample chroma vectors, in 1/8 reduced samples */
+    if (part->w)
+        mc_lowres(h, sl, dest_y, pic->data[0], sl->mb_linesize,
+                  mx >> (lowres - 1), my >> (lowres - 1), part->w, part->h,
+                  pic_width, pic_height, avg);
+
+    if (!part->cw || (CONFIG_GRAY && h->flags & AV_CODEC_FLAG_GRAY))
+        return;
+
+    if (MB_FIELD(sl)) {
+        // chroma offset when predicting from a field of opposite parity
+        my += 2 * ((sl->mb_y & 1) - (pic->reference - 1));
+    }
+
+    mc_lowres(h, sl, dest_cb, pic->data[1], sl->mb_uvlinesize,
+              mx >> lowres, my >> lowres, part->cw, part->ch,
+              pic_width >> 1, pic_height >> 1, avg);
+    mc_lowres(h, sl, dest_cr, pic->data[2], sl->mb_uvlinesize,
+              mx >> lowres, my >> lowres, part->cw, part->ch,
+              pic_width >> 1, pic_height >> 1, avg);
+}
+
+static void weight_lowres(uint8_t *block, ptrdiff_t stride, int width,
+                          int height, int log2_denom, int weight, int offset)
+{
+    int x, y;
+
+    offset = (unsigned)offset << log2_denom;
+    if (log2_denom)
+        offset += 1 << (log2_denom - 1);
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++)
+            block[x] = av_clip_uint8((block[x] * weight + offset) >> log2_denom);
+        block += stride;
+    }
+}
+
+static void biweight_lowres(uint8_t *dst, const uint8_t *src, ptrdiff_t stride,
+                            int width, int height, int log2_denom,
+                            int weightd, int weights, int offset)
+{
+    int x, y;
+
+    offset = (unsigned)((offset + 1) | 1) << log2_denom;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++)
+            dst[x] = av_clip_uint8((src[x] * weights + dst[x] * weightd +
+                                    offset) >> (log2_denom + 1));
+        dst += stride;
+        src += stride;
+    }
+}
+
+static void mc_part_weighted_lowres(const H264Context *h, H264SliceContext *sl,
+                                    int n, const LowresPart *part,
+                                    uint8_t *dest_y, uint8_t *dest_cb,
+                                    uint8_t *dest_cr, int list0, int list1)
+{
+    const int luma_denom   = sl->pwt.luma_log2_weight_denom;
+    const int chroma_denom = sl->pwt.chroma_log2_weight_denom;
+
+    if (list0 && list1) {
+        uint8_t *tmp_cb = sl->bipred_scratchpad;
+        uint8_t *tmp_cr = sl->bipred_scratchpad + 16;
+        uint8_t *tmp_y  = sl->bipred_scratchpad + 16 * sl->mb_uvlinesize;
+        int refn0       = sl->ref_cache[0][scan8[n]];
+        int refn1       = sl->ref_cache[1][scan8[n]];
+        int i;
+
+        mc_dir_part_lowres(h, sl, &sl->ref_list[0][refn0], n, 0, part,
+                           dest_y, dest_cb, dest_cr, 0);
+        mc_dir_part_lowres(h, sl, &sl->ref_list[1][refn1], n, 1, part,
+                           tmp_y, tmp_cb, tmp_cr, 0);
+
+        if (sl->pwt.use_weight == 2) {
+            int weight0 = sl->pwt.implicit_weight[refn0][refn1][sl->mb_y & 1];
+            int weight1 = 64 - weight0;
+            biweight_lowres(dest_y, tmp_y, sl->mb_linesize, part->w, part->h,
+                            5, weight0, weight1, 0);
+            biweight_lowres(dest_cb, tmp_cb, sl->mb_uvlinesize, part->cw,
+                            part->ch, 5, weight0, weight1, 0);
+            biweight_lowres(dest_cr, tmp_cr, sl->mb_uvlinesize, part->cw,
+                            part->ch, 5, weight0, weight1, 0);
+        } else {
+            biweight_lowres(dest_y, tmp_y, sl->mb_linesize, part->w, part->h,
+                            luma_denom,
+                            sl->pwt.luma_weight[refn0][0][0],
+                            sl->pwt.luma_weight[refn1][1][0],
+                            sl->pwt.luma_weight[refn0][0][1] +
+                            sl->pwt.luma_weight[refn1][1][1]);
+            for (i = 0; i < 2; i++)
+                biweight_lowres(i ? dest_cr : dest_cb, i ? tmp_cr : tmp_cb,
+                                sl->mb_uvlinesize, part->cw, part->ch,
+                                chroma_denom,
+                                sl->pwt.chroma_weight[refn0][0][i][0],
+                                sl->pwt.chroma_weight[refn1][1][i][0],
+                                sl->pwt.chroma_weight[refn0][0][i][1] +
+                                sl->pwt.chroma_weight[refn1][1][i][1]);
+        }
+    } else {
+        int list = list1 ? 1 : 0;
+        int refn = sl->ref_cache[list][scan8[n]];
+        int i;
+
+        mc_dir_part_lowres(h, sl, &sl->ref_list[list][refn], n, list, part,
+                           dest_y, dest_cb, dest_cr, 0);
+
+        weight_lowres(dest_y, sl->mb_linesize, part->w, part->h, luma_denom,
+                      sl->pwt.luma_weight[refn][list][0],
+                      sl->pwt.luma_weight[refn][list][1]);
+        if (sl->pwt.use_weight_chroma) {
+            for (i = 0; i < 2; i++)
+                weight_lowres(i ? dest_cr : dest_cb, sl->mb_uvlinesize,
+                              part->cw, part->ch, chroma_denom,
+                              sl->pwt.chroma_weight[refn][list][i][0],
+                              sl->pwt.chroma_weight[refn][list][i][1]);
+        }
+    }
+}
+
+/**
+ * Motion compensation of a partition of width x height luma samples at
+ * x_offset, y_offset in the macroblock.
+ */
+static void mc_part_lowres(const H264Context *h, H264SliceContext *sl,
+                           int n, int x_offset, int y_offset,
+                           int width, int height,
+                           uint8_t *dest_y, uint8_t *dest_cb, uint8_t *dest_cr,
+                           int list0, int list1)
+{
+    const int lowres = h->lowres;
+    LowresPart part;
+
+    if (!lowres_segment(x_offset, width,  lowres, &part.x, &part.w) ||
+        !lowres_segment(y_offset, height, lowres, &part.y, &part.h))
+        return;
+    if (!lowres_segment(x_offset >> 1, width  >> 1, lowres, &part.cx, &part.cw) ||
+        !lowres_segment(y_offset >> 1, height >> 1, lowres, &part.cy, &part.ch))
+        part.cw = part.ch = 0;
+
+    part.full_x = 16 * sl->mb_x + x_offset;
+    part.full_y = 16 * (sl->mb_y >> MB_FIELD(sl)) + y_offset;
+
+    dest_y  += part.x  + part.y  * sl->mb_linesize;
+    dest_cb += part.cx + part.cy * sl->mb_uvlinesize;
+    dest_cr += part.cx + part.cy * sl->mb_uvlinesize;
+
+    if ((sl->pwt.use_weight == 2 && list0 && list1 &&
+         (sl->pwt.implicit_weight[sl->ref_cache[0][scan8[n]]][sl->ref_cache[1][scan8[n]]][sl->mb_y & 1] != 32)) ||
+        sl->pwt.use_weight == 1) {
+        mc_part_weighted_lowres(h, sl, n, &part, dest_y, dest_cb, dest_cr,
+                                list0, list1);
+        return;
+    }
+
+    if (list0)
+        mc_dir_part_lowres(h, sl, &sl->ref_list[0][sl->ref_cache[0][scan8[n]]],
+                           n, 0, &part, dest_y, dest_cb, dest_cr, 0);
+    if (list1)
+        mc_dir_part_lowres(h, sl, &sl->ref_list[1][sl->ref_cache[1][scan8[n]]],
+                           n, 1, &part, dest_y, dest_cb, dest_cr, list0);
+}
+
+static void hl_motion_lowres(const H264Context *h, H264SliceContext *sl,
+                             uint8_t *dest_y, uint8_t *dest_cb,
+                             uint8_t *dest_cr)
+{
+    const int mb_type = h->cur_pic.mb_type[sl->mb_xy];
+    int i, j;
+
+    if (HAVE_THREADS && (h->avctx->active_thread_type & FF_THREAD_FRAME))
+        ff_h264_await_references(h, sl);
+
+    if (IS_16X16(mb_type)) {
+        mc_part_lowres(h, sl, 0, 0, 0, 16, 16, dest_y, dest_cb, dest_cr,
+                       IS_DIR(mb_type, 0, 0), IS_DIR(mb_type, 0, 1));
+    } else if (IS_16X8(mb_type)) {
+        mc_part_lowres(h, sl, 0, 0, 0, 16, 8, dest_y, dest_cb, dest_cr,
+                       IS_DIR(mb_type, 0, 0), IS_DIR(mb_type, 0, 1));
+        mc_part_lowres(h, sl, 8, 0, 8, 16, 8, dest_y, dest_cb, dest_cr,
+                       IS_DIR(mb_type, 1, 0), IS_DIR(mb_type, 1, 1));
+    } else if (IS_8X16(mb_type)) {
+        mc_part_lowres(h, sl, 0, 0, 0, 8, 16, dest_y, dest_cb, dest_cr,
+                       IS_DIR(mb_type, 0, 0), IS_DIR(mb_type, 0, 1));
+        mc_part_lowres(h, sl, 4, 8, 0, 8, 16, dest_y, dest_cb, dest_cr,
+                       IS_DIR(mb_type, 1, 0), IS_DIR(mb_type, 1, 1));
+    } else {
+        for (i = 0; i < 4; i++) {
+            const int sub_mb_type = sl->sub_mb_type[i];
+            const int n  = 4 * i;
+            const int x  = (i & 1) << 3;
+            const int y  = (i & 2) << 2;
+            const int l0 = IS_DIR(sub_mb_type, 0, 0);
+            const int l1 = IS_DIR(sub_mb_type, 0, 1);
+
+            if (IS_SUB_8X8(sub_mb_type)) {
+                mc_part_lowres(h, sl, n, x, y, 8, 8,
+                               dest_y, dest_cb, dest_cr, l0, l1);
+            } else if (IS_SUB_8X4(sub_mb_type)) {
+                mc_part_lowres(h, sl, n, x, y, 8, 4,
+                               dest_y, dest_cb, dest_cr, l0, l1);
+                mc_part_lowres(h, sl, n + 2, x, y + 4, 8, 4,
+                               dest_y, dest_cb, dest_cr, l0, l1);
+            } else if (IS_SUB_4X8(sub_mb_type)) {
+                mc_part_lowres(h, sl, n, x, y, 4, 8,
+                               dest_y, dest_cb, dest_cr, l0, l1);
+                mc_part_lowres(h, sl, n + 1, x + 4, y, 4, 8,
+                               dest_y, dest_cb, dest_cr, l0, l1);
+            } else {
+                for (j = 0; j < 4; j++)
+                    mc_part_lowres(h, sl, n + j, x + 4 * (j & 1), y + 2 * (j & 2),
+                                   4, 4, dest_y, dest_cb, dest_cr, l0, l1);
+            }
+        }
+    }
+}
+
+/**
+ * Average the src_size x src_size block at src over the areas of the output
+ * samples.
+ */
+static void reduce_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *src,
+                         ptrdiff_t src_stride, int src_size, int lowres)
+{
+    const int size = src_size >> lowres;
+    int x, y, i, j;
+
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x++) {
+            const uint8_t *s = src + (x << lowres) + (y << lowres) * src_stride;
+            int sum = 0;
+
+            for (j = 0; j < 1 << lowres; j++)
+                for (i = 0; i < 1 << lowres; i++)
+                    sum += s[i + j * src_stride];
+            dst[x] = (sum + (1 << (2 * lowres - 1))) >> (2 * lowres);
+        }
+        dst += stride;
+    }
+}
+
+/* the full resolution macroblock starts at the second row and the 17th
+ * column of the reconstruction buffers, the luma one has room for the 8
+ * top right neighbours */
+#define FULL_STRIDE   48
+#define FULL_CSTRIDE  32
+
+static av_always_inline int border_avail(const H264Context *h,
+                                         const H264SliceContext *sl, int mb_xy)
+{
+    return h->slice_table[mb_xy] == sl->slice_num;
+}
+
+/**
+ * The borders follow the lines of the picture: in MBAFF pictures the right
+ * columns of the two macroblocks of a pair hold the 32 lines of the pair in
+ * order, and the bottom rows its last two lines, whatever the coding of the
+ * pair. The first line of a frame macroblock at the bottom of its pair is
+ * predicted from the bottom row of the top one, until it replaces it.
+ *
+ * @return the line of the pair holding line i of the current macroblock,
+ *         i itself outside of MBAFF pictures
+ */
+static av_always_inline int pair_line(const H264Context *h,
+                                      const H264SliceContext *sl,
+                                      int i, int size)
+{
+    const int bottom = FRAME_MBAFF(h) && (sl->mb_y & 1);
+
+    return FRAME_MBAFF(h) && MB_FIELD(sl) ? 2 * i + bottom : bottom * size + i;
+}
+
+/**
+ * Load the full resolution neighbours of the current macroblock in plane p.
+ * The ones outside the slice are not used by the prediction, they are only
+ * set to keep the output deterministic.
+ */
+static void load_border(const H264Context *h, const H264SliceContext *sl,
+                        uint8_t *dst, ptrdiff_t stride, int p)
+{
+    const H264LowresBorder *b = h->lowres_borders;
+    const int size    = p ? 8 : 16;
+    const int top_xy  = sl->mb_xy - (h->mb_stride << MB_FIELD(sl));
+    const int left_xy = sl->mb_xy - 1 -
+                        (FRAME_MBAFF(h) && (sl->mb_y & 1)) * h->mb_stride;
+    const int left    = border_avail(h, sl, left_xy);
+    int i;
+
+    if (FRAME_MBAFF(h) && !MB_FIELD(sl) && (sl->mb_y & 1))
+        dst[-stride - 1] = left ? b[left_xy].right[p][size - 1] : 128;
+    else
+        dst[-stride - 1] = border_avail(h, sl, top_xy - 1) ?
+                           b[top_xy - 1].bottom[p][size - 1] : 128;
+    if (border_avail(h, sl, top_xy))
+        memcpy(dst - stride, b[top_xy].bottom[p], size);
+    else
+        memset(dst - stride, 128, size);
+    if (!p) {
+        if (border_avail(h, sl, top_xy + 1))
+            memcpy(dst - stride + 16, b[top_xy + 1].bottom[0], 8);
+        else
+            memset(dst - stride + 16, 128, 8);
+    }
+    for (i = 0; i < size; i++) {
+        const int line = pair_line(h, sl, i, size);
+
+        dst[i * stride - 1] = left ? b[left_xy + line / size * h->mb_stride].right[p][line % size] :
+                                     128;
+    }
+}
+
+/**
+ * Keep the edges of the current macroblock in plane p.
+ *
+ * @param right  the right column of the macroblock
+ * @param last   its last row
+ * @param last2  the row before the last one
+ */
+static void store_border(const H264Context *h, const H264SliceContext *sl,
+                         int p, const uint8_t *right, const uint8_t *last,
+                         const uint8_t *last2)
+{
+    H264LowresBorder *b = h->lowres_borders;
+    const int size      = p ? 8 : 16;
+    const int pair_xy   = sl->mb_xy -
+                          (FRAME_MBAFF(h) && (sl->mb_y & 1)) * h->mb_stride;
+    int i;
+
+    memcpy(b[sl->mb_xy].bottom[p], last, size);
+    if (FRAME_MBAFF(h) && !MB_FIELD(sl) && (sl->mb_y & 1))
+        memcpy(b[pair_xy].bottom[p], last2, size);
+    for (i = 0; i < size; i++) {
+        const int line = pair_line(h, sl, i, size);
+
+        b[pair_xy + line / size * h->mb_stride].right[p][line % size] = right[i];
+    }
+}
+
+static void store_full_border(const H264Context *h, const H264SliceContext *sl,
+                              const uint8_t *src, ptrdiff_t stride, int p)
+{
+    const int size = p ? 8 : 16;
+    uint8_t right[16];
+    int i;
+
+    for (i = 0; i < size; i++)
+        right[i] = src[i * stride + size - 1];
+    store_border(h, sl, p, right, src + (size - 1) * stride,
+                 src + (size - 2) * stride);
+}
+
+/**
+ * Interpolate linearly the n full resolution samples of an edge from the
+ * n >> lowres reduced ones at src, step apart. The reduced samples are at the
+ * center of their areas, the edge samples beyond the first and last ones
+ * repeat them.
+ */
+static void upsample_edge(uint8_t *dst, int n, const uint8_t *src,
+                          ptrdiff_t step, int lowres)
+{
+    const int last  = (n >> lowres) - 1;
+    const int shift = lowres + 1;
+    int x;
+
+    for (x = 0; x < n; x++) {
+        /* the position of the sample in 1 / (2 << lowres) reduced samples */
+        const int pos  = 2 * x + 1 - (1 << lowres);
+        const int i    = pos >> shift;
+        const int frac = pos & ((1 << shift) - 1);
+
+        if (pos < 0)
+            dst[x] = src[0];
+        else if (i >= last)
+            dst[x] = src[last * step];
+        else
+            dst[x] = (src[i * step] * ((1 << shift) - frac) +
+                      src[(i + 1) * step] * frac + (1 << lowres)) >> shift;
+    }
+}
+
+static void store_reduced_border(const H264Context *h,
+                                 const H264SliceContext *sl,
+                                 const uint8_t *src, ptrdiff_t stride, int p)
+{
+    const int size  = p ? 8 : 16;
+    const int rsize = size >> h->lowres;
+    uint8_t right[16], last[16];
+
+    upsample_edge(right, size, src + rsize - 1, stride, h->lowres);
+    upsample_edge(last,  size, src + (rsize - 1) * stride, 1, h->lowres);
+    store_border(h, sl, p, right, last, last);
+}
+
+/**
+ * Predict the luma of an intra macroblock and add its residual at full
+ * resolution, like hl_decode_mb_predict_luma() and hl_decode_mb_idct_luma()
+ * for 8-bit samples without transform bypass.
+ */
+static void intra_luma_full(const H264Context *h, H264SliceContext *sl,
+                            int mb_type, uint8_t *dest_y,
+                            const int *block_offset)
+{
+    int i;
+
+    if (IS_INTRA4x4(mb_type)) {
+        if (IS_8x8DCT(mb_type)) {
+            for (i = 0; i < 16; i += 4) {
+                uint8_t *const ptr = dest_y + block_offset[i];
+                const int dir      = sl->intra4x4_pred_mode_cache[scan8[i]];
+                const int nnz      = sl->non_zero_count_cache[scan8[i]];
+
+                h->hpc.pred8x8l[dir](ptr, (sl->topleft_samples_available << i) & 0x8000,
+                                     (sl->topright_samples_available << i) & 0x4000,
+                                     FULL_STRIDE);
+                if (nnz) {
+                    if (nnz == 1 && sl->mb[i * 16])
+                        h->h264dsp.h264_idct8_dc_add(ptr, sl->mb + i * 16, FULL_STRIDE);
+                    else
+                        h->h264dsp.h264_idct8_add(ptr, sl->mb + i * 16, FULL_STRIDE);
+                }
+            }
+        } else {
+            for (i = 0; i < 16; i++) {
+                uint8_t *const ptr = dest_y + block_offset[i];
+                const int dir      = sl->intra4x4_pred_mode_cache[scan8[i]];
+                const int nnz      = sl->non_zero_count_cache[scan8[i]];
+                uint8_t *topright  = NULL;
+                uint32_t tr;
+
+                if (dir == DIAG_DOWN_LEFT_PRED || dir == VERT_LEFT_PRED) {
+                    if ((sl->topright_samples_available << i) & 0x8000) {
+                        topright = ptr + 4 - FULL_STRIDE;
+                    } else {
+                        tr       = ptr[3 - FULL_STRIDE] * 0x01010101u;
+                        topright = (uint8_t *)&tr;
+                    }
+                }
+
+                h->hpc.pred4x4[dir](ptr, topright, FULL_STRIDE);
+                if (nnz) {
+                    if (nnz == 1 && sl->mb[i * 16])
+                        h->h264dsp.h264_idct_dc_add(ptr, sl->mb + i * 16, FULL_STRIDE);
+                    else
+                        h->h264dsp.h264_idct_add(ptr, sl->mb + i * 16, FULL_STRIDE);
+                }
+            }
+        }
+    } else {
+        h->hpc.pred16x16[sl->intra16x16_pred_mode](dest_y, FULL_STRIDE);
+        if (sl->non_zero_count_cache[scan8[LUMA_DC_BLOCK_INDEX]])
+            h->h264dsp.h264_luma_dc_dequant_idct(sl->mb, sl->mb_luma_dc[0],
+                                                 h->ps.pps->dequant4_coeff[0][sl->qscale][0]);
+        h->h264dsp.h264_idct_add16intra(dest_y, block_offset, sl->mb,
+                                        FULL_STRIDE, sl->non_zero_count_cache);
+    }
+}
+
+/**
+ * Reconstruct an intra or PCM macroblock at full resolution from the full
+ * resolution neighbours, keep its edges for the next intra macroblocks and
+ * reduce it into the picture.
+ */
+static void intra_mb_full(const H264Context *h, H264SliceContext *sl,
+                          int mb_type, uint8_t *dest_y, uint8_t *dest_cb,
+                          uint8_t *dest_cr, int linesize, int uvlinesize,
+                          int gray)
+{
+    DECLARE_ALIGNED(16, uint8_t, luma)[17 * FULL_STRIDE];
+    DECLARE_ALIGNED(16, uint8_t, chroma)[2][9 * FULL_CSTRIDE];
+    uint8_t *full[3] = { luma      + FULL_STRIDE  + 16,
+                         chroma[0] + FULL_CSTRIDE + 16,
+                         chroma[1] + FULL_CSTRIDE + 16 };
+    const int planes = gray ? 1 : 3;
+    int block_offset[48];
+    int i, p;
+
+    if (IS_INTRA_PCM(mb_type)) {
+        for (i = 0; i < 16; i++)
+            memcpy(full[0] + i * FULL_STRIDE, sl->intra_pcm_ptr + i * 16, 16);
+        for (p = 1; p < planes; p++) {
+            for (i = 0; i < 8; i++) {
+                if (h->ps.sps->chroma_format_idc)
+                    memcpy(full[p] + i * FULL_CSTRIDE,
+                           sl->intra_pcm_ptr + 192 + 64 * p + i * 8, 8);
+                else
+                    memset(full[p] + i * FULL_CSTRIDE, 128, 8);
+            }
+        }
+    } else {
+        for (i = 0; i < 16; i++) {
+            const int x = 4 * ((scan8[i] - scan8[0]) & 7);
+            const int y = 4 * ((scan8[i] - scan8[0]) >> 3);
+
+            block_offset[i]      = x + y * FULL_STRIDE;
+            block_offset[16 + i] =
+            block_offset[32 + i] = x + y * FULL_CSTRIDE;
+        }
+
+        load_border(h, sl, full[0], FULL_STRIDE, 0);
+        for (p = 1; p < planes; p++) {
+            load_border(h, sl, full[p], FULL_CSTRIDE, p);
+            h->hpc.pred8x8[sl->chroma_pred_mode](full[p], FULL_CSTRIDE);
+        }
+
+        intra_luma_full(h, sl, mb_type, full[0], block_offset);
+
+        if (!gray && (sl->cbp & 0x30)) {
+            if (sl->non_zero_count_cache[scan8[CHROMA_DC_BLOCK_INDEX + 0]])
+                h->h264dsp.h264_chroma_dc_dequant_idct(sl->mb + 16 * 16 * 1,
+                                                       h->ps.pps->dequant4_coeff[1][sl->chroma_qp[0]][0]);
+            if (sl->non_zero_count_cache[scan8[CHROMA_DC_BLOCK_INDEX + 1]])
+                h->h264dsp.h264_chroma_dc_dequant_idct(sl->mb + 16 * 16 * 2,
+                                                       h->ps.pps->dequant4_coeff[2][sl->chroma_qp[1]][0]);
+            h->h264dsp.h264_idct_add8(full + 1, block_offset, sl->mb,
+                                      FULL_CSTRIDE, sl->non_zero_count_cache);
+        }
+    }
+
+    store_full_border(h, sl, full[0], FULL_STRIDE, 0);
+    reduce_block(dest_y, linesize, full[0], FULL_STRIDE, 16, h->lowres);
+    for (p = 1; p < planes; p++) {
+        store_full_border(h, sl, full[p], FULL_CSTRIDE, p);
+        reduce_block(p == 1 ? dest_cb : dest_cr, uvlinesize,
+                     full[p], FULL_CSTRIDE, 8, h->lowres);
+    }
+}
+
+void ff_h264_hl_decode_mb_lowres(const H264Context *h, H264SliceContext *sl)
+{
+    const int mb_x    = sl->mb_x;
+    const int mb_y    = sl->mb_y;
+    const int mb_xy   = sl->mb_xy;
+    const int mb_type = h->cur_pic.mb_type[mb_xy];
+    const int lowres  = h->lowres;
+    const int size    = 16 >> lowres;
+    const int csize   = 8 >> lowres;
+    const int gray    = CONFIG_GRAY && (h->flags & AV_CODEC_FLAG_GRAY);
+    uint8_t *dest_y, *dest_cb, *dest_cr;
+    int linesize, uvlinesize;
+    int i;
+
+    dest_y  = h->cur_pic.f->data[0] + (mb_x + mb_y * sl->linesize)   * size;
+    dest_cb = h->cur_pic.f->data[1] + (mb_x + mb_y * sl->uvlinesize) * csize;
+    dest_cr = h->cur_pic.f->data[2] + (mb_x + mb_y * sl->uvlinesize) * csize;
+
+    h->list_counts[mb_xy] = sl->list_count;
+
+    if (MB_FIELD(sl)) {
+        linesize   = sl->mb_linesize   = sl->linesize   * 2;
+        uvlinesize = sl->mb_uvlinesize = sl->uvlinesize * 2;
+        if (mb_y & 1) {
+            dest_y  -= sl->linesize   * (size  - 1);
+            dest_cb -= sl->uvlinesize * (csize - 1);
+            dest_cr -= sl->uvlinesize * (csize - 1);
+        }
+        if (FRAME_MBAFF(h)) {
+            int list;
+            for (list = 0; list < sl->list_count; list++) {
+                if (!USES_LIST(mb_type, list))
+                    continue;
+                if (IS_16X16(mb_type)) {
+                    int8_t *ref = &sl->ref_cache[list][scan8[0]];
+                    fill_rectangle(ref, 4, 4, 8, (16 + *ref) ^ (sl->mb_y & 1), 1);
+                } else {
+                    for (i = 0; i < 16; i += 4) {
+                        int ref = sl->ref_cache[list][scan8[i]];
+                        if (ref >= 0)
+                            fill_rectangle(&sl->ref_cache[list][scan8[i]], 2, 2,
+                                           8, (16 + ref) ^ (sl->mb_y & 1), 1);
+                    }
+                }
+            }
+        }
+    } else {
+        linesize   = sl->mb_linesize   = sl->linesize;
+        uvlinesize = sl->mb_uvlinesize = sl->uvlinesize;
+    }
+
+    if (IS_INTRA(mb_type)) {
+        intra_mb_full(h, sl, mb_type, dest_y, dest_cb, dest_cr,
+                      linesize, uvlinesize, gray);
+        return;
+    }
+
+    hl_motion_lowres(h, sl, dest_y, dest_cb, dest_cr);
+    idct_luma_lowres(h, sl, mb_type, dest_y, linesize);
+
+    if (!gray && (sl->cbp & 0x30)) {
+        if (sl->non_zero_count_cache[scan8[CHROMA_DC_BLOCK_INDEX + 0]])
+            h->h264dsp.h264_chroma_dc_dequant_idct(sl->mb + 16 * 16 * 1,
+                                                   h->ps.pps->dequant4_coeff[4][sl->chroma_qp[0]][0]);
+        if (sl->non_zero_count_cache[scan8[CHROMA_DC_BLOCK_INDEX + 1]])
+            h->h264dsp.h264_chroma_dc_dequant_idct(sl->mb + 16 * 16 * 2,
+                                                   h->ps.pps->dequant4_coeff[5][sl->chroma_qp[1]][0]);
+        idct4_add8x8_lowres(h, sl, dest_cb, uvlinesize, 16, 1);
+        idct4_add8x8_lowres(h, sl, dest_cr, uvlinesize, 32, 1);
+    }
+
+    store_reduced_border(h, sl, dest_y, linesize, 0);
+    if (!gray) {
+        store_reduced_border(h, sl, dest_cb, uvlinesize, 1);
+        store_reduced_border(h, sl, dest_cr, uvlinesize, 2);
+    }
+}
@@ -77,7 +77,7 @@ static void MCFUNC(hl_motion)(const H264Context *h, H264SliceContext *sl,
     assert(IS_INTER(mb_type));
 
     if (HAVE_THREADS && (h->avctx->active_thread_type & FF_THREAD_FRAME))
-        await_references(h, sl);
+        ff_h264_await_references(h, sl);
     prefetch_motion(h, sl, 0, PIXEL_SHIFT, CHROMA_IDC);
 
     if (IS_16X16(mb_type)) {
@@ -17,14 +17,14 @@
  */
 
 #include "bytestream.h"
-#include "get_bits.h"
-#include "golomb_legacy.h"
+#include "bitstream.h"
+#include "golomb.h"
 #include "h264.h"
 #include "h264dec.h"
 #include "h264_parse.h"
 #include "h264_ps.h"
 
-int ff_h264_pred_weight_table(GetBitContext *gb, const SPS *sps,
+int ff_h264_pred_weight_table(BitstreamContext *bc, const SPS *sps,
                               const int *ref_count, int slice_type_nos,
                               H264PredWeightTable *pwt)
 {
@@ -33,9 +33,9 @@ int ff_h264_pred_weight_table(GetBitContext *gb, const SPS *sps,
 
     pwt->use_weight             = 0;
     pwt->use_weight_chroma      = 0;
-    pwt->luma_log2_weight_denom = get_ue_golomb(gb);
+    pwt->luma_log2_weight_denom = get_ue_golomb(bc);
     if (sps->chroma_format_idc)
-        pwt->chroma_log2_weight_denom = get_ue_golomb(gb);
+        pwt->chroma_log2_weight_denom = get_ue_golomb(bc);
     luma_def   = 1 << pwt->luma_log2_weight_denom;
     chroma_def = 1 << pwt->chroma_log2_weight_denom;
 
@@ -45,10 +45,10 @@ int ff_h264_pred_weight_table(GetBitContext *gb, const SPS *sps,
         for (i = 0; i < ref_count[list]; i++) {
             int luma_weight_flag, chroma_weight_flag;
 
-            luma_weight_flag = get_bits1(gb);
+            luma_weight_flag = bitstream_read_bit(bc);
             if (luma_weight_flag) {
-                pwt->luma_weight[i][list][0] = get_se_golomb(gb);
-                pwt->luma_weight[i][list][1] = get_se_golomb(gb);
+                pwt->luma_weight[i][list][0] = get_se_golomb(bc);
+                pwt->luma_weight[i][list][1] = get_se_golomb(bc);
                 if (pwt->luma_weight[i][list][0] != luma_def ||
                     pwt->luma_weight[i][list][1] != 0) {
                     pwt->use_weight             = 1;
@@ -60,12 +60,12 @@ int ff_h264_pred_weight_table(GetBitContext *gb, const SPS *sps,
             }
 
             if (sps->chroma_format_idc) {
-                chroma_weight_flag = get_bits1(gb);
+                chroma_weight_flag = bitstream_read_bit(bc);
                 if (chroma_weight_flag) {
                     int j;
                     for (j = 0; j < 2; j++) {
-                        pwt->chroma_weight[i][list][j][0] = get_se_golomb(gb);
-                        pwt->chroma_weight[i][list][j][1] = get_se_golomb(gb);
+                        pwt->chroma_weight[i][list][j][0] = get_se_golomb(bc);
+                        pwt->chroma_weight[i][list][j][1] = get_se_golomb(bc);
                         if (pwt->chroma_weight[i][list][j][0] != chroma_def ||
                             pwt->chroma_weight[i][list][j][1] != 0) {
                             pwt->use_weight_chroma        = 1;
@@ -189,7 +189,7 @@ int ff_h264_check_intra_pred_mode(void *logctx, int top_samples_available,
 }
 
 int ff_h264_parse_ref_count(int *plist_count, int ref_count[2],
-                            GetBitContext *gb, const PPS *pps,
+                            BitstreamContext *bc, const PPS *pps,
                             int slice_type_nos, int picture_structure)
 {
     int list_count;
@@ -200,14 +200,14 @@ int ff_h264_parse_ref_count(int *plist_count, int ref_count[2],
     ref_count[1] = pps->ref_count[1];
 
     if (slice_type_nos != AV_PICTURE_TYPE_I) {
-        num_ref_idx_active_override_flag = get_bits1(gb);
+        num_ref_idx_active_override_flag = bitstream_read_bit(bc);
 
         if (num_ref_idx_active_override_flag) {
-            ref_count[0] = get_ue_golomb(gb) + 1;
+            ref_count[0] = get_ue_golomb(bc) + 1;
             if (ref_count[0] < 1)
                 goto fail;
             if (slice_type_nos == AV_PICTURE_TYPE_B) {
-                ref_count[1] = get_ue_golomb(gb) + 1;
+                ref_count[1] = get_ue_golomb(bc) + 1;
                 if (ref_count[1] < 1)
                     goto fail;
             }
@@ -34,7 +34,7 @@
 #include "cabac.h"
 #include "cabac_functions.h"
 #include "error_resilience.h"
-#include "golomb_legacy.h"
+#include "golomb.h"
 #include "avcodec.h"
 #include "h264.h"
 #include "h264dec.h"
@@ -402,6 +402,7 @@ int ff_h264_update_thread_context(AVCodecContext *dst,
     }
 
     h->enable_er       = h1->enable_er;
+    h->lowres          = h1->lowres;
     h->workaround_bugs = h1->workaround_bugs;
     h->droppable       = h1->droppable;
 
@@ -749,7 +750,8 @@ static enum AVPixelFormat get_pixel_format(H264Context *h)
         break;
     case 8:
 #if CONFIG_H264_VDPAU_HWACCEL
-        *fmt++ = AV_PIX_FMT_VDPAU;
+        if (!h->lowres)
+            *fmt++ = AV_PIX_FMT_VDPAU;
 #endif
         if (CHROMA444(h)) {
             if (h->avctx->colorspace == AVCOL_SPC_RGB)
@@ -764,19 +766,22 @@ static enum AVPixelFormat get_pixel_format(H264Context *h)
             else
                 *fmt++ = AV_PIX_FMT_YUV422P;
         } else {
+            /* the hardware decoders only output full size pictures */
+            if (!h->lowres) {
 #if CONFIG_H264_DXVA2_HWACCEL
-            *fmt++ = AV_PIX_FMT_DXVA2_VLD;
+                *fmt++ = AV_PIX_FMT_DXVA2_VLD;
 #endif
 #if CONFIG_H264_D3D11VA_HWACCEL
-            *fmt++ = AV_PIX_FMT_D3D11VA_VLD;
+                *fmt++ = AV_PIX_FMT_D3D11VA_VLD;
 #endif
 #if CONFIG_H264_VAAPI_HWACCEL
-            *fmt++ = AV_PIX_FMT_VAAPI;
+                *fmt++ = AV_PIX_FMT_VAAPI;
 #endif
 #if CONFIG_H264_VDA_HWACCEL
-            *fmt++ = AV_PIX_FMT_VDA_VLD;
-            *fmt++ = AV_PIX_FMT_VDA;
+                *fmt++ = AV_PIX_FMT_VDA_VLD;
+                *fmt++ = AV_PIX_FMT_VDA;
 #endif
+            }
             if (h->avctx->codec->pix_fmts)
                 choices = h->avctx->codec->pix_fmts;
             else if (h->avctx->color_range == AVCOL_RANGE_JPEG)
@@ -823,8 +828,17 @@ static int init_dimensions(H264Context *h)
         h->height_from_caller = 0;
     }
 
-    h->avctx->coded_width  = h->width;
-    h->avctx->coded_height = h->height;
+    if (h->lowres) {
+        width  = AV_CEIL_RSHIFT(width,  h->lowres);
+        height = AV_CEIL_RSHIFT(height, h->lowres);
+        cl   >>= h->lowres;
+        ct   >>= h->lowres;
+        cr     = (h->width  >> h->lowres) - width  - cl;
+        cb     = (h->height >> h->lowres) - height - ct;
+    }
+
+    h->avctx->coded_width  = h->width  >> h->lowres;
+    h->avctx->coded_height = h->height >> h->lowres;
     h->avctx->width        = width;
     h->avctx->height       = height;
     h->crop_right          = cr;
@@ -945,6 +959,14 @@ static int h264_init_ps(H264Context *h, const H264SliceContext *sl)
     h->width  = 16 * h->mb_width;
     h->height = 16 * h->mb_height;
 
+    if (h->lowres && (sps->bit_depth_luma != 8 || sps->chroma_format_idc > 1 ||
+                      sps->transform_bypass)) {
+        avpriv_report_missing_feature(h->avctx,
+                                      "Lowres decoding of high bit depth, "
+                                      "4:2:2, 4:4:4 or lossless streams");
+        return AVERROR_PATCHWELCOME;
+    }
+
     ret = init_dimensions(h);
     if (ret < 0)
         return ret;
@@ -1420,8 +1442,8 @@ static int h264_field_start(H264Context *h, const H264SliceContext *sl,
                               (const uint8_t **)prev->f->data,
                               prev->f->linesize,
                               prev->f->format,
-                              h->mb_width  * 16,
-                              h->mb_height * 16);
+                              h->mb_width  * 16 >> h->lowres,
+                              h->mb_height * 16 >> h->lowres);
                 h->short_ref[0]->poc = prev->poc + 2;
             }
             h->short_ref[0]->frame_num = h->poc.prev_frame_num;
@@ -1526,9 +1548,9 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     unsigned int slice_type, tmp, i;
     int field_pic_flag, bottom_field_flag, picture_structure;
 
-    sl->first_mb_addr = get_ue_golomb(&sl->gb);
+    sl->first_mb_addr = get_ue_golomb(&sl->bc);
 
-    slice_type = get_ue_golomb_31(&sl->gb);
+    slice_type = get_ue_golomb_31(&sl->bc);
     if (slice_type > 9) {
         av_log(avctx, AV_LOG_ERROR,
                "slice type %d too large at %d\n",
@@ -1551,7 +1573,7 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
         return AVERROR_INVALIDDATA;
     }
 
-    sl->pps_id = get_ue_golomb(&sl->gb);
+    sl->pps_id = get_ue_golomb(&sl->bc);
     if (sl->pps_id >= MAX_PPS_COUNT) {
         av_log(avctx, AV_LOG_ERROR, "pps_id %u out of range\n", sl->pps_id);
         return AVERROR_INVALIDDATA;
@@ -1571,16 +1593,16 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     }
     sps = (const SPS*)ps->sps_list[pps->sps_id]->data;
 
-    sl->frame_num = get_bits(&sl->gb, sps->log2_max_frame_num);
+    sl->frame_num = bitstream_read(&sl->bc, sps->log2_max_frame_num);
 
     sl->mb_mbaff       = 0;
 
     if (sps->frame_mbs_only_flag) {
         picture_structure = PICT_FRAME;
     } else {
-        field_pic_flag = get_bits1(&sl->gb);
+        field_pic_flag = bitstream_read_bit(&sl->bc);
         if (field_pic_flag) {
-            bottom_field_flag = get_bits1(&sl->gb);
+            bottom_field_flag = bitstream_read_bit(&sl->bc);
             picture_structure = PICT_TOP_FIELD + bottom_field_flag;
         } else {
             picture_structure = PICT_FRAME;
@@ -1598,31 +1620,31 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     }
 
     if (nal->type == H264_NAL_IDR_SLICE)
-        get_ue_golomb(&sl->gb); /* idr_pic_id */
+        get_ue_golomb(&sl->bc); /* idr_pic_id */
 
     if (sps->poc_type == 0) {
-        sl->poc_lsb = get_bits(&sl->gb, sps->log2_max_poc_lsb);
+        sl->poc_lsb = bitstream_read(&sl->bc, sps->log2_max_poc_lsb);
 
         if (pps->pic_order_present == 1 && picture_structure == PICT_FRAME)
-            sl->delta_poc_bottom = get_se_golomb(&sl->gb);
+            sl->delta_poc_bottom = get_se_golomb(&sl->bc);
     }
 
     if (sps->poc_type == 1 && !sps->delta_pic_order_always_zero_flag) {
-        sl->delta_poc[0] = get_se_golomb(&sl->gb);
+        sl->delta_poc[0] = get_se_golomb(&sl->bc);
 
         if (pps->pic_order_present == 1 && picture_structure == PICT_FRAME)
-            sl->delta_poc[1] = get_se_golomb(&sl->gb);
+            sl->delta_poc[1] = get_se_golomb(&sl->bc);
     }
 
     sl->redundant_pic_count = 0;
     if (pps->redundant_pic_cnt_present)
-        sl->redundant_pic_count = get_ue_golomb(&sl->gb);
+        sl->redundant_pic_count = get_ue_golomb(&sl->bc);
 
     if (sl->slice_type_nos == AV_PICTURE_TYPE_B)
-        sl->direct_spatial_mv_pred = get_bits1(&sl->gb);
+        sl->direct_spatial_mv_pred = bitstream_read_bit(&sl->bc);
 
     ret = ff_h264_parse_ref_count(&sl->list_count, sl->ref_count,
-                                  &sl->gb, pps, sl->slice_type_nos,
+                                  &sl->bc, pps, sl->slice_type_nos,
                                   picture_structure);
     if (ret < 0)
         return ret;
@@ -1643,18 +1665,18 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     if ((pps->weighted_pred && sl->slice_type_nos == AV_PICTURE_TYPE_P) ||
         (pps->weighted_bipred_idc == 1 &&
          sl->slice_type_nos == AV_PICTURE_TYPE_B))
-        ff_h264_pred_weight_table(&sl->gb, sps, sl->ref_count,
+        ff_h264_pred_weight_table(&sl->bc, sps, sl->ref_count,
                                   sl->slice_type_nos, &sl->pwt);
 
     sl->explicit_ref_marking = 0;
     if (nal->ref_idc) {
-        ret = ff_h264_decode_ref_pic_marking(sl, &sl->gb, nal, avctx);
+        ret = ff_h264_decode_ref_pic_marking(sl, &sl->bc, nal, avctx);
         if (ret < 0 && (avctx->err_recognition & AV_EF_EXPLODE))
             return AVERROR_INVALIDDATA;
     }
 
     if (sl->slice_type_nos != AV_PICTURE_TYPE_I && pps->cabac) {
-        tmp = get_ue_golomb_31(&sl->gb);
+        tmp = get_ue_golomb_31(&sl->bc);
         if (tmp > 2) {
             av_log(avctx, AV_LOG_ERROR, "cabac_init_idc %u overflow\n", tmp);
             return AVERROR_INVALIDDATA;
@@ -1663,7 +1685,7 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     }
 
     sl->last_qscale_diff = 0;
-    tmp = pps->init_qp + get_se_golomb(&sl->gb);
+    tmp = pps->init_qp + get_se_golomb(&sl->bc);
     if (tmp > 51 + 6 * (sps->bit_depth_luma - 8)) {
         av_log(avctx, AV_LOG_ERROR, "QP %u out of range\n", tmp);
         return AVERROR_INVALIDDATA;
@@ -1673,16 +1695,16 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
     sl->chroma_qp[1] = get_chroma_qp(pps, 1, sl->qscale);
     // FIXME qscale / qp ... stuff
     if (sl->slice_type == AV_PICTURE_TYPE_SP)
-        get_bits1(&sl->gb); /* sp_for_switch_flag */
+        bitstream_read_bit(&sl->bc); /* sp_for_switch_flag */
     if (sl->slice_type == AV_PICTURE_TYPE_SP ||
         sl->slice_type == AV_PICTURE_TYPE_SI)
-        get_se_golomb(&sl->gb); /* slice_qs_delta */
+        get_se_golomb(&sl->bc); /* slice_qs_delta */
 
     sl->deblocking_filter     = 1;
     sl->slice_alpha_c0_offset = 0;
     sl->slice_beta_offset     = 0;
     if (pps->deblocking_filter_parameters_present) {
-        tmp = get_ue_golomb_31(&sl->gb);
+        tmp = get_ue_golomb_31(&sl->bc);
         if (tmp > 2) {
             av_log(avctx, AV_LOG_ERROR,
                    "deblocking_filter_idc %u out of range\n", tmp);
@@ -1693,8 +1715,8 @@ static int h264_slice_header_parse(H264SliceContext *sl, const H2645NAL *nal,
             sl->deblocking_filter ^= 1;  // 1<->0
 
         if (sl->deblocking_filter) {
-            sl->slice_alpha_c0_offset = get_se_golomb(&sl->gb) * 2;
-            sl->slice_beta_offset     = get_se_golomb(&sl->gb) * 2;
+            sl->slice_alpha_c0_offset = get_se_golomb(&sl->bc) * 2;
+            sl->slice_beta_offset     = get_se_golomb(&sl->bc) * 2;
             if (sl->slice_alpha_c0_offset >  12 ||
                 sl->slice_alpha_c0_offset < -12 ||
                 sl->slice_beta_offset >  12     ||
@@ -1772,7 +1794,9 @@ static int h264_slice_init(H264Context *h, H264SliceContext *sl,
         ff_h264_direct_dist_scale_factor(h, sl);
     ff_h264_direct_ref_list_init(h, sl);
 
-    if (h->avctx->skip_loop_filter >= AVDISCARD_ALL ||
+    /* the loop filter works on full resolution edges */
+    if (h->lowres ||
+        h->avctx->skip_loop_filter >= AVDISCARD_ALL ||
         (h->avctx->skip_loop_filter >= AVDISCARD_NONKEY &&
          sl->slice_type_nos != AV_PICTURE_TYPE_I) ||
         (h->avctx->skip_loop_filter >= AVDISCARD_BIDIR  &&
@@ -1865,7 +1889,12 @@ int ff_h264_queue_decode_slice(H264Context *h, const H2645NAL *nal)
     H264SliceContext *sl = h->slice_ctx + h->nb_slice_ctx_queued;
     int ret;
 
-    sl->gb = nal->gb;
+    /* the NAL header was read with the GetBitContext of the NAL unit,
+     * continue from there with the slice reader */
+    ret = bitstream_init(&sl->bc, nal->gb.buffer, nal->gb.size_in_bits);
+    if (ret < 0)
+        return ret;
+    bitstream_skip(&sl->bc, get_bits_count(&nal->gb));
 
     ret = h264_slice_header_parse(sl, nal, &h->ps, h->avctx);
     if (ret < 0)
@@ -2327,12 +2356,12 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
     if (h->ps.pps->cabac) {
         /* realign */
-        align_get_bits(&sl->gb);
+        bitstream_align(&sl->bc);
 
         /* init cabac */
         ff_init_cabac_decoder(&sl->cabac,
-                              sl->gb.buffer + get_bits_count(&sl->gb) / 8,
-                              (get_bits_left(&sl->gb) + 7) / 8);
+                              sl->bc.buffer + bitstream_tell(&sl->bc) / 8,
+                              (bitstream_bits_left(&sl->bc) + 7) / 8);
 
         ff_h264_init_cabac_states(h, sl);
 
@@ -2396,7 +2425,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
             if (eos || sl->mb_y >= h->mb_height) {
                 ff_tlog(h->avctx, "slice end %d %d\n",
-                        get_bits_count(&sl->gb), sl->gb.size_in_bits);
+                        bitstream_tell(&sl->bc), sl->bc.size_in_bits);
                 er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x - 1,
                              sl->mb_y, ER_MB_END);
                 if (sl->mb_x > lf_x_start)
@@ -2449,9 +2478,9 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 }
                 if (sl->mb_y >= h->mb_height) {
                     ff_tlog(h->avctx, "slice end %d %d\n",
-                            get_bits_count(&sl->gb), sl->gb.size_in_bits);
+                            bitstream_tell(&sl->bc), sl->bc.size_in_bits);
 
-                    if (get_bits_left(&sl->gb) == 0) {
+                    if (bitstream_bits_left(&sl->bc) == 0) {
                         er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y,
                                      sl->mb_x - 1, sl->mb_y, ER_MB_END);
 
@@ -2465,11 +2494,11 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 }
             }
 
-            if (get_bits_left(&sl->gb) <= 0 && sl->mb_skip_run <= 0) {
+            if (bitstream_bits_left(&sl->bc) <= 0 && sl->mb_skip_run <= 0) {
                 ff_tlog(h->avctx, "slice end %d %d\n",
-                        get_bits_count(&sl->gb), sl->gb.size_in_bits);
+                        bitstream_tell(&sl->bc), sl->bc.size_in_bits);
 
-                if (get_bits_left(&sl->gb) == 0) {
+                if (bitstream_bits_left(&sl->bc) == 0) {
                     er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y,
                                  sl->mb_x - 1, sl->mb_y, ER_MB_END);
                     if (sl->mb_x > lf_x_start)
@@ -94,6 +94,8 @@ void ff_h264_draw_horiz_band(const H264Context *h, H264SliceContext *sl,
         height <<= 1;
         y      <<= 1;
     }
+    height >>= h->lowres;
+    y      >>= h->lowres;
 
     height = FFMIN(height, avctx->height - y);
 
@@ -131,6 +133,7 @@ void ff_h264_free_tables(H264Context *h)
     av_freep(&h->slice_table_base);
     h->slice_table = NULL;
     av_freep(&h->list_counts);
+    av_freep(&h->lowres_borders);
 
     av_freep(&h->mb2b_xy);
     av_freep(&h->mb2br_xy);
@@ -189,6 +192,9 @@ int ff_h264_alloc_tables(H264Context *h)
                       4 * big_mb_num * sizeof(uint8_t), fail);
     FF_ALLOCZ_OR_GOTO(h->avctx, h->list_counts,
                       big_mb_num * sizeof(uint8_t), fail)
+    if (h->lowres)
+        FF_ALLOCZ_OR_GOTO(h->avctx, h->lowres_borders,
+                          big_mb_num * sizeof(*h->lowres_borders), fail)
 
     memset(h->slice_table_base, -1,
            (big_mb_num + h->mb_stride) * sizeof(*h->slice_table_base));
@@ -400,6 +406,12 @@ static av_cold int h264_decode_init(AVCodecContext *avctx)
 
     avctx->internal->allocate_progress = 1;
 
+    if (h->lowres && h->enable_er) {
+        av_log(avctx, AV_LOG_WARNING,
+               "Error resilience is not supported with lowres, disabling it.\n");
+        h->enable_er = 0;
+    }
+
     if (h->enable_er) {
         av_log(avctx, AV_LOG_WARNING,
                "Error resilience is enabled. It is unsafe and unsupported and may crash. "
@@ -412,12 +424,15 @@ static av_cold int h264_decode_init(AVCodecContext *avctx)
 static int decode_init_thread_copy(AVCodecContext *avctx)
 {
     H264Context *h = avctx->priv_data;
+    /* the output size depends on it before the first context update */
+    const int lowres = h->lowres;
     int ret;
 
     if (!avctx->internal->is_copy)
         return 0;
 
     memset(h, 0, sizeof(*h));
+    h->lowres = lowres;
 
     ret = h264_init_context(avctx, h);
     if (ret < 0)
@@ -763,6 +778,7 @@ out:
 #define VD AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_DECODING_PARAM
 static const AVOption h264_options[] = {
     { "enable_er", "Enable error resilience on damaged frames (unsafe)", OFFSET(enable_er), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, VD },
+    { "lowres", "Lower the decoding resolution by a power of two (inexact)", OFFSET(lowres), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 3, VD },
     { NULL },
 };
 
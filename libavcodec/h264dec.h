@@ -32,6 +32,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/thread.h"
 
+#include "bitstream.h"
 #include "cabac.h"
 #include "error_resilience.h"
 #include "h264_parse.h"
@@ -171,9 +172,18 @@ typedef struct H264Ref {
     H264Picture *parent;
 } H264Ref;
 
+/**
+ * Full resolution samples on the bottom and right edges of a macroblock
+ * decoded at reduced resolution, the chroma planes use the first 8 of each.
+ */
+typedef struct H264LowresBorder {
+    uint8_t bottom[3][16];
+    uint8_t right[3][16];
+} H264LowresBorder;
+
 typedef struct H264SliceContext {
     struct H264Context *h264;
-    GetBitContext gb;
+    BitstreamContext bc;
     ERContext er;
 
     int slice_num;
@@ -528,6 +538,12 @@ typedef struct H264Context {
 
     int enable_er;
 
+    /* log2 of the downscaling factor of the decoded pictures, only 8-bit
+     * 4:2:0 streams can be decoded at reduced resolution */
+    int lowres;
+    /* the intra macroblocks are predicted from these in lowres mode */
+    H264LowresBorder *lowres_borders;
+
     H264SEIContext sei;
 
     AVBufferPool *qscale_table_pool;
@@ -559,10 +575,21 @@ void ff_h264_remove_all_refs(H264Context *h);
  */
 int ff_h264_execute_ref_pic_marking(H264Context *h);
 
-int ff_h264_decode_ref_pic_marking(H264SliceContext *sl, GetBitContext *gb,
+int ff_h264_decode_ref_pic_marking(H264SliceContext *sl, BitstreamContext *bc,
                                    const H2645NAL *nal, void *logctx);
 
 void ff_h264_hl_decode_mb(const H264Context *h, H264SliceContext *sl);
+
+/**
+ * Reconstruct a macroblock at the reduced resolution selected with the
+ * lowres option.
+ */
+void ff_h264_hl_decode_mb_lowres(const H264Context *h, H264SliceContext *sl);
+
+/**
+ * Wait until all reference frames are available for MC operations.
+ */
+void ff_h264_await_references(const H264Context *h, H264SliceContext *sl);
 void ff_h264_decode_init_vlc(void);
 
 /**
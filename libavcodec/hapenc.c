@@ -326,6 +326,7 @@ AVCodec ff_hap_encoder = {
     .init           = hap_init,
     .encode2        = hap_encode,
     .close          = hap_close,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGBA, AV_PIX_FMT_NONE,
     },
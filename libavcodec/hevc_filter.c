@@ -24,6 +24,7 @@
 
 #include "libavutil/common.h"
 #include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
 
 #include "cabac_functions.h"
 #include "hevcdec.h"
@@ -72,7 +73,7 @@ static int chroma_tc(HEVCContext *s, int qp_y, int c_idx, int tc_offset)
 static int get_qPy_pred(HEVCContext *s, int xC, int yC,
                         int xBase, int yBase, int log2_cb_size)
 {
-    HEVCLocalContext *lc     = &s->HEVClc;
+    HEVCLocalContext *lc     = s->HEVClc;
     int ctb_size_mask        = (1 << s->ps.sps->log2_ctb_size) - 1;
     int MinCuQpDeltaSizeMask = (1 << (s->ps.sps->log2_ctb_size -
                                       s->ps.pps->diff_cu_qp_delta_depth)) - 1;
@@ -155,12 +156,12 @@ void ff_hevc_set_qPy(HEVCContext *s, int xC, int yC,
 {
     int qp_y = get_qPy_pred(s, xC, yC, xBase, yBase, log2_cb_size);
 
-    if (s->HEVClc.tu.cu_qp_delta != 0) {
+    if (s->HEVClc->tu.cu_qp_delta != 0) {
         int off = s->ps.sps->qp_bd_offset;
-        s->HEVClc.qp_y = FFUMOD(qp_y + s->HEVClc.tu.cu_qp_delta + 52 + 2 * off,
+        s->HEVClc->qp_y = FFUMOD(qp_y + s->HEVClc->tu.cu_qp_delta + 52 + 2 * off,
                                 52 + off) - off;
     } else
-        s->HEVClc.qp_y = qp_y;
+        s->HEVClc->qp_y = qp_y;
 }
 
 static int get_qPy(HEVCContext *s, int xC, int yC)
@@ -183,8 +184,170 @@ static void copy_CTB(uint8_t *dst, uint8_t *src,
     }
 }
 
+static void copy_pixel(uint8_t *dst, const uint8_t *src, int pixel_shift)
+{
+    if (pixel_shift)
+        AV_COPY16(dst, src);
+    else
+        *dst = *src;
+}
+
 #define CTB(tab, x, y) ((tab)[(y) * s->ps.sps->ctb_width + (x)])
 
+/*
+ * The SAO of a CTB is applied on up to four regions: the CTB itself
+ * (class 0) and the parts of the above (1), left (2) and above-left (3)
+ * CTBs which could not be filtered before this CTB got deblocked.
+ * sao_region() returns the position and size of such a region relative
+ * to the top-left corner of the CTB.
+ */
+static void sao_region(int class, int chroma, int *borders,
+                       int *x0, int *y0, int *width, int *height)
+{
+    int dx = (8 >> chroma) + 2;
+    int dy = (4 >> chroma) + 2;
+
+    *x0 = *y0 = 0;
+    switch (class) {
+    case 0:
+        if (!borders[2])
+            *width -= dx;
+        if (!borders[3])
+            *height -= dy;
+        break;
+    case 1:
+        *y0 = -dy;
+        if (!borders[2])
+            *width -= dx;
+        *height = dy;
+        break;
+    case 2:
+        *x0    = -dx;
+        *width =  dx;
+        if (!borders[3])
+            *height -= dy;
+        break;
+    case 3:
+        *y0     = -dy;
+        *x0     = -dx;
+        *width  =  dx;
+        *height =  dy;
+        break;
+    }
+}
+
+static void sao_band_filter(HEVCContext *s, uint8_t *dst, uint8_t *src,
+                            ptrdiff_t stride, SAOParams *sao, int *borders,
+                            int width, int height, int c_idx, int class)
+{
+    int pixel_shift = s->ps.sps->pixel_shift;
+    int x0, y0;
+
+    sao_region(class, !!c_idx, borders, &x0, &y0, &width, &height);
+    if (width <= 0 || height <= 0)
+        return;
+
+    s->hevcdsp.sao_band_filter(dst + y0 * stride + (x0 << pixel_shift),
+                               src + y0 * stride + (x0 << pixel_shift),
+                               stride, sao->offset_val[c_idx],
+                               sao->band_position[c_idx], width, height);
+}
+
+static void sao_edge_filter(HEVCContext *s, uint8_t *dst, uint8_t *src,
+                            ptrdiff_t stride, SAOParams *sao, int *borders,
+                            int width, int height, int c_idx, int class,
+                            uint8_t vert_edge, uint8_t horiz_edge,
+                            uint8_t diag_edge)
+{
+    int pixel_shift  = s->ps.sps->pixel_shift;
+    int sao_eo_class = sao->eo_class[c_idx];
+    int x0, y0, init_x = 0, init_y = 0;
+    int y, save;
+
+    sao_region(class, !!c_idx, borders, &x0, &y0, &width, &height);
+    dst += y0 * stride + (x0 << pixel_shift);
+    src += y0 * stride + (x0 << pixel_shift);
+
+    // The samples on the picture borders are left as they are (the
+    // offset of their edge category, SaoOffsetVal[0], is always 0) and
+    // they were already copied to dst.
+    if (sao_eo_class != SAO_EO_VERT && class < 2) {
+        if (borders[0])
+            init_x = 1;
+        if (borders[2])
+            width--;
+    }
+    if (sao_eo_class != SAO_EO_HORIZ && !(class & 1)) {
+        if (borders[1])
+            init_y = 1;
+        if (borders[3])
+            height--;
+    }
+
+    if (width > init_x && height > init_y)
+        s->hevcdsp.sao_edge_filter(dst + init_y * stride + (init_x << pixel_shift),
+                                   src + init_y * stride + (init_x << pixel_shift),
+                                   stride, sao->offset_val[c_idx], sao_eo_class,
+                                   width - init_x, height - init_y);
+
+    // Restore the samples that can't be modified
+#define COPY_PIXEL(x, y) copy_pixel(dst + (y) * stride + ((x) << pixel_shift), \
+                                    src + (y) * stride + ((x) << pixel_shift), \
+                                    pixel_shift)
+#define COPY_ROW(x, y, w)                                                       \
+    do {                                                                        \
+        if ((w) > 0)                                                            \
+            memcpy(dst + (y) * stride + ((x) << pixel_shift),                   \
+                   src + (y) * stride + ((x) << pixel_shift),                   \
+                   (w) << pixel_shift);                                         \
+    } while (0)
+
+    switch (class) {
+    case 0:
+        save = !diag_edge && sao_eo_class == SAO_EO_135D && !borders[0] && !borders[1];
+        if (vert_edge && sao_eo_class != SAO_EO_VERT)
+            for (y = init_y + save; y < height; y++)
+                COPY_PIXEL(0, y);
+        if (horiz_edge && sao_eo_class != SAO_EO_HORIZ)
+            COPY_ROW(init_x + save, 0, width - init_x - save);
+        if (diag_edge && sao_eo_class == SAO_EO_135D)
+            COPY_PIXEL(0, 0);
+        break;
+    case 1:
+        save = !diag_edge && sao_eo_class == SAO_EO_45D && !borders[0];
+        if (vert_edge && sao_eo_class != SAO_EO_VERT)
+            for (y = init_y; y < height - save; y++)
+                COPY_PIXEL(0, y);
+        if (horiz_edge && sao_eo_class != SAO_EO_HORIZ)
+            COPY_ROW(init_x + save, height - 1, width - init_x - save);
+        if (diag_edge && sao_eo_class == SAO_EO_45D)
+            COPY_PIXEL(0, height - 1);
+        break;
+    case 2:
+        save = !diag_edge && sao_eo_class == SAO_EO_45D && !borders[1];
+        if (vert_edge && sao_eo_class != SAO_EO_VERT)
+            for (y = init_y + save; y < height; y++)
+                COPY_PIXEL(width - 1, y);
+        if (horiz_edge && sao_eo_class != SAO_EO_HORIZ)
+            COPY_ROW(init_x, 0, width - save - init_x);
+        if (diag_edge && sao_eo_class == SAO_EO_45D)
+            COPY_PIXEL(width - 1, 0);
+        break;
+    case 3:
+        save = !diag_edge && sao_eo_class == SAO_EO_135D;
+        if (vert_edge && sao_eo_class != SAO_EO_VERT)
+            for (y = init_y; y < height - save; y++)
+                COPY_PIXEL(width - 1, y);
+        if (horiz_edge && sao_eo_class != SAO_EO_HORIZ)
+            COPY_ROW(init_x, height - 1, width - save - init_x);
+        if (diag_edge && sao_eo_class == SAO_EO_135D)
+            COPY_PIXEL(width - 1, height - 1);
+        break;
+    }
+#undef COPY_PIXEL
+#undef COPY_ROW
+}
+
 static void sao_filter_CTB(HEVCContext *s, int x, int y)
 {
     //  TODO: This should be easily parallelizable
@@ -292,21 +455,15 @@ static void sao_filter_CTB(HEVCContext *s, int x, int y)
 
             switch (sao[class_index]->type_idx[c_idx]) {
             case SAO_BAND:
-                s->hevcdsp.sao_band_filter[classes[class_index]](dst, src,
-                                                                 stride,
-                                                                 sao[class_index],
-                                                                 edges, width,
-                                                                 height, c_idx);
+                sao_band_filter(s, dst, src, stride, sao[class_index], edges,
+                                width, height, c_idx, classes[class_index]);
                 break;
             case SAO_EDGE:
-                s->hevcdsp.sao_edge_filter[classes[class_index]](dst, src,
-                                                                 stride,
-                                                                 sao[class_index],
-                                                                 edges, width,
-                                                                 height, c_idx,
-                                                                 vert_edge[classes[class_index]],
-                                                                 horiz_edge[classes[class_index]],
-                                                                 diag_edge[classes[class_index]]);
+                sao_edge_filter(s, dst, src, stride, sao[class_index], edges,
+                                width, height, c_idx, classes[class_index],
+                                vert_edge[classes[class_index]],
+                                horiz_edge[classes[class_index]],
+                                diag_edge[classes[class_index]]);
                 break;
             }
         }
@@ -585,7 +742,7 @@ static int boundary_strength(HEVCContext *s, MvField *curr,
 void ff_hevc_deblocking_boundary_strengths(HEVCContext *s, int x0, int y0,
                                            int log2_trafo_size)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     MvField *tab_mvf     = s->ref->tab_mvf;
     int log2_min_pu_size = s->ps.sps->log2_min_pu_size;
     int log2_min_tu_size = s->ps.sps->log2_min_tb_size;
@@ -456,7 +456,7 @@ fail:
 
 static int hls_slice_header(HEVCContext *s)
 {
-    GetBitContext *gb = &s->HEVClc.gb;
+    GetBitContext *gb = &s->HEVClc->gb;
     SliceHeader *sh   = &s->sh;
     int i, ret;
 
@@ -759,12 +759,33 @@ static int hls_slice_header(HEVCContext *s)
 
     sh->num_entry_point_offsets = 0;
     if (s->ps.pps->tiles_enabled_flag || s->ps.pps->entropy_coding_sync_enabled_flag) {
-        sh->num_entry_point_offsets = get_ue_golomb_long(gb);
+        unsigned num_entry_point_offsets = get_ue_golomb_long(gb);
+
+        if (num_entry_point_offsets >= s->ps.sps->ctb_size) {
+            av_log(s->avctx, AV_LOG_ERROR, "Invalid number of entry points: %u\n",
+                   num_entry_point_offsets);
+            return AVERROR_INVALIDDATA;
+        }
+        sh->num_entry_point_offsets = num_entry_point_offsets;
+
         if (sh->num_entry_point_offsets > 0) {
-            int offset_len = get_ue_golomb_long(gb) + 1;
+            unsigned offset_len = get_ue_golomb_long(gb) + 1;
+
+            if (offset_len > 32) {
+                av_log(s->avctx, AV_LOG_ERROR, "Invalid entry point offset length: %u\n",
+                       offset_len);
+                return AVERROR_INVALIDDATA;
+            }
+
+            av_fast_malloc(&sh->entry_point_offset, &sh->entry_point_offset_size,
+                           sh->num_entry_point_offsets * sizeof(*sh->entry_point_offset));
+            if (!sh->entry_point_offset) {
+                sh->num_entry_point_offsets = 0;
+                return AVERROR(ENOMEM);
+            }
 
             for (i = 0; i < sh->num_entry_point_offsets; i++)
-                skip_bits(gb, offset_len);
+                sh->entry_point_offset[i] = get_bits_long(gb, offset_len) + 1;
         }
     }
 
@@ -793,10 +814,10 @@ static int hls_slice_header(HEVCContext *s)
         return AVERROR_INVALIDDATA;
     }
 
-    s->HEVClc.first_qp_group = !s->sh.dependent_slice_segment_flag;
+    s->HEVClc->first_qp_group = !s->sh.dependent_slice_segment_flag;
 
     if (!s->ps.pps->cu_qp_delta_enabled_flag)
-        s->HEVClc.qp_y = FFUMOD(s->sh.slice_qp + 52 + 2 * s->ps.sps->qp_bd_offset,
+        s->HEVClc->qp_y = FFUMOD(s->sh.slice_qp + 52 + 2 * s->ps.sps->qp_bd_offset,
                                 52 + s->ps.sps->qp_bd_offset) - s->ps.sps->qp_bd_offset;
 
     s->slice_initialized = 1;
@@ -820,7 +841,7 @@ do {                                                    \
 
 static void hls_sao_param(HEVCContext *s, int rx, int ry)
 {
-    HEVCLocalContext *lc    = &s->HEVClc;
+    HEVCLocalContext *lc    = s->HEVClc;
     int sao_merge_left_flag = 0;
     int sao_merge_up_flag   = 0;
     int shift               = s->ps.sps->bit_depth - FFMIN(s->ps.sps->bit_depth, 10);
@@ -898,7 +919,7 @@ static void hls_residual_coding(HEVCContext *s, int x0, int y0,
         x_c = (scan_x_cg[offset >> 4] << 2) + scan_x_off[n];    \
         y_c = (scan_y_cg[offset >> 4] << 2) + scan_y_off[n];    \
     } while (0)
-    HEVCLocalContext *lc    = &s->HEVClc;
+    HEVCLocalContext *lc    = s->HEVClc;
     int transform_skip_flag = 0;
 
     int last_significant_coeff_x, last_significant_coeff_y;
@@ -1255,7 +1276,7 @@ static int hls_transform_unit(HEVCContext *s, int x0, int y0,
                               int log2_cb_size, int log2_trafo_size,
                               int blk_idx, int cbf_luma, int cbf_cb, int cbf_cr)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
 
     if (lc->cu.pred_mode == MODE_INTRA) {
         int trafo_size = 1 << log2_trafo_size;
@@ -1357,7 +1378,7 @@ static int hls_transform_tree(HEVCContext *s, int x0, int y0,
                               int trafo_depth, int blk_idx,
                               int cbf_cb, int cbf_cr)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     uint8_t split_transform_flag;
     int ret;
 
@@ -1451,7 +1472,7 @@ do {
 static int hls_pcm_sample(HEVCContext *s, int x0, int y0, int log2_cb_size)
 {
     //TODO: non-4:2:0 support
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     GetBitContext gb;
     int cb_size   = 1 << log2_cb_size;
     ptrdiff_t stride0 = s->frame->linesize[0];
@@ -1480,7 +1501,7 @@ static int hls_pcm_sample(HEVCContext *s, int x0, int y0, int log2_cb_size)
 
 static void hls_mvd_coding(HEVCContext *s, int x0, int y0, int log2_cb_size)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int x = ff_hevc_abs_mvd_greater0_flag_decode(s);
     int y = ff_hevc_abs_mvd_greater0_flag_decode(s);
 
@@ -1519,7 +1540,7 @@ static void luma_mc(HEVCContext *s, int16_t *dst, ptrdiff_t dststride,
                     AVFrame *ref, const Mv *mv, int x_off, int y_off,
                     int block_w, int block_h, int pred_idx)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     uint8_t *src         = ref->data[0];
     ptrdiff_t srcstride  = ref->linesize[0];
     int pic_width        = s->ps.sps->width;
@@ -1573,7 +1594,7 @@ static void chroma_mc(HEVCContext *s, int16_t *dst1, int16_t *dst2,
                       ptrdiff_t dststride, AVFrame *ref, const Mv *mv,
                       int x_off, int y_off, int block_w, int block_h, int pred_idx)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     uint8_t *src1        = ref->data[1];
     uint8_t *src2        = ref->data[2];
     ptrdiff_t src1stride = ref->linesize[1];
@@ -1642,7 +1663,7 @@ static void hevc_luma_mv_mpv_mode(HEVCContext *s, int x0, int y0, int nPbW,
                                   int nPbH, int log2_cb_size, int part_idx,
                                   int merge_idx, MvField *mv)
 {
-    HEVCLocalContext *lc             = &s->HEVClc;
+    HEVCLocalContext *lc             = s->HEVClc;
     enum InterPredIdc inter_pred_idc = PRED_L0;
     int mvp_flag;
 
@@ -1694,7 +1715,7 @@ static void hls_prediction_unit(HEVCContext *s, int x0, int y0,
 #define POS(c_idx, x, y)                                                              \
     &s->frame->data[c_idx][((y) >> s->ps.sps->vshift[c_idx]) * s->frame->linesize[c_idx] + \
                            (((x) >> s->ps.sps->hshift[c_idx]) << s->ps.sps->pixel_shift)]
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int merge_idx = 0;
     struct MvField current_mv = {{{ 0 }}};
 
@@ -1880,7 +1901,7 @@ static void hls_prediction_unit(HEVCContext *s, int x0, int y0,
 static int luma_intra_pred_mode(HEVCContext *s, int x0, int y0, int pu_size,
                                 int prev_intra_luma_pred_flag)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int x_pu             = x0 >> s->ps.sps->log2_min_pu_size;
     int y_pu             = y0 >> s->ps.sps->log2_min_pu_size;
     int min_pu_width     = s->ps.sps->min_pu_width;
@@ -1981,7 +2002,7 @@ static av_always_inline void set_ct_depth(HEVCContext *s, int x0, int y0,
 static void intra_prediction_unit(HEVCContext *s, int x0, int y0,
                                   int log2_cb_size)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     static const uint8_t intra_chroma_table[4] = { 0, 26, 10, 1 };
     uint8_t prev_intra_luma_pred_flag[4];
     int split   = lc->cu.part_mode == PART_NxN;
@@ -2022,7 +2043,7 @@ static void intra_prediction_unit_default_value(HEVCContext *s,
                                                 int x0, int y0,
                                                 int log2_cb_size)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int pb_size          = 1 << log2_cb_size;
     int size_in_pus      = pb_size >> s->ps.sps->log2_min_pu_size;
     int min_pu_width     = s->ps.sps->min_pu_width;
@@ -2043,7 +2064,7 @@ static void intra_prediction_unit_default_value(HEVCContext *s,
 static int hls_coding_unit(HEVCContext *s, int x0, int y0, int log2_cb_size)
 {
     int cb_size          = 1 << log2_cb_size;
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int log2_min_cb_size = s->ps.sps->log2_min_cb_size;
     int length           = cb_size >> log2_min_cb_size;
     int min_cb_width     = s->ps.sps->min_cb_width;
@@ -2192,7 +2213,7 @@ static int hls_coding_unit(HEVCContext *s, int x0, int y0, int log2_cb_size)
 static int hls_coding_quadtree(HEVCContext *s, int x0, int y0,
                                int log2_cb_size, int cb_depth)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     const int cb_size    = 1 << log2_cb_size;
     int split_cu;
 
@@ -2243,7 +2264,7 @@ do {                                                                   \
 static void hls_decode_neighbour(HEVCContext *s, int x_ctb, int y_ctb,
                                  int ctb_addr_ts)
 {
-    HEVCLocalContext *lc  = &s->HEVClc;
+    HEVCLocalContext *lc  = s->HEVClc;
     int ctb_size          = 1 << s->ps.sps->log2_ctb_size;
     int ctb_addr_rs       = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
     int ctb_addr_in_slice = ctb_addr_rs - s->sh.slice_addr;
@@ -2290,7 +2311,315 @@ static void hls_decode_neighbour(HEVCContext *s, int x_ctb, int y_ctb,
     lc->ctb_up_left_flag = ((x_ctb > 0) && (y_ctb > 0)  && (ctb_addr_in_slice-1 >= s->ps.sps->ctb_width) && (s->ps.pps->tile_id[ctb_addr_ts] == s->ps.pps->tile_id[s->ps.pps->ctb_addr_rs_to_ts[ctb_addr_rs-1 - s->ps.sps->ctb_width]]));
 }
 
-static int hls_slice_data(HEVCContext *s)
+static int hls_decode_entry_wpp(AVCodecContext *avctx, void *arg,
+                                int job, int thread)
+{
+    HEVCContext      *s0 = avctx->priv_data;
+    HEVCContext      *s  = s0->sList[thread];
+    HEVCLocalContext *lc = s0->HEVClcList[thread];
+    HEVCSubstream    *ss = &s0->substreams[job];
+    int log2_ctb_size    = s->ps.sps->log2_ctb_size;
+    int ctb_size         = 1 << log2_ctb_size;
+    int ctb_width        = s->ps.sps->ctb_width;
+    int ctb_addr_rs      = s->sh.slice_ctb_addr_rs + job * ctb_width;
+    int y_ctb            = (ctb_addr_rs / ctb_width) << log2_ctb_size;
+    int more_data        = 1;
+    int x, ret;
+
+    lc->qp_y           = s0->HEVClc->qp_y;
+    lc->first_qp_group = s0->HEVClc->first_qp_group;
+
+    for (x = 0; x < ctb_width && more_data; x++, ctb_addr_rs++) {
+        int x_ctb = x << log2_ctb_size;
+
+        /* the CTBs above and above-right must have been decoded */
+        if (job) {
+            ff_thread_await_slice_progress(avctx, job - 1, FFMIN(x + 2, ctb_width));
+            if (s0->substreams[job - 1].error) {
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
+        }
+
+        hls_decode_neighbour(s, x_ctb, y_ctb, ctb_addr_rs);
+
+        if (!x) {
+            if (!job) {
+                lc->gb = s0->HEVClc->gb;
+                ff_hevc_cabac_init(s, ctb_addr_rs);
+            } else {
+                ff_hevc_cabac_init_substream(s, ctb_addr_rs, ss->data, ss->size,
+                                             s0->substreams[job - 1].state);
+            }
+        }
+
+        hls_sao_param(s, x, y_ctb >> log2_ctb_size);
+
+        s->deblock[ctb_addr_rs].beta_offset = s->sh.beta_offset;
+        s->deblock[ctb_addr_rs].tc_offset   = s->sh.tc_offset;
+        s->filter_slice_edges[ctb_addr_rs]  = s->sh.slice_loop_filter_across_slices_enabled_flag;
+
+        ret = hls_coding_quadtree(s, x_ctb, y_ctb, log2_ctb_size, 0);
+        if (ret < 0)
+            goto fail;
+        more_data = !ff_hevc_end_of_slice_flag_decode(s);
+
+        if (x == 1) {
+            memcpy(ss->state, lc->cabac_state, HEVC_CONTEXTS);
+            ss->state_saved = 1;
+        }
+
+        ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        ff_thread_report_slice_progress(avctx, job, x + 1);
+    }
+
+    /* only the last row may end before the end of the CTB row and it has to
+     * end the slice segment */
+    if (more_data != (job < s->sh.num_entry_point_offsets)) {
+        av_log(avctx, AV_LOG_ERROR, "Invalid WPP substream %d\n", job);
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+
+    ss->nb_ctbs = x;
+    if (job == s->sh.num_entry_point_offsets)
+        *s0->HEVClc = *lc;
+
+    return 0;
+fail:
+    ss->error = 1;
+    ff_thread_report_slice_progress(avctx, job, INT_MAX);
+    return ret;
+}
+
+static int hls_decode_entry_tile(AVCodecContext *avctx, void *arg,
+                                 int job, int thread)
+{
+    HEVCContext      *s0 = avctx->priv_data;
+    HEVCContext      *s  = s0->sList[thread];
+    HEVCLocalContext *lc = s0->HEVClcList[thread];
+    HEVCSubstream    *ss = &s0->substreams[job];
+    const HEVCPPS   *pps = s->ps.pps;
+    int log2_ctb_size    = s->ps.sps->log2_ctb_size;
+    int ctb_width        = s->ps.sps->ctb_width;
+    int tile             = pps->tile_id[pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs]] + job;
+    int tile_x           = tile % pps->num_tile_columns;
+    int tile_y           = tile / pps->num_tile_columns;
+    int ctb_addr_ts      = pps->ctb_addr_rs_to_ts[pps->tile_pos_rs[tile]];
+    int nb_ctbs          = pps->column_width[tile_x] * pps->row_height[tile_y];
+    int more_data        = 1;
+    int i, ret;
+
+    lc->qp_y             = s0->HEVClc->qp_y;
+    lc->first_qp_group   = 1;
+    lc->start_of_tiles_x = pps->col_bd[tile_x] << log2_ctb_size;
+    lc->end_of_tiles_x   = pps->col_bd[tile_x + 1] << log2_ctb_size;
+
+    /* the deblocking boundary strengths on the tile edges depend on the
+     * tiles above and to the left */
+    if (pps->loop_filter_across_tiles_enabled_flag && tile_y &&
+        job >= pps->num_tile_columns) {
+        ff_thread_await_slice_progress(avctx, job - pps->num_tile_columns,
+                                       pps->row_height[tile_y - 1]);
+        if (s0->substreams[job - pps->num_tile_columns].error) {
+            ret = AVERROR_INVALIDDATA;
+            goto fail;
+        }
+    }
+
+    for (i = 0; i < nb_ctbs && more_data; i++, ctb_addr_ts++) {
+        int ctb_addr_rs = pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+        int x           = ctb_addr_rs % ctb_width;
+        int y           = ctb_addr_rs / ctb_width;
+
+        if (pps->loop_filter_across_tiles_enabled_flag && tile_x && job &&
+            x == pps->col_bd[tile_x]) {
+            ff_thread_await_slice_progress(avctx, job - 1, y - pps->row_bd[tile_y] + 1);
+            if (s0->substreams[job - 1].error) {
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
+        }
+
+        hls_decode_neighbour(s, x << log2_ctb_size, y << log2_ctb_size, ctb_addr_ts);
+
+        if (!i) {
+            if (!job) {
+                lc->gb = s0->HEVClc->gb;
+                ff_hevc_cabac_init(s, ctb_addr_ts);
+            } else {
+                ff_hevc_cabac_init_substream(s, ctb_addr_ts, ss->data, ss->size, NULL);
+            }
+        }
+
+        hls_sao_param(s, x, y);
+
+        s->deblock[ctb_addr_rs].beta_offset = s->sh.beta_offset;
+        s->deblock[ctb_addr_rs].tc_offset   = s->sh.tc_offset;
+        s->filter_slice_edges[ctb_addr_rs]  = s->sh.slice_loop_filter_across_slices_enabled_flag;
+
+        ret = hls_coding_quadtree(s, x << log2_ctb_size, y << log2_ctb_size,
+                                  log2_ctb_size, 0);
+        if (ret < 0)
+            goto fail;
+        more_data = !ff_hevc_end_of_slice_flag_decode(s);
+
+        if (x + 1 == pps->col_bd[tile_x + 1])
+            ff_thread_report_slice_progress(avctx, job, y - pps->row_bd[tile_y] + 1);
+    }
+
+    /* a slice segment spanning several tiles contains complete tiles */
+    if (i < nb_ctbs || more_data != (job < s->sh.num_entry_point_offsets)) {
+        av_log(avctx, AV_LOG_ERROR, "Invalid tile substream %d\n", job);
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+
+    ss->nb_ctbs = nb_ctbs;
+    if (job == s->sh.num_entry_point_offsets)
+        *s0->HEVClc = *lc;
+
+    return 0;
+fail:
+    ss->error = 1;
+    ff_thread_report_slice_progress(avctx, job, INT_MAX);
+    return ret;
+}
+
+/**
+ * Locate the substreams of the current slice segment from the entry points,
+ * which count the emulation prevention bytes.
+ */
+static int init_substreams(HEVCContext *s, const H2645NAL *nal)
+{
+    GetBitContext *gb = &s->HEVClc->gb;
+    int nb_substreams = s->sh.num_entry_point_offsets + 1;
+    int offset        = (get_bits_count(gb) + 1 + 7) / 8;
+    int skipped       = 0;
+    int64_t raw_offset;
+    int i;
+
+    av_fast_malloc(&s->substreams, &s->substreams_size,
+                   nb_substreams * sizeof(*s->substreams));
+    if (!s->substreams)
+        return AVERROR(ENOMEM);
+    memset(s->substreams, 0, nb_substreams * sizeof(*s->substreams));
+
+    while (skipped < nal->skipped_bytes && nal->skipped_bytes_pos[skipped] <= offset)
+        skipped++;
+    raw_offset = offset + skipped;
+
+    s->substreams[0].data = gb->buffer + offset;
+    for (i = 1; i < nb_substreams; i++) {
+        int next;
+
+        raw_offset += s->sh.entry_point_offset[i - 1];
+        while (skipped < nal->skipped_bytes &&
+               nal->skipped_bytes_pos[skipped] + skipped < raw_offset)
+            skipped++;
+        next = FFMIN(raw_offset - skipped, nal->size);
+
+        if (next <= offset) {
+            av_log(s->avctx, AV_LOG_ERROR, "Invalid entry point %d\n", i - 1);
+            return AVERROR_INVALIDDATA;
+        }
+        s->substreams[i - 1].size = next - offset;
+        s->substreams[i].data     = gb->buffer + next;
+        offset = next;
+    }
+    if (offset >= nal->size) {
+        av_log(s->avctx, AV_LOG_ERROR, "Invalid entry point %d\n", i - 2);
+        return AVERROR_INVALIDDATA;
+    }
+    s->substreams[i - 1].size = nal->size - offset;
+
+    return 0;
+}
+
+/**
+ * Decode the substreams (WPP rows or tiles) of the current slice segment in
+ * parallel.
+ *
+ * @return the address of the first CTB after the slice segment, in tile scan
+ *         order, or a negative error code
+ */
+static int hls_slice_data_substreams(HEVCContext *s, const H2645NAL *nal)
+{
+    const HEVCSPS *sps = s->ps.sps;
+    const HEVCPPS *pps = s->ps.pps;
+    int nb_substreams  = s->sh.num_entry_point_offsets + 1;
+    int ctb_size       = 1 << sps->log2_ctb_size;
+    int ctb_addr_ts    = pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs];
+    int start_ts       = ctb_addr_ts;
+    int x_ctb = 0, y_ctb = 0;
+    int i, ret;
+
+    ret = init_substreams(s, nal);
+    if (ret < 0)
+        return ret;
+
+    ret = ff_thread_init_slice_progress(s->avctx, nb_substreams);
+    if (ret < 0)
+        return ret;
+
+    for (i = 0; i < s->nb_slice_threads; i++) {
+        memcpy(s->sList[i], s, sizeof(*s));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
+    }
+
+    if (pps->entropy_coding_sync_enabled_flag) {
+        s->avctx->execute2(s->avctx, hls_decode_entry_wpp, NULL, NULL, nb_substreams);
+    } else {
+        /* the slice address of the neighbouring CTBs is needed for the
+         * deblocking boundaries, set it upfront as the tiles are decoded out
+         * of order */
+        for (i = 0; i < nb_substreams; i++) {
+            int tile = pps->tile_id[start_ts] + i;
+            ctb_addr_ts += pps->column_width[tile % pps->num_tile_columns] *
+                           pps->row_height[tile / pps->num_tile_columns];
+        }
+        for (i = start_ts; i < ctb_addr_ts; i++)
+            s->tab_slice_address[pps->ctb_addr_ts_to_rs[i]] = s->sh.slice_addr;
+
+        s->avctx->execute2(s->avctx, hls_decode_entry_tile, NULL, NULL, nb_substreams);
+    }
+
+    ctb_addr_ts = start_ts;
+    for (i = 0; i < nb_substreams; i++) {
+        if (s->substreams[i].error)
+            return AVERROR_INVALIDDATA;
+        ctb_addr_ts += s->substreams[i].nb_ctbs;
+    }
+
+    if (pps->entropy_coding_sync_enabled_flag) {
+        for (i = nb_substreams - 1; i >= 0; i--) {
+            if (s->substreams[i].state_saved) {
+                memcpy(s->cabac_state, s->substreams[i].state, HEVC_CONTEXTS);
+                break;
+            }
+        }
+    } else {
+        /* the in-loop filters are run in decoding order once all the tiles
+         * have been reconstructed */
+        for (i = start_ts; i < ctb_addr_ts; i++) {
+            int ctb_addr_rs = pps->ctb_addr_ts_to_rs[i];
+            x_ctb = (ctb_addr_rs % sps->ctb_width) << sps->log2_ctb_size;
+            y_ctb = (ctb_addr_rs / sps->ctb_width) << sps->log2_ctb_size;
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        }
+    }
+
+    i     = pps->ctb_addr_ts_to_rs[ctb_addr_ts - 1];
+    x_ctb = (i % sps->ctb_width) << sps->log2_ctb_size;
+    y_ctb = (i / sps->ctb_width) << sps->log2_ctb_size;
+    if (x_ctb + ctb_size >= sps->width &&
+        y_ctb + ctb_size >= sps->height)
+        ff_hevc_hls_filter(s, x_ctb, y_ctb);
+
+    return ctb_addr_ts;
+}
+
+static int hls_slice_data(HEVCContext *s, const H2645NAL *nal)
 {
     int ctb_size    = 1 << s->ps.sps->log2_ctb_size;
     int more_data   = 1;
@@ -2299,6 +2628,23 @@ static int hls_slice_data(HEVCContext *s)
     int ctb_addr_ts = s->ps.pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs];
     int ret;
 
+    if (s->sh.num_entry_point_offsets > 0 && s->nb_slice_threads > 1) {
+        const HEVCPPS *pps = s->ps.pps;
+        int nb_substreams  = s->sh.num_entry_point_offsets + 1;
+
+        /* WPP rows, when the slice segment starts a CTB row */
+        if (pps->entropy_coding_sync_enabled_flag && !pps->tiles_enabled_flag &&
+            !(s->sh.slice_ctb_addr_rs % s->ps.sps->ctb_width) &&
+            s->sh.slice_ctb_addr_rs / s->ps.sps->ctb_width + nb_substreams <= s->ps.sps->ctb_height)
+            return hls_slice_data_substreams(s, nal);
+
+        /* complete tiles, when the slice segment starts a tile */
+        if (pps->tiles_enabled_flag && !pps->entropy_coding_sync_enabled_flag &&
+            ctb_addr_ts == pps->ctb_addr_rs_to_ts[pps->tile_pos_rs[pps->tile_id[ctb_addr_ts]]] &&
+            pps->tile_id[ctb_addr_ts] + nb_substreams <= pps->num_tile_columns * pps->num_tile_rows)
+            return hls_slice_data_substreams(s, nal);
+    }
+
     while (more_data && ctb_addr_ts < s->ps.sps->ctb_size) {
         int ctb_addr_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
 
@@ -2411,7 +2757,7 @@ static int set_side_data(HEVCContext *s)
 
 static int hevc_frame_start(HEVCContext *s)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     int ret;
 
     memset(s->horizontal_bs, 0, 2 * s->bs_width * (s->bs_height + 1));
@@ -2461,7 +2807,7 @@ fail:
 
 static int decode_nal_unit(HEVCContext *s, const H2645NAL *nal)
 {
-    HEVCLocalContext *lc = &s->HEVClc;
+    HEVCLocalContext *lc = s->HEVClc;
     GetBitContext *gb    = &lc->gb;
     int ctb_addr_ts, ret;
 
@@ -2568,7 +2914,7 @@ static int decode_nal_unit(HEVCContext *s, const H2645NAL *nal)
             if (ret < 0)
                 goto fail;
         } else {
-            ctb_addr_ts = hls_slice_data(s);
+            ctb_addr_ts = hls_slice_data(s, nal);
             if (ctb_addr_ts >= (s->ps.sps->ctb_width * s->ps.sps->ctb_height)) {
                 s->is_decoded = 1;
                 if ((s->ps.pps->transquant_bypass_enable_flag ||
@@ -2912,6 +3258,20 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
 
     ff_h2645_packet_uninit(&s->pkt);
 
+    for (i = 0; i < s->nb_slice_threads; i++) {
+        if (s->sList)
+            av_freep(&s->sList[i]);
+        if (s->HEVClcList)
+            av_freep(&s->HEVClcList[i]);
+    }
+    av_freep(&s->sList);
+    av_freep(&s->HEVClcList);
+    s->nb_slice_threads = 0;
+
+    av_freep(&s->HEVClc);
+    av_freep(&s->substreams);
+    av_freep(&s->sh.entry_point_offset);
+
     return 0;
 }
 
@@ -2922,6 +3282,25 @@ static av_cold int hevc_init_context(AVCodecContext *avctx)
 
     s->avctx = avctx;
 
+    s->HEVClc = av_mallocz(sizeof(*s->HEVClc));
+    if (!s->HEVClc)
+        goto fail;
+
+    if (avctx->active_thread_type & FF_THREAD_SLICE) {
+        s->sList      = av_mallocz_array(avctx->thread_count, sizeof(*s->sList));
+        s->HEVClcList = av_mallocz_array(avctx->thread_count, sizeof(*s->HEVClcList));
+        if (!s->sList || !s->HEVClcList)
+            goto fail;
+        s->nb_slice_threads = avctx->thread_count;
+
+        for (i = 0; i < s->nb_slice_threads; i++) {
+            s->sList[i]      = av_malloc(sizeof(*s->sList[i]));
+            s->HEVClcList[i] = av_mallocz(sizeof(*s->HEVClcList[i]));
+            if (!s->sList[i] || !s->HEVClcList[i])
+                goto fail;
+        }
+    }
+
     s->tmp_frame = av_frame_alloc();
     if (!s->tmp_frame)
         goto fail;
@@ -3095,7 +3474,7 @@ AVCodec ff_hevc_decoder = {
     .update_thread_context = hevc_update_thread_context,
     .init_thread_copy      = hevc_init_thread_copy,
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                             AV_CODEC_CAP_FRAME_THREADS,
+                             AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
     .profiles              = NULL_IF_CONFIG_SMALL(ff_hevc_profiles),
     .caps_internal         = FF_CODEC_CAP_EXPORTS_CROPPING | FF_CODEC_CAP_INIT_THREADSAFE,
 };
@@ -280,6 +280,8 @@ typedef struct SliceHeader {
     unsigned int max_num_merge_cand; ///< 5 - 5_minus_max_num_merge_cand
 
     int num_entry_point_offsets;
+    unsigned int *entry_point_offset; ///< entry_point_offset_minus1 + 1
+    unsigned int  entry_point_offset_size;
 
     int8_t slice_qp;
 
@@ -444,11 +446,40 @@ typedef struct HEVCLocalContext {
     int boundary_flags;
 } HEVCLocalContext;
 
+/**
+ * A substream of a slice segment, i.e. a tile or a WPP row, decoded
+ * independently when slice threading is active.
+ */
+typedef struct HEVCSubstream {
+    const uint8_t *data;
+    int size;
+
+    /** set when the substream could not be decoded */
+    int error;
+    /** number of CTBs decoded */
+    int nb_ctbs;
+
+    /** WPP: 1 if state holds the CABAC state saved after the 2nd CTB */
+    int state_saved;
+    uint8_t state[HEVC_CONTEXTS];
+} HEVCSubstream;
+
 typedef struct HEVCContext {
     const AVClass *c;  // needed by private avoptions
     AVCodecContext *avctx;
 
-    HEVCLocalContext HEVClc;
+    HEVCLocalContext *HEVClc;
+
+    /**
+     * Per-thread copies of the context and of the local context, used for
+     * decoding the substreams of a slice segment with slice threading.
+     */
+    struct HEVCContext **sList;
+    HEVCLocalContext   **HEVClcList;
+    int                  nb_slice_threads;
+
+    HEVCSubstream *substreams;
+    unsigned int   substreams_size;
 
     uint8_t cabac_state[HEVC_CONTEXTS];
 
@@ -562,6 +593,14 @@ int ff_hevc_slice_rpl(HEVCContext *s);
 
 void ff_hevc_save_states(HEVCContext *s, int ctb_addr_ts);
 void ff_hevc_cabac_init(HEVCContext *s, int ctb_addr_ts);
+/**
+ * Initialize the CABAC decoder for a substream (tile or WPP row) which does
+ * not start the slice segment.
+ * @param wpp_state the state saved in the CTB row above, WPP only
+ */
+void ff_hevc_cabac_init_substream(HEVCContext *s, int ctb_addr_ts,
+                                  const uint8_t *buf, int size,
+                                  const uint8_t *wpp_state);
 int ff_hevc_sao_merge_flag_decode(HEVCContext *s);
 int ff_hevc_sao_type_idx_decode(HEVCContext *s);
 int ff_hevc_sao_band_position_decode(HEVCContext *s);
@@ -648,6 +687,7 @@ void ff_hevc_hls_filter(HEVCContext *s, int x, int y);
 void ff_hevc_hls_filters(HEVCContext *s, int x_ctb, int y_ctb, int ctb_size);
 
 void ff_hevc_pred_init(HEVCPredContext *hpc, int bit_depth);
+void ff_hevc_pred_init_x86(HEVCPredContext *hpc, int bit_depth);
 
 extern const uint8_t ff_hevc_qpel_extra_before[4];
 extern const uint8_t ff_hevc_qpel_extra_after[4];
@@ -49,13 +49,18 @@ typedef struct HEVCDSPContext {
     void (*idct[4])(int16_t *coeffs, int col_limit);
     void (*idct_dc[4])(int16_t *coeffs);
 
-    void (*sao_band_filter[4])(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
-                               struct SAOParams *sao, int *borders,
-                               int width, int height, int c_idx);
-    void (*sao_edge_filter[4])(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
-                               struct SAOParams *sao, int *borders, int width,
-                               int height, int c_idx, uint8_t vert_edge,
-                               uint8_t horiz_edge, uint8_t diag_edge);
+    /**
+     * Apply SAO to a width x height block. dst and src share the stride.
+     * The edge filter reads the samples around the block from src, the
+     * picture borders and the unfilterable edges are handled by the caller.
+     * The SIMD versions may read up to 32 bytes past the end of each src row.
+     */
+    void (*sao_band_filter)(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+                            int *sao_offset_val, int sao_left_class,
+                            int width, int height);
+    void (*sao_edge_filter)(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+                            int *sao_offset_val, int sao_eo_class,
+                            int width, int height);
 
     void (*put_hevc_qpel[2][2][8])(int16_t *dst, ptrdiff_t dststride, uint8_t *src,
                                    ptrdiff_t srcstride, int height,
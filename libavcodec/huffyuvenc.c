@@ -26,6 +26,9 @@
  * huffyuv encoder
  */
 
+/* the pixels are written as long runs of short Huffman codes */
+#define BITSTREAM_WRITER_64
+
 #include "libavutil/opt.h"
 
 #include "avcodec.h"
@@ -207,6 +210,15 @@ FF_ENABLE_DEPRECATION_WARNINGS
                    "2 pass huffyuv encoding\n");
             return -1;
         }
+        /* The tables adapt to the previous frames, which only a single
+         * thread encodes in order. */
+        if (avctx->active_thread_type & FF_THREAD_FRAME) {
+            av_log(avctx, AV_LOG_WARNING,
+                   "context=1 is not compatible with frame threading, "
+                   "using one thread\n");
+            avctx->active_thread_type = 0;
+            avctx->thread_count       = 1;
+        }
     }
 
     if (avctx->codec->id == AV_CODEC_ID_HUFFYUV) {
@@ -734,6 +746,7 @@ AVCodec ff_huffyuv_encoder = {
     .init           = encode_init,
     .encode2        = encode_frame,
     .close          = encode_end,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]){
         AV_PIX_FMT_YUV422P, AV_PIX_FMT_RGB24,
         AV_PIX_FMT_RGB32, AV_PIX_FMT_NONE
@@ -761,6 +774,7 @@ AVCodec ff_ffvhuff_encoder = {
     .init           = encode_init,
     .encode2        = encode_frame,
     .close          = encode_end,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]){
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_RGB24,
         AV_PIX_FMT_RGB32, AV_PIX_FMT_NONE
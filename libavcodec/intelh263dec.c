@@ -28,47 +28,47 @@ int ff_intel_h263_decode_picture_header(MpegEncContext *s)
 {
     int format;
 
-    if (get_bits_left(&s->gb) == 64) { /* special dummy frames */
+    if (bitstream_bits_left(&s->bc) == 64) { /* special dummy frames */
         return FRAME_SKIPPED;
     }
 
     /* picture header */
-    if (get_bits_long(&s->gb, 22) != 0x20) {
+    if (bitstream_read(&s->bc, 22) != 0x20) {
         av_log(s->avctx, AV_LOG_ERROR, "Bad picture start code\n");
         return -1;
     }
-    s->picture_number = get_bits(&s->gb, 8); /* picture timestamp */
+    s->picture_number = bitstream_read(&s->bc, 8); /* picture timestamp */
 
-    if (get_bits1(&s->gb) != 1) {
+    if (bitstream_read_bit(&s->bc) != 1) {
         av_log(s->avctx, AV_LOG_ERROR, "Bad marker\n");
         return -1;      /* marker */
     }
-    if (get_bits1(&s->gb) != 0) {
+    if (bitstream_read_bit(&s->bc) != 0) {
         av_log(s->avctx, AV_LOG_ERROR, "Bad H.263 id\n");
         return -1;      /* H.263 id */
     }
-    skip_bits1(&s->gb);         /* split screen off */
-    skip_bits1(&s->gb);         /* camera  off */
-    skip_bits1(&s->gb);         /* freeze picture release off */
+    bitstream_skip(&s->bc, 1);         /* split screen off */
+    bitstream_skip(&s->bc, 1);         /* camera  off */
+    bitstream_skip(&s->bc, 1);         /* freeze picture release off */
 
-    format = get_bits(&s->gb, 3);
+    format = bitstream_read(&s->bc, 3);
     if (format == 0 || format == 6) {
         av_log(s->avctx, AV_LOG_ERROR, "Intel H.263 free format not supported\n");
         return -1;
     }
     s->h263_plus = 0;
 
-    s->pict_type = AV_PICTURE_TYPE_I + get_bits1(&s->gb);
+    s->pict_type = AV_PICTURE_TYPE_I + bitstream_read_bit(&s->bc);
 
-    s->unrestricted_mv = get_bits1(&s->gb);
+    s->unrestricted_mv = bitstream_read_bit(&s->bc);
     s->h263_long_vectors = s->unrestricted_mv;
 
-    if (get_bits1(&s->gb) != 0) {
+    if (bitstream_read_bit(&s->bc) != 0) {
         av_log(s->avctx, AV_LOG_ERROR, "SAC not supported\n");
         return -1;      /* SAC: off */
     }
-    s->obmc= get_bits1(&s->gb);
-    s->pb_frame = get_bits1(&s->gb);
+    s->obmc= bitstream_read_bit(&s->bc);
+    s->pb_frame = bitstream_read_bit(&s->bc);
 
     if (format < 6) {
         s->width = ff_h263_format[format][0];
@@ -76,31 +76,31 @@ int ff_intel_h263_decode_picture_header(MpegEncContext *s)
         s->avctx->sample_aspect_ratio.num = 12;
         s->avctx->sample_aspect_ratio.den = 11;
     } else {
-        format = get_bits(&s->gb, 3);
+        format = bitstream_read(&s->bc, 3);
         if(format == 0 || format == 7){
             av_log(s->avctx, AV_LOG_ERROR, "Wrong Intel H.263 format\n");
             return -1;
         }
-        if(get_bits(&s->gb, 2))
+        if(bitstream_read(&s->bc, 2))
             av_log(s->avctx, AV_LOG_ERROR, "Bad value for reserved field\n");
-        s->loop_filter = get_bits1(&s->gb);
-        if(get_bits1(&s->gb))
+        s->loop_filter = bitstream_read_bit(&s->bc);
+        if(bitstream_read_bit(&s->bc))
             av_log(s->avctx, AV_LOG_ERROR, "Bad value for reserved field\n");
-        if(get_bits1(&s->gb))
+        if(bitstream_read_bit(&s->bc))
             s->pb_frame = 2;
-        if(get_bits(&s->gb, 5))
+        if(bitstream_read(&s->bc, 5))
             av_log(s->avctx, AV_LOG_ERROR, "Bad value for reserved field\n");
-        if(get_bits(&s->gb, 5) != 1)
+        if(bitstream_read(&s->bc, 5) != 1)
             av_log(s->avctx, AV_LOG_ERROR, "Invalid marker\n");
     }
     if(format == 6){
-        int ar = get_bits(&s->gb, 4);
-        skip_bits(&s->gb, 9); // display width
-        skip_bits1(&s->gb);
-        skip_bits(&s->gb, 9); // display height
+        int ar = bitstream_read(&s->bc, 4);
+        bitstream_skip(&s->bc, 9); // display width
+        bitstream_skip(&s->bc, 1);
+        bitstream_skip(&s->bc, 9); // display height
         if(ar == 15){
-            s->avctx->sample_aspect_ratio.num = get_bits(&s->gb, 8); // aspect ratio - width
-            s->avctx->sample_aspect_ratio.den = get_bits(&s->gb, 8); // aspect ratio - height
+            s->avctx->sample_aspect_ratio.num = bitstream_read(&s->bc, 8); // aspect ratio - width
+            s->avctx->sample_aspect_ratio.den = bitstream_read(&s->bc, 8); // aspect ratio - height
         } else {
             s->avctx->sample_aspect_ratio = ff_h263_pixel_aspect[ar];
         }
@@ -108,17 +108,17 @@ int ff_intel_h263_decode_picture_header(MpegEncContext *s)
             av_log(s->avctx, AV_LOG_ERROR, "Invalid aspect ratio.\n");
     }
 
-    s->chroma_qscale= s->qscale = get_bits(&s->gb, 5);
-    skip_bits1(&s->gb); /* Continuous Presence Multipoint mode: off */
+    s->chroma_qscale= s->qscale = bitstream_read(&s->bc, 5);
+    bitstream_skip(&s->bc, 1); /* Continuous Presence Multipoint mode: off */
 
     if(s->pb_frame){
-        skip_bits(&s->gb, 3); //temporal reference for B-frame
-        skip_bits(&s->gb, 2); //dbquant
+        bitstream_skip(&s->bc, 3); //temporal reference for B-frame
+        bitstream_skip(&s->bc, 2); //dbquant
     }
 
     /* PEI */
-    while (get_bits1(&s->gb) != 0) {
-        skip_bits(&s->gb, 8);
+    while (bitstream_read_bit(&s->bc) != 0) {
+        bitstream_skip(&s->bc, 8);
     }
     s->f_code = 1;
 
@@ -81,10 +81,16 @@
 
 typedef struct FramePool {
     /**
-     * Pools for each data plane. For audio all the planes have the same size,
-     * so only pools[0] is used.
+     * Buffers for the data planes of all the frame geometries, which outlive
+     * geometry changes.
      */
-    AVBufferPool *pools[4];
+    struct FrameBufferCache *cache;
+
+    /**
+     * Size of the buffer for each data plane, 0 for unused planes. For audio
+     * all the planes have the same size, so only plane_size[0] is used.
+     */
+    int plane_size[4];
 
     /*
      * Pool parameters
@@ -98,6 +104,20 @@ typedef struct FramePool {
     int samples;
 } FramePool;
 
+/**
+ * Allocate a frame pool.
+ *
+ * @param max_idle_size maximum number of bytes of unused buffers kept for
+ *                      reuse, 0 for the peak number of bytes in use
+ */
+FramePool *ff_frame_pool_alloc(int64_t max_idle_size);
+
+/**
+ * Free a frame pool. The buffers still in use are freed once they are
+ * released.
+ */
+void ff_frame_pool_free(FramePool **pool);
+
 typedef struct DecodeSimpleContext {
     AVPacket *in_pkt;
     AVFrame  *out_frame;
@@ -242,6 +242,20 @@ static inline int pix_abs8_c(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
     return s;
 }
 
+#define SAD_X4(size)                                                    \
+static void sad ## size ## _x4_c(uint8_t *src, uint8_t *const ref[4],   \
+                                 ptrdiff_t stride, int h,               \
+                                 int scores[4])                         \
+{                                                                       \
+    scores[0] = pix_abs ## size ## _c(NULL, src, ref[0], stride, h);    \
+    scores[1] = pix_abs ## size ## _c(NULL, src, ref[1], stride, h);    \
+    scores[2] = pix_abs ## size ## _c(NULL, src, ref[2], stride, h);    \
+    scores[3] = pix_abs ## size ## _c(NULL, src, ref[3], stride, h);    \
+}
+
+SAD_X4(16)
+SAD_X4(8)
+
 static int pix_abs8_x2_c(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                          ptrdiff_t stride, int h)
 {
@@ -920,6 +934,8 @@ av_cold void ff_me_cmp_init(MECmpContext *c, AVCodecContext *avctx)
 #endif
     c->sad[0] = pix_abs16_c;
     c->sad[1] = pix_abs8_c;
+    c->sad_x4[0] = sad16_x4_c;
+    c->sad_x4[1] = sad8_x4_c;
     c->sse[0] = sse16_c;
     c->sse[1] = sse8_c;
     c->sse[2] = sse4_c;
@@ -36,6 +36,12 @@ typedef int (*me_cmp_func)(struct MpegEncContext *c,
                            uint8_t *blk2 /* align 1 */, ptrdiff_t stride,
                            int h);
 
+/* Compare one block against four candidate blocks with the same stride,
+ * storing one score per candidate; h has the same limits as above. */
+typedef void (*me_cmp_x4_func)(uint8_t *src /* align width (8 or 16) */,
+                               uint8_t *const ref[4] /* align 1 */,
+                               ptrdiff_t stride, int h, int scores[4]);
+
 typedef struct MECmpContext {
     int (*sum_abs_dctelem)(int16_t *block /* align 16 */);
 
@@ -60,6 +66,8 @@ typedef struct MECmpContext {
     me_cmp_func frame_skip_cmp[6]; // only width 8 used
 
     me_cmp_func pix_abs[2][4];
+
+    me_cmp_x4_func sad_x4[2]; /* [0] 16, [1] 8 */
 } MECmpContext;
 
 void ff_me_cmp_init_static(void);
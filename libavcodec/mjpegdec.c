@@ -43,6 +43,7 @@
 #include "mjpegdec.h"
 #include "jpeglsdec.h"
 #include "put_bits.h"
+#include "thread.h"
 
 
 static int build_vlc(VLC *vlc, const uint8_t *bits_table,
@@ -68,34 +69,58 @@ static int build_vlc(VLC *vlc, const uint8_t *bits_table,
                               huff_code, 2, 2, huff_sym, 2, 2, use_static);
 }
 
-static int build_basic_mjpeg_vlc(MJpegDecodeContext *s)
+/* build the VLCs of a Huffman table and keep the table itself around */
+static int init_huffman_table(MJpegDecodeContext *s, int class, int index,
+                              const uint8_t *bits_table,
+                              const uint8_t *val_table)
 {
-    int ret;
-
-    if ((ret = build_vlc(&s->vlcs[0][0], avpriv_mjpeg_bits_dc_luminance,
-                         avpriv_mjpeg_val_dc, 12, 0, 0)) < 0)
+    int i, n = 0, code_max = 0, ret;
+
+    for (i = 1; i <= 16; i++)
+        n += bits_table[i];
+    for (i = 0; i < n; i++)
+        code_max = FFMAX(code_max, val_table[i]);
+
+    memcpy(s->huffman_bits[class][index], bits_table, 17);
+    memcpy(s->huffman_vals[class][index], val_table, n);
+    memset(s->huffman_vals[class][index] + n, 0, 256 - n);
+
+    /* build VLC and flush previous vlc if present */
+    ff_free_vlc(&s->vlcs[class][index]);
+    av_log(s->avctx, AV_LOG_DEBUG, "class=%d index=%d nb_codes=%d\n",
+           class, index, code_max + 1);
+    if ((ret = build_vlc(&s->vlcs[class][index], bits_table, val_table,
+                         code_max + 1, 0, class > 0)) < 0)
         return ret;
 
-    if ((ret = build_vlc(&s->vlcs[0][1], avpriv_mjpeg_bits_dc_chrominance,
-                         avpriv_mjpeg_val_dc, 12, 0, 0)) < 0)
-        return ret;
+    if (class > 0) {
+        ff_free_vlc(&s->vlcs[2][index]);
+        if ((ret = build_vlc(&s->vlcs[2][index], bits_table, val_table,
+                             code_max + 1, 0, 0)) < 0)
+            return ret;
+    }
+    return 0;
+}
 
-    if ((ret = build_vlc(&s->vlcs[1][0], avpriv_mjpeg_bits_ac_luminance,
-                         avpriv_mjpeg_val_ac_luminance, 251, 0, 1)) < 0)
-        return ret;
+static int build_basic_mjpeg_vlc(MJpegDecodeContext *s)
+{
+    int ret;
 
-    if ((ret = build_vlc(&s->vlcs[1][1], avpriv_mjpeg_bits_ac_chrominance,
-                         avpriv_mjpeg_val_ac_chrominance, 251, 0, 1)) < 0)
+    if ((ret = init_huffman_table(s, 0, 0, avpriv_mjpeg_bits_dc_luminance,
+                                  avpriv_mjpeg_val_dc)) < 0)
         return ret;
 
-    if ((ret = build_vlc(&s->vlcs[2][0], avpriv_mjpeg_bits_ac_luminance,
-                         avpriv_mjpeg_val_ac_luminance, 251, 0, 0)) < 0)
+    if ((ret = init_huffman_table(s, 0, 1, avpriv_mjpeg_bits_dc_chrominance,
+                                  avpriv_mjpeg_val_dc)) < 0)
         return ret;
 
-    if ((ret = build_vlc(&s->vlcs[2][1], avpriv_mjpeg_bits_ac_chrominance,
-                         avpriv_mjpeg_val_ac_chrominance, 251, 0, 0)) < 0)
+    if ((ret = init_huffman_table(s, 1, 0, avpriv_mjpeg_bits_ac_luminance,
+                                  avpriv_mjpeg_val_ac_luminance)) < 0)
         return ret;
 
+    if ((ret = init_huffman_table(s, 1, 1, avpriv_mjpeg_bits_ac_chrominance,
+                                  avpriv_mjpeg_val_ac_chrominance)) < 0)
+        return ret;
 
     return 0;
 }
@@ -131,7 +156,7 @@ av_cold int ff_mjpeg_decode_init(AVCodecContext *avctx)
 
     if (s->extern_huff) {
         av_log(avctx, AV_LOG_INFO, "mjpeg: using external huffman table\n");
-        if ((ret = init_get_bits(&s->gb, avctx->extradata, avctx->extradata_size * 8)) < 0)
+        if ((ret = bitstream_init(&s->bc, avctx->extradata, avctx->extradata_size * 8)) < 0)
             return ret;
         if ((ret = ff_mjpeg_decode_dht(s))) {
             av_log(avctx, AV_LOG_ERROR,
@@ -155,22 +180,22 @@ int ff_mjpeg_decode_dqt(MJpegDecodeContext *s)
 {
     int len, index, i, j;
 
-    len = get_bits(&s->gb, 16) - 2;
+    len = bitstream_read(&s->bc, 16) - 2;
 
     while (len >= 65) {
         /* only 8-bit precision handled */
-        if (get_bits(&s->gb, 4) != 0) {
+        if (bitstream_read(&s->bc, 4) != 0) {
             av_log(s->avctx, AV_LOG_ERROR, "dqt: 16-bit precision\n");
             return -1;
         }
-        index = get_bits(&s->gb, 4);
+        index = bitstream_read(&s->bc, 4);
         if (index >= 4)
             return -1;
         av_log(s->avctx, AV_LOG_DEBUG, "index=%d\n", index);
         /* read quant table */
         for (i = 0; i < 64; i++) {
             j = s->scantable.permutated[i];
-            s->quant_matrixes[index][j] = get_bits(&s->gb, 8);
+            s->quant_matrixes[index][j] = bitstream_read(&s->bc, 8);
         }
 
         // XXX FIXME fine-tune, and perhaps add dc too
@@ -186,54 +211,38 @@ int ff_mjpeg_decode_dqt(MJpegDecodeContext *s)
 /* decode huffman tables and build VLC decoders */
 int ff_mjpeg_decode_dht(MJpegDecodeContext *s)
 {
-    int len, index, i, class, n, v, code_max;
+    int len, index, i, class, n;
     uint8_t bits_table[17];
     uint8_t val_table[256];
     int ret = 0;
 
-    len = get_bits(&s->gb, 16) - 2;
+    len = bitstream_read(&s->bc, 16) - 2;
 
     while (len > 0) {
         if (len < 17)
             return AVERROR_INVALIDDATA;
-        class = get_bits(&s->gb, 4);
+        class = bitstream_read(&s->bc, 4);
         if (class >= 2)
             return AVERROR_INVALIDDATA;
-        index = get_bits(&s->gb, 4);
+        index = bitstream_read(&s->bc, 4);
         if (index >= 4)
             return AVERROR_INVALIDDATA;
         n = 0;
         for (i = 1; i <= 16; i++) {
-            bits_table[i] = get_bits(&s->gb, 8);
+            bits_table[i] = bitstream_read(&s->bc, 8);
             n += bits_table[i];
         }
         len -= 17;
         if (len < n || n > 256)
             return AVERROR_INVALIDDATA;
 
-        code_max = 0;
-        for (i = 0; i < n; i++) {
-            v = get_bits(&s->gb, 8);
-            if (v > code_max)
-                code_max = v;
-            val_table[i] = v;
-        }
+        for (i = 0; i < n; i++)
+            val_table[i] = bitstream_read(&s->bc, 8);
         len -= n;
 
-        /* build VLC and flush previous vlc if present */
-        ff_free_vlc(&s->vlcs[class][index]);
-        av_log(s->avctx, AV_LOG_DEBUG, "class=%d index=%d nb_codes=%d\n",
-               class, index, code_max + 1);
-        if ((ret = build_vlc(&s->vlcs[class][index], bits_table, val_table,
-                             code_max + 1, 0, class > 0)) < 0)
+        if ((ret = init_huffman_table(s, class, index,
+                                      bits_table, val_table)) < 0)
             return ret;
-
-        if (class > 0) {
-            ff_free_vlc(&s->vlcs[2][index]);
-            if ((ret = build_vlc(&s->vlcs[2][index], bits_table, val_table,
-                                 code_max + 1, 0, 0)) < 0)
-                return ret;
-        }
     }
     return 0;
 }
@@ -243,10 +252,11 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     int h_count[MAX_COMPONENTS] = { 0 };
     int v_count[MAX_COMPONENTS] = { 0 };
     int len, nb_components, i, width, height, bits, pix_fmt_id, ret;
+    ThreadFrame tframe = { 0 };
 
     /* XXX: verify len field validity */
-    len     = get_bits(&s->gb, 16);
-    bits    = get_bits(&s->gb, 8);
+    len     = bitstream_read(&s->bc, 16);
+    bits    = bitstream_read(&s->bc, 8);
 
     if (s->pegasus_rct)
         bits = 9;
@@ -258,8 +268,8 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
         return -1;
     }
 
-    height = get_bits(&s->gb, 16);
-    width  = get_bits(&s->gb, 16);
+    height = bitstream_read(&s->bc, 16);
+    width  = bitstream_read(&s->bc, 16);
 
     // HACK for odd_height.mov
     if (s->interlaced && s->width == width && s->height == height + 1)
@@ -269,7 +279,7 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     if (av_image_check_size(width, height, 0, s->avctx) < 0)
         return AVERROR_INVALIDDATA;
 
-    nb_components = get_bits(&s->gb, 8);
+    nb_components = bitstream_read(&s->bc, 8);
     if (nb_components <= 0 ||
         nb_components > MAX_COMPONENTS)
         return -1;
@@ -291,15 +301,15 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     s->v_max         = 1;
     for (i = 0; i < nb_components; i++) {
         /* component id */
-        s->component_id[i] = get_bits(&s->gb, 8) - 1;
-        h_count[i]         = get_bits(&s->gb, 4);
-        v_count[i]         = get_bits(&s->gb, 4);
+        s->component_id[i] = bitstream_read(&s->bc, 8) - 1;
+        h_count[i]         = bitstream_read(&s->bc, 4);
+        v_count[i]         = bitstream_read(&s->bc, 4);
         /* compute hmax and vmax (only used in interleaved case) */
         if (h_count[i] > s->h_max)
             s->h_max = h_count[i];
         if (v_count[i] > s->v_max)
             s->v_max = v_count[i];
-        s->quant_index[i] = get_bits(&s->gb, 8);
+        s->quant_index[i] = bitstream_read(&s->bc, 8);
         if (s->quant_index[i] >= 4)
             return AVERROR_INVALIDDATA;
         if (!h_count[i] || !v_count[i]) {
@@ -410,7 +420,8 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     }
 
     av_frame_unref(s->picture_ptr);
-    if (ff_get_buffer(s->avctx, s->picture_ptr, AV_GET_BUFFER_FLAG_REF) < 0) {
+    tframe.f = s->picture_ptr;
+    if (ff_thread_get_buffer(s->avctx, &tframe, AV_GET_BUFFER_FLAG_REF) < 0) {
         av_log(s->avctx, AV_LOG_ERROR, "get_buffer() failed\n");
         return -1;
     }
@@ -446,10 +457,11 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
     return 0;
 }
 
-static inline int mjpeg_decode_dc(MJpegDecodeContext *s, int dc_index)
+static inline int mjpeg_decode_dc(MJpegDecodeContext *s, BitstreamContext *bc,
+                                  int dc_index)
 {
     int code;
-    code = get_vlc2(&s->gb, s->vlcs[0][dc_index].table, 9, 2);
+    code = bitstream_read_vlc(bc, s->vlcs[0][dc_index].table, 9, 2);
     if (code < 0) {
         av_log(s->avctx, AV_LOG_WARNING,
                "mjpeg_decode_dc: bad vlc: %d:%d (%p)\n",
@@ -458,46 +470,36 @@ static inline int mjpeg_decode_dc(MJpegDecodeContext *s, int dc_index)
     }
 
     if (code)
-        return get_xbits(&s->gb, code);
+        return bitstream_read_xbits(bc, code);
     else
         return 0;
 }
 
 /* decode block and dequantize */
-static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
-                        int dc_index, int ac_index, int16_t *quant_matrix)
+static int decode_block(MJpegDecodeContext *s, BitstreamContext *bc, int *last_dc,
+                        int16_t *block, int dc_index, int ac_index,
+                        int16_t *quant_matrix)
 {
     int code, i, j, level, val;
 
     /* DC coef */
-    val = mjpeg_decode_dc(s, dc_index);
+    val = mjpeg_decode_dc(s, bc, dc_index);
     if (val == 0xffff) {
         av_log(s->avctx, AV_LOG_ERROR, "error dc\n");
         return AVERROR_INVALIDDATA;
     }
-    val = val * quant_matrix[0] + s->last_dc[component];
-    s->last_dc[component] = val;
+    val = val * quant_matrix[0] + *last_dc;
+    *last_dc = val;
     block[0] = val;
     /* AC coefs */
     i = 0;
-    {OPEN_READER(re, &s->gb);
     do {
-        UPDATE_CACHE(re, &s->gb);
-        GET_VLC(code, re, &s->gb, s->vlcs[1][ac_index].table, 9, 2);
+        code = bitstream_read_vlc(bc, s->vlcs[1][ac_index].table, 9, 2);
 
         i += ((unsigned)code) >> 4;
             code &= 0xf;
         if (code) {
-            if (code > MIN_CACHE_BITS - 16)
-                UPDATE_CACHE(re, &s->gb);
-
-            {
-                int cache = GET_CACHE(re, &s->gb);
-                int sign  = (~cache) >> 31;
-                level     = (NEG_USR32(sign ^ cache,code) ^ sign) - sign;
-            }
-
-            LAST_SKIP_BITS(re, &s->gb, code);
+            level = bitstream_read_xbits(bc, code);
 
             if (i > 63) {
                 av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
@@ -507,7 +509,6 @@ static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
             block[j] = level * quant_matrix[j];
         }
     } while (i < 63);
-    CLOSE_READER(re, &s->gb);}
 
     return 0;
 }
@@ -518,7 +519,7 @@ static int decode_dc_progressive(MJpegDecodeContext *s, int16_t *block,
 {
     int val;
     s->bdsp.clear_block(block);
-    val = mjpeg_decode_dc(s, dc_index);
+    val = mjpeg_decode_dc(s, &s->bc, dc_index);
     if (val == 0xffff) {
         av_log(s->avctx, AV_LOG_ERROR, "error dc\n");
         return AVERROR_INVALIDDATA;
@@ -542,58 +543,39 @@ static int decode_block_progressive(MJpegDecodeContext *s, int16_t *block,
         return 0;
     }
 
-    {
-        OPEN_READER(re, &s->gb);
-        for (i = ss; ; i++) {
-            UPDATE_CACHE(re, &s->gb);
-            GET_VLC(code, re, &s->gb, s->vlcs[2][ac_index].table, 9, 2);
-
-            run = ((unsigned) code) >> 4;
-            code &= 0xF;
-            if (code) {
-                i += run;
-                if (code > MIN_CACHE_BITS - 16)
-                    UPDATE_CACHE(re, &s->gb);
-
-                {
-                    int cache = GET_CACHE(re, &s->gb);
-                    int sign  = (~cache) >> 31;
-                    level     = (NEG_USR32(sign ^ cache,code) ^ sign) - sign;
-                }
+    for (i = ss; ; i++) {
+        code = bitstream_read_vlc(&s->bc, s->vlcs[2][ac_index].table, 9, 2);
 
-                LAST_SKIP_BITS(re, &s->gb, code);
+        run = ((unsigned) code) >> 4;
+        code &= 0xF;
+        if (code) {
+            i += run;
+            level = bitstream_read_xbits(&s->bc, code);
 
+            if (i >= se) {
+                if (i == se) {
+                    j = s->scantable.permutated[se];
+                    block[j] = level * quant_matrix[j] << Al;
+                    break;
+                }
+                av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
+                return AVERROR_INVALIDDATA;
+            }
+            j = s->scantable.permutated[i];
+            block[j] = level * quant_matrix[j] << Al;
+        } else {
+            if (run == 0xF) {// ZRL - skip 15 coefficients
+                i += 15;
                 if (i >= se) {
-                    if (i == se) {
-                        j = s->scantable.permutated[se];
-                        block[j] = level * quant_matrix[j] << Al;
-                        break;
-                    }
-                    av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
+                    av_log(s->avctx, AV_LOG_ERROR, "ZRL overflow: %d\n", i);
                     return AVERROR_INVALIDDATA;
                 }
-                j = s->scantable.permutated[i];
-                block[j] = level * quant_matrix[j] << Al;
             } else {
-                if (run == 0xF) {// ZRL - skip 15 coefficients
-                    i += 15;
-                    if (i >= se) {
-                        av_log(s->avctx, AV_LOG_ERROR, "ZRL overflow: %d\n", i);
-                        return AVERROR_INVALIDDATA;
-                    }
-                } else {
-                    val = (1 << run);
-                    if (run) {
-                        UPDATE_CACHE(re, &s->gb);
-                        val += NEG_USR32(GET_CACHE(re, &s->gb), run);
-                        LAST_SKIP_BITS(re, &s->gb, run);
-                    }
-                    *EOBRUN = val - 1;
-                    break;
-                }
+                val = (1 << run) + bitstream_read(&s->bc, run);
+                *EOBRUN = val - 1;
+                break;
             }
         }
-        CLOSE_READER(re, &s->gb);
     }
 
     if (i > *last_nnz)
@@ -603,11 +585,9 @@ static int decode_block_progressive(MJpegDecodeContext *s, int16_t *block,
 }
 
 #define REFINE_BIT(j) {                                             \
-    UPDATE_CACHE(re, &s->gb);                                       \
     sign = block[j] >> 15;                                          \
-    block[j] += SHOW_UBITS(re, &s->gb, 1) *                         \
+    block[j] += bitstream_read_bit(&s->bc) *                        \
                 ((quant_matrix[j] ^ sign) - sign) << Al;            \
-    LAST_SKIP_BITS(re, &s->gb, 1);                                  \
 }
 
 #define ZERO_RUN                                                    \
@@ -636,19 +616,15 @@ static int decode_block_refinement(MJpegDecodeContext *s, int16_t *block,
     int code, i = ss, j, sign, val, run;
     int last    = FFMIN(se, *last_nnz);
 
-    OPEN_READER(re, &s->gb);
     if (*EOBRUN) {
         (*EOBRUN)--;
     } else {
         for (; ; i++) {
-            UPDATE_CACHE(re, &s->gb);
-            GET_VLC(code, re, &s->gb, s->vlcs[2][ac_index].table, 9, 2);
+            code = bitstream_read_vlc(&s->bc, s->vlcs[2][ac_index].table, 9, 2);
 
             if (code & 0xF) {
                 run = ((unsigned) code) >> 4;
-                UPDATE_CACHE(re, &s->gb);
-                val = SHOW_UBITS(re, &s->gb, 1);
-                LAST_SKIP_BITS(re, &s->gb, 1);
+                val = bitstream_read_bit(&s->bc);
                 ZERO_RUN;
                 j = s->scantable.permutated[i];
                 val--;
@@ -656,7 +632,6 @@ static int decode_block_refinement(MJpegDecodeContext *s, int16_t *block,
                 if (i == se) {
                     if (i > *last_nnz)
                         *last_nnz = i;
-                    CLOSE_READER(re, &s->gb);
                     return 0;
                 }
             } else {
@@ -664,13 +639,7 @@ static int decode_block_refinement(MJpegDecodeContext *s, int16_t *block,
                 if (run == 0xF) {
                     ZERO_RUN;
                 } else {
-                    val = run;
-                    run = (1 << run);
-                    if (val) {
-                        UPDATE_CACHE(re, &s->gb);
-                        run += SHOW_UBITS(re, &s->gb, val);
-                        LAST_SKIP_BITS(re, &s->gb, val);
-                    }
+                    run = (1 << run) + bitstream_read(&s->bc, run);
                     *EOBRUN = run - 1;
                     break;
                 }
@@ -686,7 +655,6 @@ static int decode_block_refinement(MJpegDecodeContext *s, int16_t *block,
         if (block[j])
             REFINE_BIT(j)
     }
-    CLOSE_READER(re, &s->gb);
 
     return 0;
 }
@@ -735,12 +703,12 @@ static int ljpeg_decode_rgb_scan(MJpegDecodeContext *s, int predictor,
                 PREDICT(pred, topleft[i], top[i], left[i], modified_predictor);
 
                 left[i] = buffer[mb_x][i] =
-                    mask & (pred + (mjpeg_decode_dc(s, s->dc_index[i]) << point_transform));
+                    mask & (pred + (mjpeg_decode_dc(s, &s->bc, s->dc_index[i]) << point_transform));
             }
 
             if (s->restart_interval && !--s->restart_count) {
-                align_get_bits(&s->gb);
-                skip_bits(&s->gb, 16); /* skip RSTn */
+                bitstream_align(&s->bc);
+                bitstream_skip(&s->bc, 16); /* skip RSTn */
             }
         }
 
@@ -810,7 +778,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s, int predictor,
 
                         if (s->interlaced && s->bottom_field)
                             ptr += linesize >> 1;
-                        *ptr = pred + (mjpeg_decode_dc(s, s->dc_index[i]) << point_transform);
+                        *ptr = pred + (mjpeg_decode_dc(s, &s->bc, s->dc_index[i]) << point_transform);
 
                         if (++x == h) {
                             x = 0;
@@ -839,7 +807,7 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s, int predictor,
                               (h * mb_x + x);
                         PREDICT(pred, ptr[-linesize - 1],
                                 ptr[-linesize], ptr[-1], predictor);
-                        *ptr = pred + (mjpeg_decode_dc(s, s->dc_index[i]) << point_transform);
+                        *ptr = pred + (mjpeg_decode_dc(s, &s->bc, s->dc_index[i]) << point_transform);
                         if (++x == h) {
                             x = 0;
                             y++;
@@ -848,11 +816,135 @@ static int ljpeg_decode_yuv_scan(MJpegDecodeContext *s, int predictor,
                 }
             }
             if (s->restart_interval && !--s->restart_count) {
-                align_get_bits(&s->gb);
-                skip_bits(&s->gb, 16); /* skip RSTn */
+                bitstream_align(&s->bc);
+                bitstream_skip(&s->bc, 16); /* skip RSTn */
+            }
+        }
+    }
+    return 0;
+}
+
+/* the restart intervals of a baseline scan, decoded in parallel slice jobs */
+typedef struct MJpegRestartSlices {
+    int nb_components;
+    int first_marker;   ///< index of the first RSTn of the scan in restart_pos
+    int nb_intervals;
+    int nb_jobs;
+    int scan_start;     ///< offset of the entropy coded data in the unescaped buffer
+    int scan_end;
+} MJpegRestartSlices;
+
+static int decode_restart_intervals(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s        = avctx->priv_data;
+    const MJpegRestartSlices *rs = arg;
+    const int nb_mcus            = s->mb_width * s->mb_height;
+    int first = rs->nb_intervals *  jobnr      / rs->nb_jobs;
+    int last  = rs->nb_intervals * (jobnr + 1) / rs->nb_jobs;
+    int last_dc[MAX_COMPONENTS];
+    BitstreamContext bc;
+    int i, k, mcu, mcu_end;
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
+
+    for (k = first; k < last; k++) {
+        int start = k ? s->restart_pos[rs->first_marker + k - 1] : rs->scan_start;
+        int end   = k < rs->nb_intervals - 1 ?
+                    s->restart_pos[rs->first_marker + k] - 2 : rs->scan_end;
+
+        bitstream_init(&bc, s->buffer + start, (end - start) * 8);
+        for (i = 0; i < rs->nb_components; i++)
+            last_dc[i] = 1024;
+
+        mcu     = k * s->restart_interval;
+        mcu_end = FFMIN(mcu + s->restart_interval, nb_mcus);
+        for (; mcu < mcu_end; mcu++) {
+            int mb_x = mcu % s->mb_width;
+            int mb_y = mcu / s->mb_width;
+
+            if (bitstream_bits_left(&bc) < 0) {
+                av_log(avctx, AV_LOG_ERROR, "overread %d\n",
+                       -bitstream_bits_left(&bc));
+                return AVERROR_INVALIDDATA;
+            }
+            for (i = 0; i < rs->nb_components; i++) {
+                int c = s->comp_index[i];
+                int h = s->h_scount[i];
+                int v = s->v_scount[i];
+                int x = 0, y = 0, j;
+
+                for (j = 0; j < s->nb_blocks[i]; j++) {
+                    uint8_t *ptr = s->picture_ptr->data[c] +
+                                   s->linesize[c] * (v * mb_y + y) * 8 +
+                                   (h * mb_x + x) * 8;
+
+                    s->bdsp.clear_block(block);
+                    if (decode_block(s, &bc, &last_dc[i], block,
+                                     s->dc_index[i], s->ac_index[i],
+                                     s->quant_matrixes[s->quant_index[c]]) < 0) {
+                        av_log(avctx, AV_LOG_ERROR,
+                               "error y=%d x=%d\n", mb_y, mb_x);
+                        return AVERROR_INVALIDDATA;
+                    }
+                    s->idsp.idct_put(ptr, s->linesize[c], block);
+                    if (++x == h) {
+                        x = 0;
+                        y++;
+                    }
+                }
             }
         }
     }
+
+    emms_c();
+    return 0;
+}
+
+/**
+ * Decode the restart intervals of a baseline scan in parallel.
+ *
+ * @return 0 or a negative error code if the scan was decoded, 1 if the
+ *         restart markers do not split it into the expected intervals
+ */
+static int mjpeg_decode_scan_slices(MJpegDecodeContext *s, int nb_components)
+{
+    AVCodecContext *avctx = s->avctx;
+    MJpegRestartSlices rs;
+    int nb_markers, i, ret;
+
+    rs.nb_components = nb_components;
+    rs.scan_start    = bitstream_tell(&s->bc) >> 3;
+    rs.scan_end      = s->bc.size_in_bits >> 3;
+    rs.nb_intervals  = (s->mb_width * s->mb_height + s->restart_interval - 1) /
+                       s->restart_interval;
+
+    for (i = 0; i < s->nb_restart_pos; i++)
+        if (s->restart_pos[i] - 2 >= rs.scan_start)
+            break;
+    rs.first_marker = i;
+    nb_markers      = s->nb_restart_pos - i;
+    if (nb_markers < rs.nb_intervals - 1)
+        return 1;
+    if (nb_markers > rs.nb_intervals - 1)
+        rs.scan_end = s->restart_pos[i + rs.nb_intervals - 1] - 2;
+
+    /* a few intervals per thread to even out their different sizes */
+    rs.nb_jobs = FFMIN(rs.nb_intervals, avctx->thread_count * 4);
+    av_fast_malloc(&s->slice_ret, &s->slice_ret_size,
+                   rs.nb_jobs * sizeof(*s->slice_ret));
+    if (!s->slice_ret)
+        return AVERROR(ENOMEM);
+
+    avctx->execute2(avctx, decode_restart_intervals, &rs, s->slice_ret,
+                    rs.nb_jobs);
+
+    bitstream_seek(&s->bc, rs.scan_end * 8);
+
+    for (i = 0; i < rs.nb_jobs; i++) {
+        ret = s->slice_ret[i];
+        if (ret < 0)
+            return ret;
+    }
     return 0;
 }
 
@@ -864,10 +956,18 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
     uint8_t *data[MAX_COMPONENTS];
     const uint8_t *reference_data[MAX_COMPONENTS];
     int linesize[MAX_COMPONENTS];
-    GetBitContext mb_bitmask_gb;
+    BitstreamContext mb_bitmask_bc;
+
+    if (s->avctx->active_thread_type & FF_THREAD_SLICE &&
+        s->restart_interval && !s->progressive && !s->interlaced &&
+        !mb_bitmask) {
+        int ret = mjpeg_decode_scan_slices(s, nb_components);
+        if (ret <= 0)
+            return ret;
+    }
 
     if (mb_bitmask)
-        init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width * s->mb_height);
+        bitstream_init(&mb_bitmask_bc, mb_bitmask, s->mb_width * s->mb_height);
 
     for (i = 0; i < nb_components; i++) {
         int c   = s->comp_index[i];
@@ -879,14 +979,14 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
 
     for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
         for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
-            const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
+            const int copy_mb = mb_bitmask && !bitstream_read_bit(&mb_bitmask_bc);
 
             if (s->restart_interval && !s->restart_count)
                 s->restart_count = s->restart_interval;
 
-            if (get_bits_left(&s->gb) < 0) {
+            if (bitstream_bits_left(&s->bc) < 0) {
                 av_log(s->avctx, AV_LOG_ERROR, "overread %d\n",
-                       -get_bits_left(&s->gb));
+                       -bitstream_bits_left(&s->bc));
                 return AVERROR_INVALIDDATA;
             }
             for (i = 0; i < nb_components; i++) {
@@ -913,7 +1013,8 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
                                 linesize[c], 8);
                         else {
                             s->bdsp.clear_block(s->block);
-                            if (decode_block(s, s->block, i,
+                            if (decode_block(s, &s->bc, &s->last_dc[i],
+                                             s->block,
                                              s->dc_index[i], s->ac_index[i],
                                              s->quant_matrixes[s->quant_index[c]]) < 0) {
                                 av_log(s->avctx, AV_LOG_ERROR,
@@ -927,7 +1028,7 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
                                          (h * mb_x + x);
                         int16_t *block = s->blocks[c][block_idx];
                         if (Ah)
-                            block[0] += get_bits1(&s->gb) *
+                            block[0] += bitstream_read_bit(&s->bc) *
                                         s->quant_matrixes[s->quant_index[c]][0] << Al;
                         else if (decode_dc_progressive(s, block, i, s->dc_index[i],
                                                        s->quant_matrixes[s->quant_index[c]],
@@ -950,18 +1051,18 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
 
             if (s->restart_interval) {
                 s->restart_count--;
-                i = 8 + ((-get_bits_count(&s->gb)) & 7);
+                i = 8 + ((-bitstream_tell(&s->bc)) & 7);
                 /* skip RSTn */
-                if (show_bits(&s->gb, i) == (1 << i) - 1) {
-                    int pos = get_bits_count(&s->gb);
-                    align_get_bits(&s->gb);
-                    while (get_bits_left(&s->gb) >= 8 && show_bits(&s->gb, 8) == 0xFF)
-                        skip_bits(&s->gb, 8);
-                    if ((get_bits(&s->gb, 8) & 0xF8) == 0xD0) {
+                if (bitstream_peek(&s->bc, i) == (1 << i) - 1) {
+                    int pos = bitstream_tell(&s->bc);
+                    bitstream_align(&s->bc);
+                    while (bitstream_bits_left(&s->bc) >= 8 && bitstream_peek(&s->bc, 8) == 0xFF)
+                        bitstream_skip(&s->bc, 8);
+                    if ((bitstream_read(&s->bc, 8) & 0xF8) == 0xD0) {
                         for (i = 0; i < nb_components; i++) /* reset dc */
                             s->last_dc[i] = 1024;
                     } else
-                        skip_bits_long(&s->gb, pos - get_bits_count(&s->gb));
+                        bitstream_seek(&s->bc, pos);
                 }
             }
         }
@@ -982,7 +1083,7 @@ static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
     int linesize  = s->linesize[c];
     int last_scan = 0;
     int16_t *quant_matrix = s->quant_matrixes[s->quant_index[c]];
-    GetBitContext mb_bitmask_gb;
+    BitstreamContext mb_bitmask_bc;
 
     if (ss < 0  || ss >= 64 ||
         se < ss || se >= 64 ||
@@ -990,7 +1091,7 @@ static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
         return AVERROR_INVALIDDATA;
 
     if (mb_bitmask)
-        init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width * s->mb_height);
+        bitstream_init(&mb_bitmask_bc, mb_bitmask, s->mb_width * s->mb_height);
 
     if (!Al) {
         // s->coefs_finished is a bitmask for coefficients coded
@@ -1012,7 +1113,7 @@ static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
         int16_t (*block)[64] = &s->blocks[c][block_idx];
         uint8_t *last_nnz    = &s->last_nnz[c][block_idx];
         for (mb_x = 0; mb_x < s->mb_width; mb_x++, block++, last_nnz++) {
-            const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
+            const int copy_mb = mb_bitmask && !bitstream_read_bit(&mb_bitmask_bc);
 
             if (!copy_mb) {
                 int ret;
@@ -1053,8 +1154,8 @@ int ff_mjpeg_decode_sos(MJpegDecodeContext *s, const uint8_t *mb_bitmask,
     int ilv, prev_shift;
 
     /* XXX: verify len field validity */
-    len = get_bits(&s->gb, 16);
-    nb_components = get_bits(&s->gb, 8);
+    len = bitstream_read(&s->bc, 16);
+    nb_components = bitstream_read(&s->bc, 8);
     if (nb_components == 0 || nb_components > MAX_COMPONENTS) {
         avpriv_report_missing_feature(s->avctx,
                                       "decode_sos: nb_components (%d)",
@@ -1066,7 +1167,7 @@ int ff_mjpeg_decode_sos(MJpegDecodeContext *s, const uint8_t *mb_bitmask,
         return AVERROR_INVALIDDATA;
     }
     for (i = 0; i < nb_components; i++) {
-        id = get_bits(&s->gb, 8) - 1;
+        id = bitstream_read(&s->bc, 8) - 1;
         av_log(s->avctx, AV_LOG_DEBUG, "component: %d\n", id);
         /* find component index */
         for (index = 0; index < s->nb_components; index++)
@@ -1088,8 +1189,8 @@ int ff_mjpeg_decode_sos(MJpegDecodeContext *s, const uint8_t *mb_bitmask,
         s->h_scount[i]  = s->h_count[index];
         s->v_scount[i]  = s->v_count[index];
 
-        s->dc_index[i] = get_bits(&s->gb, 4);
-        s->ac_index[i] = get_bits(&s->gb, 4);
+        s->dc_index[i] = bitstream_read(&s->bc, 4);
+        s->ac_index[i] = bitstream_read(&s->bc, 4);
 
         if (s->dc_index[i] <  0 || s->ac_index[i] < 0 ||
             s->dc_index[i] >= 4 || s->ac_index[i] >= 4)
@@ -1099,10 +1200,10 @@ int ff_mjpeg_decode_sos(MJpegDecodeContext *s, const uint8_t *mb_bitmask,
             goto out_of_range;
     }
 
-    predictor = get_bits(&s->gb, 8);       /* JPEG Ss / lossless JPEG predictor /JPEG-LS NEAR */
-    ilv = get_bits(&s->gb, 8);             /* JPEG Se / JPEG-LS ILV */
-    prev_shift      = get_bits(&s->gb, 4); /* Ah */
-    point_transform = get_bits(&s->gb, 4); /* Al */
+    predictor = bitstream_read(&s->bc, 8);       /* JPEG Ss / lossless JPEG predictor /JPEG-LS NEAR */
+    ilv = bitstream_read(&s->bc, 8);             /* JPEG Se / JPEG-LS ILV */
+    prev_shift      = bitstream_read(&s->bc, 4); /* Ah */
+    point_transform = bitstream_read(&s->bc, 4); /* Al */
 
     if (nb_components > 1) {
         /* interleaved stream */
@@ -1127,7 +1228,7 @@ int ff_mjpeg_decode_sos(MJpegDecodeContext *s, const uint8_t *mb_bitmask,
 
     /* mjpeg-b can have padding bytes between sos and image data, skip them */
     for (i = s->mjpb_skiptosod; i > 0; i--)
-        skip_bits(&s->gb, 8);
+        bitstream_skip(&s->bc, 8);
 
     if (s->lossless && s->rgb && nb_components != 3) {
         avpriv_request_sample(s->avctx,
@@ -1176,14 +1277,14 @@ next_field:
     }
 
     if (s->interlaced &&
-        get_bits_left(&s->gb) > 32 &&
-        show_bits(&s->gb, 8) == 0xFF) {
-        GetBitContext bak = s->gb;
-        align_get_bits(&bak);
-        if (show_bits(&bak, 16) == 0xFFD1) {
+        bitstream_bits_left(&s->bc) > 32 &&
+        bitstream_peek(&s->bc, 8) == 0xFF) {
+        BitstreamContext bak = s->bc;
+        bitstream_align(&bak);
+        if (bitstream_peek(&bak, 16) == 0xFFD1) {
             ff_dlog(s->avctx, "AVRn interlaced picture marker found\n");
-            s->gb = bak;
-            skip_bits(&s->gb, 16);
+            s->bc = bak;
+            bitstream_skip(&s->bc, 16);
             s->bottom_field ^= 1;
 
             goto next_field;
@@ -1199,9 +1300,9 @@ next_field:
 
 static int mjpeg_decode_dri(MJpegDecodeContext *s)
 {
-    if (get_bits(&s->gb, 16) != 4)
+    if (bitstream_read(&s->bc, 16) != 4)
         return AVERROR_INVALIDDATA;
-    s->restart_interval = get_bits(&s->gb, 16);
+    s->restart_interval = bitstream_read(&s->bc, 16);
     s->restart_count    = 0;
     av_log(s->avctx, AV_LOG_DEBUG, "restart interval: %d\n",
            s->restart_interval);
@@ -1213,13 +1314,13 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
 {
     int len, id, i;
 
-    len = get_bits(&s->gb, 16);
+    len = bitstream_read(&s->bc, 16);
     if (len < 5)
         return AVERROR_INVALIDDATA;
-    if (8 * len > get_bits_left(&s->gb))
+    if (8 * len > bitstream_bits_left(&s->bc))
         return AVERROR_INVALIDDATA;
 
-    id   = get_bits_long(&s->gb, 32);
+    id   = bitstream_read(&s->bc, 32);
     id   = av_be2ne32(id);
     len -= 6;
 
@@ -1238,7 +1339,7 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
             4bytes      field_size_less_padding
         */
         s->buggy_avid = 1;
-        i = get_bits(&s->gb, 8);
+        i = bitstream_read(&s->bc, 8);
         if (i == 2)
             s->bottom_field = 1;
         else if (i == 1)
@@ -1248,13 +1349,13 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
 
     if (id == AV_RL32("JFIF")) {
         int t_w, t_h, v1, v2;
-        skip_bits(&s->gb, 8); /* the trailing zero-byte */
-        v1 = get_bits(&s->gb, 8);
-        v2 = get_bits(&s->gb, 8);
-        skip_bits(&s->gb, 8);
+        bitstream_skip(&s->bc, 8); /* the trailing zero-byte */
+        v1 = bitstream_read(&s->bc, 8);
+        v2 = bitstream_read(&s->bc, 8);
+        bitstream_skip(&s->bc, 8);
 
-        s->avctx->sample_aspect_ratio.num = get_bits(&s->gb, 16);
-        s->avctx->sample_aspect_ratio.den = get_bits(&s->gb, 16);
+        s->avctx->sample_aspect_ratio.num = bitstream_read(&s->bc, 16);
+        s->avctx->sample_aspect_ratio.den = bitstream_read(&s->bc, 16);
         ff_set_sar(s->avctx, s->avctx->sample_aspect_ratio);
 
         if (s->avctx->debug & FF_DEBUG_PICT_INFO)
@@ -1264,8 +1365,8 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
                    s->avctx->sample_aspect_ratio.num,
                    s->avctx->sample_aspect_ratio.den);
 
-        t_w = get_bits(&s->gb, 8);
-        t_h = get_bits(&s->gb, 8);
+        t_w = bitstream_read(&s->bc, 8);
+        t_h = bitstream_read(&s->bc, 8);
         if (t_w && t_h) {
             /* skip thumbnail */
             if (len -10 - (t_w * t_h * 3) > 0)
@@ -1275,13 +1376,13 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
         goto out;
     }
 
-    if (id == AV_RL32("Adob") && (get_bits(&s->gb, 8) == 'e')) {
+    if (id == AV_RL32("Adob") && (bitstream_read(&s->bc, 8) == 'e')) {
         if (s->avctx->debug & FF_DEBUG_PICT_INFO)
             av_log(s->avctx, AV_LOG_INFO, "mjpeg: Adobe header found\n");
-        skip_bits(&s->gb, 16); /* version */
-        skip_bits(&s->gb, 16); /* flags0 */
-        skip_bits(&s->gb, 16); /* flags1 */
-        skip_bits(&s->gb,  8); /* transform */
+        bitstream_skip(&s->bc, 16); /* version */
+        bitstream_skip(&s->bc, 16); /* flags0 */
+        bitstream_skip(&s->bc, 16); /* flags1 */
+        bitstream_skip(&s->bc,  8); /* transform */
         len -= 7;
         goto out;
     }
@@ -1290,11 +1391,11 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
         if (s->avctx->debug & FF_DEBUG_PICT_INFO)
             av_log(s->avctx, AV_LOG_INFO,
                    "Pegasus lossless jpeg header found\n");
-        skip_bits(&s->gb, 16); /* version ? */
-        skip_bits(&s->gb, 16); /* unknown always 0? */
-        skip_bits(&s->gb, 16); /* unknown always 0? */
-        skip_bits(&s->gb, 16); /* unknown always 0? */
-        switch (get_bits(&s->gb, 8)) {
+        bitstream_skip(&s->bc, 16); /* version ? */
+        bitstream_skip(&s->bc, 16); /* unknown always 0? */
+        bitstream_skip(&s->bc, 16); /* unknown always 0? */
+        bitstream_skip(&s->bc, 16); /* unknown always 0? */
+        switch (bitstream_read(&s->bc, 8)) {
         case 1:
             s->rgb         = 1;
             s->pegasus_rct = 0;
@@ -1312,7 +1413,7 @@ static int mjpeg_decode_app(MJpegDecodeContext *s)
 
     /* Apple MJPEG-A */
     if ((s->start_code == APP1) && (len > (0x28 - 8))) {
-        id   = get_bits_long(&s->gb, 32);
+        id   = bitstream_read(&s->bc, 32);
         id   = av_be2ne32(id);
         len -= 4;
         /* Apple MJPEG-A */
@@ -1328,22 +1429,22 @@ out:
         av_log(s->avctx, AV_LOG_ERROR,
                "mjpeg: error, decode_app parser read over the end\n");
     while (--len > 0)
-        skip_bits(&s->gb, 8);
+        bitstream_skip(&s->bc, 8);
 
     return 0;
 }
 
 static int mjpeg_decode_com(MJpegDecodeContext *s)
 {
-    int len = get_bits(&s->gb, 16);
-    if (len >= 2 && 8 * len - 16 <= get_bits_left(&s->gb)) {
+    int len = bitstream_read(&s->bc, 16);
+    if (len >= 2 && 8 * len - 16 <= bitstream_bits_left(&s->bc)) {
         int i;
         char *cbuf = av_malloc(len - 1);
         if (!cbuf)
             return AVERROR(ENOMEM);
 
         for (i = 0; i < len - 2; i++)
-            cbuf[i] = get_bits(&s->gb, 8);
+            cbuf[i] = bitstream_read(&s->bc, 8);
         if (i > 0 && cbuf[i - 1] == '\n')
             cbuf[i - 1] = 0;
         else
@@ -1397,6 +1498,20 @@ found:
     return val;
 }
 
+/* remember where a restart interval starts for decoding them in parallel */
+static int add_restart_pos(MJpegDecodeContext *s, int pos)
+{
+    if (s->nb_restart_pos >= s->restart_pos_size / sizeof(*s->restart_pos)) {
+        int *tmp = av_fast_realloc(s->restart_pos, &s->restart_pos_size,
+                                   (s->nb_restart_pos + 1) * sizeof(*tmp));
+        if (!tmp)
+            return AVERROR(ENOMEM);
+        s->restart_pos = tmp;
+    }
+    s->restart_pos[s->nb_restart_pos++] = pos;
+    return 0;
+}
+
 int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                          const uint8_t **buf_ptr, const uint8_t *buf_end,
                          const uint8_t **unescaped_buf_ptr,
@@ -1414,6 +1529,7 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
         const uint8_t *src = *buf_ptr;
         uint8_t *dst = s->buffer;
 
+        s->nb_restart_pos = 0;
         while (src < buf_end) {
             uint8_t x = *(src++);
 
@@ -1423,9 +1539,12 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                     while (src < buf_end && x == 0xff)
                         x = *(src++);
 
-                    if (x >= 0xd0 && x <= 0xd7)
+                    if (x >= 0xd0 && x <= 0xd7) {
                         *(dst++) = x;
-                    else if (x)
+                        if (s->avctx->active_thread_type & FF_THREAD_SLICE &&
+                            add_restart_pos(s, dst - s->buffer) < 0)
+                            return AVERROR(ENOMEM);
+                    } else if (x)
                         break;
                 }
             }
@@ -1485,6 +1604,23 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
     return start_code;
 }
 
+/* check whether the rest of the image is only entropy coded data, so that
+ * the following frames do not depend on decoding it */
+static int mjpeg_headers_done(const uint8_t *buf_ptr, const uint8_t *buf_end)
+{
+    while ((buf_ptr = memchr(buf_ptr, 0xff, buf_end - buf_ptr)) &&
+           ++buf_ptr < buf_end) {
+        int code = *buf_ptr;
+
+        if (code == EOI)
+            break;
+        if (code >= 0xc0 && code < 0xff && code != SOS &&
+            (code < RST0 || code > RST7))
+            return 0;
+    }
+    return 1;
+}
+
 int ff_mjpeg_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
                           AVPacket *avpkt)
 {
@@ -1496,6 +1632,7 @@ int ff_mjpeg_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     const uint8_t *unescaped_buf_ptr;
     int unescaped_buf_size;
     int start_code;
+    int setup_finished = 0;
     int ret = 0;
 
     s->got_picture = 0; // picture from previous image can not be reused
@@ -1519,8 +1656,8 @@ int ff_mjpeg_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
         av_log(avctx, AV_LOG_DEBUG, "marker=%x avail_size_in_buf=%td\n",
                start_code, buf_end - buf_ptr);
 
-        ret = init_get_bits(&s->gb, unescaped_buf_ptr,
-                            unescaped_buf_size * 8);
+        ret = bitstream_init(&s->bc, unescaped_buf_ptr,
+                             unescaped_buf_size * 8);
         if (ret < 0)
             return ret;
 
@@ -1643,6 +1780,14 @@ eoi_parser:
                        "Can not process SOS before SOF, skipping\n");
                 break;
                 }
+            /* interlaced images switch fields at EOI, so the next thread
+             * has to wait for the whole image */
+            if (avctx->active_thread_type & FF_THREAD_FRAME &&
+                !setup_finished && !s->interlaced &&
+                mjpeg_headers_done(buf_ptr, buf_end)) {
+                ff_thread_finish_setup(avctx);
+                setup_finished = 1;
+            }
             if ((ret = ff_mjpeg_decode_sos(s, NULL, NULL)) < 0 &&
                 (avctx->err_recognition & AV_EF_EXPLODE))
                 return ret;
@@ -1672,10 +1817,10 @@ eoi_parser:
 
 not_the_end:
         /* eof process start code */
-        buf_ptr += (get_bits_count(&s->gb) + 7) / 8;
+        buf_ptr += (bitstream_tell(&s->bc) + 7) / 8;
         av_log(avctx, AV_LOG_DEBUG,
                "marker parser used %d bytes (%d bits)\n",
-               (get_bits_count(&s->gb) + 7) / 8, get_bits_count(&s->gb));
+               (bitstream_tell(&s->bc) + 7) / 8, bitstream_tell(&s->bc));
     }
     if (s->got_picture) {
         av_log(avctx, AV_LOG_WARNING, "EOI missing, emulating\n");
@@ -1702,6 +1847,8 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
         av_frame_unref(s->picture_ptr);
 
     av_free(s->buffer);
+    av_freep(&s->restart_pos);
+    av_freep(&s->slice_ret);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size = 0;
 
@@ -1716,6 +1863,75 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     return 0;
 }
 
+#if HAVE_THREADS
+static av_cold int mjpeg_decode_init_thread_copy(AVCodecContext *avctx)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+
+    /* the picture and the tables still belong to the first thread */
+    s->picture     = NULL;
+    s->picture_ptr = NULL;
+    memset(s->vlcs, 0, sizeof(s->vlcs));
+
+    return ff_mjpeg_decode_init(avctx);
+}
+
+static int mjpeg_decode_update_thread_context(AVCodecContext *dst,
+                                              const AVCodecContext *src)
+{
+    MJpegDecodeContext *s = dst->priv_data, *s1 = src->priv_data;
+    int class, index, ret;
+
+    if (dst == src)
+        return 0;
+
+    for (class = 0; class < 2; class++) {
+        for (index = 0; index < 4; index++) {
+            if (!memcmp(s->huffman_bits[class][index],
+                        s1->huffman_bits[class][index],
+                        sizeof(s->huffman_bits[class][index])) &&
+                !memcmp(s->huffman_vals[class][index],
+                        s1->huffman_vals[class][index],
+                        sizeof(s->huffman_vals[class][index])))
+                continue;
+            if ((ret = init_huffman_table(s, class, index,
+                                          s1->huffman_bits[class][index],
+                                          s1->huffman_vals[class][index])) < 0)
+                return ret;
+        }
+    }
+    memcpy(s->quant_matrixes, s1->quant_matrixes, sizeof(s->quant_matrixes));
+    memcpy(s->qscale,         s1->qscale,         sizeof(s->qscale));
+
+    s->width         = s1->width;
+    s->height        = s1->height;
+    s->bits          = s1->bits;
+    s->nb_components = s1->nb_components;
+    memcpy(s->h_count, s1->h_count, sizeof(s->h_count));
+    memcpy(s->v_count, s1->v_count, sizeof(s->v_count));
+
+    s->first_picture      = s1->first_picture;
+    s->interlaced         = s1->interlaced;
+    s->bottom_field       = s1->bottom_field;
+    s->interlace_polarity = s1->interlace_polarity;
+    s->restart_interval   = s1->restart_interval;
+    s->buggy_avid         = s1->buggy_avid;
+    s->cs_itu601          = s1->cs_itu601;
+    s->rgb                = s1->rgb;
+    s->rct                = s1->rct;
+    s->pegasus_rct        = s1->pegasus_rct;
+
+    s->maxval = s1->maxval;
+    s->near   = s1->near;
+    s->t1     = s1->t1;
+    s->t2     = s1->t2;
+    s->t3     = s1->t3;
+    s->reset  = s1->reset;
+
+    return 0;
+}
+#endif
+
 #define OFFSET(x) offsetof(MJpegDecodeContext, x)
 #define VD AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_DECODING_PARAM
 static const AVOption options[] = {
@@ -1740,7 +1956,10 @@ AVCodec ff_mjpeg_decoder = {
     .init           = ff_mjpeg_decode_init,
     .close          = ff_mjpeg_decode_end,
     .decode         = ff_mjpeg_decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(mjpeg_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(mjpeg_decode_update_thread_context),
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS |
+                      AV_CODEC_CAP_FRAME_THREADS,
     .priv_class     = &mjpegdec_class,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
@@ -33,17 +33,18 @@
 #include "libavutil/pixdesc.h"
 
 #include "avcodec.h"
+#include "bitstream.h"
 #include "blockdsp.h"
-#include "get_bits.h"
 #include "hpeldsp.h"
 #include "idctdsp.h"
+#include "vlc.h"
 
 #define MAX_COMPONENTS 4
 
 typedef struct MJpegDecodeContext {
     AVClass *class;
     AVCodecContext *avctx;
-    GetBitContext gb;
+    BitstreamContext bc;
 
     int start_code; /* current start code */
     int buffer_size;
@@ -51,6 +52,8 @@ typedef struct MJpegDecodeContext {
 
     int16_t quant_matrixes[4][64];
     VLC vlcs[3][4];
+    uint8_t huffman_bits[2][4][17];  ///< raw Huffman tables the VLCs are built from,
+    uint8_t huffman_vals[2][4][256]; ///< used to rebuild them in other frame threads
     int qscale[4];      ///< quantizer scale calculated from quant_matrixes
 
     int org_height;  /* size given at codec init */
@@ -102,6 +105,11 @@ typedef struct MJpegDecodeContext {
 
     int restart_interval;
     int restart_count;
+    int *restart_pos;               ///< offsets of the data following each RSTn in the unescaped scan
+    unsigned int restart_pos_size;
+    int nb_restart_pos;
+    int *slice_ret;                 ///< return values of the restart interval slice jobs
+    unsigned int slice_ret_size;
 
     int buggy_avid;
     int cs_itu601;
@@ -325,6 +325,14 @@ int ff_init_me(MpegEncContext *s){
     c->sub_flags= get_flags(c, 0, c->avctx->me_sub_cmp&FF_CMP_CHROMA);
     c->mb_flags = get_flags(c, 0, c->avctx->mb_cmp    &FF_CMP_CHROMA);
 
+    if (c->avctx->me_cmp == FF_CMP_SAD) {
+        c->me_cmp_x4[0] = s->mecc.sad_x4[0];
+        c->me_cmp_x4[1] = s->mecc.sad_x4[1];
+    } else {
+        c->me_cmp_x4[0] =
+        c->me_cmp_x4[1] = NULL;
+    }
+
 /*FIXME s->no_rounding b_type*/
     if (s->avctx->flags & AV_CODEC_FLAG_QPEL) {
         c->sub_motion_search= qpel_motion_search;
@@ -1081,6 +1089,171 @@ int ff_pre_estimate_p_frame_motion(MpegEncContext * s,
     return dmin;
 }
 
+static void hier_downscale(uint8_t *dst, int dst_stride,
+                           const uint8_t *src, int src_stride, int w, int h)
+{
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        const uint8_t *s0 = src + 2 * y * src_stride;
+        const uint8_t *s1 = s0 + src_stride;
+
+        for (x = 0; x < w; x++)
+            dst[x] = (s0[2 * x] + s0[2 * x + 1] +
+                      s1[2 * x] + s1[2 * x + 1] + 2) >> 2;
+        dst += dst_stride;
+    }
+}
+
+void ff_me_hier_build_pyramid(MpegEncContext *s, int start_mb_y, int end_mb_y)
+{
+    MotionEstContext * const c = &s->me;
+    int level;
+
+    for (level = 1; level <= c->hier_levels; level++) {
+        const int size   = 16 >> level;
+        const int stride = c->hier_stride[level];
+        const int offset = start_mb_y * size * stride;
+        const uint8_t *src, *ref;
+        int src_stride, ref_stride, src_offset, ref_offset;
+
+        if (level == 1) {
+            src        = s->new_picture.f->data[0];
+            ref        = s->last_picture.f->data[0];
+            src_stride = s->new_picture.f->linesize[0];
+            ref_stride = s->last_picture.f->linesize[0];
+        } else {
+            src        = c->hier_src[level - 1];
+            ref        = c->hier_ref[level - 1];
+            src_stride = ref_stride = c->hier_stride[level - 1];
+        }
+        src_offset = start_mb_y * 2 * size * src_stride;
+        ref_offset = start_mb_y * 2 * size * ref_stride;
+
+        hier_downscale(c->hier_src[level] + offset, stride,
+                       src + src_offset, src_stride,
+                       s->mb_width * size, (end_mb_y - start_mb_y) * size);
+        hier_downscale(c->hier_ref[level] + offset, stride,
+                       ref + ref_offset, ref_stride,
+                       s->mb_width * size, (end_mb_y - start_mb_y) * size);
+    }
+}
+
+static int hier_sad(MpegEncContext *s, uint8_t *src, uint8_t *ref,
+                    int stride, int size)
+{
+    int x, y, sad = 0;
+
+    if (size == 8)
+        return s->mecc.sad[1](NULL, src, ref, stride, 8);
+
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x++)
+            sad += FFABS(src[x] - ref[x]);
+        src += stride;
+        ref += stride;
+    }
+    return sad;
+}
+
+/**
+ * Search the square of the given radius around *mx, *my at one level of
+ * the pyramid, the vectors being in pixels of that level.
+ */
+static int hier_search(MpegEncContext *s, int level, int mb_x, int mb_y,
+                       int *mx, int *my, int dmin, int radius)
+{
+    MotionEstContext * const c = &s->me;
+    const int size   = 16 >> level;
+    const int stride = c->hier_stride[level];
+    const int x      = mb_x * size;
+    const int y      = mb_y * size;
+    /* keep the block inside the downscaled picture */
+    const int xmin   = FFMAX(-x, -(-c->xmin >> level));
+    const int ymin   = FFMAX(-y, -(-c->ymin >> level));
+    const int xmax   = FFMIN(s->mb_width  * size - size - x, c->xmax >> level);
+    const int ymax   = FFMIN(s->mb_height * size - size - y, c->ymax >> level);
+    uint8_t *src     = c->hier_src[level] + y * stride + x;
+    uint8_t *ref     = c->hier_ref[level] + y * stride + x;
+    const int cx     = av_clip(*mx, xmin, xmax);
+    const int cy     = av_clip(*my, ymin, ymax);
+    int dx, dy;
+
+    if (dmin == INT_MAX || cx != *mx || cy != *my) {
+        *mx  = cx;
+        *my  = cy;
+        dmin = hier_sad(s, src, ref + cy * stride + cx, stride, size);
+    }
+
+    for (dy = FFMAX(cy - radius, ymin); dy <= FFMIN(cy + radius, ymax); dy++) {
+        for (dx = FFMAX(cx - radius, xmin); dx <= FFMIN(cx + radius, xmax); dx++) {
+            int d;
+
+            if (dx == cx && dy == cy)
+                continue;
+            d = hier_sad(s, src, ref + dy * stride + dx, stride, size);
+            if (d < dmin) {
+                dmin = d;
+                *mx  = dx;
+                *my  = dy;
+            }
+        }
+    }
+    return dmin;
+}
+
+void ff_me_hier_estimate(MpegEncContext *s, int mb_x, int mb_y)
+{
+    MotionEstContext * const c = &s->me;
+    const int xy    = mb_y * s->mb_stride + mb_x;
+    const int shift = 1 + s->quarter_sample;
+    int level = c->hier_levels;
+    int cand[4][2], nb_cand = 0;
+    int mx = 0, my = 0, dmin = INT_MAX;
+    int i;
+
+    get_limits(s, 16 * mb_x, 16 * mb_y);
+
+    /* full-pel candidates: zero, the spatial neighbours already searched
+     * by this pass and the vector of the previous P-frame */
+    cand[nb_cand][0]   = 0;
+    cand[nb_cand++][1] = 0;
+    if (mb_x > 0) {
+        cand[nb_cand][0]   = c->hier_mv[xy - 1][0];
+        cand[nb_cand++][1] = c->hier_mv[xy - 1][1];
+    }
+    if (!s->first_slice_line) {
+        cand[nb_cand][0]   = c->hier_mv[xy - s->mb_stride][0];
+        cand[nb_cand++][1] = c->hier_mv[xy - s->mb_stride][1];
+    }
+    cand[nb_cand][0]   = s->p_mv_table[xy][0] >> shift;
+    cand[nb_cand++][1] = s->p_mv_table[xy][1] >> shift;
+
+    for (i = 0; i < nb_cand; i++) {
+        int cmx = cand[i][0] >> level;
+        int cmy = cand[i][1] >> level;
+        int d   = hier_search(s, level, mb_x, mb_y, &cmx, &cmy, INT_MAX, 0);
+
+        if (d < dmin) {
+            dmin = d;
+            mx   = cmx;
+            my   = cmy;
+        }
+    }
+
+    /* exhaustive search around the best candidate at the coarsest level,
+     * then refinement at each finer level */
+    dmin = hier_search(s, level, mb_x, mb_y, &mx, &my, dmin, 2);
+    for (level--; level > 0; level--) {
+        mx  *= 2;
+        my  *= 2;
+        dmin = hier_search(s, level, mb_x, mb_y, &mx, &my, INT_MAX, 1);
+    }
+
+    c->hier_mv[xy][0] = av_clip(2 * mx, c->xmin, c->xmax);
+    c->hier_mv[xy][1] = av_clip(2 * my, c->ymin, c->ymax);
+}
+
 static int estimate_motion_b(MpegEncContext *s, int mb_x, int mb_y,
                              int16_t (*mv_table)[2], int ref_index, int f_code)
 {
@@ -25,6 +25,7 @@
 
 #include "avcodec.h"
 #include "hpeldsp.h"
+#include "me_cmp.h"
 #include "qpeldsp.h"
 
 struct MpegEncContext;
@@ -32,6 +33,10 @@ struct MpegEncContext;
 #define MAX_MV 2048
 #define ME_MAP_SIZE 64
 
+/* radius of the full resolution search around the vector found by the
+ * hierarchical pre-pass */
+#define ME_HIER_REFINE_RADIUS 1
+
 #define FF_ME_ZERO 0
 #define FF_ME_EPZS 1
 #define FF_ME_XONE 2
@@ -91,6 +96,16 @@ typedef struct MotionEstContext {
                              int *mx_ptr, int *my_ptr, int dmin,
                              int src_index, int ref_index,
                              int size, int h);
+    me_cmp_x4_func me_cmp_x4[2];    /**< me_cmp of 4 full-pel candidates at once,
+                                     * for 16 and 8 pixel wide blocks, NULL
+                                     * if not available for the cmp function */
+
+    /* hierarchical pre-pass */
+    int hier_levels;                ///< number of downscaled levels, 0 if disabled
+    uint8_t *hier_src[3];           ///< downscaled luma of the current picture, by level
+    uint8_t *hier_ref[3];           ///< downscaled luma of the reference picture, by level
+    int hier_stride[3];
+    int16_t (*hier_mv)[2];          ///< full-pel vectors found by the pre-pass, per MB
 } MotionEstContext;
 
 static inline int ff_h263_round_chroma(int x)
@@ -111,6 +126,19 @@ void ff_estimate_b_frame_motion(struct MpegEncContext *s, int mb_x, int mb_y);
 int ff_pre_estimate_p_frame_motion(struct MpegEncContext *s,
                                    int mb_x, int mb_y);
 
+/**
+ * Downscale the luma of the current and reference pictures for the
+ * hierarchical pre-pass, for the given MB rows.
+ */
+void ff_me_hier_build_pyramid(struct MpegEncContext *s,
+                              int start_mb_y, int end_mb_y);
+
+/**
+ * Find a full-pel vector for a MB of a P-frame with a search over the
+ * downscaled pictures, used as a predictor by the full resolution search.
+ */
+void ff_me_hier_estimate(struct MpegEncContext *s, int mb_x, int mb_y);
+
 int ff_epzs_motion_search(struct MpegEncContext *s, int *mx_ptr, int *my_ptr,
                           int P[10][2], int src_index, int ref_index,
                           int16_t (*last_mv)[2], int ref_mv_scale, int size,
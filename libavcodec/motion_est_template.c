@@ -425,10 +425,14 @@ static av_always_inline int small_diamond_search(MpegEncContext * s, int *best,
     LOAD_COMMON
     LOAD_COMMON2
     unsigned map_generation = c->map_generation;
+    me_cmp_x4_func cmpf_x4 = NULL;
 
     cmpf        = s->mecc.me_cmp[size];
     chroma_cmpf = s->mecc.me_cmp[size + 1];
 
+    if (size < 2 && !(flags & (FLAG_CHROMA | FLAG_DIRECT)))
+        cmpf_x4 = c->me_cmp_x4[size];
+
     { /* ensure that the best point is in the MAP as h/qpel refinement needs it */
         const unsigned key = (best[1]<<ME_MAP_MV_BITS) + best[0] + map_generation;
         const int index= ((best[1]<<ME_MAP_SHIFT) + best[0])&(ME_MAP_SIZE-1);
@@ -445,6 +449,59 @@ static av_always_inline int small_diamond_search(MpegEncContext * s, int *best,
         const int y= best[1];
         next_dir=-1;
 
+        if (cmpf_x4) {
+            /* score the neighbours which are not in the map with one call,
+             * then update the best vector in the same order as below */
+            static const int8_t dir_mv[4][2] = {
+                { -1, 0 }, { 0, -1 }, { 1, 0 }, { 0, 1 }
+            };
+            uint8_t *const ref = c->ref[ref_index][0] + x + y * c->stride;
+            uint8_t *cand[4];
+            int scores[4], check[4], nb_check = 0, i;
+
+            check[0] = dir != 2 && x > xmin;
+            check[1] = dir != 3 && y > ymin;
+            check[2] = dir != 0 && x < xmax;
+            check[3] = dir != 1 && y < ymax;
+            for (i = 0; i < 4; i++) {
+                const int nx = x + dir_mv[i][0];
+                const int ny = y + dir_mv[i][1];
+                if (check[i])
+                    check[i] = map[((ny << ME_MAP_SHIFT) + nx) & (ME_MAP_SIZE - 1)] !=
+                               (ny << ME_MAP_MV_BITS) + nx + map_generation;
+                nb_check += check[i];
+                cand[i] = ref + dir_mv[i][0] + dir_mv[i][1] * c->stride;
+            }
+
+            if (nb_check > 1) {
+                for (i = 0; i < 4; i++)
+                    if (!check[i])
+                        cand[i] = ref;
+                cmpf_x4(c->src[src_index][0], cand, c->stride, h, scores);
+
+                for (i = 0; i < 4; i++) {
+                    const int nx = x + dir_mv[i][0];
+                    const int ny = y + dir_mv[i][1];
+                    const int index = ((ny << ME_MAP_SHIFT) + nx) & (ME_MAP_SIZE - 1);
+                    if (!check[i])
+                        continue;
+                    map[index]       = (ny << ME_MAP_MV_BITS) + nx + map_generation;
+                    score_map[index] = scores[i];
+                    d = scores[i] + (mv_penalty[(nx << shift) - pred_x] +
+                                     mv_penalty[(ny << shift) - pred_y]) * penalty_factor;
+                    if (d < dmin) {
+                        best[0]  = nx;
+                        best[1]  = ny;
+                        dmin     = d;
+                        next_dir = i;
+                    }
+                }
+                if (next_dir == -1)
+                    return dmin;
+                continue;
+            }
+        }
+
         if(dir!=2 && x>xmin) CHECK_MV_DIR(x-1, y  , 0)
         if(dir!=3 && y>ymin) CHECK_MV_DIR(x  , y-1, 1)
         if(dir!=0 && x<xmax) CHECK_MV_DIR(x+1, y  , 2)
@@ -900,6 +957,44 @@ static av_always_inline int epzs_motion_search_internal(MpegEncContext * s, int
         s->mpv_flags & FF_MPV_FLAG_MV0)
         dmin += (mv_penalty[pred_x] + mv_penalty[pred_y])*penalty_factor;
 
+    /* The hierarchical pre-pass has already searched a wide area on the
+     * downscaled pictures, so only its vector and the prediction are checked
+     * here, followed by a small window around the best of them, instead of
+     * the whole predictor set and the diamond search. */
+    if (c->hier_mv && !c->pre_pass && size == 0 && h == 16 &&
+        s->pict_type != AV_PICTURE_TYPE_B) {
+        const int xy = s->mb_x + s->mb_y * s->mb_stride;
+        int x, y, cx, cy;
+
+        if (!s->first_slice_line &&
+            dmin < ((h * h * s->avctx->mv0_threshold) >> 8) &&
+            (P_LEFT[0] | P_LEFT[1] | P_TOP[0] | P_TOP[1] |
+             P_TOPRIGHT[0] | P_TOPRIGHT[1]) == 0) {
+            *mx_ptr = 0;
+            *my_ptr = 0;
+            c->skip = 1;
+            return dmin;
+        }
+
+        CHECK_CLIPPED_MV(c->hier_mv[xy][0], c->hier_mv[xy][1])
+        if (s->first_slice_line)
+            CHECK_MV(P_LEFT[0] >> shift, P_LEFT[1] >> shift)
+        else
+            CHECK_MV(P_MEDIAN[0] >> shift, P_MEDIAN[1] >> shift)
+
+        cx = best[0];
+        cy = best[1];
+        for (y = FFMAX(cy - ME_HIER_REFINE_RADIUS, ymin);
+             y <= FFMIN(cy + ME_HIER_REFINE_RADIUS, ymax); y++)
+            for (x = FFMAX(cx - ME_HIER_REFINE_RADIUS, xmin);
+                 x <= FFMIN(cx + ME_HIER_REFINE_RADIUS, xmax); x++)
+                CHECK_MV(x, y)
+
+        *mx_ptr = best[0];
+        *my_ptr = best[1];
+        return dmin;
+    }
+
     /* first line */
     if (s->first_slice_line) {
         CHECK_MV(P_LEFT[0]>>shift, P_LEFT[1]>>shift)
@@ -239,7 +239,7 @@ int ff_mpeg1_find_frame_end(ParseContext *pc, const uint8_t *buf, int buf_size,
 
 #define MAX_INDEX (64 - 1)
 
-int ff_mpeg1_decode_block_intra(GetBitContext *gb,
+int ff_mpeg1_decode_block_intra(BitstreamContext *bc,
                                 const uint16_t *quant_matrix,
                                 uint8_t *const scantable, int last_dc[3],
                                 int16_t *block, int index, int qscale)
@@ -250,7 +250,7 @@ int ff_mpeg1_decode_block_intra(GetBitContext *gb,
     /* DC coefficient */
     component = index <= 3 ? 0 : index - 4 + 1;
 
-    diff = decode_dc(gb, component);
+    diff = decode_dc(bc, component);
     if (diff >= 0xffff)
         return AVERROR_INVALIDDATA;
 
@@ -260,63 +260,50 @@ int ff_mpeg1_decode_block_intra(GetBitContext *gb,
 
     block[0] = dc * quant_matrix[0];
 
-    {
-        OPEN_READER(re, gb);
-        /* now quantify & encode AC coefficients */
-        while (1) {
-            int level, run, j;
+    /* now quantify & encode AC coefficients */
+    while (1) {
+        int level, run, j;
 
-            UPDATE_CACHE(re, gb);
-            GET_RL_VLC(level, run, re, gb, rl->rl_vlc[0], TEX_VLC_BITS, 2, 0);
+        BITSTREAM_RL_VLC(level, run, bc, rl->rl_vlc[0], TEX_VLC_BITS, 2);
 
-            if (level == 127) {
+        if (level == 127) {
+            break;
+        } else if (level != 0) {
+            i += run;
+            if (i > MAX_INDEX)
                 break;
-            } else if (level != 0) {
-                i += run;
-                if (i > MAX_INDEX)
-                    break;
 
-                j = scantable[i];
+            j = scantable[i];
+            level = (level * qscale * quant_matrix[j]) >> 4;
+            level = (level - 1) | 1;
+            level = bitstream_apply_sign(bc, level);
+        } else {
+            /* escape */
+            run   = bitstream_read(bc, 6) + 1;
+            level = bitstream_read_signed(bc, 8);
+
+            if (level == -128)
+                level = bitstream_read(bc, 8) - 256;
+            else if (level == 0)
+                level = bitstream_read(bc, 8);
+
+            i += run;
+            if (i > MAX_INDEX)
+                break;
+
+            j = scantable[i];
+            if (level < 0) {
+                level = -level;
                 level = (level * qscale * quant_matrix[j]) >> 4;
                 level = (level - 1) | 1;
-                level = (level ^ SHOW_SBITS(re, gb, 1)) -
-                        SHOW_SBITS(re, gb, 1);
-                LAST_SKIP_BITS(re, gb, 1);
+                level = -level;
             } else {
-                /* escape */
-                run = SHOW_UBITS(re, gb, 6) + 1;
-                LAST_SKIP_BITS(re, gb, 6);
-                UPDATE_CACHE(re, gb);
-                level = SHOW_SBITS(re, gb, 8);
-                SKIP_BITS(re, gb, 8);
-
-                if (level == -128) {
-                    level = SHOW_UBITS(re, gb, 8) - 256;
-                    LAST_SKIP_BITS(re, gb, 8);
-                } else if (level == 0) {
-                    level = SHOW_UBITS(re, gb, 8);
-                    LAST_SKIP_BITS(re, gb, 8);
-                }
-
-                i += run;
-                if (i > MAX_INDEX)
-                    break;
-
-                j = scantable[i];
-                if (level < 0) {
-                    level = -level;
-                    level = (level * qscale * quant_matrix[j]) >> 4;
-                    level = (level - 1) | 1;
-                    level = -level;
-                } else {
-                    level = (level * qscale * quant_matrix[j]) >> 4;
-                    level = (level - 1) | 1;
-                }
+                level = (level * qscale * quant_matrix[j]) >> 4;
+                level = (level - 1) | 1;
             }
-
-            block[j] = level;
         }
-        CLOSE_READER(re, gb);
+
+        block[j] = level;
     }
 
     if (i > MAX_INDEX)
@@ -76,6 +76,19 @@ static int dct_quantize_trellis_c(MpegEncContext *s, int16_t *block, int n, int
 static uint8_t default_mv_penalty[MAX_FCODE + 1][MAX_MV * 2 + 1];
 static uint8_t default_fcode_tab[MAX_MV * 2 + 1];
 
+/* scale of the DCT coefficients for the trellis distortion, in 4.12 fixed
+ * point, for the DCTs which are not scaled */
+static const uint16_t unit_dct_scale[64] = {
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+    4096, 4096, 4096, 4096, 4096, 4096, 4096, 4096,
+};
+
 const AVOption ff_mpv_generic_options[] = {
     FF_MPV_COMMON_OPTS
     { NULL },
@@ -183,6 +196,26 @@ void ff_write_quant_matrix(PutBitContext *pb, uint16_t *matrix)
         put_bits(pb, 1, 0);
 }
 
+/**
+ * update the trellis dequantization matrices from the transmitted ones
+ */
+static void update_trellis_matrix(MpegEncContext *s)
+{
+    int i;
+
+    for (i = 0; i < 64; i++) {
+        int j = s->idsp.idct_permutation[i];
+
+        if (s->out_format == FMT_H263) {
+            s->trellis_matrix[0][i] =
+            s->trellis_matrix[1][i] = 1;
+        } else {
+            s->trellis_matrix[0][i] = s->intra_matrix[j];
+            s->trellis_matrix[1][i] = s->inter_matrix[j];
+        }
+    }
+}
+
 /**
  * init s->current_picture.qscale_table from s->lambda_table
  */
@@ -242,7 +275,7 @@ av_cold int ff_mpv_encode_init(AVCodecContext *avctx)
 {
     MpegEncContext *s = avctx->priv_data;
     AVCPBProperties *cpb_props;
-    int i, ret, format_supported;
+    int i, j, ret, format_supported;
 
     mpv_encode_defaults(s);
 
@@ -514,7 +547,17 @@ FF_ENABLE_DEPRECATION_WARNINGS
         return AVERROR(EINVAL);
     }
 
+    /* A frame-threaded encoder needs a constant quantizer, since the rate
+     * control state cannot be shared between the encoding threads. */
+    if (avctx->active_thread_type & FF_THREAD_FRAME && !s->fixed_qscale) {
+        av_log(avctx, AV_LOG_WARNING,
+               "Frame threading requires a fixed quantizer, using one thread\n");
+        avctx->active_thread_type = 0;
+        avctx->thread_count       = 1;
+    }
+
     if (s->avctx->thread_count > 1         &&
+        !(avctx->active_thread_type & FF_THREAD_FRAME) &&
         s->codec_id != AV_CODEC_ID_MPEG4      &&
         s->codec_id != AV_CODEC_ID_MPEG1VIDEO &&
         s->codec_id != AV_CODEC_ID_MPEG2VIDEO &&
@@ -524,7 +567,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
         return -1;
     }
 
-    if (s->avctx->thread_count < 1) {
+    if (s->avctx->thread_count < 1 &&
+        !(avctx->active_thread_type & FF_THREAD_FRAME)) {
         av_log(avctx, AV_LOG_ERROR,
                "automatic thread number detection not supported by codec,"
                "patch welcome\n");
@@ -768,6 +812,21 @@ FF_ENABLE_DEPRECATION_WARNINGS
                           2 * 64 * sizeof(uint16_t), fail);
     }
 
+    if (s->me_hier) {
+        s->me.hier_levels = s->me_hier;
+        FF_ALLOCZ_OR_GOTO(s->avctx, s->me.hier_mv,
+                          s->mb_stride * s->mb_height * sizeof(*s->me.hier_mv), fail);
+        for (i = 1; i <= s->me.hier_levels; i++) {
+            int size = 16 >> i;
+
+            s->me.hier_stride[i] = FFALIGN(s->mb_width * size, 16);
+            FF_ALLOCZ_OR_GOTO(s->avctx, s->me.hier_src[i],
+                              s->me.hier_stride[i] * s->mb_height * size, fail);
+            FF_ALLOCZ_OR_GOTO(s->avctx, s->me.hier_ref[i],
+                              s->me.hier_stride[i] * s->mb_height * size, fail);
+        }
+    }
+
     if (CONFIG_H263_ENCODER)
         ff_h263dsp_init(&s->h263dsp);
     if (!s->dct_quantize)
@@ -837,6 +896,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
         if (s->avctx->inter_matrix)
             s->inter_matrix[j] = s->avctx->inter_matrix[i];
     }
+    update_trellis_matrix(s);
 
     /* precompute matrix */
     /* for mjpeg, we do include qscale in the matrix */
@@ -875,6 +935,13 @@ FF_ENABLE_DEPRECATION_WARNINGS
             ret = av_frame_get_buffer(s->tmp_frames[i], 32);
             if (ret < 0)
                 return ret;
+
+            /* the trial encodes may read pictures which are not set yet,
+             * e.g. when there is no previous picture */
+            for (j = 0; j < 3; j++)
+                memset(s->tmp_frames[i]->data[j], 0,
+                       s->tmp_frames[i]->linesize[j] *
+                       AV_CEIL_RSHIFT(s->tmp_frames[i]->height, !!j));
         }
     }
 
@@ -921,6 +988,11 @@ av_cold int ff_mpv_encode_end(AVCodecContext *avctx)
     av_freep(&s->input_picture);
     av_freep(&s->reordered_input_picture);
     av_freep(&s->dct_offset);
+    av_freep(&s->me.hier_mv);
+    for (i = 1; i < FF_ARRAY_ELEMS(s->me.hier_src); i++) {
+        av_freep(&s->me.hier_src[i]);
+        av_freep(&s->me.hier_ref[i]);
+    }
 
     return 0;
 }
@@ -1172,13 +1244,68 @@ static int encode_frame(AVCodecContext *c, AVFrame *frame)
     return size;
 }
 
+/* one trial encode of estimate_best_b_count() */
+typedef struct BFrameTrial {
+    AVCodecContext *c;
+    AVFrame *frames[MAX_B_FRAMES + 2];
+    int b_count;
+    int max_b_frames;
+    int p_lambda;
+    int b_lambda;
+    int lambda2;
+    int64_t rd;
+} BFrameTrial;
+
+static int b_frame_trial(AVCodecContext *avctx, void *arg)
+{
+    BFrameTrial *t = arg;
+    AVCodecContext *c = t->c;
+    int i, out_size;
+
+    t->frames[0]->pict_type = AV_PICTURE_TYPE_I;
+    t->frames[0]->quality   = 1 * FF_QP2LAMBDA;
+
+    out_size = encode_frame(c, t->frames[0]);
+    if (out_size < 0)
+        return out_size;
+
+    //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
+
+    for (i = 0; i < t->max_b_frames + 1; i++) {
+        int is_p = i % (t->b_count + 1) == t->b_count || i == t->max_b_frames;
+
+        t->frames[i + 1]->pict_type = is_p ?
+                                      AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
+        t->frames[i + 1]->quality   = is_p ? t->p_lambda : t->b_lambda;
+
+        out_size = encode_frame(c, t->frames[i + 1]);
+        if (out_size < 0)
+            return out_size;
+
+        t->rd += (out_size * t->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    }
+
+    /* get the delayed frames */
+    out_size = encode_frame(c, NULL);
+    if (out_size < 0)
+        return out_size;
+    t->rd += (out_size * t->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+
+    t->rd += c->error[0] + c->error[1] + c->error[2];
+
+    return 0;
+}
+
 static int estimate_best_b_count(MpegEncContext *s)
 {
     const AVCodec *codec = avcodec_find_encoder(s->avctx->codec_id);
     const int scale = s->brd_scale;
     int width  = s->width  >> scale;
     int height = s->height >> scale;
-    int i, j, out_size, p_lambda, b_lambda, lambda2;
+    int i, j, p_lambda, b_lambda, lambda2;
+    BFrameTrial trials[MAX_B_FRAMES + 1] = { { 0 } };
+    int rets[MAX_B_FRAMES + 1];
+    int nb_trials = 0;
     int64_t best_rd  = INT64_MAX;
     int best_b_count = -1;
     int ret = 0;
@@ -1196,46 +1323,56 @@ static int estimate_best_b_count(MpegEncContext *s)
                FF_LAMBDA_SHIFT;
 
     for (i = 0; i < s->max_b_frames + 2; i++) {
-        Picture pre_input, *pre_input_ptr = i ? s->input_picture[i - 1] :
-                                                s->next_picture_ptr;
+        Picture *pre_input_ptr = i ? s->input_picture[i - 1] :
+                                     s->next_picture_ptr;
 
         if (pre_input_ptr && (!i || s->input_picture[i - 1])) {
-            pre_input = *pre_input_ptr;
-
-            if (!pre_input.shared && i) {
-                pre_input.f->data[0] += INPLACE_OFFSET;
-                pre_input.f->data[1] += INPLACE_OFFSET;
-                pre_input.f->data[2] += INPLACE_OFFSET;
+            /* offset a copy of the pointers, the picture itself is used
+             * for encoding later */
+            uint8_t *data[3] = { pre_input_ptr->f->data[0],
+                                 pre_input_ptr->f->data[1],
+                                 pre_input_ptr->f->data[2] };
+
+            if (!pre_input_ptr->shared && i) {
+                data[0] += INPLACE_OFFSET;
+                data[1] += INPLACE_OFFSET;
+                data[2] += INPLACE_OFFSET;
             }
 
             s->mpvencdsp.shrink[scale](s->tmp_frames[i]->data[0],
                                        s->tmp_frames[i]->linesize[0],
-                                       pre_input.f->data[0],
-                                       pre_input.f->linesize[0],
+                                       data[0],
+                                       pre_input_ptr->f->linesize[0],
                                        width, height);
             s->mpvencdsp.shrink[scale](s->tmp_frames[i]->data[1],
                                        s->tmp_frames[i]->linesize[1],
-                                       pre_input.f->data[1],
-                                       pre_input.f->linesize[1],
+                                       data[1],
+                                       pre_input_ptr->f->linesize[1],
                                        width >> 1, height >> 1);
             s->mpvencdsp.shrink[scale](s->tmp_frames[i]->data[2],
                                        s->tmp_frames[i]->linesize[2],
-                                       pre_input.f->data[2],
-                                       pre_input.f->linesize[2],
+                                       data[2],
+                                       pre_input_ptr->f->linesize[2],
                                        width >> 1, height >> 1);
         }
     }
 
+    /* Open the trial encoders here, avcodec_open2() must not be called
+     * concurrently. The trial encodes are independent, so they run as
+     * parallel jobs when slice threading is enabled. */
     for (j = 0; j < s->max_b_frames + 1; j++) {
+        BFrameTrial *t = &trials[nb_trials];
         AVCodecContext *c;
-        int64_t rd = 0;
 
         if (!s->input_picture[j])
             break;
 
-        c = avcodec_alloc_context3(NULL);
-        if (!c)
-            return AVERROR(ENOMEM);
+        c = t->c = avcodec_alloc_context3(NULL);
+        if (!c) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        nb_trials++;
 
         c->width        = width;
         c->height       = height;
@@ -1253,55 +1390,47 @@ static int estimate_best_b_count(MpegEncContext *s)
         if (ret < 0)
             goto fail;
 
-        s->tmp_frames[0]->pict_type = AV_PICTURE_TYPE_I;
-        s->tmp_frames[0]->quality   = 1 * FF_QP2LAMBDA;
-
-        out_size = encode_frame(c, s->tmp_frames[0]);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-
-        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
-
-        for (i = 0; i < s->max_b_frames + 1; i++) {
-            int is_p = i % (j + 1) == j || i == s->max_b_frames;
-
-            s->tmp_frames[i + 1]->pict_type = is_p ?
-                                     AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
-            s->tmp_frames[i + 1]->quality   = is_p ? p_lambda : b_lambda;
-
-            out_size = encode_frame(c, s->tmp_frames[i + 1]);
-            if (out_size < 0) {
-                ret = out_size;
+        /* each trial sets its own picture types on the shared pictures */
+        for (i = 0; i < s->max_b_frames + 2; i++) {
+            t->frames[i] = av_frame_alloc();
+            if (!t->frames[i]) {
+                ret = AVERROR(ENOMEM);
                 goto fail;
             }
-
-            rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
+            ret = av_frame_ref(t->frames[i], s->tmp_frames[i]);
+            if (ret < 0)
+                goto fail;
         }
 
-        /* get the delayed frames */
-        out_size = encode_frame(c, NULL);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-        rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
+        t->b_count      = j;
+        t->max_b_frames = s->max_b_frames;
+        t->p_lambda     = p_lambda;
+        t->b_lambda     = b_lambda;
+        t->lambda2      = lambda2;
+    }
 
-        rd += c->error[0] + c->error[1] + c->error[2];
+    s->avctx->execute(s->avctx, b_frame_trial, trials, rets, nb_trials,
+                      sizeof(*trials));
 
-        if (rd < best_rd) {
-            best_rd = rd;
+    for (j = 0; j < nb_trials; j++) {
+        if (rets[j] < 0) {
+            ret = rets[j];
+            goto fail;
+        }
+        if (trials[j].rd < best_rd) {
+            best_rd = trials[j].rd;
             best_b_count = j;
         }
+    }
 
 fail:
-        avcodec_free_context(&c);
-        if (ret < 0)
-            return ret;
+    for (j = 0; j < nb_trials; j++) {
+        avcodec_free_context(&trials[j].c);
+        for (i = 0; i < FF_ARRAY_ELEMS(trials[j].frames); i++)
+            av_frame_free(&trials[j].frames[i]);
     }
 
-    return best_b_count;
+    return ret < 0 ? ret : best_b_count;
 }
 
 static int select_input_picture(MpegEncContext *s)
@@ -2552,6 +2681,27 @@ static int pre_estimate_motion_thread(AVCodecContext *c, void *arg){
     return 0;
 }
 
+static int hier_pyramid_thread(AVCodecContext *c, void *arg){
+    MpegEncContext *s= *(void**)arg;
+
+    ff_me_hier_build_pyramid(s, s->start_mb_y, s->end_mb_y);
+
+    return 0;
+}
+
+static int hier_estimate_motion_thread(AVCodecContext *c, void *arg){
+    MpegEncContext *s= *(void**)arg;
+
+    s->first_slice_line=1;
+    for(s->mb_y= s->start_mb_y; s->mb_y < s->end_mb_y; s->mb_y++) {
+        for(s->mb_x=0; s->mb_x < s->mb_width; s->mb_x++)
+            ff_me_hier_estimate(s, s->mb_x, s->mb_y);
+        s->first_slice_line=0;
+    }
+
+    return 0;
+}
+
 static int estimate_motion_thread(AVCodecContext *c, void *arg){
     MpegEncContext *s= *(void**)arg;
 
@@ -3452,6 +3602,10 @@ static int encode_picture(MpegEncContext *s, int picture_number)
                 s->me_pre == 2) {
                 s->avctx->execute(s->avctx, pre_estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
             }
+            if (s->me.hier_levels) {
+                s->avctx->execute(s->avctx, hier_pyramid_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+                s->avctx->execute(s->avctx, hier_estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+            }
         }
 
         s->avctx->execute(s->avctx, estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
@@ -3555,6 +3709,7 @@ static int encode_picture(MpegEncContext *s, int picture_number)
         s->intra_matrix[0] = ff_mpeg2_dc_scale_table[s->intra_dc_precision][8];
         ff_convert_matrix(s, s->q_intra_matrix, s->q_intra_matrix16,
                        s->intra_matrix, s->intra_quant_bias, 8, 8, 1);
+        update_trellis_matrix(s);
         s->qscale= 8;
     }
 
@@ -3649,7 +3804,6 @@ static int dct_quantize_trellis_c(MpegEncContext *s,
     const uint8_t *scantable= s->intra_scantable.scantable;
     const uint8_t *perm_scantable= s->intra_scantable.permutated;
     int max=0;
-    unsigned int threshold1, threshold2;
     int bias=0;
     int run_tab[65];
     int level_tab[65];
@@ -3662,11 +3816,15 @@ static int dct_quantize_trellis_c(MpegEncContext *s,
     int last_i;
     int coeff[2][64];
     int coeff_count[64];
+    int dist[2][64];
     int qmul, qadd, start_i, last_non_zero, i, dc;
     const int esc_length= s->ac_esc_length;
     uint8_t * length;
     uint8_t * last_length;
     const int lambda= s->lambda2 >> (FF_LAMBDA_SHIFT - 6);
+    const uint16_t *matrix;
+    const uint16_t *dct_scale = s->fdsp.fdct == ff_fdct_ifast ? ff_inv_aanscales
+                                                              : unit_dct_scale;
 
     s->fdsp.fdct(block);
 
@@ -3692,60 +3850,30 @@ static int dct_quantize_trellis_c(MpegEncContext *s,
         /* note: block[0] is assumed to be positive */
         block[0] = (block[0] + (q >> 1)) / q;
         start_i = 1;
-        last_non_zero = 0;
         qmat = s->q_intra_matrix[qscale];
         if(s->mpeg_quant || s->out_format == FMT_MPEG1)
             bias= 1<<(QMAT_SHIFT-1);
         length     = s->intra_ac_vlc_length;
         last_length= s->intra_ac_vlc_last_length;
+        matrix     = s->trellis_matrix[0];
     } else {
         start_i = 0;
-        last_non_zero = -1;
         qmat = s->q_inter_matrix[qscale];
         length     = s->inter_ac_vlc_length;
         last_length= s->inter_ac_vlc_last_length;
+        matrix     = s->trellis_matrix[1];
     }
     last_i= start_i;
 
-    threshold1= (1<<QMAT_SHIFT) - bias - 1;
-    threshold2= (threshold1<<1);
-
-    for(i=63; i>=start_i; i--) {
-        const int j = scantable[i];
-        int level = block[j] * qmat[j];
-
-        if(((unsigned)(level+threshold1))>threshold2){
-            last_non_zero = i;
-            break;
-        }
-    }
-
-    for(i=start_i; i<=last_non_zero; i++) {
-        const int j = scantable[i];
-        int level = block[j] * qmat[j];
-
-//        if(   bias+level >= (1<<(QMAT_SHIFT - 3))
-//           || bias-level >= (1<<(QMAT_SHIFT - 3))){
-        if(((unsigned)(level+threshold1))>threshold2){
-            if(level>0){
-                level= (bias + level)>>QMAT_SHIFT;
-                coeff[0][i]= level;
-                coeff[1][i]= level-1;
-//                coeff[2][k]= level-2;
-            }else{
-                level= (bias - level)>>QMAT_SHIFT;
-                coeff[0][i]= -level;
-                coeff[1][i]= -level+1;
-//                coeff[2][k]= -level+2;
-            }
-            coeff_count[i]= FFMIN(level, 2);
-            assert(coeff_count[i]);
-            max |=level;
-        }else{
-            coeff[0][i]= (level>>31)|1;
-            coeff_count[i]= 1;
-        }
-    }
+    /* the candidates and their distortions are indexed in raster order,
+     * the quantized intra DC is kept out of them */
+    dc = block[0];
+    if (start_i)
+        block[0] = 0;
+    last_non_zero = s->mpvencdsp.trellis_levels(coeff, coeff_count, &max,
+                                                block, qmat, bias, QMAT_SHIFT,
+                                                scantable, start_i);
+    block[0] = dc;
 
     *overflow= s->max_qcoeff < max; //overflow might have happened
 
@@ -3754,42 +3882,35 @@ static int dct_quantize_trellis_c(MpegEncContext *s,
         return last_non_zero;
     }
 
+    if (s->out_format == FMT_H263)
+        s->mpvencdsp.trellis_distortion[0](dist, coeff[0], block, dct_scale,
+                                           matrix, qmul, qadd, 0,
+                                           scantable, start_i, last_non_zero);
+    else if (s->mb_intra)
+        s->mpvencdsp.trellis_distortion[1](dist, coeff[0], block, dct_scale,
+                                           matrix, qscale, 0, 3,
+                                           scantable, start_i, last_non_zero);
+    else
+        s->mpvencdsp.trellis_distortion[1](dist, coeff[0], block, dct_scale,
+                                           matrix, 2 * qscale, qscale, 4,
+                                           scantable, start_i, last_non_zero);
+
     score_tab[start_i]= 0;
     survivor[0]= start_i;
     survivor_count= 1;
 
     for(i=start_i; i<=last_non_zero; i++){
-        int level_index, j, zero_distortion;
-        int dct_coeff= FFABS(block[ scantable[i] ]);
+        const int k = scantable[i];
+        const int nb_levels = FFMAX(coeff_count[k], 1);
+        int level_index, j;
         int best_score=256*256*256*120;
 
-        if (s->fdsp.fdct == ff_fdct_ifast)
-            dct_coeff= (dct_coeff*ff_inv_aanscales[ scantable[i] ]) >> 12;
-        zero_distortion= dct_coeff*dct_coeff;
-
-        for(level_index=0; level_index < coeff_count[i]; level_index++){
-            int distortion;
-            int level= coeff[level_index][i];
-            const int alevel= FFABS(level);
-            int unquant_coeff;
+        for(level_index=0; level_index < nb_levels; level_index++){
+            int distortion= dist[level_index][k];
+            int level= coeff[level_index][k];
 
             assert(level);
 
-            if(s->out_format == FMT_H263){
-                unquant_coeff= alevel*qmul + qadd;
-            } else { // MPEG-1
-                j = s->idsp.idct_permutation[scantable[i]]; // FIXME: optimize
-                if(s->mb_intra){
-                        unquant_coeff = (int)(  alevel  * qscale * s->intra_matrix[j]) >> 3;
-                        unquant_coeff =   (unquant_coeff - 1) | 1;
-                }else{
-                        unquant_coeff = (((  alevel  << 1) + 1) * qscale * ((int) s->inter_matrix[j])) >> 4;
-                        unquant_coeff =   (unquant_coeff - 1) | 1;
-                }
-                unquant_coeff<<= 3;
-            }
-
-            distortion= (unquant_coeff - dct_coeff) * (unquant_coeff - dct_coeff) - zero_distortion;
             level+=64;
             if((level&(~127)) == 0){
                 for(j=survivor_count-1; j>=0; j--){
@@ -3892,7 +4013,7 @@ static int dct_quantize_trellis_c(MpegEncContext *s,
         int best_level= 0;
         int best_score= dc * dc;
 
-        for(i=0; i<coeff_count[0]; i++){
+        for(i=0; i<FFMAX(coeff_count[0], 1); i++){
             int level= coeff[i][0];
             int alevel= FFABS(level);
             int unquant_coeff, score, distortion;
@@ -22,6 +22,7 @@
 
 #include "config.h"
 #include "libavutil/attributes.h"
+#include "libavutil/common.h"
 #include "libavutil/imgutils.h"
 #include "avcodec.h"
 #include "me_cmp.h"
@@ -228,6 +229,93 @@ static void shrink88(uint8_t *dst, int dst_wrap,
     }
 }
 
+static int trellis_levels_c(int level[2][64], int count[64], int *max,
+                            const int16_t *block, const int *qmat,
+                            int bias, int shift,
+                            const uint8_t *scantable, int start)
+{
+    const unsigned threshold1 = (1 << shift) - bias - 1;
+    const unsigned threshold2 = threshold1 << 1;
+    int i, last;
+
+    *max = 0;
+
+    for (last = 63; last >= start; last--) {
+        const int j = scantable[last];
+
+        if ((unsigned)(block[j] * qmat[j] + threshold1) > threshold2)
+            break;
+    }
+
+    for (i = start; i <= last; i++) {
+        const int j = scantable[i];
+        int l       = block[j] * qmat[j];
+
+        if ((unsigned)(l + threshold1) > threshold2) {
+            int alevel = (bias + FFABS(l)) >> shift;
+            int sign   = (l >> 31) | 1;
+
+            level[0][j] = sign * alevel;
+            level[1][j] = sign * (alevel - 1);
+            count[j]    = FFMIN(alevel, 2);
+            *max       |= alevel;
+        } else {
+            level[0][j] = (l >> 31) | 1;
+            count[j]    = 0;
+        }
+    }
+    return last;
+}
+
+static av_always_inline
+void trellis_distortion(int dist[2][64], const int level[64],
+                        const int16_t *block, const uint16_t *dct_scale,
+                        const uint16_t *matrix, int mul, int add, int shift,
+                        const uint8_t *scantable, int start, int last,
+                        int odd)
+{
+    int i, k;
+
+    for (i = start; i <= last; i++) {
+        const int j      = scantable[i];
+        const int alevel = FFABS(level[j]);
+        int dct_coeff    = (FFABS(block[j]) * dct_scale[j]) >> 12;
+
+        for (k = 0; k < FFMIN(alevel, 2); k++) {
+            int unquant = ((alevel - k) * mul + add) * matrix[j] >> shift;
+
+            if (odd)
+                unquant = ((unquant - 1) | 1) << 3;
+            dist[k][j] = (unquant - dct_coeff) * (unquant - dct_coeff) -
+                         dct_coeff * dct_coeff;
+        }
+    }
+}
+
+static void trellis_distortion_c(int dist[2][64], const int level[64],
+                                 const int16_t *block,
+                                 const uint16_t *dct_scale,
+                                 const uint16_t *matrix,
+                                 int mul, int add, int shift,
+                                 const uint8_t *scantable,
+                                 int start, int last)
+{
+    trellis_distortion(dist, level, block, dct_scale, matrix,
+                       mul, add, shift, scantable, start, last, 0);
+}
+
+static void trellis_distortion_odd_c(int dist[2][64], const int level[64],
+                                     const int16_t *block,
+                                     const uint16_t *dct_scale,
+                                     const uint16_t *matrix,
+                                     int mul, int add, int shift,
+                                     const uint8_t *scantable,
+                                     int start, int last)
+{
+    trellis_distortion(dist, level, block, dct_scale, matrix,
+                       mul, add, shift, scantable, start, last, 1);
+}
+
 av_cold void ff_mpegvideoencdsp_init(MpegvideoEncDSPContext *c,
                                      AVCodecContext *avctx)
 {
@@ -244,6 +332,10 @@ av_cold void ff_mpegvideoencdsp_init(MpegvideoEncDSPContext *c,
 
     c->draw_edges = draw_edges_8_c;
 
+    c->trellis_levels        = trellis_levels_c;
+    c->trellis_distortion[0] = trellis_distortion_c;
+    c->trellis_distortion[1] = trellis_distortion_odd_c;
+
     if (ARCH_ARM)
         ff_mpegvideoencdsp_init_arm(c, avctx);
     if (ARCH_PPC)
@@ -42,6 +42,47 @@ typedef struct MpegvideoEncDSPContext {
 
     void (*draw_edges)(uint8_t *buf, int wrap, int width, int height,
                        int w, int h, int sides);
+
+    /**
+     * Compute the candidate levels of the trellis quantizer for the
+     * coefficients scantable[start..last] of a block, last being the last
+     * one outside of the dead zone: the rounded level and the level one step
+     * closer to zero. Implementations may compute the candidates of the
+     * other coefficients as well.
+     * @param level  candidates, level[1] is only meaningful if count is 2
+     * @param count  number of candidates, 0 for the coefficients in the dead
+     *               zone, which have the single candidate +-1 in level[0]
+     * @param max    set to the bitwise or of the absolute levels outside of
+     *               the dead zone
+     * @param block  coefficients, the ones before start in scan order must
+     *               be 0
+     * @param qmat   quantization multipliers with shift fractional bits
+     * @param bias   rounding bias of the quantization
+     * @return last, start - 1 if all the coefficients are in the dead zone
+     */
+    int (*trellis_levels)(int level[2][64], int count[64], int *max,
+                          const int16_t *block, const int *qmat,
+                          int bias, int shift,
+                          const uint8_t *scantable, int start);
+
+    /**
+     * Compute the change of distortion when each coefficient of a block is
+     * coded with its candidate levels instead of zero.
+     * The level l is dequantized as ((|l| * mul + add) * matrix[i]) >> shift,
+     * which [1] then makes odd and scales by 8 as in MPEG-1; the absolute
+     * DCT coefficients are scaled by dct_scale[i] / 4096.
+     * Only the coefficients scantable[start..last] are needed, and dist[1]
+     * only where |level| > 1; implementations may compute the others as well.
+     * @param level  the first candidate, the second one is a step closer to 0,
+     *               the ones before start in scan order may be uninitialized
+     */
+    void (*trellis_distortion[2])(int dist[2][64], const int level[64],
+                                  const int16_t *block,
+                                  const uint16_t *dct_scale,
+                                  const uint16_t *matrix,
+                                  int mul, int add, int shift,
+                                  const uint8_t *scantable,
+                                  int start, int last);
 } MpegvideoEncDSPContext;
 
 void ff_mpegvideoencdsp_init(MpegvideoEncDSPContext *c,
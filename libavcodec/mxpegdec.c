@@ -82,7 +82,7 @@ static int mxpeg_decode_app(MXpegDecodeContext *s,
     if (buf_size < 2)
         return 0;
     len = AV_RB16(buf_ptr);
-    skip_bits(&s->jpg.gb, 8*FFMIN(len,buf_size));
+    bitstream_skip(&s->jpg.bc, 8*FFMIN(len,buf_size));
 
     return 0;
 }
@@ -149,7 +149,7 @@ static int mxpeg_decode_com(MXpegDecodeContext *s,
     if (len > 14 && len <= buf_size && !strncmp(buf_ptr + 2, "MXM", 3)) {
         ret = mxpeg_decode_mxm(s, buf_ptr + 2, len - 2);
     }
-    skip_bits(&s->jpg.gb, 8*FFMIN(len,buf_size));
+    bitstream_skip(&s->jpg.bc, 8*FFMIN(len,buf_size));
 
     return ret;
 }
@@ -203,7 +203,7 @@ static int mxpeg_decode_frame(AVCodecContext *avctx,
         if (start_code < 0)
             goto the_end;
         {
-            init_get_bits(&jpg->gb, unescaped_buf_ptr, unescaped_buf_size*8);
+            bitstream_init(&jpg->bc, unescaped_buf_ptr, unescaped_buf_size*8);
 
             if (start_code >= APP0 && start_code <= APP15) {
                 mxpeg_decode_app(s, unescaped_buf_ptr, unescaped_buf_size);
@@ -310,7 +310,7 @@ static int mxpeg_decode_frame(AVCodecContext *avctx,
                 break;
             }
 
-            buf_ptr += (get_bits_count(&jpg->gb)+7) >> 3;
+            buf_ptr += (bitstream_tell(&jpg->bc)+7) >> 3;
         }
 
     }
@@ -192,6 +192,7 @@ int avcodec_copy_context(AVCodecContext *dest, const AVCodecContext *src)
     dest->rc_override     = NULL;
     dest->subtitle_header = NULL;
     dest->hw_frames_ctx   = NULL;
+    dest->thread_pool     = NULL;
 
 #define alloc_and_copy_or_fail(obj, size, pad) \
     if (src->obj && size > 0) { \
@@ -217,6 +218,12 @@ int avcodec_copy_context(AVCodecContext *dest, const AVCodecContext *src)
             goto fail;
     }
 
+    if (src->thread_pool) {
+        dest->thread_pool = av_buffer_ref(src->thread_pool);
+        if (!dest->thread_pool)
+            goto fail;
+    }
+
     return 0;
 
 fail:
@@ -226,6 +233,7 @@ fail:
     av_freep(&dest->inter_matrix);
     av_freep(&dest->extradata);
     av_buffer_unref(&dest->hw_frames_ctx);
+    av_buffer_unref(&dest->thread_pool);
     return AVERROR(ENOMEM);
 }
 #endif
@@ -419,6 +419,7 @@ static const AVOption avcodec_options[] = {
 {"side_data_only_packets", NULL, OFFSET(side_data_only_packets), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, 1, A|V|E },
 #endif
 {"apply_cropping", NULL, OFFSET(apply_cropping), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, 1, V | D },
+{"frame_cache_size", "maximum size of the unused frame buffers kept for reuse (0 = peak size in use)", OFFSET(frame_cache_size), AV_OPT_TYPE_INT64, {.i64 = 0 }, 0, INT64_MAX, V|A|E|D},
 {NULL},
 };
 
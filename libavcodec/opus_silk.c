@@ -27,6 +27,7 @@
 #include <stdint.h>
 
 #include "opus.h"
+#include "opusdsp.h"
 
 typedef struct SilkFrame {
     int coded;
@@ -43,6 +44,7 @@ typedef struct SilkFrame {
 
 struct SilkContext {
     AVCodecContext *avctx;
+    OpusDSPContext dsp;
     int output_channels;
 
     int midonly;
@@ -1430,14 +1432,8 @@ static void silk_decode_frame(SilkContext *s, OpusRangeCoder *rc,
         }
 
         /* LPC synthesis */
-        for (j = 0; j < s->sflength; j++) {
-            sum = resptr[j] * sf[i].gain;
-            for (k = 1; k <= order; k++)
-                sum += lpc_coeff[k - 1] * lpc[j - k];
-
-            lpc[j] = sum;
-            dst[j] = av_clipf(sum, -1.0f, 1.0f);
-        }
+        s->dsp.lpc_synthesis(dst, lpc, resptr, lpc_coeff, order, s->sflength,
+                             sf[i].gain);
     }
 
     frame->prev_voiced = voiced;
@@ -1589,6 +1585,8 @@ int ff_silk_init(AVCodecContext *avctx, SilkContext **ps, int output_channels)
     s->avctx           = avctx;
     s->output_channels = output_channels;
 
+    ff_opus_dsp_init(&s->dsp);
+
     ff_silk_flush(s);
 
     *ps = s;
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_OPUSDSP_H
+#define AVCODEC_OPUSDSP_H
+
+typedef struct OpusDSPContext {
+    /**
+     * Apply the CELT pitch pre-filter inverse with constant period and gains,
+     * in place.
+     *
+     * @param data   the samples to filter, data[-period - 2] to data[-1] are
+     *               read too
+     * @param period the pitch period, at least 15
+     * @param gains  the gains of the center, first and second taps
+     * @param len    number of samples, a multiple of 8
+     */
+    void (*postfilter)(float *data, int period, const float *gains, int len);
+
+    /**
+     * Apply the CELT deemphasis filter and scale the output to [-1, 1].
+     *
+     * @param len   number of samples, a multiple of 4
+     * @param coeff the filter state after the previous block
+     * @return the filter state after this block
+     */
+    float (*deemphasis)(float *out, const float *in, int len, float coeff);
+
+    /**
+     * Run the SILK LPC synthesis filter over one subframe.
+     *
+     * lpc[j] = gain * res[j] + sum(coeffs[k - 1] * lpc[j - k], k = 1..order)
+     * and dst[j] is lpc[j] clipped to [-1, 1].
+     *
+     * @param lpc    the unclipped filter output, lpc[-order] to lpc[-1] must
+     *               hold the previous outputs
+     * @param order  the filter order, 10 or 16
+     * @param len    number of samples, a multiple of 4
+     */
+    void (*lpc_synthesis)(float *dst, float *lpc, const float *res,
+                          const float *coeffs, int order, int len,
+                          float gain);
+
+    /**
+     * Multiply a vector by a constant, in place. Used to apply the band
+     * energies to the CELT normalized spectrum.
+     *
+     * @param X   the vector, with no alignment constraint
+     * @param len number of coefficients, at least 1
+     */
+    void (*scale)(float *X, int len, float gain);
+
+    /**
+     * Convert the decoded CELT pulses of a band to floats:
+     * X[i] = gain * iy[i].
+     *
+     * @param X   the output, with no alignment constraint
+     * @param len number of coefficients, at least 1
+     */
+    void (*normalize_residual)(float *X, const int *iy, int len, float gain);
+
+    /**
+     * Scale a CELT band in place to the norm gain:
+     * X[i] *= gain / sqrt(1e-15 + sum(X[j] * X[j])).
+     *
+     * @param X   the vector, with no alignment constraint
+     * @param len number of coefficients, at least 1
+     */
+    void (*renormalize)(float *X, int len, float gain);
+} OpusDSPContext;
+
+void ff_opus_dsp_init(OpusDSPContext *s);
+void ff_opus_dsp_init_x86(OpusDSPContext *s);
+
+#endif /* AVCODEC_OPUSDSP_H */
@@ -21,6 +21,7 @@
 
 #include "libavutil/avstring.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/stereo3d.h"
 
 #include "avcodec.h"
@@ -28,6 +29,7 @@
 #include "internal.h"
 #include "png.h"
 #include "pngdsp.h"
+#include "thread.h"
 
 /* TODO:
  * - add 2, 4 and 16 bit depth support
@@ -64,6 +66,14 @@ typedef struct PNGDecContext {
     int pass_row_size; /* decompress row size of the current pass */
     int y;
     z_stream zstream;
+
+    /* slice threading: one job inflates the rows into rows_buf while
+     * another one reconstructs them */
+    uint8_t *rows_buf;
+    unsigned int rows_buf_size;
+    int rows_stride;
+    uint32_t idat_length; ///< length of the first IDAT chunk
+    int idat_rows;        ///< number of rows the inflate job produced
 } PNGDecContext;
 
 /* Mask to determine which y pixels can be written in a pass */
@@ -405,6 +415,83 @@ static int png_decode_idat(PNGDecContext *s, int length)
     return 0;
 }
 
+/* inflate the IDAT chunk starting at the current position and all the
+ * following ones, each row into its own slot of rows_buf */
+static int png_inflate_rows(AVCodecContext *avctx)
+{
+    PNGDecContext *s = avctx->priv_data;
+    uint32_t length  = s->idat_length;
+    int ret, y = 0;
+
+    s->zstream.avail_out = s->crow_size;
+    s->zstream.next_out  = s->rows_buf + 15;
+    for (;;) {
+        s->zstream.avail_in = FFMIN(length, bytestream2_get_bytes_left(&s->gb));
+        s->zstream.next_in  = s->gb.buffer;
+        bytestream2_skip(&s->gb, length + 4); /* data and crc */
+
+        while (s->zstream.avail_in > 0) {
+            ret = inflate(&s->zstream, Z_PARTIAL_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                ret = AVERROR_INVALIDDATA;
+                goto end;
+            }
+            if (s->zstream.avail_out == 0) {
+                /* the slot after the last row takes any excess data */
+                if (y < s->height)
+                    ff_thread_report_slice_progress(avctx, 0, ++y);
+                s->zstream.avail_out = s->crow_size;
+                s->zstream.next_out  = s->rows_buf + 15 + y * s->rows_stride;
+            }
+            if (ret == Z_STREAM_END && s->zstream.avail_in > 0) {
+                av_log(avctx, AV_LOG_WARNING,
+                       "%d undecompressed bytes left in buffer\n", s->zstream.avail_in);
+                break;
+            }
+        }
+
+        /* the image data may be split over consecutive IDAT chunks */
+        if (bytestream2_get_bytes_left(&s->gb) < 8 ||
+            AV_RL32(s->gb.buffer + 4) != MKTAG('I', 'D', 'A', 'T'))
+            break;
+        length = bytestream2_get_be32(&s->gb);
+        if (length > 0x7fffffff) {
+            ret = AVERROR_INVALIDDATA;
+            goto end;
+        }
+        bytestream2_skip(&s->gb, 4);
+    }
+    ret = 0;
+end:
+    s->idat_rows = y;
+    if (y < s->height) {
+        /* let the reconstruction job run through the missing rows,
+         * the frame is rejected afterwards */
+        memset(s->rows_buf + 15 + y * s->rows_stride, 0,
+               (s->height - y) * s->rows_stride);
+        ff_thread_report_slice_progress(avctx, 0, s->height);
+    }
+    return ret;
+}
+
+static int png_decode_rows(AVCodecContext *avctx, void *arg,
+                           int job, int threadnr)
+{
+    PNGDecContext *s = avctx->priv_data;
+    int y;
+
+    if (!job)
+        return png_inflate_rows(avctx);
+
+    for (y = 0; y < s->height; y++) {
+        ff_thread_await_slice_progress(avctx, 0, y + 1);
+        s->crow_buf = s->rows_buf + 15 + y * s->rows_stride;
+        png_handle_row(s);
+    }
+    emms_c();
+    return 0;
+}
+
 static int decode_frame(AVCodecContext *avctx,
                         void *data, int *got_frame,
                         AVPacket *avpkt)
@@ -415,7 +502,7 @@ static int decode_frame(AVCodecContext *avctx,
     AVFrame *p             = data;
     uint8_t *crow_buf_base = NULL;
     uint32_t tag, length;
-    int ret;
+    int ret, threaded;
 
     /* check signature */
     if (buf_size < 8) {
@@ -483,6 +570,9 @@ static int decode_frame(AVCodecContext *avctx,
         case MKTAG('I', 'D', 'A', 'T'):
             if (!(s->state & PNG_IHDR))
                 goto fail;
+            /* inflate and filter reconstruction run in parallel */
+            threaded = avctx->active_thread_type & FF_THREAD_SLICE &&
+                       !s->interlace_type;
             if (!(s->state & PNG_IDAT)) {
                 /* init image info */
                 avctx->width  = s->width;
@@ -568,8 +658,34 @@ static int decode_frame(AVCodecContext *avctx,
                 s->crow_buf          = crow_buf_base + 15;
                 s->zstream.avail_out = s->crow_size;
                 s->zstream.next_out  = s->crow_buf;
+
+                if (threaded) {
+                    /* one more slot for the data after the last row,
+                     * crow_buf + 1 is 16-byte aligned in every slot */
+                    s->rows_stride = FFALIGN(s->crow_size, 16);
+                    av_fast_malloc(&s->rows_buf, &s->rows_buf_size,
+                                   (s->height + 1) * s->rows_stride + 16);
+                    if (!s->rows_buf)
+                        goto fail;
+                }
+            } else if (threaded) {
+                /* the consecutive IDAT chunks have all been decoded */
+                goto skip_tag;
             }
             s->state |= PNG_IDAT;
+            if (threaded) {
+                int job_ret[2];
+
+                s->idat_length = length;
+                if (ff_thread_init_slice_progress(avctx, 1) < 0)
+                    goto fail;
+                avctx->execute2(avctx, png_decode_rows, NULL, job_ret, 2);
+                if (job_ret[0] < 0)
+                    goto fail;
+                if (s->idat_rows < s->height)
+                    s->state &= ~PNG_ALLIMAGE;
+                break;
+            }
             if (png_decode_idat(s, length) < 0)
                 goto fail;
             bytestream2_skip(&s->gb, 4); /* crc */
@@ -694,6 +810,8 @@ static av_cold int png_dec_end(AVCodecContext *avctx)
     PNGDecContext *s = avctx->priv_data;
 
     av_frame_free(&s->prev);
+    av_freep(&s->rows_buf);
+    s->rows_buf_size = 0;
 
     return 0;
 }
@@ -707,6 +825,6 @@ AVCodec ff_png_decoder = {
     .init           = png_dec_init,
     .close          = png_dec_end,
     .decode         = decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1 /*| AV_CODEC_CAP_DRAW_HORIZ_BAND*/,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS /*| AV_CODEC_CAP_DRAW_HORIZ_BAND*/,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
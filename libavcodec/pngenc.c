@@ -25,6 +25,7 @@
 #include "avcodec.h"
 #include "bytestream.h"
 #include "huffyuvencdsp.h"
+#include "internal.h"
 #include "png.h"
 
 /* TODO:
@@ -35,6 +36,17 @@
 
 #define IOBUF_SIZE 4096
 
+/* the minimum height of the strips compressed by separate slice threads */
+#define MIN_STRIP_ROWS 16
+
+typedef struct PNGEncStrip {
+    uint8_t *buf;          ///< compressed rows of the strip
+    unsigned int buf_size;
+    int len;
+    uLong adler;           ///< Adler-32 of the filtered rows of the strip
+    int row_count;
+} PNGEncStrip;
+
 typedef struct PNGEncContext {
     AVClass *class;
     HuffYUVEncDSPContext hdsp;
@@ -47,6 +59,16 @@ typedef struct PNGEncContext {
 
     z_stream zstream;
     uint8_t buf[IOBUF_SIZE];
+
+    PNGEncStrip *strips;
+    int *strip_ret;
+    int nb_strips;
+
+    /* current frame parameters for the strip jobs */
+    int color_type;
+    int bits_per_pixel;
+    int row_size;
+    int compression_level;
 } PNGEncContext;
 
 static void png_get_interlaced_row(uint8_t *dst, int row_size,
@@ -125,7 +147,7 @@ static void png_filter_row(PNGEncContext *c, uint8_t *dst, int filter_type,
         memcpy(dst, src, size);
         break;
     case PNG_FILTER_VALUE_SUB:
-        c->hdsp.diff_bytes(dst, src, src - bpp, size);
+        c->hdsp.diff_bytes(dst + bpp, src + bpp, src, size - bpp);
         memcpy(dst, src, bpp);
         break;
     case PNG_FILTER_VALUE_UP:
@@ -233,13 +255,151 @@ static int png_write_row(PNGEncContext *s, const uint8_t *data, int size)
     return 0;
 }
 
+/* Compress a horizontal strip of the image into its own deflate stream which
+ * ends with a sync flush, so that the strips can be concatenated. Since the
+ * filters are applied to the unfiltered previous row, the rows the previous
+ * strip ends with can be filtered again and preset as the deflate dictionary,
+ * which keeps the compression close to the one of a single stream. */
+static int encode_strip(AVCodecContext *avctx, void *arg, int job, int threadnr)
+{
+    PNGEncContext *s   = avctx->priv_data;
+    PNGEncStrip *strip = &s->strips[job];
+    const AVFrame *p   = arg;
+    int row_size       = s->row_size;
+    int y_start        = avctx->height *  job      / s->nb_strips;
+    int y_end          = avctx->height * (job + 1) / s->nb_strips;
+    int y_dict         = FFMAX(y_start - (32768 + row_size) / (row_size + 1), 0);
+    int last           = job == s->nb_strips - 1;
+    uint8_t *crow_base = NULL;
+    uint8_t *rgba_buf  = NULL;
+    uint8_t *top_buf   = NULL;
+    uint8_t *dict      = NULL;
+    uint8_t *crow_buf, *ptr, *top, *crow;
+    z_stream zstream;
+    int y, ret, size;
+
+    strip->len       = 0;
+    strip->row_count = y_end - y_start;
+    strip->adler     = adler32(0, Z_NULL, 0);
+
+    /* only the first strip has the zlib header, the other ones are raw
+     * deflate data continuing the stream */
+    zstream.zalloc = ff_png_zalloc;
+    zstream.zfree  = ff_png_zfree;
+    zstream.opaque = NULL;
+    ret = deflateInit2(&zstream, s->compression_level,
+                       Z_DEFLATED, job ? -15 : 15, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK)
+        return AVERROR_UNKNOWN;
+
+    /* room for the sync flush and the checksum appended to the last strip */
+    size = deflateBound(&zstream, strip->row_count * (row_size + 1)) + 16;
+    av_fast_malloc(&strip->buf, &strip->buf_size, size + 4);
+    crow_base = av_malloc((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
+    if (!strip->buf || !crow_base)
+        goto fail_alloc;
+    crow_buf = crow_base + 15;
+    if (s->color_type == PNG_COLOR_TYPE_RGB_ALPHA) {
+        rgba_buf = av_malloc(row_size + 1);
+        top_buf  = av_malloc(row_size + 1);
+        if (!rgba_buf || !top_buf)
+            goto fail_alloc;
+    }
+    if (y_dict < y_start) {
+        dict = av_malloc((y_start - y_dict) * (row_size + 1));
+        if (!dict)
+            goto fail_alloc;
+    }
+
+    zstream.avail_out = size;
+    zstream.next_out  = strip->buf;
+    top = NULL;
+    for (y = FFMAX(y_dict - 1, 0); y < y_end; y++) {
+        ptr = p->data[0] + y * p->linesize[0];
+        if (s->color_type == PNG_COLOR_TYPE_RGB_ALPHA) {
+            FFSWAP(uint8_t *, rgba_buf, top_buf);
+            convert_from_rgb32(rgba_buf, ptr, avctx->width);
+            ptr = rgba_buf;
+        }
+        if (y >= y_dict) {
+            crow = png_choose_filter(s, crow_buf, ptr, top,
+                                     row_size, s->bits_per_pixel >> 3);
+            if (y < y_start) {
+                memcpy(dict + (y - y_dict) * (row_size + 1), crow, row_size + 1);
+            } else {
+                if (y == y_start && dict &&
+                    deflateSetDictionary(&zstream, dict,
+                                         (y_start - y_dict) * (row_size + 1)) != Z_OK)
+                    goto fail;
+                strip->adler = adler32(strip->adler, crow, row_size + 1);
+
+                zstream.avail_in = row_size + 1;
+                zstream.next_in  = crow;
+                if (deflate(&zstream, Z_NO_FLUSH) != Z_OK || zstream.avail_in)
+                    goto fail;
+            }
+        }
+        top = ptr;
+    }
+
+    ret = deflate(&zstream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (ret != (last ? Z_STREAM_END : Z_OK) || !zstream.avail_out)
+        goto fail;
+    strip->len = size - zstream.avail_out;
+    ret        = 0;
+
+end:
+    av_free(crow_base);
+    av_free(rgba_buf);
+    av_free(top_buf);
+    av_free(dict);
+    deflateEnd(&zstream);
+    return ret;
+fail:
+    ret = AVERROR_UNKNOWN;
+    goto end;
+fail_alloc:
+    ret = AVERROR(ENOMEM);
+    goto end;
+}
+
+static int png_write_strips(AVCodecContext *avctx, const AVFrame *p)
+{
+    PNGEncContext *s = avctx->priv_data;
+    PNGEncStrip *last = &s->strips[s->nb_strips - 1];
+    uLong adler;
+    int i;
+
+    avctx->execute2(avctx, encode_strip, (void *)p, s->strip_ret, s->nb_strips);
+
+    for (i = 0; i < s->nb_strips; i++)
+        if (s->strip_ret[i] < 0)
+            return s->strip_ret[i];
+
+    /* the zlib trailer holds the checksum of all the strips */
+    adler = s->strips[0].adler;
+    for (i = 1; i < s->nb_strips; i++)
+        adler = adler32_combine(adler, s->strips[i].adler,
+                                s->strips[i].row_count * (s->row_size + 1));
+    AV_WB32(last->buf + last->len, adler);
+    last->len += 4;
+
+    for (i = 0; i < s->nb_strips; i++) {
+        if (s->bytestream_end - s->bytestream < s->strips[i].len + 100)
+            return -1;
+        png_write_chunk(&s->bytestream, MKTAG('I', 'D', 'A', 'T'),
+                        s->strips[i].buf, s->strips[i].len);
+    }
+    return 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
     PNGEncContext *s       = avctx->priv_data;
     AVFrameSideData *side_data;
     const AVFrame *const p = pict;
-    int bit_depth, color_type, y, len, row_size, ret, is_progressive;
+    int bit_depth, color_type, y, len, row_size, ret, is_progressive, threaded;
     int bits_per_pixel, pass_row_size, enc_row_size, max_packet_size;
     int compression_level;
     uint8_t *ptr, *top, *crow_buf, *crow;
@@ -303,6 +463,16 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     max_packet_size = avctx->height * (enc_row_size +
                                        ((enc_row_size + IOBUF_SIZE - 1) / IOBUF_SIZE) * 12)
                       + AV_INPUT_BUFFER_MIN_SIZE;
+
+    /* the interlaced passes are compressed in a single stream */
+    threaded = s->nb_strips > 1 && !is_progressive;
+    if (threaded) {
+        s->color_type        = color_type;
+        s->bits_per_pixel    = bits_per_pixel;
+        s->row_size          = row_size;
+        s->compression_level = compression_level;
+        max_packet_size     += s->nb_strips * 32;
+    }
     if (!pkt->data &&
         (ret = av_new_packet(pkt, max_packet_size)) < 0) {
         av_log(avctx, AV_LOG_ERROR, "Could not allocate output packet of size %d.\n",
@@ -425,6 +595,9 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                     }
             }
         }
+    } else if (threaded) {
+        if (png_write_strips(avctx, p) < 0)
+            goto fail;
     } else {
         top = NULL;
         for (y = 0; y < avctx->height; y++) {
@@ -441,7 +614,7 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         }
     }
     /* compress last bytes */
-    for (;;) {
+    while (!threaded) {
         ret = deflate(&s->zstream, Z_FINISH);
         if (ret == Z_OK || ret == Z_STREAM_END) {
             len = IOBUF_SIZE - s->zstream.avail_out;
@@ -500,6 +673,29 @@ FF_ENABLE_DEPRECATION_WARNINGS
     if (avctx->pix_fmt == AV_PIX_FMT_MONOBLACK)
         s->filter_type = PNG_FILTER_VALUE_NONE;
 
+    if (avctx->active_thread_type & FF_THREAD_SLICE)
+        s->nb_strips = av_clip(avctx->height / MIN_STRIP_ROWS,
+                               1, avctx->thread_count);
+    if (s->nb_strips > 1) {
+        s->strips    = av_mallocz_array(s->nb_strips, sizeof(*s->strips));
+        s->strip_ret = av_malloc_array(s->nb_strips, sizeof(*s->strip_ret));
+        if (!s->strips || !s->strip_ret)
+            return AVERROR(ENOMEM);
+    }
+
+    return 0;
+}
+
+static av_cold int png_enc_close(AVCodecContext *avctx)
+{
+    PNGEncContext *s = avctx->priv_data;
+    int i;
+
+    for (i = 0; i < s->nb_strips && s->strips; i++)
+        av_freep(&s->strips[i].buf);
+    av_freep(&s->strips);
+    av_freep(&s->strip_ret);
+
     return 0;
 }
 
@@ -531,7 +727,10 @@ AVCodec ff_png_encoder = {
     .priv_data_size = sizeof(PNGEncContext),
     .priv_class     = &png_class,
     .init           = png_enc_init,
+    .close          = png_enc_close,
     .encode2        = encode_frame,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_RGB32, AV_PIX_FMT_PAL8, AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_RGBA64BE, AV_PIX_FMT_RGB48BE, AV_PIX_FMT_GRAY16BE,
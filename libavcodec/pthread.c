@@ -29,6 +29,9 @@
  * @see doc/multithreading.txt
  */
 
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+
 #include "avcodec.h"
 #include "internal.h"
 #include "pthread_internal.h"
@@ -40,6 +43,9 @@
  * Threading requires more than one thread.
  * Frame threading requires entire frames to be passed to the codec,
  * and introduces extra decoding delay, so is incompatible with low_delay.
+ * Frame-threaded encoders additionally cannot do two-pass encoding, and
+ * encoders supporting both only use frame threading when slice threading
+ * is not allowed by thread_type.
  *
  * @param avctx The context.
  */
@@ -49,6 +55,20 @@ static void validate_thread_parameters(AVCodecContext *avctx)
                                 && !(avctx->flags  & AV_CODEC_FLAG_TRUNCATED)
                                 && !(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY)
                                 && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
+
+    /* Two-pass statistics have to be gathered from the frames in order. */
+    if (av_codec_is_encoder(avctx->codec) &&
+        avctx->flags & (AV_CODEC_FLAG_PASS1 | AV_CODEC_FLAG_PASS2))
+        frame_threading_supported = 0;
+
+    /* Encoders that can also split a picture keep using slice threads unless
+     * frame threads are requested alone: slices speed up single-picture
+     * encodes too and add no delay. */
+    if (av_codec_is_encoder(avctx->codec) &&
+        avctx->codec->capabilities & AV_CODEC_CAP_SLICE_THREADS &&
+        avctx->thread_type & FF_THREAD_SLICE)
+        frame_threading_supported = 0;
+
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
     } else if (frame_threading_supported && (avctx->thread_type & FF_THREAD_FRAME)) {
@@ -73,15 +93,35 @@ int ff_thread_init(AVCodecContext *avctx)
 
     if (avctx->active_thread_type&FF_THREAD_SLICE)
         return ff_slice_thread_init(avctx);
-    else if (avctx->active_thread_type&FF_THREAD_FRAME)
+    else if (avctx->active_thread_type&FF_THREAD_FRAME &&
+             av_codec_is_decoder(avctx->codec))
         return ff_frame_thread_init(avctx);
 
+    /* Frame-threaded encoders are started by ff_frame_thread_encoder_init()
+     * once init() has been called on the user context. init() may size
+     * per-thread state by thread_count, so resolve it beforehand. */
+    if (avctx->active_thread_type & FF_THREAD_FRAME) {
+        if (!avctx->thread_count) {
+            int nb_cpus = av_cpu_count();
+            av_log(avctx, AV_LOG_DEBUG, "detected %d logical cores\n", nb_cpus);
+            // use number of cores + 1 as thread count if there is more than one
+            if (nb_cpus > 1)
+                avctx->thread_count = FFMIN(nb_cpus + 1, MAX_AUTO_THREADS);
+            else
+                avctx->thread_count = 1;
+        }
+        if (avctx->thread_count <= 1)
+            avctx->active_thread_type = 0;
+    }
+
     return 0;
 }
 
 void ff_thread_free(AVCodecContext *avctx)
 {
-    if (avctx->active_thread_type&FF_THREAD_FRAME)
+    if (avctx->active_thread_type&FF_THREAD_FRAME && av_codec_is_encoder(avctx->codec))
+        ff_frame_thread_encoder_free(avctx, avctx->thread_count);
+    else if (avctx->active_thread_type&FF_THREAD_FRAME)
         ff_frame_thread_free(avctx, avctx->thread_count);
     else
         ff_slice_thread_free(avctx);
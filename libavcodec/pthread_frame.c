@@ -48,6 +48,7 @@
 #include "libavutil/internal.h"
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
+#include "libavutil/trace.h"
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -141,6 +142,7 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
     PerThreadContext *p = arg;
     AVCodecContext *avctx = p->avctx;
     const AVCodec *codec = avctx->codec;
+    int frame_number;
 
     while (1) {
         if (atomic_load(&p->state) == STATE_INPUT_READY) {
@@ -177,7 +179,12 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
 
         av_frame_unref(p->frame);
         p->got_frame = 0;
+        frame_number = avctx->frame_number;
+        av_trace_begin(avctx, "frame_thread_decode", p->avpkt.stream_index,
+                       frame_number);
         p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
+        av_trace_end(avctx, "frame_thread_decode", p->avpkt.stream_index,
+                     frame_number);
 
         if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
             if (avctx->internal->allocate_progress)
@@ -0,0 +1,440 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Frame multithreading support functions for encoders
+ * @see doc/multithreading.txt
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#endif
+
+#include "avcodec.h"
+#include "internal.h"
+#include "pthread_internal.h"
+#include "thread.h"
+
+#include "libavutil/common.h"
+#include "libavutil/frame.h"
+#include "libavutil/internal.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/trace.h"
+
+enum {
+    ///< Set when the thread is awaiting a frame.
+    STATE_INPUT_READY,
+    ///< Set while the thread is encoding a frame.
+    STATE_ENCODING,
+    ///< Set when the packet is ready, until it has been returned to the user.
+    STATE_OUTPUT_READY,
+};
+
+/**
+ * Context used by encoding threads.
+ */
+typedef struct EncodeThreadContext {
+    pthread_t       thread;
+    int             thread_init;
+    pthread_cond_t  input_cond;     ///< Used to wait for a new frame from the main thread.
+    pthread_cond_t  output_cond;    ///< Used by the main thread to wait for packets to finish.
+    pthread_mutex_t mutex;          ///< Mutex used to protect state and die.
+
+    AVCodecContext *avctx;          ///< Context used to encode frames passed to this thread.
+    int             codec_init;     ///< Set when init() succeeded on avctx.
+
+    AVFrame  *frame;                ///< Input frame.
+    AVPacket  pkt;                  ///< Output packet.
+    int       got_packet;           ///< The output of got_packet_ptr from the last encode2() call.
+    int       result;               ///< The result of the last encode2() call.
+
+    int state;
+    int die;                        ///< Set when the thread should exit.
+} EncodeThreadContext;
+
+/**
+ * Context stored in the client AVCodecInternal thread_ctx.
+ */
+typedef struct FrameThreadEncContext {
+    EncodeThreadContext *threads;   ///< The contexts for each thread.
+
+    int next_encoding;              ///< The next context to submit a frame to.
+    int next_finished;              ///< The next context to return output from.
+    int nb_pending;                 ///< Number of frames whose packet has not been returned yet.
+} FrameThreadEncContext;
+
+static attribute_align_arg void *frame_encoder_thread(void *arg)
+{
+    EncodeThreadContext *p = arg;
+    AVCodecContext *avctx  = p->avctx;
+    int frame_number;
+
+    pthread_mutex_lock(&p->mutex);
+    while (1) {
+        while (p->state != STATE_ENCODING && !p->die)
+            pthread_cond_wait(&p->input_cond, &p->mutex);
+        if (p->die)
+            break;
+        pthread_mutex_unlock(&p->mutex);
+
+        p->got_packet = 0;
+        frame_number  = avctx->frame_number;
+        av_trace_begin(avctx, "frame_thread_encode", -1, frame_number);
+        p->result     = avctx->codec->encode2(avctx, &p->pkt, p->frame,
+                                              &p->got_packet);
+        av_trace_end(avctx, "frame_thread_encode", -1, frame_number);
+        /* Only encoders without delay are frame threaded, so the packet
+         * always belongs to the frame that was just submitted. */
+        if (p->result >= 0 && p->got_packet)
+            p->pkt.pts = p->pkt.dts = p->frame->pts;
+        else
+            av_packet_unref(&p->pkt);
+        av_frame_unref(p->frame);
+        emms_c();
+
+        pthread_mutex_lock(&p->mutex);
+        p->state = STATE_OUTPUT_READY;
+        pthread_cond_signal(&p->output_cond);
+    }
+    pthread_mutex_unlock(&p->mutex);
+
+    return NULL;
+}
+
+static int return_packet(AVCodecContext *avctx, EncodeThreadContext *p,
+                         AVPacket *avpkt)
+{
+    int ret;
+
+    if (!avpkt->data) {
+        av_packet_move_ref(avpkt, &p->pkt);
+        return 0;
+    }
+
+    /* the caller supplied its own buffer */
+    if (avpkt->size < p->pkt.size) {
+        av_log(avctx, AV_LOG_ERROR, "User packet is too small (%d < %d)\n",
+               avpkt->size, p->pkt.size);
+        av_packet_unref(&p->pkt);
+        return AVERROR(EINVAL);
+    }
+
+    memcpy(avpkt->data, p->pkt.data, p->pkt.size);
+    avpkt->size = p->pkt.size;
+    ret = av_packet_copy_props(avpkt, &p->pkt);
+    av_packet_unref(&p->pkt);
+
+    return ret;
+}
+
+int ff_thread_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
+                           const AVFrame *frame, int *got_packet_ptr)
+{
+    FrameThreadEncContext *fctx = avctx->internal->thread_ctx;
+    EncodeThreadContext *p;
+    int ret;
+
+    *got_packet_ptr = 0;
+
+    /*
+     * Submit the frame to the next encoding thread. Its previous packet
+     * has always been returned at this point.
+     */
+
+    if (frame) {
+        p = &fctx->threads[fctx->next_encoding];
+
+        ret = av_frame_ref(p->frame, frame);
+        if (ret < 0)
+            return ret;
+        p->avctx->frame_number = avctx->frame_number;
+
+        pthread_mutex_lock(&p->mutex);
+        p->state = STATE_ENCODING;
+        pthread_cond_signal(&p->input_cond);
+        pthread_mutex_unlock(&p->mutex);
+
+        if (++fctx->next_encoding >= avctx->thread_count)
+            fctx->next_encoding = 0;
+
+        /* Don't return anything until every thread has a frame to work on. */
+        if (++fctx->nb_pending < avctx->thread_count)
+            return 0;
+    }
+
+    /*
+     * Return the packet of the oldest pending frame. When draining, skip
+     * over frames that produced no packet so we don't signal EOF too early.
+     */
+
+    while (fctx->nb_pending) {
+        p = &fctx->threads[fctx->next_finished];
+
+        pthread_mutex_lock(&p->mutex);
+        while (p->state != STATE_OUTPUT_READY)
+            pthread_cond_wait(&p->output_cond, &p->mutex);
+        p->state = STATE_INPUT_READY;
+        pthread_mutex_unlock(&p->mutex);
+
+        if (++fctx->next_finished >= avctx->thread_count)
+            fctx->next_finished = 0;
+        fctx->nb_pending--;
+
+        if (p->result < 0)
+            return p->result;
+
+        if (p->got_packet) {
+            ret = return_packet(avctx, p, avpkt);
+            if (ret < 0)
+                return ret;
+            *got_packet_ptr = 1;
+            return 0;
+        }
+
+        if (frame)
+            break;
+    }
+
+    return 0;
+}
+
+void ff_frame_thread_encoder_free(AVCodecContext *avctx, int thread_count)
+{
+    FrameThreadEncContext *fctx = avctx->internal->thread_ctx;
+    const AVCodec *codec = avctx->codec;
+    int i;
+
+    for (i = 0; i < thread_count; i++) {
+        EncodeThreadContext *p = &fctx->threads[i];
+
+        pthread_mutex_lock(&p->mutex);
+        p->die = 1;
+        pthread_cond_signal(&p->input_cond);
+        pthread_mutex_unlock(&p->mutex);
+
+        if (p->thread_init)
+            pthread_join(p->thread, NULL);
+    }
+
+    for (i = 0; i < thread_count; i++) {
+        EncodeThreadContext *p = &fctx->threads[i];
+        AVCodecContext *copy   = p->avctx;
+
+        if (copy) {
+            int j;
+
+            if (p->codec_init && codec->close)
+                codec->close(copy);
+
+            if (copy->priv_data && codec->priv_class)
+                av_opt_free(copy->priv_data);
+            av_freep(&copy->priv_data);
+            av_freep(&copy->extradata);
+
+            for (j = 0; j < copy->nb_coded_side_data; j++)
+                av_freep(&copy->coded_side_data[j].data);
+            av_freep(&copy->coded_side_data);
+
+#if FF_API_CODED_FRAME
+FF_DISABLE_DEPRECATION_WARNINGS
+            av_frame_free(&copy->coded_frame);
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+            av_buffer_unref(&copy->hw_frames_ctx);
+            av_buffer_unref(&copy->hw_device_ctx);
+
+            if (copy->internal) {
+                ff_frame_pool_free(&copy->internal->pool);
+                av_packet_free(&copy->internal->last_pkt_props);
+            }
+            av_freep(&copy->internal);
+            av_freep(&p->avctx);
+        }
+
+        av_packet_unref(&p->pkt);
+        av_frame_free(&p->frame);
+
+        pthread_mutex_destroy(&p->mutex);
+        pthread_cond_destroy(&p->input_cond);
+        pthread_cond_destroy(&p->output_cond);
+    }
+
+    av_freep(&fctx->threads);
+    av_freep(&avctx->internal->thread_ctx);
+}
+
+/**
+ * Create a context for an encoding thread, with the user-visible
+ * configuration of avctx but its own private and internal state.
+ */
+static int init_thread_copy(AVCodecContext *avctx, EncodeThreadContext *p)
+{
+    const AVCodec *codec = avctx->codec;
+    AVCodecContext *copy;
+    int err;
+
+    copy = p->avctx = av_malloc(sizeof(*copy));
+    if (!copy)
+        return AVERROR(ENOMEM);
+
+    *copy = *avctx;
+
+    /* buffers owned by the user context must not be shared */
+    copy->internal           = NULL;
+    copy->priv_data          = NULL;
+    copy->extradata          = NULL;
+    copy->extradata_size     = 0;
+    copy->stats_out          = NULL;
+    copy->coded_side_data    = NULL;
+    copy->nb_coded_side_data = 0;
+    copy->hw_frames_ctx      = NULL;
+    copy->hw_device_ctx      = NULL;
+    copy->thread_pool        = NULL;
+#if FF_API_CODED_FRAME
+FF_DISABLE_DEPRECATION_WARNINGS
+    copy->coded_frame        = NULL;
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+
+    copy->thread_count       = 1;
+    copy->active_thread_type = 0;
+    copy->execute            = avcodec_default_execute;
+    copy->execute2           = avcodec_default_execute2;
+
+    copy->internal = av_mallocz(sizeof(*copy->internal));
+    if (!copy->internal)
+        return AVERROR(ENOMEM);
+    copy->internal->thread_ctx = p;
+
+    /* needed by encoders which allocate their frames with ff_get_buffer() */
+    copy->internal->pool           = ff_frame_pool_alloc(avctx->frame_cache_size);
+    copy->internal->last_pkt_props = av_packet_alloc();
+    if (!copy->internal->pool || !copy->internal->last_pkt_props)
+        return AVERROR(ENOMEM);
+
+    if (codec->priv_data_size) {
+        copy->priv_data = av_mallocz(codec->priv_data_size);
+        if (!copy->priv_data)
+            return AVERROR(ENOMEM);
+        if (codec->priv_class) {
+            *(const AVClass **)copy->priv_data = codec->priv_class;
+            err = av_opt_copy(copy->priv_data, avctx->priv_data);
+            if (err < 0)
+                return err;
+        }
+    }
+
+#if FF_API_CODED_FRAME
+FF_DISABLE_DEPRECATION_WARNINGS
+    copy->coded_frame = av_frame_alloc();
+    if (!copy->coded_frame)
+        return AVERROR(ENOMEM);
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+
+    if (avctx->hw_frames_ctx) {
+        copy->hw_frames_ctx = av_buffer_ref(avctx->hw_frames_ctx);
+        if (!copy->hw_frames_ctx)
+            return AVERROR(ENOMEM);
+    }
+    if (avctx->hw_device_ctx) {
+        copy->hw_device_ctx = av_buffer_ref(avctx->hw_device_ctx);
+        if (!copy->hw_device_ctx)
+            return AVERROR(ENOMEM);
+    }
+
+    if (codec->init) {
+        err = codec->init(copy);
+        if (err < 0) {
+            if (codec->caps_internal & FF_CODEC_CAP_INIT_CLEANUP)
+                codec->close(copy);
+            return err;
+        }
+    }
+    p->codec_init = 1;
+
+    return 0;
+}
+
+int ff_frame_thread_encoder_init(AVCodecContext *avctx)
+{
+    int thread_count = avctx->thread_count;
+    FrameThreadEncContext *fctx;
+    int i, err = 0;
+
+#if HAVE_W32THREADS
+    w32thread_init();
+#endif
+
+    /* the thread count was resolved by ff_thread_init() */
+    if (thread_count <= 1) {
+        avctx->active_thread_type = 0;
+        return 0;
+    }
+
+    avctx->internal->thread_ctx = fctx = av_mallocz(sizeof(FrameThreadEncContext));
+    if (!fctx)
+        return AVERROR(ENOMEM);
+
+    fctx->threads = av_mallocz_array(thread_count, sizeof(EncodeThreadContext));
+    if (!fctx->threads) {
+        av_freep(&avctx->internal->thread_ctx);
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < thread_count; i++) {
+        EncodeThreadContext *p = &fctx->threads[i];
+
+        pthread_mutex_init(&p->mutex, NULL);
+        pthread_cond_init(&p->input_cond, NULL);
+        pthread_cond_init(&p->output_cond, NULL);
+
+        p->frame = av_frame_alloc();
+        if (!p->frame) {
+            err = AVERROR(ENOMEM);
+            goto error;
+        }
+
+        err = init_thread_copy(avctx, p);
+        if (err < 0)
+            goto error;
+
+        if (pthread_create(&p->thread, NULL, frame_encoder_thread, p)) {
+            err = AVERROR(ENOMEM);
+            goto error;
+        }
+        p->thread_init = 1;
+    }
+
+    return 0;
+
+error:
+    ff_frame_thread_encoder_free(avctx, i + 1);
+    avctx->active_thread_type = 0;
+
+    return err;
+}
@@ -31,4 +31,6 @@ void ff_slice_thread_free(AVCodecContext *avctx);
 int ff_frame_thread_init(AVCodecContext *avctx);
 void ff_frame_thread_free(AVCodecContext *avctx, int thread_count);
 
+void ff_frame_thread_encoder_free(AVCodecContext *avctx, int thread_count);
+
 #endif // AVCODEC_PTHREAD_INTERNAL_H
@@ -24,6 +24,8 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
+
 #if HAVE_PTHREADS
 #include <pthread.h>
 #elif HAVE_W32THREADS
@@ -38,6 +40,7 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
+#include "libavutil/threadpool.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -58,6 +61,15 @@ typedef struct SliceThreadContext {
     unsigned current_execute;
     int current_job;
     int done;
+
+    /**
+     * Progress counters used to synchronize jobs which depend on each other,
+     * see ff_thread_report_slice_progress().
+     */
+    atomic_int *progress;
+    int nb_progress;
+    pthread_cond_t progress_cond;
+    pthread_mutex_t progress_mutex;
 } SliceThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -101,17 +113,22 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     SliceThreadContext *c = avctx->internal->thread_ctx;
     int i;
 
-    pthread_mutex_lock(&c->current_job_lock);
-    c->done = 1;
-    pthread_cond_broadcast(&c->current_job_cond);
-    pthread_mutex_unlock(&c->current_job_lock);
+    if (c->workers) {
+        pthread_mutex_lock(&c->current_job_lock);
+        c->done = 1;
+        pthread_cond_broadcast(&c->current_job_cond);
+        pthread_mutex_unlock(&c->current_job_lock);
 
-    for (i=0; i<avctx->thread_count; i++)
-         pthread_join(c->workers[i], NULL);
+        for (i=0; i<avctx->thread_count; i++)
+             pthread_join(c->workers[i], NULL);
 
-    pthread_mutex_destroy(&c->current_job_lock);
-    pthread_cond_destroy(&c->current_job_cond);
-    pthread_cond_destroy(&c->last_job_cond);
+        pthread_mutex_destroy(&c->current_job_lock);
+        pthread_cond_destroy(&c->current_job_cond);
+        pthread_cond_destroy(&c->last_job_cond);
+    }
+    pthread_mutex_destroy(&c->progress_mutex);
+    pthread_cond_destroy(&c->progress_cond);
+    av_free(c->progress);
     av_free(c->workers);
     av_freep(&avctx->internal->thread_ctx);
 }
@@ -163,6 +180,60 @@ static int thread_execute2(AVCodecContext *avctx, action_func2* func2, void *arg
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
+/* the jobs of an execute() call on the shared thread pool */
+typedef struct PoolJobs {
+    AVCodecContext *avctx;
+    action_func *func;
+    action_func2 *func2;
+    void *args;
+    int *rets;
+    int job_size;
+} PoolJobs;
+
+static void pool_job(void *opaque, int job, int thread)
+{
+    PoolJobs *p = opaque;
+    int ret;
+
+    ret = p->func ? p->func(p->avctx, (char*)p->args + job*p->job_size):
+                    p->func2(p->avctx, p->args, job, thread);
+    if (p->rets)
+        p->rets[job] = ret;
+}
+
+static int pool_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
+{
+    PoolJobs p = {
+        .avctx    = avctx,
+        .func     = func,
+        .args     = arg,
+        .rets     = ret,
+        .job_size = job_size,
+    };
+
+    if (job_count <= 0)
+        return 0;
+
+    return av_thread_pool_execute(avctx->thread_pool, pool_job, &p,
+                                  job_count, avctx->thread_count);
+}
+
+static int pool_execute2(AVCodecContext *avctx, action_func2* func2, void *arg, int *ret, int job_count)
+{
+    PoolJobs p = {
+        .avctx = avctx,
+        .func2 = func2,
+        .args  = arg,
+        .rets  = ret,
+    };
+
+    if (job_count <= 0)
+        return 0;
+
+    return av_thread_pool_execute(avctx->thread_pool, pool_job, &p,
+                                  job_count, avctx->thread_count);
+}
+
 int ff_slice_thread_init(AVCodecContext *avctx)
 {
     int i;
@@ -192,6 +263,17 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     if (!c)
         return -1;
 
+    /* the jobs run on the workers of the shared pool */
+    if (avctx->thread_pool) {
+        avctx->internal->thread_ctx = c;
+        pthread_cond_init(&c->progress_cond, NULL);
+        pthread_mutex_init(&c->progress_mutex, NULL);
+
+        avctx->execute  = pool_execute;
+        avctx->execute2 = pool_execute2;
+        return 0;
+    }
+
     c->workers = av_mallocz(sizeof(pthread_t)*thread_count);
     if (!c->workers) {
         av_free(c);
@@ -206,6 +288,8 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     pthread_cond_init(&c->current_job_cond, NULL);
     pthread_cond_init(&c->last_job_cond, NULL);
     pthread_mutex_init(&c->current_job_lock, NULL);
+    pthread_cond_init(&c->progress_cond, NULL);
+    pthread_mutex_init(&c->progress_mutex, NULL);
     pthread_mutex_lock(&c->current_job_lock);
     for (i=0; i<thread_count; i++) {
         if(pthread_create(&c->workers[i], NULL, worker, avctx)) {
@@ -222,3 +306,56 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     avctx->execute2 = thread_execute2;
     return 0;
 }
+
+int ff_thread_init_slice_progress(AVCodecContext *avctx, int count)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+    int i;
+
+    if (!(avctx->active_thread_type & FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return 0;
+
+    if (count > c->nb_progress) {
+        av_freep(&c->progress);
+        c->nb_progress = 0;
+
+        c->progress = av_malloc_array(count, sizeof(*c->progress));
+        if (!c->progress)
+            return AVERROR(ENOMEM);
+        c->nb_progress = count;
+    }
+
+    for (i = 0; i < count; i++)
+        atomic_init(&c->progress[i], 0);
+
+    return 0;
+}
+
+void ff_thread_report_slice_progress(AVCodecContext *avctx, int idx, int n)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+
+    if (!(avctx->active_thread_type & FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return;
+
+    pthread_mutex_lock(&c->progress_mutex);
+    atomic_store_explicit(&c->progress[idx], n, memory_order_release);
+    pthread_cond_broadcast(&c->progress_cond);
+    pthread_mutex_unlock(&c->progress_mutex);
+}
+
+void ff_thread_await_slice_progress(AVCodecContext *avctx, int idx, int n)
+{
+    SliceThreadContext *c = avctx->internal->thread_ctx;
+
+    if (!(avctx->active_thread_type & FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return;
+
+    if (atomic_load_explicit(&c->progress[idx], memory_order_acquire) >= n)
+        return;
+
+    pthread_mutex_lock(&c->progress_mutex);
+    while (atomic_load_explicit(&c->progress[idx], memory_order_relaxed) < n)
+        pthread_cond_wait(&c->progress_cond, &c->progress_mutex);
+    pthread_mutex_unlock(&c->progress_mutex);
+}
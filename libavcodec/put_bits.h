@@ -32,11 +32,37 @@
 
 #include "libavutil/intreadwrite.h"
 
+#include "config.h"
+
+/*
+ * Files defining BITSTREAM_WRITER_64 before including this header get a
+ * writer that accumulates 64 bits before storing them, which halves the
+ * number of stores for encoders writing long runs of codes. The output is
+ * identical to the one of the 32-bit writer.
+ */
+#if defined(BITSTREAM_WRITER_64) && HAVE_FAST_64BIT
+typedef uint64_t BitBuf;
+#define BUF_BITS 64
+#define BIT_BUF  bit_buf64
+#define AV_WBBUF AV_WB64
+#define AV_WLBUF AV_WL64
+#else
+typedef uint32_t BitBuf;
+#define BUF_BITS 32
+#define BIT_BUF  bit_buf
+#define AV_WBBUF AV_WB32
+#define AV_WLBUF AV_WL32
+#endif
+
 typedef struct PutBitContext {
     uint32_t bit_buf;
     int bit_left;
     uint8_t *buf, *buf_ptr, *buf_end;
     int size_in_bits;
+    /* Accumulator of the 64-bit writer. It comes last so that the fields
+     * above keep the offsets expected by the avpriv_ functions, which are
+     * called from the other libraries and only know the 32-bit writer. */
+    uint64_t bit_buf64;
 } PutBitContext;
 
 /**
@@ -57,8 +83,8 @@ static inline void init_put_bits(PutBitContext *s, uint8_t *buffer,
     s->buf          = buffer;
     s->buf_end      = s->buf + buffer_size;
     s->buf_ptr      = s->buf;
-    s->bit_left     = 32;
-    s->bit_buf      = 0;
+    s->bit_left     = BUF_BITS;
+    s->BIT_BUF      = 0;
 }
 
 /**
@@ -66,7 +92,7 @@ static inline void init_put_bits(PutBitContext *s, uint8_t *buffer,
  */
 static inline int put_bits_count(PutBitContext *s)
 {
-    return (s->buf_ptr - s->buf) * 8 + 32 - s->bit_left;
+    return (s->buf_ptr - s->buf) * 8 + BUF_BITS - s->bit_left;
 }
 
 /**
@@ -74,7 +100,7 @@ static inline int put_bits_count(PutBitContext *s)
  */
 static inline int put_bits_left(PutBitContext* s)
 {
-    return (s->buf_end - s->buf_ptr) * 8 - 32 + s->bit_left;
+    return (s->buf_end - s->buf_ptr) * 8 - BUF_BITS + s->bit_left;
 }
 
 /**
@@ -82,26 +108,28 @@ static inline int put_bits_left(PutBitContext* s)
  */
 static inline void flush_put_bits(PutBitContext *s)
 {
+    BitBuf bit_buf = s->BIT_BUF;
+
 #ifndef BITSTREAM_WRITER_LE
-    if (s->bit_left < 32)
-        s->bit_buf <<= s->bit_left;
+    if (s->bit_left < BUF_BITS)
+        bit_buf <<= s->bit_left;
 #endif
-    while (s->bit_left < 32) {
+    while (s->bit_left < BUF_BITS) {
         /* XXX: should test end of buffer */
 #ifdef BITSTREAM_WRITER_LE
-        *s->buf_ptr++ = s->bit_buf;
-        s->bit_buf  >>= 8;
+        *s->buf_ptr++ = bit_buf;
+        bit_buf     >>= 8;
 #else
-        *s->buf_ptr++ = s->bit_buf >> 24;
-        s->bit_buf  <<= 8;
+        *s->buf_ptr++ = bit_buf >> (BUF_BITS - 8);
+        bit_buf     <<= 8;
 #endif
         s->bit_left  += 8;
     }
-    s->bit_left = 32;
-    s->bit_buf  = 0;
+    s->bit_left = BUF_BITS;
+    s->BIT_BUF  = 0;
 }
 
-#ifdef BITSTREAM_WRITER_LE
+#if defined(BITSTREAM_WRITER_LE) || BUF_BITS != 32
 #define avpriv_align_put_bits align_put_bits_unsupported_here
 #define avpriv_put_string ff_put_string_unsupported_here
 #define avpriv_copy_bits avpriv_copy_bits_unsupported_here
@@ -133,22 +161,22 @@ void avpriv_copy_bits(PutBitContext *pb, const uint8_t *src, int length);
  */
 static inline void put_bits(PutBitContext *s, int n, unsigned int value)
 {
-    unsigned int bit_buf;
+    BitBuf bit_buf;
     int bit_left;
 
     assert(n <= 31 && value < (1U << n));
 
-    bit_buf  = s->bit_buf;
+    bit_buf  = s->BIT_BUF;
     bit_left = s->bit_left;
 
     /* XXX: optimize */
 #ifdef BITSTREAM_WRITER_LE
-    bit_buf |= value << (32 - bit_left);
+    bit_buf |= (BitBuf)value << (BUF_BITS - bit_left);
     if (n >= bit_left) {
-        AV_WL32(s->buf_ptr, bit_buf);
-        s->buf_ptr += 4;
-        bit_buf     = (bit_left == 32) ? 0 : value >> bit_left;
-        bit_left   += 32;
+        AV_WLBUF(s->buf_ptr, bit_buf);
+        s->buf_ptr += sizeof(BitBuf);
+        bit_buf     = (bit_left == BUF_BITS) ? 0 : value >> bit_left;
+        bit_left   += BUF_BITS;
     }
     bit_left -= n;
 #else
@@ -158,14 +186,14 @@ static inline void put_bits(PutBitContext *s, int n, unsigned int value)
     } else {
         bit_buf   <<= bit_left;
         bit_buf    |= value >> (n - bit_left);
-        AV_WB32(s->buf_ptr, bit_buf);
-        s->buf_ptr += 4;
-        bit_left   += 32 - n;
+        AV_WBBUF(s->buf_ptr, bit_buf);
+        s->buf_ptr += sizeof(BitBuf);
+        bit_left   += BUF_BITS - n;
         bit_buf     = value;
     }
 #endif
 
-    s->bit_buf  = bit_buf;
+    s->BIT_BUF  = bit_buf;
     s->bit_left = bit_left;
 }
 
@@ -208,7 +236,7 @@ static inline uint8_t *put_bits_ptr(PutBitContext *s)
 static inline void skip_put_bytes(PutBitContext *s, int n)
 {
     assert((put_bits_count(s) & 7) == 0);
-    assert(s->bit_left == 32);
+    assert(s->bit_left == BUF_BITS);
     s->buf_ptr += n;
 }
 
@@ -220,8 +248,8 @@ static inline void skip_put_bytes(PutBitContext *s, int n)
 static inline void skip_put_bits(PutBitContext *s, int n)
 {
     s->bit_left -= n;
-    s->buf_ptr  -= 4 * (s->bit_left >> 5);
-    s->bit_left &= 31;
+    s->buf_ptr  -= (s->bit_left & ~(BUF_BITS - 1)) >> 3;
+    s->bit_left &= BUF_BITS - 1;
 }
 
 /**
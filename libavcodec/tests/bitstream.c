@@ -0,0 +1,260 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the BitstreamContext reader against the bits written by put_bits
+ * and against the GetBitContext reader. With -b the two readers are
+ * also timed on a VLC-heavy synthetic stream.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/avcodec.h"
+#include "libavcodec/bitstream.h"
+#include "libavcodec/get_bits.h"
+#include "libavcodec/put_bits.h"
+#include "libavcodec/vlc.h"
+
+#define COUNT  100000
+#define SIZE   (COUNT * 4 + AV_INPUT_BUFFER_PADDING_SIZE)
+
+#define VLC_BITS  7
+#define NB_CODES  16
+
+/* canonical prefix code, the codes longer than VLC_BITS need a subtable */
+static const uint8_t  vlc_lens[NB_CODES] = {
+    2, 2, 3, 4, 5, 6, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+};
+static const uint16_t vlc_codes[NB_CODES] = {
+    0x000, 0x001, 0x004, 0x00A, 0x016, 0x02E, 0x02F, 0x030,
+    0x062, 0x063, 0x0C8, 0x0C9, 0x194, 0x195, 0x32C, 0x32D,
+};
+
+static int sizes[COUNT];
+static int syms[COUNT];
+static int vals[COUNT];
+
+static void write_32(PutBitContext *pb, int n, uint32_t v)
+{
+    v &= n == 32 ? 0xFFFFFFFF : (1U << n) - 1;
+    if (n > 16) {
+        put_bits(pb, n - 16, v >> 16);
+        put_bits(pb, 16, v & 0xFFFF);
+    } else if (n) {
+        put_bits(pb, n, v);
+    }
+}
+
+static int check_read(const uint8_t *buf, int size)
+{
+    BitstreamContext bc;
+    GetBitContext gb;
+    int i, j;
+
+    bitstream_init8(&bc, buf, size);
+    init_get_bits8(&gb, buf, size);
+
+    for (i = 0; i < COUNT; i++) {
+        int n      = sizes[i];
+        uint32_t v = vals[i] & (n == 32 ? 0xFFFFFFFF : (1U << n) - 1);
+        uint32_t r;
+
+        switch (i % 5) {
+        case 0:
+            r = bitstream_read(&bc, n);
+            break;
+        case 1:
+            r = n ? bitstream_peek(&bc, n) : 0;
+            bitstream_skip(&bc, n);
+            break;
+        case 2:
+            r = n ? (uint32_t)bitstream_read_signed(&bc, n) &
+                    (n == 32 ? 0xFFFFFFFF : (1U << n) - 1) : 0;
+            break;
+        case 3:
+            r = (uint32_t)bitstream_read_63(&bc, n);
+            break;
+        default:
+            r = 0;
+            for (j = 0; j < n; j++)
+                r = r << 1 | bitstream_read_bit(&bc);
+            break;
+        }
+        if (r != v) {
+            fprintf(stderr, "read %d: %d bits, expected %08x, got %08x\n",
+                    i, n, v, r);
+            return 1;
+        }
+
+        skip_bits_long(&gb, n);
+        if (bitstream_tell(&bc) != get_bits_count(&gb)) {
+            fprintf(stderr, "read %d: position %d, expected %d\n",
+                    i, bitstream_tell(&bc), get_bits_count(&gb));
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int check_seek(const uint8_t *buf, int size, AVLFG *lfg)
+{
+    BitstreamContext bc;
+    GetBitContext gb;
+    int i;
+
+    bitstream_init8(&bc, buf, size);
+    init_get_bits8(&gb, buf, size);
+
+    for (i = 0; i < COUNT / 10; i++) {
+        int pos = av_lfg_get(lfg) % (size * 8 - 64);
+        int n   = av_lfg_get(lfg) % 25 + 1;
+        unsigned a, b;
+
+        bitstream_seek(&bc, pos);
+        skip_bits_long(&gb, pos - get_bits_count(&gb));
+
+        a = bitstream_read(&bc, n);
+        b = get_bits(&gb, n);
+        if (a != b) {
+            fprintf(stderr, "seek to %d: %d bits, expected %x, got %x\n",
+                    pos, n, b, a);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int check_vlc(const uint8_t *buf, int size, VLC *vlc)
+{
+    BitstreamContext bc;
+    int i;
+
+    bitstream_init8(&bc, buf, size);
+
+    for (i = 0; i < COUNT; i++) {
+        int s = bitstream_read_vlc(&bc, vlc->table, VLC_BITS, 2);
+        int v = bitstream_read(&bc, 5);
+
+        if (s != syms[i] || v != (vals[i] & 31)) {
+            fprintf(stderr, "vlc %d: expected %d/%d, got %d/%d\n",
+                    i, syms[i], vals[i] & 31, s, v);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void bench(const uint8_t *buf, int size, VLC *vlc)
+{
+    int64_t t0, t_get, t_bc;
+    unsigned sum_get = 0, sum_bc = 0;
+    int run, i;
+
+    t0 = av_gettime_relative();
+    for (run = 0; run < 100; run++) {
+        GetBitContext gb;
+
+        init_get_bits8(&gb, buf, size);
+        for (i = 0; i < COUNT; i++) {
+            sum_get += get_vlc2(&gb, vlc->table, VLC_BITS, 2);
+            sum_get += get_bits(&gb, 5);
+        }
+    }
+    t_get = av_gettime_relative() - t0;
+
+    t0 = av_gettime_relative();
+    for (run = 0; run < 100; run++) {
+        BitstreamContext bc;
+
+        bitstream_init8(&bc, buf, size);
+        for (i = 0; i < COUNT; i++) {
+            sum_bc += bitstream_read_vlc(&bc, vlc->table, VLC_BITS, 2);
+            sum_bc += bitstream_read(&bc, 5);
+        }
+    }
+    t_bc = av_gettime_relative() - t0;
+
+    printf("GetBitContext:    %6.2f ns/symbol (%u)\n",
+           t_get * 1000.0 / (100.0 * COUNT), sum_get);
+    printf("BitstreamContext: %6.2f ns/symbol (%u)\n",
+           t_bc  * 1000.0 / (100.0 * COUNT), sum_bc);
+}
+
+int main(int argc, char **argv)
+{
+    PutBitContext pb;
+    AVLFG lfg;
+    VLC vlc = { 0 };
+    uint8_t *buf;
+    int i, size, ret = 1;
+
+    buf = av_mallocz(SIZE);
+    if (!buf)
+        return 2;
+
+    av_lfg_init(&lfg, 1);
+
+    for (i = 0; i < COUNT; i++) {
+        sizes[i] = av_lfg_get(&lfg) % 33;
+        vals[i]  = av_lfg_get(&lfg);
+        syms[i]  = av_lfg_get(&lfg) % NB_CODES;
+    }
+
+    init_put_bits(&pb, buf, SIZE - AV_INPUT_BUFFER_PADDING_SIZE);
+    for (i = 0; i < COUNT; i++)
+        write_32(&pb, sizes[i], vals[i]);
+    flush_put_bits(&pb);
+    size = put_bits_count(&pb) + 7 >> 3;
+
+    if (check_read(buf, size) || check_seek(buf, size, &lfg))
+        goto end;
+
+    if (init_vlc(&vlc, VLC_BITS, NB_CODES, vlc_lens, 1, 1,
+                 vlc_codes, 2, 2, 0) < 0)
+        goto end;
+
+    memset(buf, 0, SIZE);
+    init_put_bits(&pb, buf, SIZE - AV_INPUT_BUFFER_PADDING_SIZE);
+    for (i = 0; i < COUNT; i++) {
+        put_bits(&pb, vlc_lens[syms[i]], vlc_codes[syms[i]]);
+        put_bits(&pb, 5, vals[i] & 31);
+    }
+    flush_put_bits(&pb);
+    size = put_bits_count(&pb) + 7 >> 3;
+
+    if (check_vlc(buf, size, &vlc))
+        goto end;
+
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+        bench(buf, size, &vlc);
+
+    ret = 0;
+end:
+    ff_free_vlc(&vlc);
+    av_free(buf);
+    return ret;
+}
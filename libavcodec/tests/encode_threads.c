@@ -0,0 +1,246 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Open intra-only encoders with automatic and explicit thread counts and
+ * check the threading method picked and that frame threading reproduces
+ * the single-threaded output, or that one thread is used when the options
+ * do not allow frame threading.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "libavutil/common.h"
+#include "libavutil/dict.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libavcodec/avcodec.h"
+
+#define WIDTH      128
+#define HEIGHT      64
+#define NB_FRAMES    6
+#define MAX_SIZE   (1 << 20)
+
+typedef struct TestCodec {
+    const char *name;
+    enum AVPixelFormat pix_fmt;
+    const char *options;
+    int serial;             ///< the options prevent frame threading
+} TestCodec;
+
+static const TestCodec codecs[] = {
+    { "prores",  AV_PIX_FMT_YUV422P10 },
+    { "png",     AV_PIX_FMT_RGB24     },
+    { "v210",    AV_PIX_FMT_YUV422P10 },
+    { "ffvhuff", AV_PIX_FMT_YUV420P, "context=1", 1 },
+};
+
+static uint8_t ref_data[NB_FRAMES][MAX_SIZE];
+static int     ref_size[NB_FRAMES];
+
+static void fill_frame(AVFrame *frame, int n)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    int p, x, y;
+
+    for (p = 0; p < 4 && frame->data[p]; p++) {
+        int w = p && p < 3 ? AV_CEIL_RSHIFT(WIDTH,  desc->log2_chroma_w) : WIDTH;
+        int h = p && p < 3 ? AV_CEIL_RSHIFT(HEIGHT, desc->log2_chroma_h) : HEIGHT;
+
+        if (desc->comp[0].depth > 8) {
+            for (y = 0; y < h; y++) {
+                uint16_t *line = (uint16_t *)(frame->data[p] + y * frame->linesize[p]);
+                for (x = 0; x < w; x++)
+                    line[x] = (x * 7 + y * 3 + n * 11 + p * 100) & 0x3FF;
+            }
+        } else {
+            for (y = 0; y < h; y++)
+                for (x = 0; x < frame->linesize[p]; x++)
+                    frame->data[p][y * frame->linesize[p] + x] = x * 5 + y * 3 + n * 7;
+        }
+    }
+}
+
+static int receive_packets(AVCodecContext *avctx, AVPacket *pkt, int *nb_out,
+                           int compare)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_packet(avctx, pkt)) >= 0) {
+        int n = *nb_out;
+
+        if (n >= NB_FRAMES || pkt->size > MAX_SIZE) {
+            av_packet_unref(pkt);
+            return AVERROR_BUG;
+        }
+        if (!compare) {
+            memcpy(ref_data[n], pkt->data, pkt->size);
+            ref_size[n] = pkt->size;
+        } else if (compare > 0 && (pkt->size != ref_size[n] ||
+                                   memcmp(pkt->data, ref_data[n], pkt->size))) {
+            fprintf(stderr, "packet %d differs from the single-threaded one\n", n);
+            av_packet_unref(pkt);
+            return AVERROR_BUG;
+        }
+        (*nb_out)++;
+        av_packet_unref(pkt);
+    }
+
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+/**
+ * Encode NB_FRAMES frames and return the threading method used.
+ *
+ * @param compare 0 to store the packets as reference, 1 to compare against
+ *                the reference, -1 to only check that all packets are output
+ */
+static int encode(const TestCodec *t, int thread_count, int thread_type,
+                  int compare)
+{
+    AVCodec *codec = avcodec_find_encoder_by_name(t->name);
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    AVPacket *pkt = av_packet_alloc();
+    AVDictionary *opts = NULL;
+    int i, nb_out = 0, ret = AVERROR(ENOMEM);
+
+    if (!avctx || !frame || !pkt)
+        goto end;
+
+    avctx->width        = WIDTH;
+    avctx->height       = HEIGHT;
+    avctx->pix_fmt      = t->pix_fmt;
+    avctx->time_base    = (AVRational){ 1, 25 };
+    avctx->thread_count = thread_count;
+    avctx->thread_type  = thread_type;
+
+    if (t->options) {
+        ret = av_dict_parse_string(&opts, t->options, "=", ":", 0);
+        if (ret < 0)
+            goto end;
+    }
+
+    ret = avcodec_open2(avctx, codec, &opts);
+    if (ret < 0) {
+        fprintf(stderr, "%s: cannot open the encoder with %d threads\n",
+                t->name, thread_count);
+        goto end;
+    }
+    if (avctx->thread_count <= 0) {
+        fprintf(stderr, "%s: thread count %d left unresolved\n",
+                t->name, avctx->thread_count);
+        ret = AVERROR_BUG;
+        goto end;
+    }
+
+    frame->format = avctx->pix_fmt;
+    frame->width  = WIDTH;
+    frame->height = HEIGHT;
+    ret = av_frame_get_buffer(frame, 32);
+    if (ret < 0)
+        goto end;
+
+    for (i = 0; i < NB_FRAMES; i++) {
+        ret = av_frame_make_writable(frame);
+        if (ret < 0)
+            goto end;
+        fill_frame(frame, i);
+        frame->pts = i;
+
+        ret = avcodec_send_frame(avctx, frame);
+        if (ret < 0)
+            goto end;
+        ret = receive_packets(avctx, pkt, &nb_out, compare);
+        if (ret < 0)
+            goto end;
+    }
+    ret = avcodec_send_frame(avctx, NULL);
+    if (ret >= 0)
+        ret = receive_packets(avctx, pkt, &nb_out, compare);
+    if (ret < 0)
+        goto end;
+
+    if (nb_out != NB_FRAMES) {
+        fprintf(stderr, "%s: %d packets for %d frames\n",
+                t->name, nb_out, NB_FRAMES);
+        ret = AVERROR_BUG;
+        goto end;
+    }
+
+    ret = avctx->active_thread_type;
+end:
+    av_dict_free(&opts);
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&avctx);
+    return ret;
+}
+
+int main(void)
+{
+    int i, type;
+
+    avcodec_register_all();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(codecs); i++) {
+        const TestCodec *t = &codecs[i];
+        const AVCodec *codec = avcodec_find_encoder_by_name(t->name);
+        int slice = !!(codec && codec->capabilities & AV_CODEC_CAP_SLICE_THREADS);
+        int frame = t->serial ? 0 : FF_THREAD_FRAME;
+
+        if (!codec)
+            continue;
+
+        if (encode(t, 1, FF_THREAD_FRAME | FF_THREAD_SLICE, 0) < 0)
+            return 1;
+
+        /* automatic thread count, the default of the command line tools */
+        type = encode(t, 0, FF_THREAD_FRAME | FF_THREAD_SLICE, slice ? -1 : 1);
+        if (type < 0)
+            return 1;
+
+        type = encode(t, 3, FF_THREAD_FRAME | FF_THREAD_SLICE, slice ? -1 : 1);
+        if (type < 0)
+            return 1;
+        if (HAVE_THREADS && type != (slice ? FF_THREAD_SLICE : frame)) {
+            fprintf(stderr, "%s: unexpected thread type %d\n", t->name, type);
+            return 1;
+        }
+
+        /* init() of the user context has to see the resolved count */
+        if (encode(t, 0, FF_THREAD_FRAME, 1) < 0)
+            return 1;
+
+        type = encode(t, 3, FF_THREAD_FRAME, 1);
+        if (type < 0)
+            return 1;
+        if (HAVE_THREADS && type != frame) {
+            fprintf(stderr, "%s: frame threading %s\n", t->name,
+                    frame ? "not used" : "used");
+            return 1;
+        }
+    }
+
+    return 0;
+}
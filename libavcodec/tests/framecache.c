@@ -0,0 +1,188 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the reuse and eviction of the frame buffer cache, directly and
+ * through the default get_buffer2() across frame size changes.
+ */
+
+#include <stdio.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libavcodec/avcodec.h"
+#include "libavcodec/framecache.h"
+#include "libavcodec/internal.h"
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s\n",                    \
+                    __FILE__, __LINE__, #cond);                             \
+            return 1;                                                       \
+        }                                                                   \
+    } while (0)
+
+static int test_cache_sizes(void)
+{
+    FrameBufferCache *cache = ff_frame_buffer_cache_alloc(0);
+    AVBufferRef *big, *small, *large;
+    uint8_t *big_data;
+    int i;
+
+    CHECK(cache);
+
+    /* a smaller request reuses the idle buffer of a larger one */
+    big = ff_frame_buffer_cache_get(cache, 1000);
+    CHECK(big);
+    big_data = big->data;
+    av_buffer_unref(&big);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 1024);
+
+    small = ff_frame_buffer_cache_get(cache, 600);
+    CHECK(small && small->data == big_data && small->size == 600);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 0);
+    av_buffer_unref(&small);
+
+    /* but not when the idle buffer is more than twice as large */
+    small = ff_frame_buffer_cache_get(cache, 400);
+    CHECK(small && small->data != big_data);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 1024);
+
+    /* idle memory is capped at the peak in use, the oldest buffers go first */
+    av_buffer_unref(&small);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 448);
+
+    /* a larger request allocates, the smaller buffer stays idle */
+    large = ff_frame_buffer_cache_get(cache, 2000);
+    CHECK(large && large->size == 2000);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 448);
+    av_buffer_unref(&large);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 2048);
+
+    /* idle buffers unused for FRAME_BUFFER_MAX_AGE requests are freed */
+    for (i = 0; i <= FRAME_BUFFER_MAX_AGE; i++) {
+        small = ff_frame_buffer_cache_get(cache, 16);
+        CHECK(small);
+        av_buffer_unref(&small);
+    }
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 16);
+
+    ff_frame_buffer_cache_free(&cache);
+    CHECK(!cache);
+    return 0;
+}
+
+static int test_cache_cap(void)
+{
+    FrameBufferCache *cache = ff_frame_buffer_cache_alloc(2500);
+    AVBufferRef *buf[3], *ref;
+    uint8_t *data[3];
+    int i;
+
+    CHECK(cache);
+
+    for (i = 0; i < 3; i++) {
+        buf[i] = ff_frame_buffer_cache_get(cache, 1024);
+        CHECK(buf[i]);
+        data[i] = buf[i]->data;
+    }
+    /* the least recently released buffer is evicted first */
+    for (i = 0; i < 3; i++)
+        av_buffer_unref(&buf[i]);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 2048);
+
+    ref = ff_frame_buffer_cache_get(cache, 1024);
+    CHECK(ref && ref->data == data[2]);
+    buf[0] = ff_frame_buffer_cache_get(cache, 1024);
+    CHECK(buf[0] && buf[0]->data == data[1]);
+    CHECK(ff_frame_buffer_cache_idle_size(cache) == 0);
+    av_buffer_unref(&buf[0]);
+
+    /* buffers in use keep the cache alive */
+    ff_frame_buffer_cache_free(&cache);
+    av_buffer_unref(&ref);
+    return 0;
+}
+
+static int get_frame(AVCodecContext *avctx, AVFrame *frame, int w, int h)
+{
+    frame->format = avctx->pix_fmt;
+    frame->width  = w;
+    frame->height = h;
+    return avcodec_default_get_buffer2(avctx, frame, 0);
+}
+
+static int is_plane(uint8_t * const planes[3], const uint8_t *data)
+{
+    return data == planes[0] || data == planes[1] || data == planes[2];
+}
+
+static int test_get_buffer(void)
+{
+    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_RAWVIDEO);
+    AVCodecContext *avctx;
+    AVFrame *frame;
+    uint8_t *planes[3];
+    int i;
+
+    if (!codec)
+        return 0;
+    avctx = avcodec_alloc_context3(codec);
+    frame = av_frame_alloc();
+    CHECK(avctx && frame);
+    avctx->width   = 640;
+    avctx->height  = 360;
+    avctx->pix_fmt = AV_PIX_FMT_YUV420P;
+    /* with a single frame in use the default cap would evict the larger
+     * buffers as soon as the smaller frame is released */
+    CHECK(av_opt_set_int(avctx, "frame_cache_size", 1 << 20, 0) >= 0);
+    CHECK(avcodec_open2(avctx, codec, NULL) >= 0);
+
+    CHECK(get_frame(avctx, frame, 640, 360) >= 0);
+    for (i = 0; i < 3; i++)
+        planes[i] = frame->buf[i]->data;
+    av_frame_unref(frame);
+
+    /* switching down puts the luma plane in a chroma buffer of the
+     * larger frame */
+    CHECK(get_frame(avctx, frame, 320, 180) >= 0);
+    CHECK(is_plane(planes, frame->buf[0]->data));
+    av_frame_unref(frame);
+
+    /* switching back up finds all the buffers of the larger frame */
+    CHECK(get_frame(avctx, frame, 640, 360) >= 0);
+    for (i = 0; i < 3; i++)
+        CHECK(is_plane(planes, frame->buf[i]->data));
+
+    /* the frame outlives the codec context */
+    avcodec_free_context(&avctx);
+    av_frame_free(&frame);
+    return 0;
+}
+
+int main(void)
+{
+    avcodec_register_all();
+
+    if (test_cache_sizes() || test_cache_cap() || test_get_buffer())
+        return 1;
+    return 0;
+}
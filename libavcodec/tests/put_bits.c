@@ -0,0 +1,154 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the 64-bit writer selected by BITSTREAM_WRITER_64 produces the
+ * same bitstream as the default 32-bit writer. With -b both writers are
+ * timed on workloads modelled on the huffyuv and flac encoders.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/avcodec.h"
+
+#include "put_bits_writers.h"
+
+#define FUNC(name) name ## _32
+#include "put_bits_template.c"
+
+#define COUNT  (1 << 18)
+#define SIZE   (COUNT * 8)
+#define RUNS   100
+
+static uint8_t  field_len[COUNT];
+static uint32_t field_val[COUNT];
+static uint8_t  pixels[COUNT];
+static int32_t  residual[COUNT];
+static uint8_t  rice_k[COUNT / 256];
+static uint8_t  code_len[256];
+static uint32_t code_bits[256];
+
+static int compare(const char *name, const uint8_t *buf32, int bits32,
+                   const uint8_t *buf64, int bits64)
+{
+    if (bits32 < 0 || bits64 < 0) {
+        fprintf(stderr, "%s: wrong bit count while writing\n", name);
+        return 1;
+    }
+    if (bits32 != bits64 || memcmp(buf32, buf64, (bits32 + 7) >> 3)) {
+        fprintf(stderr, "%s: 64-bit writer output differs\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+static void bench(uint8_t *buf32, uint8_t *buf64)
+{
+    int64_t t32 = 0, t64 = 0, t0;
+    int run;
+
+    for (run = 0; run < RUNS; run++) {
+        t0   = av_gettime_relative();
+        write_huffyuv_32(buf32, SIZE, pixels, COUNT, code_len, code_bits);
+        t32 += av_gettime_relative() - t0;
+        t0   = av_gettime_relative();
+        write_huffyuv_64(buf64, SIZE, pixels, COUNT, code_len, code_bits);
+        t64 += av_gettime_relative() - t0;
+    }
+    printf("huffyuv: 32-bit %6.2f ns/code, 64-bit %6.2f ns/code\n",
+           t32 * 1000.0 / (RUNS * COUNT), t64 * 1000.0 / (RUNS * COUNT));
+
+    t32 = t64 = 0;
+    for (run = 0; run < RUNS; run++) {
+        t0   = av_gettime_relative();
+        write_flac_32(buf32, SIZE, residual, COUNT, rice_k);
+        t32 += av_gettime_relative() - t0;
+        t0   = av_gettime_relative();
+        write_flac_64(buf64, SIZE, residual, COUNT, rice_k);
+        t64 += av_gettime_relative() - t0;
+    }
+    printf("flac:    32-bit %6.2f ns/code, 64-bit %6.2f ns/code\n",
+           t32 * 1000.0 / (RUNS * COUNT), t64 * 1000.0 / (RUNS * COUNT));
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t *buf32, *buf64;
+    AVLFG lfg;
+    int i, ret = 1;
+
+    buf32 = av_mallocz(SIZE);
+    buf64 = av_mallocz(SIZE);
+    if (!buf32 || !buf64)
+        goto end;
+
+    av_lfg_init(&lfg, 1);
+
+    for (i = 0; i < COUNT; i++) {
+        field_len[i] = av_lfg_get(&lfg) % 32;
+        field_val[i] = av_lfg_get(&lfg);
+    }
+
+    /* residuals concentrated around 0, as after prediction */
+    for (i = 0; i < COUNT; i++) {
+        unsigned r = av_lfg_get(&lfg);
+        int v      = (r & 0xFF) >> (r >> 8 & 7);
+
+        pixels[i]   = r & 0x800 ? -v : v;
+        residual[i] = r & 0x800 ? -v : v;
+    }
+    for (i = 0; i < COUNT / 256; i++)
+        rice_k[i] = av_lfg_get(&lfg) % 6;
+
+    /* code lengths growing with the magnitude, as in the huffyuv tables */
+    for (i = 0; i < 256; i++) {
+        int d = FFMIN(i, 256 - i);
+
+        code_len[i]  = 2 + 2 * av_log2(d + 1);
+        code_bits[i] = av_lfg_get(&lfg) & ((1 << code_len[i]) - 1);
+    }
+
+    if (compare("fields",
+                buf32, write_fields_32(buf32, SIZE, field_len, field_val, COUNT),
+                buf64, write_fields_64(buf64, SIZE, field_len, field_val, COUNT)) ||
+        compare("huffyuv",
+                buf32, write_huffyuv_32(buf32, SIZE, pixels, COUNT,
+                                        code_len, code_bits),
+                buf64, write_huffyuv_64(buf64, SIZE, pixels, COUNT,
+                                        code_len, code_bits)) ||
+        compare("flac",
+                buf32, write_flac_32(buf32, SIZE, residual, COUNT, rice_k),
+                buf64, write_flac_64(buf64, SIZE, residual, COUNT, rice_k)))
+        goto end;
+
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+        bench(buf32, buf64);
+
+    ret = 0;
+end:
+    av_free(buf32);
+    av_free(buf64);
+    return ret;
+}
@@ -0,0 +1,85 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Writers used by the put_bits test, this file is compiled once with the
+ * default writer and once with BITSTREAM_WRITER_64 defined.
+ */
+
+#include <stdint.h>
+
+#include "libavcodec/golomb_legacy.h"
+#include "libavcodec/put_bits.h"
+
+#include "put_bits_writers.h"
+
+int FUNC(write_fields)(uint8_t *buf, int size,
+                       const uint8_t *len, const uint32_t *val, int count)
+{
+    PutBitContext pb;
+    int i, bits = 0;
+
+    init_put_bits(&pb, buf, size);
+    for (i = 0; i < count; i++) {
+        if (i & 1)
+            put_sbits(&pb, len[i], val[i]);
+        else
+            put_bits(&pb, len[i], val[i] & ((1U << len[i]) - 1));
+        bits += len[i];
+        if (put_bits_count(&pb) != bits ||
+            put_bits_left(&pb)  != size * 8 - bits)
+            return -1;
+    }
+    flush_put_bits(&pb);
+
+    return put_bits_count(&pb);
+}
+
+/* the inner loop of the huffyuv encoder */
+int FUNC(write_huffyuv)(uint8_t *buf, int size, const uint8_t *src, int count,
+                        const uint8_t *len, const uint32_t *codes)
+{
+    PutBitContext pb;
+    int i;
+
+    init_put_bits(&pb, buf, size);
+    for (i = 0; i < count; i++)
+        put_bits(&pb, len[src[i]], codes[src[i]]);
+    flush_put_bits(&pb);
+
+    return put_bits_count(&pb);
+}
+
+/* the residual coding of the flac encoder, one rice parameter per
+ * partition of 256 samples */
+int FUNC(write_flac)(uint8_t *buf, int size, const int32_t *res, int count,
+                     const uint8_t *k)
+{
+    PutBitContext pb;
+    int i, j;
+
+    init_put_bits(&pb, buf, size);
+    for (i = 0; i < count; i += 256) {
+        put_bits(&pb, 4, k[i >> 8]);
+        for (j = i; j < i + 256; j++)
+            set_sr_golomb_flac(&pb, res[j], k[i >> 8], INT32_MAX, 0);
+    }
+    flush_put_bits(&pb);
+
+    return put_bits_count(&pb);
+}
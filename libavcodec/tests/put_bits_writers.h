@@ -0,0 +1,36 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_TESTS_PUT_BITS_WRITERS_H
+#define AVCODEC_TESTS_PUT_BITS_WRITERS_H
+
+#include <stdint.h>
+
+#define DECLARE_WRITERS(bits)                                                \
+int write_fields_  ## bits(uint8_t *buf, int size, const uint8_t *len,       \
+                           const uint32_t *val, int count);                  \
+int write_huffyuv_ ## bits(uint8_t *buf, int size, const uint8_t *src,       \
+                           int count, const uint8_t *len,                    \
+                           const uint32_t *codes);                           \
+int write_flac_    ## bits(uint8_t *buf, int size, const int32_t *res,       \
+                           int count, const uint8_t *k);
+
+DECLARE_WRITERS(32)
+DECLARE_WRITERS(64)
+
+#endif /* AVCODEC_TESTS_PUT_BITS_WRITERS_H */
@@ -61,6 +61,26 @@ void ff_thread_flush(AVCodecContext *avctx);
 int ff_thread_decode_frame(AVCodecContext *avctx, AVFrame *picture,
                            int *got_picture_ptr, AVPacket *avpkt);
 
+/**
+ * Submit a new frame to an encoding thread.
+ * Returns the next available packet in avpkt, in submission order.
+ * *got_packet_ptr will be 0 if none is available.
+ * Passing a NULL frame drains the remaining packets, one per call.
+ *
+ * Parameters are the same as avcodec_encode_video2().
+ */
+int ff_thread_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
+                           const AVFrame *frame, int *got_packet_ptr);
+
+/**
+ * Start the encoding threads for a frame-threaded encoder.
+ * Must be called after init() has succeeded on avctx; every thread gets
+ * its own copy of the context, initialized with the same options.
+ *
+ * @param avctx The context.
+ */
+int ff_frame_thread_encoder_init(AVCodecContext *avctx);
+
 /**
  * If the codec defines update_thread_context(), call this
  * when they are ready for the next thread to start decoding
@@ -122,6 +142,30 @@ void ff_thread_release_buffer(AVCodecContext *avctx, ThreadFrame *f);
 
 int ff_thread_ref_frame(ThreadFrame *dst, ThreadFrame *src);
 
+/**
+ * Allocate and reset the progress counters used to synchronize the jobs of a
+ * slice-threaded execute()/execute2() call, e.g. wavefront rows which depend
+ * on the row above. All counters start at 0.
+ * Jobs run in order and one at a time when slice threading is not active,
+ * so the progress functions are no-ops then.
+ *
+ * @param avctx The context.
+ * @param count The number of counters.
+ */
+int ff_thread_init_slice_progress(AVCodecContext *avctx, int count);
+
+/**
+ * Set counter idx to n and wake up the jobs waiting on it.
+ * Call this with a value larger than any awaited one when a job fails,
+ * so that the jobs depending on it cannot block forever.
+ */
+void ff_thread_report_slice_progress(AVCodecContext *avctx, int idx, int n);
+
+/**
+ * Wait until counter idx has reached at least n.
+ */
+void ff_thread_await_slice_progress(AVCodecContext *avctx, int idx, int n);
+
 int ff_thread_init(AVCodecContext *s);
 void ff_thread_free(AVCodecContext *s);
 
@@ -389,7 +389,7 @@ int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *code
         goto end;
     }
 
-    avctx->internal->pool = av_mallocz(sizeof(*avctx->internal->pool));
+    avctx->internal->pool = ff_frame_pool_alloc(avctx->frame_cache_size);
     if (!avctx->internal->pool) {
         ret = AVERROR(ENOMEM);
         goto free_and_end;
@@ -639,13 +639,25 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
     }
 
-    if (avctx->codec->init && !(avctx->active_thread_type & FF_THREAD_FRAME)) {
+    if (avctx->codec->init && (!(avctx->active_thread_type & FF_THREAD_FRAME) ||
+                               av_codec_is_encoder(avctx->codec))) {
         ret = avctx->codec->init(avctx);
         if (ret < 0) {
             goto free_and_end;
         }
     }
 
+    if (HAVE_THREADS && av_codec_is_encoder(avctx->codec) &&
+        avctx->active_thread_type & FF_THREAD_FRAME) {
+        ret = ff_frame_thread_encoder_init(avctx);
+        if (ret < 0) {
+            if (avctx->codec->close &&
+                !(avctx->codec->caps_internal & FF_CODEC_CAP_INIT_CLEANUP))
+                avctx->codec->close(avctx);
+            goto free_and_end;
+        }
+    }
+
     if (av_codec_is_decoder(avctx->codec)) {
         /* validate channel layout from the decoder */
         if (avctx->channel_layout) {
@@ -706,7 +718,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         av_packet_free(&avctx->internal->ds.in_pkt);
 
-        av_freep(&avctx->internal->pool);
+        ff_frame_pool_free(&avctx->internal->pool);
     }
     av_freep(&avctx->internal);
     avctx->codec = NULL;
@@ -737,8 +749,6 @@ av_cold int avcodec_close(AVCodecContext *avctx)
     int i;
 
     if (avcodec_is_open(avctx)) {
-        FramePool *pool = avctx->internal->pool;
-
         if (HAVE_THREADS && avctx->internal->thread_ctx)
             ff_thread_free(avctx);
         if (avctx->codec && avctx->codec->close)
@@ -751,9 +761,7 @@ av_cold int avcodec_close(AVCodecContext *avctx)
 
         av_packet_free(&avctx->internal->ds.in_pkt);
 
-        for (i = 0; i < FF_ARRAY_ELEMS(pool->pools); i++)
-            av_buffer_pool_uninit(&pool->pools[i]);
-        av_freep(&avctx->internal->pool);
+        ff_frame_pool_free(&avctx->internal->pool);
 
         if (avctx->hwaccel && avctx->hwaccel->uninit)
             avctx->hwaccel->uninit(avctx);
@@ -771,6 +779,7 @@ av_cold int avcodec_close(AVCodecContext *avctx)
 
     av_buffer_unref(&avctx->hw_frames_ctx);
     av_buffer_unref(&avctx->hw_device_ctx);
+    av_buffer_unref(&avctx->thread_pool);
 
     if (avctx->priv_data && avctx->codec && avctx->codec->priv_class)
         av_opt_free(avctx->priv_data);
@@ -1454,6 +1463,19 @@ void ff_thread_await_progress(ThreadFrame *f, int progress, int field)
 {
 }
 
+int ff_thread_init_slice_progress(AVCodecContext *avctx, int count)
+{
+    return 0;
+}
+
+void ff_thread_report_slice_progress(AVCodecContext *avctx, int idx, int n)
+{
+}
+
+void ff_thread_await_slice_progress(AVCodecContext *avctx, int idx, int n)
+{
+}
+
 #endif
 
 int avcodec_is_open(AVCodecContext *s)
@@ -30,6 +30,7 @@
 #include "mpegutils.h"
 #include "mpegvideo.h"
 #include "msmpeg4data.h"
+#include "thread.h"
 #include "unary_legacy.h"
 #include "vc1.h"
 #include "vc1_pred.h"
@@ -2573,6 +2574,20 @@ static int vc1_decode_b_mb_intfr(VC1Context *v)
     return 0;
 }
 
+/** Report the MB rows up to mb_y as final to the frame threads using the
+ * current picture as a reference. The overlap smoothing and the loop filter
+ * modify the pixels up to two rows behind the row being decoded, field
+ * pictures are only reported once both fields are done.
+ */
+static void vc1_report_progress(VC1Context *v, int mb_y)
+{
+    MpegEncContext *s = &v->s;
+
+    if (mb_y >= 0 && !v->field_mode && s->pict_type != AV_PICTURE_TYPE_B &&
+        !s->er.error_occurred)
+        ff_thread_report_progress(&s->current_picture_ptr->tf, mb_y, 0);
+}
+
 /** Decode blocks of I-frame
  */
 static void vc1_decode_i_blocks(VC1Context *v)
@@ -2707,11 +2722,13 @@ static void vc1_decode_i_blocks(VC1Context *v)
             ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
         else if (s->mb_y)
             ff_mpeg_draw_horiz_band(s, (s->mb_y - 1) * 16, 16);
+        vc1_report_progress(v, s->mb_y - 2);
 
         s->first_slice_line = 0;
     }
     if (v->s.loop_filter)
         ff_mpeg_draw_horiz_band(s, (s->end_mb_y - 1) * 16, 16);
+    vc1_report_progress(v, s->end_mb_y - 1);
 
     /* This is intentionally mb_height and not end_mb_y - unlike in advanced
      * profile, these only differ are when decoding MSS2 rectangles. */
@@ -2836,6 +2853,7 @@ static void vc1_decode_i_blocks_adv(VC1Context *v)
             ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
         else if (s->mb_y)
             ff_mpeg_draw_horiz_band(s, (s->mb_y-1) * 16, 16);
+        vc1_report_progress(v, s->mb_y - 2);
         s->first_slice_line = 0;
     }
 
@@ -2851,6 +2869,7 @@ static void vc1_decode_i_blocks_adv(VC1Context *v)
     }
     if (v->s.loop_filter)
         ff_mpeg_draw_horiz_band(s, (s->end_mb_y-1)*16, 16);
+    vc1_report_progress(v, s->end_mb_y - 1);
     ff_er_add_slice(&s->er, 0, s->start_mb_y << v->field_mode, s->mb_width - 1,
                     (s->end_mb_y << v->field_mode) - 1, ER_MB_END);
 }
@@ -2915,6 +2934,7 @@ static void vc1_decode_p_blocks(VC1Context *v)
         memmove(v->is_intra_base, v->is_intra, sizeof(v->is_intra_base[0]) * s->mb_stride);
         memmove(v->luma_mv_base,  v->luma_mv,  sizeof(v->luma_mv_base[0])  * s->mb_stride);
         if (s->mb_y != s->start_mb_y) ff_mpeg_draw_horiz_band(s, (s->mb_y - 1) * 16, 16);
+        vc1_report_progress(v, s->mb_y - 2);
         s->first_slice_line = 0;
     }
     if (apply_loop_filter) {
@@ -2927,6 +2947,7 @@ static void vc1_decode_p_blocks(VC1Context *v)
     }
     if (s->end_mb_y >= s->start_mb_y)
         ff_mpeg_draw_horiz_band(s, (s->end_mb_y - 1) * 16, 16);
+    vc1_report_progress(v, s->end_mb_y - 1);
     ff_er_add_slice(&s->er, 0, s->start_mb_y << v->field_mode, s->mb_width - 1,
                     (s->end_mb_y << v->field_mode) - 1, ER_MB_END);
 }
@@ -2962,6 +2983,9 @@ static void vc1_decode_b_blocks(VC1Context *v)
 
     s->first_slice_line = 1;
     for (s->mb_y = s->start_mb_y; s->mb_y < s->end_mb_y; s->mb_y++) {
+        /* the direct mode reads the motion vectors of the co-located MBs */
+        if (!v->field_mode && s->next_picture_ptr)
+            ff_thread_await_progress(&s->next_picture_ptr->tf, s->mb_y, 0);
         s->mb_x = 0;
         init_block_index(v);
         for (; s->mb_x < s->mb_width; s->mb_x++) {
@@ -3008,10 +3032,13 @@ static void vc1_decode_skip_blocks(VC1Context *v)
         s->mb_x = 0;
         init_block_index(v);
         ff_update_block_index(s);
+        if (s->last_picture_ptr)
+            ff_thread_await_progress(&s->last_picture_ptr->tf, s->mb_y, 0);
         memcpy(s->dest[0], s->last_picture.f->data[0] + s->mb_y * 16 * s->linesize,   s->linesize   * 16);
         memcpy(s->dest[1], s->last_picture.f->data[1] + s->mb_y *  8 * s->uvlinesize, s->uvlinesize *  8);
         memcpy(s->dest[2], s->last_picture.f->data[2] + s->mb_y *  8 * s->uvlinesize, s->uvlinesize *  8);
         ff_mpeg_draw_horiz_band(s, s->mb_y * 16, 16);
+        vc1_report_progress(v, s->mb_y);
         s->first_slice_line = 0;
     }
     s->pict_type = AV_PICTURE_TYPE_P;
@@ -30,8 +30,22 @@
 #include "h264chroma.h"
 #include "mathops.h"
 #include "mpegvideo.h"
+#include "thread.h"
 #include "vc1.h"
 
+/** Wait until the reference picture is decoded down to luma line y.
+ * Field pictures wait for their whole references before decoding.
+ */
+static av_always_inline void await_reference_row(VC1Context *v, int dir, int y)
+{
+    MpegEncContext *s = &v->s;
+    Picture *ref      = dir ? s->next_picture_ptr : s->last_picture_ptr;
+
+    if (!v->field_mode && ref)
+        ff_thread_await_progress(&ref->tf,
+                                 av_clip(y >> 4, 0, s->mb_height - 1), 0);
+}
+
 /** Do motion compensation over 1 macroblock
  * Mostly adapted hpel_motion and qpel_motion from mpegvideo.c
  */
@@ -125,6 +139,8 @@ void ff_vc1_mc_1mv(VC1Context *v, int dir)
         uvsrc_y = av_clip(uvsrc_y,  -8, s->avctx->coded_height >> 1);
     }
 
+    await_reference_row(v, dir, FFMAX(src_y + 19, (uvsrc_y + 9) << 1));
+
     srcY += src_y   * s->linesize   + src_x;
     srcU += uvsrc_y * s->uvlinesize + uvsrc_x;
     srcV += uvsrc_y * s->uvlinesize + uvsrc_x;
@@ -381,6 +397,8 @@ void ff_vc1_mc_4mv_luma(VC1Context *v, int n, int dir, int avg)
         }
     }
 
+    await_reference_row(v, dir, src_y + (11 << fieldmv));
+
     srcY += src_y * s->linesize + src_x;
     if (v->field_mode && v->ref_field_type[dir])
         srcY += s->current_picture_ptr->f->linesize[0];
@@ -597,6 +615,8 @@ void ff_vc1_mc_4mv_chroma(VC1Context *v, int dir)
         return;
     }
 
+    await_reference_row(v, dir, (uvsrc_y + 9) << 1);
+
     srcU += uvsrc_y * s->uvlinesize + uvsrc_x;
     srcV += uvsrc_y * s->uvlinesize + uvsrc_x;
 
@@ -707,6 +727,8 @@ void ff_vc1_mc_4mv_chroma4(VC1Context *v, int dir, int dir2, int avg)
         // FIXME: implement proper pull-back (see vc1cropmv.c, vc1CROPMV_ChromaPullBack())
         uvsrc_x = av_clip(uvsrc_x, -8, s->avctx->coded_width  >> 1);
         uvsrc_y = av_clip(uvsrc_y, -8, s->avctx->coded_height >> 1);
+        await_reference_row(v, i < 2 ? dir : dir2,
+                            (uvsrc_y + (5 << fieldmv)) << 1);
         if (i < 2 ? dir : dir2) {
             srcU = s->next_picture.f->data[1] + uvsrc_y * s->uvlinesize + uvsrc_x;
             srcV = s->next_picture.f->data[2] + uvsrc_y * s->uvlinesize + uvsrc_x;
@@ -826,6 +848,8 @@ void ff_vc1_interp_mc(VC1Context *v)
         uvsrc_y = av_clip(uvsrc_y,  -8, s->avctx->coded_height >> 1);
     }
 
+    await_reference_row(v, 1, FFMAX(src_y + 19, (uvsrc_y + 9) << 1));
+
     srcY += src_y   * s->linesize   + src_x;
     srcU += uvsrc_y * s->uvlinesize + uvsrc_x;
     srcV += uvsrc_y * s->uvlinesize + uvsrc_x;
@@ -35,6 +35,7 @@
 #include "msmpeg4.h"
 #include "msmpeg4data.h"
 #include "profiles.h"
+#include "thread.h"
 #include "vc1.h"
 #include "vc1data.h"
 
@@ -507,6 +508,8 @@ static av_cold int vc1_decode_init(AVCodecContext *avctx)
     if (!v->sprite_output_frame)
         return AVERROR(ENOMEM);
 
+    avctx->internal->allocate_progress = 1;
+
     avctx->profile = v->profile;
     if (v->profile == PROFILE_ADVANCED)
         avctx->level = v->level;
@@ -581,6 +584,121 @@ av_cold int ff_vc1_decode_end(AVCodecContext *avctx)
     return 0;
 }
 
+#if HAVE_THREADS
+static av_cold int vc1_decode_init_thread_copy(AVCodecContext *avctx)
+{
+    VC1Context *v = avctx->priv_data;
+
+    /* owned by the first thread, the sprite decoders are not frame threaded */
+    v->sprite_output_frame = NULL;
+
+    return 0;
+}
+
+static int vc1_update_thread_context(AVCodecContext *dst,
+                                     const AVCodecContext *src)
+{
+    VC1Context *v        = dst->priv_data;
+    const VC1Context *v1 = src->priv_data;
+    MpegEncContext *s    = &v->s;
+    int ret;
+
+    if (dst == src || !v1->s.context_initialized)
+        return 0;
+
+    /* the VC-1 tables depend on the frame size, reallocate them all the
+     * same way vc1_decode_frame() does */
+    if (s->context_initialized &&
+        (s->width != v1->s.width || s->height != v1->s.height))
+        ff_vc1_decode_end(dst);
+
+    ret = ff_mpeg_update_thread_context(dst, src);
+    if (ret < 0)
+        return ret;
+
+    if (!v->mv_type_mb_plane) {
+        ret = ff_vc1_decode_init_alloc_tables(v);
+        if (ret < 0)
+            return ret;
+    }
+
+    /* sequence header, which can be repeated and changed in band in the
+     * advanced profile */
+    v->profile               = v1->profile;
+    v->level                 = v1->level;
+    v->chromaformat          = v1->chromaformat;
+    v->frmrtq_postproc       = v1->frmrtq_postproc;
+    v->bitrtq_postproc       = v1->bitrtq_postproc;
+    v->postprocflag          = v1->postprocflag;
+    v->broadcast             = v1->broadcast;
+    v->interlace             = v1->interlace;
+    v->tfcntrflag            = v1->tfcntrflag;
+    v->finterpflag           = v1->finterpflag;
+    v->psf                   = v1->psf;
+    v->res_sprite            = v1->res_sprite;
+    v->res_y411              = v1->res_y411;
+    v->res_x8                = v1->res_x8;
+    v->multires              = v1->multires;
+    v->res_fasttx            = v1->res_fasttx;
+    v->res_transtab          = v1->res_transtab;
+    v->rangered              = v1->rangered;
+    v->res_rtm_flag          = v1->res_rtm_flag;
+    v->resync_marker         = v1->resync_marker;
+    v->color_prim            = v1->color_prim;
+    v->transfer_char         = v1->transfer_char;
+    v->matrix_coef           = v1->matrix_coef;
+    v->hrd_param_flag        = v1->hrd_param_flag;
+    v->hrd_num_leaky_buckets = v1->hrd_num_leaky_buckets;
+    v->zz_8x4                = v1->zz_8x4;
+    v->zz_4x8                = v1->zz_4x8;
+    s->max_b_frames          = v1->s.max_b_frames;
+    /* res_fasttx selects the inverse transforms */
+    v->vc1dsp                = v1->vc1dsp;
+
+    /* entry point header */
+    v->broken_link      = v1->broken_link;
+    v->closed_entry     = v1->closed_entry;
+    v->panscanflag      = v1->panscanflag;
+    v->refdist_flag     = v1->refdist_flag;
+    s->loop_filter      = v1->s.loop_filter;
+    v->fastuvmc         = v1->fastuvmc;
+    v->extended_mv      = v1->extended_mv;
+    v->extended_dmv     = v1->extended_dmv;
+    v->dquant           = v1->dquant;
+    v->vstransform      = v1->vstransform;
+    v->overlap          = v1->overlap;
+    v->quantizer_mode   = v1->quantizer_mode;
+    v->range_mapy_flag  = v1->range_mapy_flag;
+    v->range_mapy       = v1->range_mapy;
+    v->range_mapuv_flag = v1->range_mapuv_flag;
+    v->range_mapuv      = v1->range_mapuv;
+
+    /* state carried over from the previous pictures */
+    v->rnd     = v1->rnd;
+    v->refdist = v1->refdist;
+
+    memcpy(v->last_luty,  v1->last_luty,  sizeof(v->last_luty));
+    memcpy(v->last_lutuv, v1->last_lutuv, sizeof(v->last_lutuv));
+    memcpy(v->next_luty,  v1->next_luty,  sizeof(v->next_luty));
+    memcpy(v->next_lutuv, v1->next_lutuv, sizeof(v->next_lutuv));
+    v->last_use_ic = v1->last_use_ic;
+    v->next_use_ic = v1->next_use_ic;
+
+    if (v->interlace) {
+        int mb_height = FFALIGN(s->mb_height, 2);
+        int size      = s->b8_stride * (mb_height * 2 + 1) +
+                        s->mb_stride * (mb_height + 1) * 2;
+
+        /* both planes of mv_f_next are swapped together with mv_f, so they
+         * always come from the same allocation */
+        memcpy(v->mv_f_next[0] - s->b8_stride - 1,
+               v1->mv_f_next[0] - s->b8_stride - 1, 2 * size);
+    }
+
+    return 0;
+}
+#endif
+
 
 /** Decode a VC1/WMV3 frame
  * @todo TODO: Handle VC-1 IDUs (Transport level?)
@@ -596,6 +714,7 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     uint8_t *buf2 = NULL;
     const uint8_t *buf_start = buf;
     int mb_height, n_slices1;
+    int setup_finished = 0, frame_started = 0;
     struct {
         uint8_t *buf;
         GetBitContext gb;
@@ -795,6 +914,7 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     if (ff_mpv_frame_start(s, avctx) < 0) {
         goto err;
     }
+    frame_started = 1;
 
     // process pulldown flags
     s->current_picture_ptr->f->repeat_pict = 0;
@@ -811,6 +931,14 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
     s->me.qpel_put = s->qdsp.put_qpel_pixels_tab;
     s->me.qpel_avg = s->qdsp.avg_qpel_pixels_tab;
 
+    /* Reference field pictures leave the field flags of their motion vectors
+     * in mv_f_next for the direct mode of the following B-field pictures,
+     * so the next frame thread can only be set up once they are decoded. */
+    if (avctx->hwaccel || !v->field_mode || s->pict_type == AV_PICTURE_TYPE_B) {
+        ff_thread_finish_setup(avctx);
+        setup_finished = 1;
+    }
+
     if (avctx->hwaccel) {
         if (avctx->hwaccel->start_frame(avctx, buf, buf_size) < 0)
             goto err;
@@ -823,6 +951,15 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
 
         ff_mpeg_er_frame_start(s);
 
+        /* field pictures do not track the progress of the single fields,
+         * wait for the whole reference frames */
+        if (v->field_mode) {
+            if (s->last_picture_ptr)
+                ff_thread_await_progress(&s->last_picture_ptr->tf, INT_MAX, 0);
+            if (s->pict_type == AV_PICTURE_TYPE_B && s->next_picture_ptr)
+                ff_thread_await_progress(&s->next_picture_ptr->tf, INT_MAX, 0);
+        }
+
         v->bits = buf_size * 8;
         v->end_mb_x = s->mb_width;
         if (v->field_mode) {
@@ -913,6 +1050,9 @@ static int vc1_decode_frame(AVCodecContext *avctx, void *data,
 
     ff_mpv_frame_end(s);
 
+    if (!setup_finished)
+        ff_thread_finish_setup(avctx);
+
     if (avctx->codec_id == AV_CODEC_ID_WMV3IMAGE || avctx->codec_id == AV_CODEC_ID_VC1IMAGE) {
 image:
         avctx->width  = avctx->coded_width  = v->output_width;
@@ -948,6 +1088,10 @@ end:
     return buf_size;
 
 err:
+    /* do not leave other frame threads waiting on a broken picture, before
+     * ff_mpv_frame_start() current_picture_ptr is still the previous one */
+    if (frame_started)
+        ff_thread_report_progress(&s->current_picture_ptr->tf, INT_MAX, 0);
     av_free(buf2);
     for (i = 0; i < n_slices; i++)
         av_free(slices[i].buf);
@@ -983,9 +1127,12 @@ AVCodec ff_vc1_decoder = {
     .close          = ff_vc1_decode_end,
     .decode         = vc1_decode_frame,
     .flush          = ff_mpeg_flush,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = vc1_hwaccel_pixfmt_list_420,
-    .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles)
+    .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles),
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vc1_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(vc1_update_thread_context),
 };
 
 #if CONFIG_WMV3_DECODER
@@ -999,9 +1146,12 @@ AVCodec ff_wmv3_decoder = {
     .close          = ff_vc1_decode_end,
     .decode         = vc1_decode_frame,
     .flush          = ff_mpeg_flush,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_FRAME_THREADS,
     .pix_fmts       = vc1_hwaccel_pixfmt_list_420,
-    .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles)
+    .profiles       = NULL_IF_CONFIG_SMALL(ff_vc1_profiles),
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vc1_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(vc1_update_thread_context),
 };
 #endif
 
@@ -71,7 +71,7 @@ static inline int set_idx(BitstreamContext *bc, int code, int *n, int *nb_bits,
     unsigned idx;
 
     *nb_bits = -*n;
-    idx = bitstream_peek(bc, *nb_bits) + code;
+    idx = show_val(bc, *nb_bits) + code;
     *n = table[idx][1];
 
     return table[idx][0];
@@ -90,10 +90,17 @@ static inline int set_idx(BitstreamContext *bc, int code, int *n, int *nb_bits,
 static inline int bitstream_read_vlc(BitstreamContext *bc, VLC_TYPE (*table)[2],
                                      int bits, int max_depth)
 {
-    int nb_bits;
-    unsigned idx = bitstream_peek(bc, bits);
-    int code = table[idx][0];
-    int n    = table[idx][1];
+    int nb_bits, code, n;
+    unsigned idx;
+
+    /* codes are at most 32 bits long, so a single refill is enough for
+     * all the lookups */
+    if (bc->bits_left < 32)
+        refill_64(bc);
+
+    idx  = show_val(bc, bits);
+    code = table[idx][0];
+    n    = table[idx][1];
 
     if (max_depth > 1 && n < 0) {
         skip_remaining(bc, bits);
@@ -111,29 +118,34 @@ static inline int bitstream_read_vlc(BitstreamContext *bc, VLC_TYPE (*table)[2],
 #define BITSTREAM_RL_VLC(level, run, bc, table, bits, max_depth) \
     do {                                                         \
         int n, nb_bits;                                          \
-        unsigned index = bitstream_peek(bc, bits);               \
+        unsigned index;                                          \
+                                                                 \
+        if ((bc)->bits_left < 32)                                \
+            refill_64(bc);                                       \
+                                                                 \
+        index = show_val(bc, bits);                              \
         level = table[index].level;                              \
         n     = table[index].len;                                \
                                                                  \
         if (max_depth > 1 && n < 0) {                            \
-            bitstream_skip(bc, bits);                            \
+            skip_remaining(bc, bits);                            \
                                                                  \
             nb_bits = -n;                                        \
                                                                  \
-            index = bitstream_peek(bc, nb_bits) + level;         \
+            index = show_val(bc, nb_bits) + level;               \
             level = table[index].level;                          \
             n     = table[index].len;                            \
             if (max_depth > 2 && n < 0) {                        \
-                bitstream_skip(bc, nb_bits);                     \
+                skip_remaining(bc, nb_bits);                     \
                 nb_bits = -n;                                    \
                                                                  \
-                index = bitstream_peek(bc, nb_bits) + level;     \
+                index = show_val(bc, nb_bits) + level;           \
                 level = table[index].level;                      \
                 n     = table[index].len;                        \
             }                                                    \
         }                                                        \
         run = table[index].run;                                  \
-        bitstream_skip(bc, n);                                   \
+        skip_remaining(bc, n);                                   \
     } while (0)
 
 #endif /* AVCODEC_VLC_H */
@@ -112,11 +112,22 @@ static void vp9_decode_flush(AVCodecContext *avctx)
     s->alloc_height = 0;
 }
 
+// the largest number of tile columns the frame header can signal
+static int max_tile_cols(int sb_cols)
+{
+    int log2_min, log2_max;
+
+    for (log2_min = 0; (sb_cols >> log2_min) > 64; log2_min++) ;
+    for (log2_max = 0; (sb_cols >> log2_max) >= 4; log2_max++) ;
+
+    return 1 << FFMAX(log2_min, log2_max - 1);
+}
+
 static int update_size(AVCodecContext *avctx, int w, int h)
 {
     VP9Context *s = avctx->priv_data;
     uint8_t *p;
-    int nb_blocks, nb_superblocks;
+    int nb_blocks, nb_superblocks, lflvl_rows;
 
     if (s->above_partition_ctx && w == s->alloc_width && h == s->alloc_height)
         return 0;
@@ -135,8 +146,7 @@ static int update_size(AVCodecContext *avctx, int w, int h)
 
 #define assign(var, type, n) var = (type)p; p += s->sb_cols * n * sizeof(*var)
     av_free(s->above_partition_ctx);
-    p = av_malloc(s->sb_cols *
-                  (240 + sizeof(*s->lflvl) + 16 * sizeof(*s->above_mv_ctx)));
+    p = av_malloc(s->sb_cols * (240 + 16 * sizeof(*s->above_mv_ctx)));
     if (!p)
         return AVERROR(ENOMEM);
     assign(s->above_partition_ctx, uint8_t *,     8);
@@ -154,23 +164,32 @@ static int update_size(AVCodecContext *avctx, int w, int h)
     assign(s->above_comp_ctx,      uint8_t *,     8);
     assign(s->above_ref_ctx,       uint8_t *,     8);
     assign(s->above_filter_ctx,    uint8_t *,     8);
-    assign(s->lflvl,               VP9Filter *,   1);
     assign(s->above_mv_ctx,        VP56mv(*)[2], 16);
 #undef assign
 
+    av_freep(&s->lflvl);
     av_freep(&s->b_base);
     av_freep(&s->block_base);
+    av_freep(&s->td);
+
+    // with slice threading, the loopfilter runs behind the tile decoding
+    // and needs the filter masks of all the rows it did not reach yet
+    lflvl_rows = avctx->active_thread_type & FF_THREAD_SLICE ? s->sb_rows : 1;
+    s->lflvl   = av_malloc_array(s->sb_cols * lflvl_rows, sizeof(*s->lflvl));
+
+    s->nb_td = max_tile_cols(s->sb_cols);
+    s->td    = av_mallocz_array(s->nb_td, sizeof(*s->td));
 
     if (avctx->active_thread_type & FF_THREAD_FRAME) {
         nb_blocks      = s->cols * s->rows;
         nb_superblocks = s->sb_cols * s->sb_rows;
     } else {
-        nb_blocks = nb_superblocks = 1;
+        nb_blocks = nb_superblocks = s->nb_td;
     }
 
     s->b_base     = av_malloc_array(nb_blocks, sizeof(*s->b_base));
     s->block_base = av_mallocz_array(nb_superblocks, (64 * 64 + 128) * 3);
-    if (!s->b_base || !s->block_base)
+    if (!s->lflvl || !s->td || !s->b_base || !s->block_base)
         return AVERROR(ENOMEM);
     s->uvblock_base[0] = s->block_base      + nb_superblocks * 64 * 64;
     s->uvblock_base[1] = s->uvblock_base[0] + nb_superblocks * 32 * 32;
@@ -409,9 +428,23 @@ static int decode_frame_header(AVCodecContext *avctx,
     s->filter.level = get_bits(&s->gb, 6);
     sharp           = get_bits(&s->gb, 3);
     /* If sharpness changed, reinit lim/mblim LUTs. if it didn't change,
-     * keep the old cache values since they are still valid. */
-    if (s->filter.sharpness != sharp)
-        memset(s->filter.lim_lut, 0, sizeof(s->filter.lim_lut));
+     * keep the old cache values since they are still valid. They are set
+     * up here rather than lazily by the blocks using them, since the tile
+     * columns may be decoded concurrently. */
+    if (s->filter.sharpness != sharp) {
+        for (i = 1; i < FF_ARRAY_ELEMS(s->filter.lim_lut); i++) {
+            int limit = i;
+
+            if (sharp > 0) {
+                limit >>= (sharp + 3) >> 2;
+                limit   = FFMIN(limit, 9 - sharp);
+            }
+            limit = FFMAX(limit, 1);
+
+            s->filter.lim_lut[i]   = limit;
+            s->filter.mblim_lut[i] = 2 * (i + 2) + limit;
+        }
+    }
     s->filter.sharpness = sharp;
     if ((s->lf_delta.enabled = get_bits1(&s->gb))) {
         if (get_bits1(&s->gb)) {
@@ -528,17 +561,7 @@ static int decode_frame_header(AVCodecContext *avctx,
     }
     s->tiling.log2_tile_rows = decode012(&s->gb);
     s->tiling.tile_rows      = 1 << s->tiling.log2_tile_rows;
-    if (s->tiling.tile_cols != (1 << s->tiling.log2_tile_cols)) {
-        s->tiling.tile_cols = 1 << s->tiling.log2_tile_cols;
-        s->c_b              = av_fast_realloc(s->c_b, &s->c_b_size,
-                                              sizeof(VP56RangeCoder) *
-                                              s->tiling.tile_cols);
-        if (!s->c_b) {
-            av_log(avctx, AV_LOG_ERROR,
-                   "Ran out of memory during range coder init\n");
-            return AVERROR(ENOMEM);
-        }
-    }
+    s->tiling.tile_cols      = 1 << s->tiling.log2_tile_cols;
 
     if (s->keyframe || s->errorres || s->intraonly) {
         s->prob_ctx[0].p =
@@ -568,12 +591,6 @@ static int decode_frame_header(AVCodecContext *avctx,
         return AVERROR_INVALIDDATA;
     }
 
-    if (s->keyframe || s->intraonly)
-        memset(s->counts.coef, 0,
-               sizeof(s->counts.coef) + sizeof(s->counts.eob));
-    else
-        memset(&s->counts, 0, sizeof(s->counts));
-
     /* FIXME is it faster to not copy here, but do it down in the fw updates
      * as explicit copies if the fw update is missing (and skip the copy upon
      * fw update)? */
@@ -604,7 +621,9 @@ static int decode_frame_header(AVCodecContext *avctx,
         }
     }
 
-    // coef updates
+    /* coef updates, p[3-10] are filled in from the pareto model here rather
+     * than lazily by the coefficient decoding, which can run concurrently
+     * in all the tile columns */
     for (i = 0; i < 4; i++) {
         uint8_t (*ref)[2][6][6][3] = s->prob_ctx[c].coef[i];
         if (vp8_rac_get(&s->c)) {
@@ -622,7 +641,7 @@ static int decode_frame_header(AVCodecContext *avctx,
                                 else
                                     p[n] = r[n];
                             }
-                            p[3] = 0;
+                            memcpy(&p[3], ff_vp9_model_pareto8[p[2]], 8);
                         }
         } else {
             for (j = 0; j < 2; j++)
@@ -634,7 +653,7 @@ static int decode_frame_header(AVCodecContext *avctx,
                             if (m > 3 && l == 0) // dc only has 3 pt
                                 break;
                             memcpy(p, r, 3);
-                            p[3] = 0;
+                            memcpy(&p[3], ff_vp9_model_pareto8[p[2]], 8);
                         }
         }
         if (s->txfmmode == i)
@@ -762,14 +781,14 @@ static int decode_frame_header(AVCodecContext *avctx,
     return (data2 - data) + size2;
 }
 
-static int decode_subblock(AVCodecContext *avctx, int row, int col,
-                           VP9Filter *lflvl,
+static int decode_subblock(AVCodecContext *avctx, VP9TileData *td,
+                           int row, int col, VP9Filter *lflvl,
                            ptrdiff_t yoff, ptrdiff_t uvoff, enum BlockLevel bl)
 {
     VP9Context *s = avctx->priv_data;
     AVFrame    *f = s->frames[CUR_FRAME].tf.f;
     int c = ((s->above_partition_ctx[col]       >> (3 - bl)) & 1) |
-            (((s->left_partition_ctx[row & 0x7] >> (3 - bl)) & 1) << 1);
+            (((td->left_partition_ctx[row & 0x7] >> (3 - bl)) & 1) << 1);
     int ret;
     const uint8_t *p = s->keyframe ? ff_vp9_default_kf_partition_probs[bl][c]
                                    : s->prob.p.partition[bl][c];
@@ -777,51 +796,53 @@ static int decode_subblock(AVCodecContext *avctx, int row, int col,
     ptrdiff_t hbs = 4 >> bl;
 
     if (bl == BL_8X8) {
-        bp  = vp8_rac_get_tree(&s->c, ff_vp9_partition_tree, p);
-        ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff, bl, bp);
+        bp  = vp8_rac_get_tree(&td->c, ff_vp9_partition_tree, p);
+        ret = ff_vp9_decode_block(avctx, td, row, col, lflvl, yoff, uvoff,
+                                  bl, bp);
     } else if (col + hbs < s->cols) {
         if (row + hbs < s->rows) {
-            bp = vp8_rac_get_tree(&s->c, ff_vp9_partition_tree, p);
+            bp = vp8_rac_get_tree(&td->c, ff_vp9_partition_tree, p);
             switch (bp) {
             case PARTITION_NONE:
-                ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff,
-                                          bl, bp);
+                ret = ff_vp9_decode_block(avctx, td, row, col, lflvl,
+                                          yoff, uvoff, bl, bp);
                 break;
             case PARTITION_H:
-                ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff,
-                                          bl, bp);
+                ret = ff_vp9_decode_block(avctx, td, row, col, lflvl,
+                                          yoff, uvoff, bl, bp);
                 if (!ret) {
                     yoff  += hbs * 8 * f->linesize[0];
                     uvoff += hbs * 4 * f->linesize[1];
-                    ret    = ff_vp9_decode_block(avctx, row + hbs, col, lflvl,
-                                                 yoff, uvoff, bl, bp);
+                    ret    = ff_vp9_decode_block(avctx, td, row + hbs, col,
+                                                 lflvl, yoff, uvoff, bl, bp);
                 }
                 break;
             case PARTITION_V:
-                ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff,
-                                          bl, bp);
+                ret = ff_vp9_decode_block(avctx, td, row, col, lflvl,
+                                          yoff, uvoff, bl, bp);
                 if (!ret) {
                     yoff  += hbs * 8;
                     uvoff += hbs * 4;
-                    ret    = ff_vp9_decode_block(avctx, row, col + hbs, lflvl,
-                                                 yoff, uvoff, bl, bp);
+                    ret    = ff_vp9_decode_block(avctx, td, row, col + hbs,
+                                                 lflvl, yoff, uvoff, bl, bp);
                 }
                 break;
             case PARTITION_SPLIT:
-                ret = decode_subblock(avctx, row, col, lflvl,
+                ret = decode_subblock(avctx, td, row, col, lflvl,
                                       yoff, uvoff, bl + 1);
                 if (!ret) {
-                    ret = decode_subblock(avctx, row, col + hbs, lflvl,
+                    ret = decode_subblock(avctx, td, row, col + hbs, lflvl,
                                           yoff + 8 * hbs, uvoff + 4 * hbs,
                                           bl + 1);
                     if (!ret) {
                         yoff  += hbs * 8 * f->linesize[0];
                         uvoff += hbs * 4 * f->linesize[1];
-                        ret    = decode_subblock(avctx, row + hbs, col, lflvl,
-                                                 yoff, uvoff, bl + 1);
+                        ret    = decode_subblock(avctx, td, row + hbs, col,
+                                                 lflvl, yoff, uvoff, bl + 1);
                         if (!ret) {
-                            ret = decode_subblock(avctx, row + hbs, col + hbs,
-                                                  lflvl, yoff + 8 * hbs,
+                            ret = decode_subblock(avctx, td, row + hbs,
+                                                  col + hbs, lflvl,
+                                                  yoff + 8 * hbs,
                                                   uvoff + 4 * hbs, bl + 1);
                         }
                     }
@@ -831,46 +852,50 @@ static int decode_subblock(AVCodecContext *avctx, int row, int col,
                 av_log(avctx, AV_LOG_ERROR, "Unexpected partition %d.", bp);
                 return AVERROR_INVALIDDATA;
             }
-        } else if (vp56_rac_get_prob_branchy(&s->c, p[1])) {
+        } else if (vp56_rac_get_prob_branchy(&td->c, p[1])) {
             bp  = PARTITION_SPLIT;
-            ret = decode_subblock(avctx, row, col, lflvl, yoff, uvoff, bl + 1);
+            ret = decode_subblock(avctx, td, row, col, lflvl,
+                                  yoff, uvoff, bl + 1);
             if (!ret)
-                ret = decode_subblock(avctx, row, col + hbs, lflvl,
+                ret = decode_subblock(avctx, td, row, col + hbs, lflvl,
                                       yoff + 8 * hbs, uvoff + 4 * hbs, bl + 1);
         } else {
             bp  = PARTITION_H;
-            ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff,
-                                      bl, bp);
+            ret = ff_vp9_decode_block(avctx, td, row, col, lflvl,
+                                      yoff, uvoff, bl, bp);
         }
     } else if (row + hbs < s->rows) {
-        if (vp56_rac_get_prob_branchy(&s->c, p[2])) {
+        if (vp56_rac_get_prob_branchy(&td->c, p[2])) {
             bp  = PARTITION_SPLIT;
-            ret = decode_subblock(avctx, row, col, lflvl, yoff, uvoff, bl + 1);
+            ret = decode_subblock(avctx, td, row, col, lflvl,
+                                  yoff, uvoff, bl + 1);
             if (!ret) {
                 yoff  += hbs * 8 * f->linesize[0];
                 uvoff += hbs * 4 * f->linesize[1];
-                ret    = decode_subblock(avctx, row + hbs, col, lflvl,
+                ret    = decode_subblock(avctx, td, row + hbs, col, lflvl,
                                          yoff, uvoff, bl + 1);
             }
         } else {
             bp  = PARTITION_V;
-            ret = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff,
-                                      bl, bp);
+            ret = ff_vp9_decode_block(avctx, td, row, col, lflvl,
+                                      yoff, uvoff, bl, bp);
         }
     } else {
         bp  = PARTITION_SPLIT;
-        ret = decode_subblock(avctx, row, col, lflvl, yoff, uvoff, bl + 1);
+        ret = decode_subblock(avctx, td, row, col, lflvl,
+                              yoff, uvoff, bl + 1);
     }
-    s->counts.partition[bl][c][bp]++;
+    td->counts.partition[bl][c][bp]++;
 
     return ret;
 }
 
-static int decode_superblock_mem(AVCodecContext *avctx, int row, int col, struct VP9Filter *lflvl,
+static int decode_superblock_mem(AVCodecContext *avctx, VP9TileData *td,
+                                 int row, int col, struct VP9Filter *lflvl,
                                  ptrdiff_t yoff, ptrdiff_t uvoff, enum BlockLevel bl)
 {
     VP9Context *s = avctx->priv_data;
-    VP9Block *b = s->b;
+    VP9Block *b = td->b;
     ptrdiff_t hbs = 4 >> bl;
     AVFrame *f = s->frames[CUR_FRAME].tf.f;
     ptrdiff_t y_stride = f->linesize[0], uv_stride = f->linesize[1];
@@ -878,43 +903,43 @@ static int decode_superblock_mem(AVCodecContext *avctx, int row, int col, struct
 
     if (bl == BL_8X8) {
         av_assert2(b->bl == BL_8X8);
-        res = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff, b->bl, b->bp);
-    } else if (s->b->bl == bl) {
-        if ((res = ff_vp9_decode_block(avctx, row, col, lflvl, yoff, uvoff, b->bl, b->bp)) < 0)
+        res = ff_vp9_decode_block(avctx, td, row, col, lflvl, yoff, uvoff, b->bl, b->bp);
+    } else if (td->b->bl == bl) {
+        if ((res = ff_vp9_decode_block(avctx, td, row, col, lflvl, yoff, uvoff, b->bl, b->bp)) < 0)
             return res;
         if (b->bp == PARTITION_H && row + hbs < s->rows) {
             yoff  += hbs * 8 * y_stride;
             uvoff += hbs * 4 * uv_stride;
-            res = ff_vp9_decode_block(avctx, row + hbs, col, lflvl, yoff, uvoff, b->bl, b->bp);
+            res = ff_vp9_decode_block(avctx, td, row + hbs, col, lflvl, yoff, uvoff, b->bl, b->bp);
         } else if (b->bp == PARTITION_V && col + hbs < s->cols) {
             yoff  += hbs * 8;
             uvoff += hbs * 4;
-            res = ff_vp9_decode_block(avctx, row, col + hbs, lflvl, yoff, uvoff, b->bl, b->bp);
+            res = ff_vp9_decode_block(avctx, td, row, col + hbs, lflvl, yoff, uvoff, b->bl, b->bp);
         }
     } else {
-        if ((res = decode_superblock_mem(avctx, row, col, lflvl, yoff, uvoff, bl + 1)) < 0)
+        if ((res = decode_superblock_mem(avctx, td, row, col, lflvl, yoff, uvoff, bl + 1)) < 0)
             return res;
         if (col + hbs < s->cols) { // FIXME why not <=?
             if (row + hbs < s->rows) {
-                if ((res = decode_superblock_mem(avctx, row, col + hbs, lflvl, yoff + 8 * hbs,
+                if ((res = decode_superblock_mem(avctx, td, row, col + hbs, lflvl, yoff + 8 * hbs,
                                                  uvoff + 4 * hbs, bl + 1)) < 0)
                     return res;
                 yoff  += hbs * 8 * y_stride;
                 uvoff += hbs * 4 * uv_stride;
-                if ((res = decode_superblock_mem(avctx, row + hbs, col, lflvl, yoff,
+                if ((res = decode_superblock_mem(avctx, td, row + hbs, col, lflvl, yoff,
                                                  uvoff, bl + 1)) < 0)
                     return res;
-                res = decode_superblock_mem(avctx, row + hbs, col + hbs, lflvl,
+                res = decode_superblock_mem(avctx, td, row + hbs, col + hbs, lflvl,
                                             yoff + 8 * hbs, uvoff + 4 * hbs, bl + 1);
             } else {
                 yoff  += hbs * 8;
                 uvoff += hbs * 4;
-                res = decode_superblock_mem(avctx, row, col + hbs, lflvl, yoff, uvoff, bl + 1);
+                res = decode_superblock_mem(avctx, td, row, col + hbs, lflvl, yoff, uvoff, bl + 1);
             }
         } else if (row + hbs < s->rows) {
             yoff  += hbs * 8 * y_stride;
             uvoff += hbs * 4 * uv_stride;
-            res = decode_superblock_mem(avctx, row + hbs, col, lflvl, yoff, uvoff, bl + 1);
+            res = decode_superblock_mem(avctx, td, row + hbs, col, lflvl, yoff, uvoff, bl + 1);
         }
     }
 
@@ -1172,6 +1197,243 @@ static void set_tile_offset(int *start, int *end, int idx, int log2_n, int n)
     *end   = FFMIN(sb_end,   n) << 3;
 }
 
+static void init_tile_data(VP9Context *s, int tile_col)
+{
+    VP9TileData *td = &s->td[tile_col];
+    int b_idx, sb_idx;
+
+    td->s     = s;
+    td->error = 0;
+    set_tile_offset(&td->tile_col_start, &td->tile_col_end,
+                    tile_col, s->tiling.log2_tile_cols, s->sb_cols);
+    memset(&td->counts, 0, sizeof(td->counts));
+
+    /* With two pass decoding, the blocks of each tile column are stored in
+     * decoding order, after those of the tile columns on its left. */
+    if (s->uses_2pass) {
+        b_idx  = FFMIN(td->tile_col_start, s->cols) * s->rows;
+        sb_idx = (td->tile_col_start >> 3) * s->sb_rows;
+    } else {
+        b_idx = sb_idx = tile_col;
+    }
+    td->b          = s->b_base          + b_idx;
+    td->block      = s->block_base      + sb_idx * 64 * 64;
+    td->uvblock[0] = s->uvblock_base[0] + sb_idx * 32 * 32;
+    td->uvblock[1] = s->uvblock_base[1] + sb_idx * 32 * 32;
+    td->eob        = s->eob_base        + sb_idx * 256;
+    td->uveob[0]   = s->uveob_base[0]   + sb_idx * 64;
+    td->uveob[1]   = s->uveob_base[1]   + sb_idx * 64;
+}
+
+// decode one row of superblocks of a tile
+static int decode_tile_sbrow(AVCodecContext *avctx, VP9TileData *td, int row,
+                             VP9Filter *lflvl, ptrdiff_t yoff, ptrdiff_t uvoff)
+{
+    VP9Context *s = avctx->priv_data;
+    int col, ret;
+
+    memset(td->left_partition_ctx, 0, 8);
+    memset(td->left_skip_ctx, 0, 8);
+    if (s->keyframe || s->intraonly)
+        memset(td->left_mode_ctx, DC_PRED, 16);
+    else
+        memset(td->left_mode_ctx, NEARESTMV, 8);
+    memset(td->left_y_nnz_ctx, 0, 16);
+    memset(td->left_uv_nnz_ctx, 0, 16);
+    memset(td->left_segpred_ctx, 0, 8);
+
+    for (col = td->tile_col_start; col < td->tile_col_end;
+         col += 8, yoff += 64, uvoff += 32, lflvl++) {
+        // FIXME integrate with lf code (i.e. zero after each
+        // use, similar to invtxfm coefficients, or similar)
+        if (s->pass != 1)
+            memset(lflvl->mask, 0, sizeof(lflvl->mask));
+
+        if (s->pass == 2)
+            ret = decode_superblock_mem(avctx, td, row, col, lflvl,
+                                        yoff, uvoff, BL_64X64);
+        else
+            ret = decode_subblock(avctx, td, row, col, lflvl,
+                                  yoff, uvoff, BL_64X64);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+// backup pre-loopfilter reconstruction data for intra
+// prediction of next row of sb64s
+static void save_intra_pred_data(VP9Context *s, int row, int col_start,
+                                 int col_end, ptrdiff_t yoff, ptrdiff_t uvoff)
+{
+    AVFrame *f = s->frames[CUR_FRAME].tf.f;
+
+    col_end = FFMIN(col_end, s->cols);
+    if (row + 8 >= s->rows || col_start >= col_end)
+        return;
+
+    memcpy(s->intra_pred_data[0] + col_start * 8,
+           f->data[0] + yoff + 63 * f->linesize[0] + col_start * 8,
+           8 * (col_end - col_start));
+    memcpy(s->intra_pred_data[1] + col_start * 4,
+           f->data[1] + uvoff + 31 * f->linesize[1] + col_start * 4,
+           4 * (col_end - col_start));
+    memcpy(s->intra_pred_data[2] + col_start * 4,
+           f->data[2] + uvoff + 31 * f->linesize[2] + col_start * 4,
+           4 * (col_end - col_start));
+}
+
+static void loopfilter_sbrow(AVCodecContext *avctx, VP9Filter *lflvl,
+                             int row, ptrdiff_t yoff, ptrdiff_t uvoff)
+{
+    VP9Context *s = avctx->priv_data;
+    int col;
+
+    for (col = 0; col < s->cols;
+         col += 8, yoff += 64, uvoff += 32, lflvl++)
+        loopfilter_subblock(avctx, lflvl, row, col, yoff, uvoff);
+}
+
+static int decode_tiles(AVCodecContext *avctx)
+{
+    VP9Context *s = avctx->priv_data;
+    AVFrame    *f = s->frames[CUR_FRAME].tf.f;
+    ptrdiff_t yoff = 0, uvoff = 0;
+    int tile_row, tile_col, row, ret;
+
+    for (tile_row = 0; tile_row < s->tiling.tile_rows; tile_row++) {
+        set_tile_offset(&s->tiling.tile_row_start, &s->tiling.tile_row_end,
+                        tile_row, s->tiling.log2_tile_rows, s->sb_rows);
+
+        if (s->pass != 2)
+            for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++)
+                memcpy(&s->td[tile_col].c, &s->td[tile_col].c_b[tile_row],
+                       sizeof(s->td[tile_col].c));
+
+        for (row = s->tiling.tile_row_start;
+             row < s->tiling.tile_row_end;
+             row += 8, yoff += f->linesize[0] * 64,
+             uvoff += f->linesize[1] * 32) {
+            for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++) {
+                VP9TileData *td = &s->td[tile_col];
+
+                ret = decode_tile_sbrow(avctx, td, row,
+                                        s->lflvl + (td->tile_col_start >> 3),
+                                        yoff  + td->tile_col_start * 8,
+                                        uvoff + td->tile_col_start * 4);
+                if (ret < 0)
+                    return ret;
+            }
+
+            if (s->pass == 1)
+                continue;
+
+            save_intra_pred_data(s, row, 0, s->cols, yoff, uvoff);
+
+            // loopfilter one row
+            if (s->filter.level)
+                loopfilter_sbrow(avctx, s->lflvl, row, yoff, uvoff);
+
+            // FIXME maybe we can make this more finegrained by running the
+            // loopfilter per-block instead of after each sbrow
+            // In fact that would also make intra pred left preparation easier?
+            ff_thread_report_progress(&s->frames[CUR_FRAME].tf, row >> 3, 0);
+        }
+    }
+
+    return 0;
+}
+
+/* Decode all the rows of one tile column, reporting the number of
+ * superblock rows done to the loopfilter. */
+static void decode_tile_col_mt(AVCodecContext *avctx, VP9TileData *td,
+                               int tile_col)
+{
+    VP9Context *s = avctx->priv_data;
+    AVFrame    *f = s->frames[CUR_FRAME].tf.f;
+    int tile_row, row, row_start, row_end, ret;
+
+    for (tile_row = 0; tile_row < s->tiling.tile_rows; tile_row++) {
+        set_tile_offset(&row_start, &row_end,
+                        tile_row, s->tiling.log2_tile_rows, s->sb_rows);
+        memcpy(&td->c, &td->c_b[tile_row], sizeof(td->c));
+
+        for (row = row_start; row < row_end; row += 8) {
+            ptrdiff_t yoff  = (row >> 3) * f->linesize[0] * 64 +
+                              td->tile_col_start * 8;
+            ptrdiff_t uvoff = (row >> 3) * f->linesize[1] * 32 +
+                              td->tile_col_start * 4;
+            VP9Filter *lflvl = s->lflvl + (row >> 3) * s->sb_cols +
+                               (td->tile_col_start >> 3);
+
+            ret = decode_tile_sbrow(avctx, td, row, lflvl, yoff, uvoff);
+            if (ret < 0) {
+                td->error = ret;
+                ff_thread_report_slice_progress(avctx, tile_col, INT_MAX);
+                return;
+            }
+
+            save_intra_pred_data(s, row, td->tile_col_start, td->tile_col_end,
+                                 yoff  - td->tile_col_start * 8,
+                                 uvoff - td->tile_col_start * 4);
+
+            ff_thread_report_slice_progress(avctx, tile_col, (row >> 3) + 1);
+        }
+    }
+}
+
+/* Run the loopfilter one superblock row behind the slowest tile column. */
+static void loopfilter_mt(AVCodecContext *avctx)
+{
+    VP9Context *s = avctx->priv_data;
+    AVFrame    *f = s->frames[CUR_FRAME].tf.f;
+    int row, tile_col;
+
+    for (row = 0; row < s->rows; row += 8) {
+        for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++)
+            ff_thread_await_slice_progress(avctx, tile_col, (row >> 3) + 1);
+
+        if (s->filter.level)
+            loopfilter_sbrow(avctx, s->lflvl + (row >> 3) * s->sb_cols, row,
+                             (row >> 3) * f->linesize[0] * 64,
+                             (row >> 3) * f->linesize[1] * 32);
+
+        ff_thread_report_progress(&s->frames[CUR_FRAME].tf, row >> 3, 0);
+    }
+}
+
+/* The first jobs decode the tile columns and the last one runs the
+ * loopfilter. The jobs are started in order and the tile columns never wait
+ * for anything, so the loopfilter only blocks on jobs which are already
+ * running or done, even when there are fewer threads than jobs. */
+static int decode_tiles_mt(AVCodecContext *avctx, void *arg, int job, int thread)
+{
+    VP9Context *s = avctx->priv_data;
+
+    if (job == s->tiling.tile_cols)
+        loopfilter_mt(avctx);
+    else
+        decode_tile_col_mt(avctx, &s->td[job], job);
+
+    return 0;
+}
+
+// sum the symbol counts of all the tile columns for the probability adaptation
+static void merge_counts(VP9Context *s)
+{
+    unsigned *dst = (unsigned *)&s->counts;
+    int i, j;
+
+    memcpy(&s->counts, &s->td[0].counts, sizeof(s->counts));
+    for (i = 1; i < s->tiling.tile_cols; i++) {
+        const unsigned *src = (const unsigned *)&s->td[i].counts;
+
+        for (j = 0; j < sizeof(s->counts) / sizeof(*dst); j++)
+            dst[j] += src[j];
+    }
+}
+
 static int update_refs(AVCodecContext *avctx)
 {
     VP9Context *s = avctx->priv_data;
@@ -1196,7 +1458,7 @@ static int vp9_decode_frame(AVCodecContext *avctx, void *output,
     const uint8_t *data = pkt->data;
     int            size = pkt->size;
     AVFrame *f;
-    int ret, tile_row, tile_col, i, ref = -1, row, col;
+    int ret, tile_row, tile_col, i, ref = -1;
 
     s->setup_finished = 0;
 
@@ -1282,129 +1544,58 @@ static int vp9_decode_frame(AVCodecContext *avctx, void *output,
     memset(s->above_uv_nnz_ctx[1], 0, s->sb_cols * 8);
     memset(s->above_segpred_ctx, 0, s->cols);
 
-    do {
-        ptrdiff_t yoff = 0, uvoff = 0;
-        s->b          = s->b_base;
-        s->block      = s->block_base;
-        s->uvblock[0] = s->uvblock_base[0];
-        s->uvblock[1] = s->uvblock_base[1];
-        s->eob        = s->eob_base;
-        s->uveob[0]   = s->uveob_base[0];
-        s->uveob[1]   = s->uveob_base[1];
-
-        for (tile_row = 0; tile_row < s->tiling.tile_rows; tile_row++) {
-            set_tile_offset(&s->tiling.tile_row_start, &s->tiling.tile_row_end,
-                            tile_row, s->tiling.log2_tile_rows, s->sb_rows);
-
-            if (s->pass != 2) {
-                for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++) {
-                    int64_t tile_size;
-
-                    if (tile_col == s->tiling.tile_cols - 1 &&
-                        tile_row == s->tiling.tile_rows - 1) {
-                        tile_size = size;
-                    } else {
-                        tile_size = AV_RB32(data);
-                        data     += 4;
-                        size     -= 4;
-                    }
-                    if (tile_size > size) {
-                        ret = AVERROR_INVALIDDATA;
-                        goto fail;
-                    }
-                    ff_vp56_init_range_decoder(&s->c_b[tile_col], data, tile_size);
-                    if (vp56_rac_get_prob_branchy(&s->c_b[tile_col], 128)) { // marker bit
-                        ret = AVERROR_INVALIDDATA;
-                        goto fail;
-                    }
-                    data += tile_size;
-                    size -= tile_size;
-                }
+    for (tile_row = 0; tile_row < s->tiling.tile_rows; tile_row++) {
+        for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++) {
+            VP9TileData *td = &s->td[tile_col];
+            int64_t tile_size;
+
+            if (tile_col == s->tiling.tile_cols - 1 &&
+                tile_row == s->tiling.tile_rows - 1) {
+                tile_size = size;
+            } else {
+                tile_size = AV_RB32(data);
+                data     += 4;
+                size     -= 4;
             }
+            if (tile_size > size) {
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
+            ff_vp56_init_range_decoder(&td->c_b[tile_row], data, tile_size);
+            if (vp56_rac_get_prob_branchy(&td->c_b[tile_row], 128)) { // marker bit
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
+            data += tile_size;
+            size -= tile_size;
+        }
+    }
 
-            for (row = s->tiling.tile_row_start;
-                 row < s->tiling.tile_row_end;
-                 row += 8, yoff += f->linesize[0] * 64,
-                 uvoff += f->linesize[1] * 32) {
-                VP9Filter *lflvl = s->lflvl;
-                ptrdiff_t yoff2 = yoff, uvoff2 = uvoff;
-
-                for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++) {
-                    set_tile_offset(&s->tiling.tile_col_start,
-                                    &s->tiling.tile_col_end,
-                                    tile_col, s->tiling.log2_tile_cols, s->sb_cols);
-
-                    memset(s->left_partition_ctx, 0, 8);
-                    memset(s->left_skip_ctx, 0, 8);
-                    if (s->keyframe || s->intraonly)
-                        memset(s->left_mode_ctx, DC_PRED, 16);
-                    else
-                        memset(s->left_mode_ctx, NEARESTMV, 8);
-                    memset(s->left_y_nnz_ctx, 0, 16);
-                    memset(s->left_uv_nnz_ctx, 0, 16);
-                    memset(s->left_segpred_ctx, 0, 8);
-
-                    memcpy(&s->c, &s->c_b[tile_col], sizeof(s->c));
-                    for (col = s->tiling.tile_col_start;
-                         col < s->tiling.tile_col_end;
-                         col += 8, yoff2 += 64, uvoff2 += 32, lflvl++) {
-                        // FIXME integrate with lf code (i.e. zero after each
-                        // use, similar to invtxfm coefficients, or similar)
-                        if (s->pass != 1)
-                            memset(lflvl->mask, 0, sizeof(lflvl->mask));
-
-                        if (s->pass == 2) {
-                            ret = decode_superblock_mem(avctx, row, col, lflvl,
-                                                        yoff2, uvoff2, BL_64X64);
-                        } else {
-                            ret = decode_subblock(avctx, row, col, lflvl,
-                                                  yoff2, uvoff2, BL_64X64);
-                        }
-                        if (ret < 0)
-                            goto fail;
-                    }
-                    if (s->pass != 2)
-                        memcpy(&s->c_b[tile_col], &s->c, sizeof(s->c));
-                }
+    do {
+        for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++)
+            init_tile_data(s, tile_col);
 
-                if (s->pass == 1)
-                    continue;
-
-                // backup pre-loopfilter reconstruction data for intra
-                // prediction of next row of sb64s
-                if (row + 8 < s->rows) {
-                    memcpy(s->intra_pred_data[0],
-                           f->data[0] + yoff +
-                           63 * f->linesize[0],
-                           8 * s->cols);
-                    memcpy(s->intra_pred_data[1],
-                           f->data[1] + uvoff +
-                           31 * f->linesize[1],
-                           4 * s->cols);
-                    memcpy(s->intra_pred_data[2],
-                           f->data[2] + uvoff +
-                           31 * f->linesize[2],
-                           4 * s->cols);
-                }
+        if (avctx->active_thread_type & FF_THREAD_SLICE) {
+            ret = ff_thread_init_slice_progress(avctx, s->tiling.tile_cols);
+            if (ret < 0)
+                goto fail;
 
-                // loopfilter one row
-                if (s->filter.level) {
-                    yoff2  = yoff;
-                    uvoff2 = uvoff;
-                    lflvl  = s->lflvl;
-                    for (col = 0; col < s->cols;
-                         col += 8, yoff2 += 64, uvoff2 += 32, lflvl++)
-                        loopfilter_subblock(avctx, lflvl, row, col, yoff2, uvoff2);
-                }
+            avctx->execute2(avctx, decode_tiles_mt, NULL, NULL,
+                            s->tiling.tile_cols + 1);
 
-                // FIXME maybe we can make this more finegrained by running the
-                // loopfilter per-block instead of after each sbrow
-                // In fact that would also make intra pred left preparation easier?
-                ff_thread_report_progress(&s->frames[CUR_FRAME].tf, row >> 3, 0);
+            for (tile_col = 0; tile_col < s->tiling.tile_cols; tile_col++) {
+                ret = s->td[tile_col].error;
+                if (ret < 0)
+                    goto fail;
             }
+        } else {
+            ret = decode_tiles(avctx);
+            if (ret < 0)
+                goto fail;
         }
 
         if (s->pass < 2 && s->refreshctx && !s->parallelmode) {
+            merge_counts(s);
             ff_vp9_adapt_probs(s);
             if (avctx->active_thread_type & FF_THREAD_FRAME) {
                 ff_thread_finish_setup(avctx);
@@ -1450,10 +1641,11 @@ static av_cold int vp9_decode_free(AVCodecContext *avctx)
         av_frame_free(&s->refs[i].f);
     }
 
-    av_freep(&s->c_b);
     av_freep(&s->above_partition_ctx);
+    av_freep(&s->lflvl);
     av_freep(&s->b_base);
     av_freep(&s->block_base);
+    av_freep(&s->td);
 
     return 0;
 }
@@ -1544,7 +1736,8 @@ AVCodec ff_vp9_decoder = {
     .decode                = vp9_decode_frame,
     .flush                 = vp9_decode_flush,
     .close                 = vp9_decode_free,
-    .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS,
+    .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                             AV_CODEC_CAP_SLICE_THREADS,
     .init_thread_copy      = vp9_decode_init,
     .update_thread_context = vp9_decode_update_thread_context,
     .bsfs                  = "vp9_superframe_split",
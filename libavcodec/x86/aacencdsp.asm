@@ -0,0 +1,125 @@
+;******************************************************************************
+;* SIMD optimized AAC encoder DSP functions
+;*
+;* This file is part of Libav.
+;*
+;* Libav is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* Libav is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with Libav; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_0_4054:    times 4 dq 0.4054
+ps_abs_mask:  times 4 dd 0x7fffffff
+ps_neg_inf:   times 4 dd 0xff800000
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_aac_abs_pow34(float *out, const float *in, int size)
+;------------------------------------------------------------------------------
+INIT_XMM sse
+cglobal aac_abs_pow34, 3, 3, 3, out, in, size
+    movsxdifnidn sizeq, sized
+    mova         m2, [ps_abs_mask]
+    lea         inq, [inq  + sizeq * 4]
+    lea        outq, [outq + sizeq * 4]
+    neg       sizeq
+.loop:
+    movu         m0, [inq + sizeq * 4]
+    andps        m0, m2
+    sqrtps       m1, m0
+    mulps        m1, m0
+    sqrtps       m1, m1
+    movu [outq + sizeq * 4], m1
+    add       sizeq, 4
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_aac_quant_bands(int *out, const float *in, const float *scaled,
+;                         int size, float Q34, int is_signed, int maxval)
+;------------------------------------------------------------------------------
+%macro QUANT_BANDS 0
+%if UNIX64
+cglobal aac_quant_bands, 6, 6, 8, out, in, scaled, size, is_signed, maxval
+%else
+cglobal aac_quant_bands, 4, 4, 8, out, in, scaled, size, Q34, is_signed, maxval
+%endif
+%if UNIX64
+    cvtsi2sd    xm2, maxvald
+%else
+    movss       xm0, Q34m
+    cvtsi2sd    xm2, dword maxvalm
+%endif
+    shufps      xm0, xm0, 0
+    unpcklpd    xm2, xm2
+%if mmsize == 32
+    vinsertf128  m2, m2, xm2, 1
+%endif
+    mova         m1, [pd_0_4054]
+
+    ; the levels of the coefficients below this threshold are negated,
+    ; 0.0 for the signed codebooks and -inf for the unsigned ones
+    xorps       xm3, xm3
+%if UNIX64
+    test is_signedd, is_signedd
+%else
+    cmp dword is_signedm, 0
+%endif
+    jnz .signed
+    movaps      xm3, [ps_neg_inf]
+.signed:
+
+    movsxdifnidn sizeq, sized
+    lea         inq, [inq     + sizeq * 4]
+    lea     scaledq, [scaledq + sizeq * 4]
+    lea        outq, [outq    + sizeq * 4]
+    neg       sizeq
+.loop:
+    movu        xm4, [scaledq + sizeq * 4]
+    mulps       xm4, xm0
+%if mmsize == 32
+    cvtps2pd     m4, xm4
+    addpd        m4, m1
+    minpd        m6, m2, m4
+    cvttpd2dq   xm6, m6
+%else
+    cvtps2pd     m5, m4
+    movhlps      m4, m4
+    cvtps2pd     m4, m4
+    addpd        m5, m1
+    addpd        m4, m1
+    minpd        m6, m2, m5
+    minpd        m5, m2, m4
+    cvttpd2dq    m6, m6
+    cvttpd2dq    m5, m5
+    punpcklqdq   m6, m5
+%endif
+    movu        xm7, [inq + sizeq * 4]
+    cmpps       xm7, xm7, xm3, 1 ; in < threshold
+    pxor        xm6, xm7
+    psubd       xm6, xm7
+    movu [outq + sizeq * 4], xm6
+    add       sizeq, 4
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+QUANT_BANDS
+INIT_YMM avx
+QUANT_BANDS
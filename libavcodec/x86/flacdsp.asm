@@ -0,0 +1,230 @@
+;******************************************************************************
+;* SIMD optimized FLAC DSP functions
+;*
+;* This file is part of Libav.
+;*
+;* Libav is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* Libav is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with Libav; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_flac_lpc_encode_16(int32_t *res, const int32_t *smp, int len,
+;                            int order, const int32_t *coefs, int shift)
+;------------------------------------------------------------------------------
+; mmsize / 4 consecutive residuals are computed at once, the coefficients are
+; broadcast to the stack beforehand, in the order of the samples they multiply
+%macro LPC_ENCODE_16 0
+cglobal flac_lpc_encode_16, 6, 7, 4, -32 * mmsize, res, smp, len, order, coefs, shift, j
+    movd        xm3, shiftd
+    movsxdifnidn orderq, orderd
+    movsxdifnidn lenq, lend
+
+    ; the first order residuals are the samples themselves
+    xor          jq, jq
+.warmup:
+    mov      shiftd, [smpq + jq * 4]
+    mov [resq + jq * 4], shiftd
+    inc          jq
+    cmp          jq, orderq
+    jl .warmup
+
+    lea          jq, [orderq - 1]
+    mov      shiftq, rsp
+.coefs:
+%if cpuflag(avx2)
+    vpbroadcastd m0, [coefsq + jq * 4]
+%else
+    movd         m0, [coefsq + jq * 4]
+    pshufd       m0, m0, 0
+%endif
+    mova   [shiftq], m0
+    add      shiftq, mmsize
+    dec          jq
+    jge .coefs
+
+    sub        lenq, orderq
+    jle .end
+    lea        smpq, [smpq + orderq * 4]
+    lea        resq, [resq + orderq * 4]
+    shl      orderq, 2
+    neg      orderq
+    sub        lenq, mmsize / 4
+    jl .tail
+
+.loop:
+    pxor         m0, m0
+    mov      coefsq, rsp
+    mov          jq, orderq
+.loop_coefs:
+    movu         m1, [smpq + jq]
+    pmulld       m1, [coefsq]
+    paddd        m0, m1
+    add      coefsq, mmsize
+    add          jq, 4
+    jl .loop_coefs
+    movu         m1, [smpq]
+    psrad        m0, xm3
+    psubd        m1, m0
+    movu     [resq], m1
+    add        smpq, mmsize
+    add        resq, mmsize
+    sub        lenq, mmsize / 4
+    jge .loop
+
+.tail:
+    add        lenq, mmsize / 4
+    jz .end
+.tail_loop:
+    pxor        xm0, xm0
+    mov      coefsq, rsp
+    mov          jq, orderq
+.tail_coefs:
+    movd        xm1, [smpq + jq]
+    pmulld      xm1, [coefsq]
+    paddd       xm0, xm1
+    add      coefsq, mmsize
+    add          jq, 4
+    jl .tail_coefs
+    movd        xm1, [smpq]
+    psrad       xm0, xm3
+    psubd       xm1, xm0
+    movd     [resq], xm1
+    add        smpq, 4
+    add        resq, 4
+    dec        lenq
+    jnz .tail_loop
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse4
+LPC_ENCODE_16
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+LPC_ENCODE_16
+%endif
+
+;------------------------------------------------------------------------------
+; void ff_flac_decorrelate_<mode>_<bits>(uint8_t **out, int32_t **in,
+;                                        int channels, int len, int shift)
+;------------------------------------------------------------------------------
+; the stereo modes only, on interleaved output
+
+; decorrelate m0 (left or mid) and m1 (right or side), the left and right
+; samples end up in mL and mR, xL is the xmm register of mL
+%macro DECORRELATE_STEREO 1
+%ifidn %1, ls
+    psubd        m2, m0, m1
+    %xdefine mL m0
+    %xdefine mR m2
+    %xdefine xL xm0
+%elifidn %1, rs
+    paddd        m0, m1
+    %xdefine mL m0
+    %xdefine mR m1
+    %xdefine xL xm0
+%else ; ms
+    psrad        m2, m1, 1
+    psubd        m0, m2
+    paddd        m2, m1, m0
+    %xdefine mL m2
+    %xdefine mR m0
+    %xdefine xL xm2
+%endif
+%endmacro
+
+; for 16 bits, m3 is shift + 16, the left sample ends up truncated in the low
+; half of each dword and the right one in the high half
+%macro STORE_16 2 ; dst, full vector
+    pslld        mL, xm3
+    pslld        mR, xm3
+    psrld        mL, 16
+    por          mL, mR
+%if %2
+    movu       [%1], mL
+%else
+    movd       [%1], xL
+%endif
+%endmacro
+
+%macro STORE_32 2 ; dst, full vector
+    pslld        mL, xm3
+    pslld        mR, xm3
+%if %2
+    punpckhdq    m4, mL, mR
+    punpckldq    mL, mR
+    movu [%1 + mmsize], m4
+    movu       [%1], mL
+%else
+    punpckldq    mL, mR
+    movq       [%1], xL
+%endif
+%endmacro
+
+%macro DECORRELATE 2 ; mode, bits
+%assign pair_size %2 / 4
+cglobal flac_decorrelate_%1_%2, 5, 5, 5, out, in0, in1, len, shift
+%if %2 == 16
+    add      shiftd, 16
+%endif
+    movd        xm3, shiftd
+    mov        in1q, [in0q + gprsize]
+    mov        in0q, [in0q]
+    mov        outq, [outq]
+    movsxdifnidn lenq, lend
+    lea        in0q, [in0q + lenq * 4]
+    lea        in1q, [in1q + lenq * 4]
+    lea        outq, [outq + lenq * pair_size]
+    neg        lenq
+    add        lenq, mmsize / 4
+    jg .tail
+.loop:
+    movu         m0, [in0q + lenq * 4 - mmsize]
+    movu         m1, [in1q + lenq * 4 - mmsize]
+    DECORRELATE_STEREO %1
+    STORE_%2 outq + lenq * pair_size - mmsize * pair_size / 4, 1
+    add        lenq, mmsize / 4
+    jle .loop
+.tail:
+    sub        lenq, mmsize / 4
+    jz .end
+.tail_loop:
+    movd        xm0, [in0q + lenq * 4]
+    movd        xm1, [in1q + lenq * 4]
+    DECORRELATE_STEREO %1
+    STORE_%2 outq + lenq * pair_size, 0
+    inc        lenq
+    jl .tail_loop
+.end:
+    RET
+%endmacro
+
+%macro DECORRELATE_FUNCS 1 ; bits
+DECORRELATE ls, %1
+DECORRELATE rs, %1
+DECORRELATE ms, %1
+%endmacro
+
+INIT_XMM sse2
+DECORRELATE_FUNCS 16
+DECORRELATE_FUNCS 32
+; the 32-bit versions are limited by the stores
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DECORRELATE_FUNCS 16
+%endif
@@ -0,0 +1,77 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/flacdsp.h"
+
+void ff_flac_lpc_encode_16_sse4(int32_t *res, const int32_t *smp, int len,
+                                int order, const int32_t *coefs, int shift);
+void ff_flac_lpc_encode_16_avx2(int32_t *res, const int32_t *smp, int len,
+                                int order, const int32_t *coefs, int shift);
+
+#define DECORRELATE_FUNC(mode, bits, opt)                               \
+void ff_flac_decorrelate_ ## mode ## _ ## bits ## _ ## opt(uint8_t **out,   \
+                                                           int32_t **in,    \
+                                                           int channels,    \
+                                                           int len,         \
+                                                           int shift);
+
+#define DECORRELATE_FUNCS(bits, opt)                                        \
+    DECORRELATE_FUNC(ls, bits, opt)                                         \
+    DECORRELATE_FUNC(rs, bits, opt)                                         \
+    DECORRELATE_FUNC(ms, bits, opt)
+
+DECORRELATE_FUNCS(16, sse2)
+DECORRELATE_FUNCS(32, sse2)
+DECORRELATE_FUNCS(16, avx2)
+
+#define SET_DECORRELATE(bits, opt)                                          \
+    do {                                                                    \
+        c->decorrelate[1] = ff_flac_decorrelate_ls_ ## bits ## _ ## opt;    \
+        c->decorrelate[2] = ff_flac_decorrelate_rs_ ## bits ## _ ## opt;    \
+        c->decorrelate[3] = ff_flac_decorrelate_ms_ ## bits ## _ ## opt;    \
+    } while (0)
+
+av_cold void ff_flacdsp_init_x86(FLACDSPContext *c, enum AVSampleFormat fmt,
+                                 int bps)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    /* the left, right and mid/side modes are always stereo, the independent
+     * mode keeps the C version for any number of channels; the decoder LPC
+     * keeps it too, as each sample depends on the previous one */
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        if (fmt == AV_SAMPLE_FMT_S16)
+            SET_DECORRELATE(16, sse2);
+        else if (fmt == AV_SAMPLE_FMT_S32)
+            SET_DECORRELATE(32, sse2);
+    }
+
+    if (EXTERNAL_SSE4(cpu_flags) && bps <= 16)
+        c->lpc_encode = ff_flac_lpc_encode_16_sse4;
+
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        if (fmt == AV_SAMPLE_FMT_S16)
+            SET_DECORRELATE(16, avx2);
+        if (bps <= 16)
+            c->lpc_encode = ff_flac_lpc_encode_16_avx2;
+    }
+}
@@ -0,0 +1,397 @@
+; *****************************************************************************
+; * SIMD optimized intra prediction functions for HEVC decoding
+; *
+; * This file is part of Libav.
+; *
+; * Libav is free software; you can redistribute it and/or
+; * modify it under the terms of the GNU Lesser General Public
+; * License as published by the Free Software Foundation; either
+; * version 2.1 of the License, or (at your option) any later version.
+; *
+; * Libav is distributed in the hope that it will be useful,
+; * but WITHOUT ANY WARRANTY; without even the implied warranty of
+; * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+; * Lesser General Public License for more details.
+; *
+; * You should have received a copy of the GNU Lesser General Public
+; * License along with Libav; if not, write to the Free Software
+; * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+; ******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_1024:  times 16 dw 1024
+pw_1to32: dw  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16
+          dw 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32
+
+cextern pw_4
+cextern pw_8
+cextern pw_16
+cextern pw_32
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; splat the pixel at address %2 into all the words of %1, clobbers tmpd
+%macro SPLAT_PIXEL 3 ; dst, address, bit depth
+%if %3 > 8
+    movzx           tmpd, word [%2]
+%else
+    movzx           tmpd, byte [%2]
+%endif
+    movd              %1, tmpd
+    SPLATW            %1, %1
+%endmacro
+
+; planar prediction, computed in blocks of 8 columns
+;   acc(x, y)  = (size - 1 - y) * top[x] + (y + 1) * left[size] + (x + 1) * top[size] + size
+;   dst(x, y)  = (acc(x, y) + (size - 1 - x) * left[y]) >> (log2(size) + 1)
+; acc is updated by adding left[size] - top[x] for every row.
+
+; void ff_hevc_pred_planar_<size>_<depth>_sse2(uint8_t *src, const uint8_t *top,
+;                                              const uint8_t *left, ptrdiff_t stride)
+%macro PRED_PLANAR 3 ; size, log2(size) + 1, bit depth
+cglobal hevc_pred_planar_%1_%3, 4, 9, 8, src, top, left, stride, cnt, tmp, dst, tbl, cx
+%assign PS (%3 + 7) / 8
+%if %3 > 8
+    add          strideq, strideq
+%endif
+    SPLAT_PIXEL       m6, leftq + %1 * PS, %3
+    SPLAT_PIXEL       m5, topq  + %1 * PS, %3
+    mova              m4, [pw_%1]
+    pxor              m7, m7
+    lea             tblq, [pw_1to32]
+    xor              cxd, cxd
+.col_loop:
+    movu              m3, [tblq + cxq * 2]      ; x + 1
+    psubw             m2, m4, m3                ; size - 1 - x
+    pmullw            m3, m5
+%if %3 > 8
+%if %1 == 4
+    movq              m1, [topq + cxq * PS]
+%else
+    movu              m1, [topq + cxq * PS]
+%endif
+%else
+%if %1 == 4
+    movd              m1, [topq + cxq]
+%else
+    movq              m1, [topq + cxq]
+%endif
+    punpcklbw         m1, m7
+%endif
+    pmullw            m0, m1, m4
+    psubw             m0, m1
+    paddw             m0, m6
+    paddw             m0, m3
+    paddw             m0, m4
+    mova              m3, m6
+    psubw             m3, m1                    ; left[size] - top[x]
+
+    lea             dstq, [srcq + cxq * PS]
+    xor             cntd, cntd
+.row_loop:
+    SPLAT_PIXEL       m1, leftq + cntq * PS, %3
+    pmullw            m1, m2
+    paddw             m1, m0
+    psrlw             m1, %2
+%if %3 > 8
+%if %1 == 4
+    movq          [dstq], m1
+%else
+    movu          [dstq], m1
+%endif
+%else
+    packuswb          m1, m1
+%if %1 == 4
+    movd          [dstq], m1
+%else
+    movq          [dstq], m1
+%endif
+%endif
+    paddw             m0, m3
+    add             dstq, strideq
+    inc             cntd
+    cmp             cntd, %1
+    jl .row_loop
+
+    add              cxd, 8
+    cmp              cxd, %1
+    jl .col_loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+PRED_PLANAR  4, 3,  8
+PRED_PLANAR  8, 4,  8
+PRED_PLANAR 16, 5,  8
+PRED_PLANAR 32, 6,  8
+PRED_PLANAR  4, 3, 10
+PRED_PLANAR  8, 4, 10
+PRED_PLANAR 16, 5, 10
+PRED_PLANAR 32, 6, 10
+
+; The angular kernels only do the interpolation along the main reference
+; array: the C wrappers build the reference (including the projection of
+; the side array for negative angles) and apply the edge filters of the
+; pure horizontal and vertical modes.
+;
+; void ff_hevc_pred_angular_{v,h}_<size>_<depth>_<opt>(uint8_t *src, ptrdiff_t stride,
+;                                                     const uint8_t *ref, int angle)
+;
+; ref points to the sample preceding the first one of the main reference,
+; stride is in bytes. ref[1 + (size * angle >> 5) + size] is loaded by the
+; last row, which is past the 2 * size samples of the reference for an
+; angle of 32: the wrappers do not call the kernels for that angle.
+
+; load the weights for position posd into all the words of m%1
+; 8 bit:  (fact << 8) | (32 - fact), for pmaddubsw
+; 10 bit: fact << 10, for pmulhrsw
+%macro ANGULAR_WEIGHT 2 ; dst register, bit depth
+    mov            factd, posd
+    and            factd, 31
+%if %2 > 8
+    shl            factd, 10
+%else
+    imul           factd, 255
+    add            factd, 32
+%endif
+    imul           factd, 0x10001
+    movd            xm%1, factd
+%if cpuflag(avx2)
+    vpbroadcastd     m%1, xm%1
+%else
+    pshufd           m%1, m%1, 0
+%endif
+%endmacro
+
+%macro ANGULAR_IDX 0
+    mov             idxd, posd
+    sar             idxd, 5
+    movsxd          idxq, idxd
+%endmacro
+
+; interpolate %1 pixels of one row from refq + idxq into srcq + %2
+; in: m4 weights, m5 pw_1024 (8 bit)
+%macro ANGULAR_ROW 3 ; width, byte offset, bit depth
+%if %3 > 8
+%if %1 == 4
+    movq              m0, [refq + idxq * 2 + 2]
+    movq              m1, [refq + idxq * 2 + 4]
+%else
+    movu              m0, [refq + idxq * 2 + %2 + 2]
+    movu              m1, [refq + idxq * 2 + %2 + 4]
+%endif
+    psubw             m1, m0
+    pmulhrsw          m1, m4
+    paddw             m0, m1
+%if %1 == 4
+    movq          [srcq], m0
+%else
+    movu     [srcq + %2], m0
+%endif
+%elif %1 <= 8
+%if %1 == 4
+    movd              m0, [refq + idxq + 1]
+    movd              m1, [refq + idxq + 2]
+%else
+    movq              m0, [refq + idxq + 1]
+    movq              m1, [refq + idxq + 2]
+%endif
+    punpcklbw         m0, m1
+    pmaddubsw         m0, m4
+    pmulhrsw          m0, m5
+    packuswb          m0, m0
+%if %1 == 4
+    movd          [srcq], m0
+%else
+    movq          [srcq], m0
+%endif
+%else
+    movu              m0, [refq + idxq + %2 + 1]
+    movu              m1, [refq + idxq + %2 + 2]
+    punpckhbw         m2, m0, m1
+    punpcklbw         m0, m1
+    pmaddubsw         m0, m4
+    pmaddubsw         m2, m4
+    pmulhrsw          m0, m5
+    pmulhrsw          m2, m5
+    packuswb          m0, m2
+    movu     [srcq + %2], m0
+%endif
+%endmacro
+
+; modes 18 to 34: the reference is the top row, prediction is done row by row
+%macro PRED_ANGULAR_V 2 ; size, bit depth
+cglobal hevc_pred_angular_v_%1_%2, 4, 8, 6, src, stride, ref, angle, pos, idx, fact, cnt
+%assign PS (%2 + 7) / 8
+%if %2 == 8
+    mova              m5, [pw_1024]
+%endif
+    mov             posd, angled
+    mov             cntd, %1
+.loop:
+    ANGULAR_IDX
+    ANGULAR_WEIGHT     4, %2
+%if %1 * PS < mmsize
+    ANGULAR_ROW       %1, 0, %2
+%else
+%assign %%off 0
+%rep %1 * PS / mmsize
+    ANGULAR_ROW       mmsize / PS, %%off, %2
+%assign %%off %%off + mmsize
+%endrep
+%endif
+    add             srcq, strideq
+    add             posd, angled
+    dec             cntd
+    jg .loop
+    RET
+%endmacro
+
+; compute one column of the block into m%1, ready to be transposed
+%macro ANGULAR_COL 3 ; dst register, height, bit depth
+    ANGULAR_IDX
+    ANGULAR_WEIGHT     8, %3
+%if %3 > 8
+%if %2 == 4
+    movq             m%1, [refq + idxq * 2 + 2]
+    movq              m9, [refq + idxq * 2 + 4]
+%else
+    movu             m%1, [refq + idxq * 2 + 2]
+    movu              m9, [refq + idxq * 2 + 4]
+%endif
+    psubw             m9, m%1
+    pmulhrsw          m9, m8
+    paddw            m%1, m9
+%else
+%if %2 == 4
+    movd             m%1, [refq + idxq + 1]
+    movd              m9, [refq + idxq + 2]
+%else
+    movq             m%1, [refq + idxq + 1]
+    movq              m9, [refq + idxq + 2]
+%endif
+    punpcklbw        m%1, m9
+    pmaddubsw        m%1, m8
+    pmulhrsw         m%1, m10
+%endif
+    add             posd, angled
+%endmacro
+
+; modes 2 to 17: the reference is the left column, prediction is done
+; column by column in blocks of 8x8 which are then transposed
+%macro PRED_ANGULAR_H 2 ; size, bit depth
+cglobal hevc_pred_angular_h_%1_%2, 4, 10, 11, src, stride, ref, angle, pos, idx, fact, dst, cntx, cnty
+%assign PS (%2 + 7) / 8
+%if %2 == 8
+    mova             m10, [pw_1024]
+%endif
+%if %1 == 4
+    mov             posd, angled
+    ANGULAR_COL        0, 4, %2
+    ANGULAR_COL        1, 4, %2
+    ANGULAR_COL        2, 4, %2
+    ANGULAR_COL        3, 4, %2
+    punpcklwd         m0, m1
+    punpcklwd         m2, m3
+    punpckhdq         m1, m0, m2
+    punpckldq         m0, m2
+    lea             dstq, [srcq + strideq * 2]
+%if %2 > 8
+    movq          [srcq], m0
+    movhps        [srcq + strideq], m0
+    movq          [dstq], m1
+    movhps        [dstq + strideq], m1
+%else
+    packuswb          m0, m1
+    movd          [srcq], m0
+    psrldq            m0, 4
+    movd          [srcq + strideq], m0
+    psrldq            m0, 4
+    movd          [dstq], m0
+    psrldq            m0, 4
+    movd          [dstq + strideq], m0
+%endif
+%else
+    mov            cntyd, %1 / 8
+.tile_row:
+    mov             posd, angled
+    mov             dstq, srcq
+    mov            cntxd, %1 / 8
+.tile:
+    ANGULAR_COL        0, 8, %2
+    ANGULAR_COL        1, 8, %2
+    ANGULAR_COL        2, 8, %2
+    ANGULAR_COL        3, 8, %2
+    ANGULAR_COL        4, 8, %2
+    ANGULAR_COL        5, 8, %2
+    ANGULAR_COL        6, 8, %2
+    ANGULAR_COL        7, 8, %2
+    TRANSPOSE8x8W      0, 1, 2, 3, 4, 5, 6, 7, 8
+    lea            factq, [strideq * 3]
+    lea             idxq, [dstq + strideq * 4]
+%if %2 > 8
+    movu          [dstq], m0
+    movu          [dstq + strideq], m1
+    movu          [dstq + strideq * 2], m2
+    movu          [dstq + factq], m3
+    movu          [idxq], m4
+    movu          [idxq + strideq], m5
+    movu          [idxq + strideq * 2], m6
+    movu          [idxq + factq], m7
+%else
+    packuswb          m0, m1
+    packuswb          m2, m3
+    packuswb          m4, m5
+    packuswb          m6, m7
+    movq          [dstq], m0
+    movhps        [dstq + strideq], m0
+    movq          [dstq + strideq * 2], m2
+    movhps        [dstq + factq], m2
+    movq          [idxq], m4
+    movhps        [idxq + strideq], m4
+    movq          [idxq + strideq * 2], m6
+    movhps        [idxq + factq], m6
+%endif
+    add             dstq, 8 * PS
+    dec            cntxd
+    jg .tile
+
+    lea             srcq, [srcq + strideq * 8]
+    add             refq, 8 * PS
+    dec            cntyd
+    jg .tile_row
+%endif
+    RET
+%endmacro
+
+INIT_XMM ssse3
+PRED_ANGULAR_V  4,  8
+PRED_ANGULAR_V  8,  8
+PRED_ANGULAR_V 16,  8
+PRED_ANGULAR_V 32,  8
+PRED_ANGULAR_V  4, 10
+PRED_ANGULAR_V  8, 10
+PRED_ANGULAR_V 16, 10
+PRED_ANGULAR_V 32, 10
+PRED_ANGULAR_H  4,  8
+PRED_ANGULAR_H  8,  8
+PRED_ANGULAR_H 16,  8
+PRED_ANGULAR_H 32,  8
+PRED_ANGULAR_H  4, 10
+PRED_ANGULAR_H  8, 10
+PRED_ANGULAR_H 16, 10
+PRED_ANGULAR_H 32, 10
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+PRED_ANGULAR_V 32,  8
+PRED_ANGULAR_V 16, 10
+PRED_ANGULAR_V 32, 10
+%endif ;HAVE_AVX2_EXTERNAL
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,315 @@
+; *****************************************************************************
+; * SIMD optimized SAO functions for HEVC decoding
+; *
+; * This file is part of Libav.
+; *
+; * Libav is free software; you can redistribute it and/or
+; * modify it under the terms of the GNU Lesser General Public
+; * License as published by the Free Software Foundation; either
+; * version 2.1 of the License, or (at your option) any later version.
+; *
+; * Libav is distributed in the hope that it will be useful,
+; * but WITHOUT ANY WARRANTY; without even the implied warranty of
+; * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+; * Lesser General Public License for more details.
+; *
+; * You should have received a copy of the GNU Lesser General Public
+; * License along with Libav; if not, write to the Free Software
+; * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+; ******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pb_2:     times 32 db 2
+pb_31:    times 32 db 31
+pw_1023:  times 16 dw 1023
+pw_514:   times 16 dw 0x0202
+pw_1284:  times 16 dw 0x0504
+
+; neighbour positions for each eo class: dx0, dy0, dx1, dy1
+sao_edge_pos: db -1,  0,  1,  0
+              db  0, -1,  0,  1
+              db -1, -1,  1,  1
+              db  1, -1, -1,  1
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; broadcast the dword in a general purpose register to all the dwords of m%1
+%macro SPLATD_GPR 2 ; dst register number, src gpr
+    movd          xm%1, %2
+%if cpuflag(avx2)
+    vpbroadcastd   m%1, xm%1
+%else
+    pshufd         m%1, m%1, 0
+%endif
+%endmacro
+
+; store the leftmost tmpd bytes of m%1 to [dstq + xq], clobbers m%1, xq and tmpd
+%macro STORE_PARTIAL 1
+%if mmsize == 32
+    cmp            tmpd, 16
+    jl .store8
+    movu  [dstq + xq], xm%1
+    vextracti128  xm%1, m%1, 1
+    add              xq, 16
+    sub            tmpd, 16
+.store8:
+%endif
+    cmp            tmpd, 8
+    jl .store4
+    movq  [dstq + xq], xm%1
+    psrldq        xm%1, 8
+    add              xq, 8
+    sub            tmpd, 8
+.store4:
+    cmp            tmpd, 4
+    jl .store2
+    movd  [dstq + xq], xm%1
+    psrldq        xm%1, 4
+    add              xq, 4
+    sub            tmpd, 4
+.store2:
+    cmp            tmpd, 2
+    movd          leftd, xm%1
+    jl .store1
+    mov   [dstq + xq], leftw
+    shr           leftd, 16
+    add              xq, 2
+    sub            tmpd, 2
+.store1:
+    cmp            tmpd, 1
+    jl .stored
+    mov   [dstq + xq], leftb
+.stored:
+%endmacro
+
+; the per row loop shared by the band and edge filters, width is in bytes
+; and the filtered vector is expected in m%1
+%macro SAO_STORE 1
+    lea            tmpd, [xq + mmsize]
+    cmp            tmpd, widthd
+    jg .tail
+    movu  [dstq + xq], m%1
+    add              xq, mmsize
+    cmp              xd, widthd
+    jl .loop_x
+    jmp .next_row
+.tail:
+    mov            tmpd, widthd
+    sub            tmpd, xd
+    STORE_PARTIAL    %1
+.next_row:
+%endmacro
+
+; put the band index (left_class + %2) & 31 and the matching offset into
+; all the pixels of m%3 and m%4 respectively
+%macro SAO_BAND_SPLAT 4 ; bit depth, band, index register, offset register
+    lea            tmpd, [leftq + %2]
+    and            tmpd, 31
+%if %1 > 8
+    imul           tmpd, 0x10001
+    SPLATD_GPR       %3, tmpd
+    movzx          tmpd, word [offsetq + 4 * (%2 + 1)]
+    imul           tmpd, 0x10001
+%else
+    imul           tmpd, 0x1010101
+    SPLATD_GPR       %3, tmpd
+    movzx          tmpd, byte [offsetq + 4 * (%2 + 1)]
+    imul           tmpd, 0x1010101
+%endif
+    SPLATD_GPR       %4, tmpd
+%endmacro
+
+; void ff_hevc_sao_band_filter_<depth>_<opt>(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+;                                           int *sao_offset_val, int sao_left_class,
+;                                           int width, int height)
+%macro SAO_BAND_FILTER 1 ; bit depth
+cglobal hevc_sao_band_filter_%1, 7, 9, 14, dst, src, stride, offset, left, width, height, x, tmp
+    SAO_BAND_SPLAT   %1, 0, 0, 4
+    SAO_BAND_SPLAT   %1, 1, 1, 5
+    SAO_BAND_SPLAT   %1, 2, 2, 6
+    SAO_BAND_SPLAT   %1, 3, 3, 7
+    pxor             m8, m8
+%if %1 > 8
+    mova             m9, [pw_1023]
+    add          widthd, widthd
+%else
+    mova             m9, [pb_31]
+%endif
+
+.loop_y:
+    xor              xd, xd
+.loop_x:
+    movu            m10, [srcq + xq]
+%if %1 > 8
+    psrlw           m11, m10, %1 - 5
+    pcmpeqw         m12, m11, m0
+    pand            m12, m4
+    pcmpeqw         m13, m11, m1
+    pand            m13, m5
+    por             m12, m13
+    pcmpeqw         m13, m11, m2
+    pand            m13, m6
+    por             m12, m13
+    pcmpeqw         m13, m11, m3
+    pand            m13, m7
+    por             m12, m13
+    paddw           m10, m12
+    pmaxsw          m10, m8
+    pminsw          m10, m9
+%else
+    ; the band index of every byte is (src >> 3) & 31, the bits shifted in
+    ; from the neighbouring byte are masked out
+    psrlw           m11, m10, 3
+    pand            m11, m9
+    pcmpeqb         m12, m11, m0
+    pand            m12, m4
+    pcmpeqb         m13, m11, m1
+    pand            m13, m5
+    por             m12, m13
+    pcmpeqb         m13, m11, m2
+    pand            m13, m6
+    por             m12, m13
+    pcmpeqb         m13, m11, m3
+    pand            m13, m7
+    por             m12, m13
+    ; add the signed offsets as words
+    punpckhbw       m13, m10, m8
+    punpcklbw       m10, m8
+    punpckhbw       m11, m12, m12
+    punpcklbw       m12, m12
+    psraw           m11, 8
+    psraw           m12, 8
+    paddw           m10, m12
+    paddw           m13, m11
+    packuswb        m10, m13
+%endif
+    SAO_STORE        10
+    add            dstq, strideq
+    add            srcq, strideq
+    dec         heightd
+    jg .loop_y
+    RET
+%endmacro
+
+; m%1 = sign(m%2 - m%3), clobbers m%3
+%macro SAO_SIGN 4 ; dst, a, b, bit depth
+%if %4 > 8
+    pcmpgtw         m%1, m%2, m%3
+    pcmpgtw         m%3, m%2
+    psubw           m%3, m%1
+    SWAP             %1, %3
+%else
+    psubusb         m%1, m%2, m%3
+    psubusb         m%3, m%2
+    pcmpeqb         m%1, m2
+    pcmpeqb         m%3, m2
+    psubb           m%1, m%3
+%endif
+%endmacro
+
+; void ff_hevc_sao_edge_filter_<depth>_<opt>(uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+;                                           int *sao_offset_val, int sao_eo_class,
+;                                           int width, int height)
+%macro SAO_EDGE_FILTER 1 ; bit depth
+cglobal hevc_sao_edge_filter_%1, 7, 12, 8, dst, src, stride, offset, left, width, height, x, tmp, src0, src1, pos
+    ; offset lookup table indexed by 2 + sign0 + sign1, the entries are
+    ; sao_offset_val[1], [2], [0], [3] and [4]
+    pxor             m0, m0
+    pinsrw          xm0, [offsetq + 4], 0
+    pinsrw          xm0, [offsetq + 8], 1
+    pinsrw          xm0, [offsetq + 0], 2
+    pinsrw          xm0, [offsetq + 12], 3
+    pinsrw          xm0, [offsetq + 16], 4
+%if %1 == 8
+    packsswb        xm0, xm0
+%endif
+%if mmsize == 32
+    vinserti128      m0, m0, xm0, 1
+%endif
+
+    ; the eo class is passed in the left argument register
+    movsxdifnidn  leftq, leftd
+    lea            posq, [sao_edge_pos]
+    movsx         src0q, byte [posq + leftq * 4 + 1]
+    movsx         src1q, byte [posq + leftq * 4 + 3]
+    imul          src0q, strideq
+    imul          src1q, strideq
+    movsx           xq, byte [posq + leftq * 4 + 0]
+    movsx          tmpq, byte [posq + leftq * 4 + 2]
+%if %1 > 8
+    add              xq, xq
+    add            tmpq, tmpq
+    add          widthd, widthd
+    mova             m1, [pw_1023]
+%else
+    mova             m1, [pb_2]
+%endif
+    add           src0q, xq
+    add           src1q, tmpq
+    add           src0q, srcq
+    add           src1q, srcq
+    pxor             m2, m2
+
+.loop_y:
+    xor              xd, xd
+.loop_x:
+    movu             m3, [srcq  + xq]
+    movu             m4, [src0q + xq]
+    movu             m5, [src1q + xq]
+    SAO_SIGN          6, 3, 4, %1
+    SAO_SIGN          7, 3, 5, %1
+%if %1 > 8
+    paddw            m6, m7
+    ; turn 2 + sign0 + sign1 into the byte pair of the matching table word
+    pmullw           m6, [pw_514]
+    paddw            m6, [pw_1284]
+    pshufb           m7, m0, m6
+    paddw            m3, m7
+    pmaxsw           m3, m2
+    pminsw           m3, m1
+%else
+    paddb            m6, m7
+    paddb            m6, m1
+    pshufb           m7, m0, m6
+    punpckhbw        m5, m3, m2
+    punpcklbw        m3, m2
+    punpckhbw        m6, m7, m7
+    punpcklbw        m7, m7
+    psraw            m6, 8
+    psraw            m7, 8
+    paddw            m3, m7
+    paddw            m5, m6
+    packuswb         m3, m5
+%endif
+    SAO_STORE         3
+    add            dstq, strideq
+    add            srcq, strideq
+    add           src0q, strideq
+    add           src1q, strideq
+    dec         heightd
+    jg .loop_y
+    RET
+%endmacro
+
+INIT_XMM sse2
+SAO_BAND_FILTER 8
+SAO_BAND_FILTER 10
+
+INIT_XMM ssse3
+SAO_EDGE_FILTER 8
+SAO_EDGE_FILTER 10
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SAO_BAND_FILTER 8
+SAO_BAND_FILTER 10
+SAO_EDGE_FILTER 8
+SAO_EDGE_FILTER 10
+%endif ;HAVE_AVX2_EXTERNAL
+
+%endif ; ARCH_X86_64
@@ -110,6 +110,19 @@ void ff_hevc_add_residual_32_10_sse2(uint8_t *dst, int16_t *res, ptrdiff_t strid
 void ff_hevc_add_residual_16_10_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
 void ff_hevc_add_residual_32_10_avx2(uint8_t *dst, int16_t *res, ptrdiff_t stride);
 
+#define SAO_FUNCS(depth, band_opt, edge_opt)                                                     \
+void ff_hevc_sao_band_filter_ ## depth ## _ ## band_opt(uint8_t *dst, uint8_t *src,              \
+                                                        ptrdiff_t stride, int *sao_offset_val,   \
+                                                        int sao_left_class, int width, int height); \
+void ff_hevc_sao_edge_filter_ ## depth ## _ ## edge_opt(uint8_t *dst, uint8_t *src,              \
+                                                        ptrdiff_t stride, int *sao_offset_val,   \
+                                                        int sao_eo_class, int width, int height);
+
+SAO_FUNCS(8,  sse2, ssse3)
+SAO_FUNCS(10, sse2, ssse3)
+SAO_FUNCS(8,  avx2, avx2)
+SAO_FUNCS(10, avx2, avx2)
+
 #define GET_PIXELS(width, depth, cf)                                                                      \
 void ff_hevc_get_pixels_ ## width ## _ ## depth ## _ ## cf(int16_t *dst, ptrdiff_t dststride,             \
                                                            uint8_t *src, ptrdiff_t srcstride,             \
@@ -384,10 +397,14 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
         if (EXTERNAL_SSE2(cpu_flags)) {
             c->idct[2] = ff_hevc_idct_16x16_8_sse2;
             c->idct[3] = ff_hevc_idct_32x32_8_sse2;
+
+            c->sao_band_filter = ff_hevc_sao_band_filter_8_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags)) {
             c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_8_ssse3;
             c->hevc_h_loop_filter_luma = ff_hevc_h_loop_filter_luma_8_ssse3;
+
+            c->sao_edge_filter = ff_hevc_sao_edge_filter_8_ssse3;
         }
 
         if (EXTERNAL_SSE4(cpu_flags)) {
@@ -408,15 +425,22 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
         if (EXTERNAL_AVX2(cpu_flags)) {
             c->idct_dc[2] = ff_hevc_idct_16x16_dc_8_avx2;
             c->idct_dc[3] = ff_hevc_idct_32x32_dc_8_avx2;
+
+            c->sao_band_filter = ff_hevc_sao_band_filter_8_avx2;
+            c->sao_edge_filter = ff_hevc_sao_edge_filter_8_avx2;
         }
     } else if (bit_depth == 10) {
         if (EXTERNAL_SSE2(cpu_flags)) {
             c->idct[2] = ff_hevc_idct_16x16_10_sse2;
             c->idct[3] = ff_hevc_idct_32x32_10_sse2;
+
+            c->sao_band_filter = ff_hevc_sao_band_filter_10_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags)) {
             c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_10_ssse3;
             c->hevc_h_loop_filter_luma = ff_hevc_h_loop_filter_luma_10_ssse3;
+
+            c->sao_edge_filter = ff_hevc_sao_edge_filter_10_ssse3;
         }
         if (EXTERNAL_SSE4(cpu_flags)) {
             SET_LUMA_FUNCS(weighted_pred,              ff_hevc_put_weighted_pred,     10, sse4);
@@ -439,6 +463,9 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
         if (EXTERNAL_AVX2(cpu_flags)) {
             c->idct_dc[2] = ff_hevc_idct_16x16_dc_10_avx2;
             c->idct_dc[3] = ff_hevc_idct_32x32_dc_10_avx2;
+
+            c->sao_band_filter = ff_hevc_sao_band_filter_10_avx2;
+            c->sao_edge_filter = ff_hevc_sao_edge_filter_10_avx2;
         }
     }
 #endif /* ARCH_X86_64 */
@@ -0,0 +1,248 @@
+/*
+ * HEVC intra prediction, x86 SIMD
+ *
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+
+#include "libavcodec/hevcdec.h"
+
+#define PRED_PLANAR_FUNCS(depth, opt)                                                   \
+void ff_hevc_pred_planar_4_  ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,     \
+                                                  const uint8_t *left, ptrdiff_t stride); \
+void ff_hevc_pred_planar_8_  ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,     \
+                                                  const uint8_t *left, ptrdiff_t stride); \
+void ff_hevc_pred_planar_16_ ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,     \
+                                                  const uint8_t *left, ptrdiff_t stride); \
+void ff_hevc_pred_planar_32_ ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,     \
+                                                  const uint8_t *left, ptrdiff_t stride);
+
+PRED_PLANAR_FUNCS(8,  sse2)
+PRED_PLANAR_FUNCS(10, sse2)
+
+#define PRED_ANGULAR_KERNEL(dir, size, depth, opt)                                        \
+void ff_hevc_pred_angular_ ## dir ## _ ## size ## _ ## depth ## _ ## opt(uint8_t *src,    \
+                                                                        ptrdiff_t stride, \
+                                                                        const uint8_t *ref, \
+                                                                        int angle);
+
+#define PRED_ANGULAR_KERNELS(depth, opt)      \
+    PRED_ANGULAR_KERNEL(v, 4,  depth, opt)    \
+    PRED_ANGULAR_KERNEL(v, 8,  depth, opt)    \
+    PRED_ANGULAR_KERNEL(v, 16, depth, opt)    \
+    PRED_ANGULAR_KERNEL(v, 32, depth, opt)    \
+    PRED_ANGULAR_KERNEL(h, 4,  depth, opt)    \
+    PRED_ANGULAR_KERNEL(h, 8,  depth, opt)    \
+    PRED_ANGULAR_KERNEL(h, 16, depth, opt)    \
+    PRED_ANGULAR_KERNEL(h, 32, depth, opt)
+
+PRED_ANGULAR_KERNELS(8,  ssse3)
+PRED_ANGULAR_KERNELS(10, ssse3)
+
+PRED_ANGULAR_KERNEL(v, 32, 8,  avx2)
+PRED_ANGULAR_KERNEL(v, 16, 10, avx2)
+PRED_ANGULAR_KERNEL(v, 32, 10, avx2)
+
+#if ARCH_X86_64 && HAVE_SSSE3_EXTERNAL
+typedef void (*angular_kernel)(uint8_t *src, ptrdiff_t stride,
+                               const uint8_t *ref, int angle);
+
+static const int8_t intra_pred_angle[] = {
+     32,  26,  21,  17, 13,  9,  5, 2, 0, -2, -5, -9, -13, -17, -21, -26, -32,
+    -26, -21, -17, -13, -9, -5, -2, 0, 2,  5,  9, 13,  17,  21,  26,  32
+};
+
+static const int16_t inv_angle[] = {
+    -4096, -1638, -910, -630, -482, -390, -315, -256, -315, -390, -482,
+    -630, -910, -1638, -4096
+};
+
+static av_always_inline int get_pixel(const uint8_t *buf, int idx, int high)
+{
+    return high ? ((const uint16_t *)buf)[idx] : buf[idx];
+}
+
+static av_always_inline void put_pixel(uint8_t *buf, int idx, int val, int high)
+{
+    if (high)
+        ((uint16_t *)buf)[idx] = val;
+    else
+        buf[idx] = val;
+}
+
+/* Same as the C pred_angular(), with the interpolation done by the kernels. */
+static av_always_inline void pred_angular(uint8_t *src, const uint8_t *top,
+                                          const uint8_t *left, ptrdiff_t stride,
+                                          int c_idx, int mode, int size,
+                                          int bit_depth, angular_kernel ver,
+                                          angular_kernel hor)
+{
+    const int high = bit_depth > 8;
+    int angle      = intra_pred_angle[mode - 2];
+    int last       = (size * angle) >> 5;
+    uint16_t ref_array[3 * MAX_TB_SIZE + 1];
+    uint8_t *ref_tmp = (uint8_t *)ref_array + (size << high);
+    const uint8_t *ref;
+    int x, y;
+
+    stride <<= high;
+
+    /* Modes 2 and 34 are plain diagonal copies of the reference. The
+     * kernels would load the sample following the reference, with a weight
+     * of 0, on their last row. */
+    if (angle == 32) {
+        const uint8_t *diag = mode == 2 ? left : top;
+
+        for (y = 0; y < size; y++)
+            memcpy(src + y * stride, diag + ((y + 1) << high), size << high);
+        return;
+    }
+
+    if (mode >= 18) {
+        ref = top - (1 << high);
+        if (angle < 0 && last < -1) {
+            memcpy(ref_tmp, ref, (size + 1) << high);
+            for (x = last; x <= -1; x++)
+                put_pixel(ref_tmp, x,
+                          get_pixel(left, -1 + ((x * inv_angle[mode - 11] + 128) >> 8), high),
+                          high);
+            ref = ref_tmp;
+        }
+
+        ver(src, stride, ref, angle);
+
+        if (mode == 26 && c_idx == 0 && size < 32) {
+            for (y = 0; y < size; y++)
+                put_pixel(src + y * stride, 0,
+                          av_clip_uintp2(get_pixel(top, 0, high) +
+                                         ((get_pixel(left, y, high) -
+                                           get_pixel(left, -1, high)) >> 1),
+                                         bit_depth),
+                          high);
+        }
+    } else {
+        ref = left - (1 << high);
+        if (angle < 0 && last < -1) {
+            memcpy(ref_tmp, ref, (size + 1) << high);
+            for (x = last; x <= -1; x++)
+                put_pixel(ref_tmp, x,
+                          get_pixel(top, -1 + ((x * inv_angle[mode - 11] + 128) >> 8), high),
+                          high);
+            ref = ref_tmp;
+        }
+
+        hor(src, stride, ref, angle);
+
+        if (mode == 10 && c_idx == 0 && size < 32) {
+            for (x = 0; x < size; x++)
+                put_pixel(src, x,
+                          av_clip_uintp2(get_pixel(left, 0, high) +
+                                         ((get_pixel(top, x, high) -
+                                           get_pixel(top, -1, high)) >> 1),
+                                         bit_depth),
+                          high);
+        }
+    }
+}
+
+#define PRED_ANGULAR(size, depth, opt, vopt, hopt)                                      \
+static void pred_angular_ ## size ## _ ## depth ## _ ## opt(uint8_t *src,               \
+                                                            const uint8_t *top,         \
+                                                            const uint8_t *left,        \
+                                                            ptrdiff_t stride,           \
+                                                            int c_idx, int mode)        \
+{                                                                                       \
+    pred_angular(src, top, left, stride, c_idx, mode, size, depth,                      \
+                 ff_hevc_pred_angular_v_ ## size ## _ ## depth ## _ ## vopt,            \
+                 ff_hevc_pred_angular_h_ ## size ## _ ## depth ## _ ## hopt);           \
+}
+
+PRED_ANGULAR(4,  8,  ssse3, ssse3, ssse3)
+PRED_ANGULAR(8,  8,  ssse3, ssse3, ssse3)
+PRED_ANGULAR(16, 8,  ssse3, ssse3, ssse3)
+PRED_ANGULAR(32, 8,  ssse3, ssse3, ssse3)
+PRED_ANGULAR(4,  10, ssse3, ssse3, ssse3)
+PRED_ANGULAR(8,  10, ssse3, ssse3, ssse3)
+PRED_ANGULAR(16, 10, ssse3, ssse3, ssse3)
+PRED_ANGULAR(32, 10, ssse3, ssse3, ssse3)
+
+#if HAVE_AVX2_EXTERNAL
+PRED_ANGULAR(32, 8,  avx2,  avx2,  ssse3)
+PRED_ANGULAR(16, 10, avx2,  avx2,  ssse3)
+PRED_ANGULAR(32, 10, avx2,  avx2,  ssse3)
+#endif /* HAVE_AVX2_EXTERNAL */
+#endif /* ARCH_X86_64 && HAVE_SSSE3_EXTERNAL */
+
+av_cold void ff_hevc_pred_init_x86(HEVCPredContext *hpc, int bit_depth)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if ARCH_X86_64
+    if (bit_depth == 8) {
+        if (EXTERNAL_SSE2(cpu_flags)) {
+            hpc->pred_planar[0] = ff_hevc_pred_planar_4_8_sse2;
+            hpc->pred_planar[1] = ff_hevc_pred_planar_8_8_sse2;
+            hpc->pred_planar[2] = ff_hevc_pred_planar_16_8_sse2;
+            hpc->pred_planar[3] = ff_hevc_pred_planar_32_8_sse2;
+        }
+#if HAVE_SSSE3_EXTERNAL
+        if (EXTERNAL_SSSE3(cpu_flags)) {
+            hpc->pred_angular[0] = pred_angular_4_8_ssse3;
+            hpc->pred_angular[1] = pred_angular_8_8_ssse3;
+            hpc->pred_angular[2] = pred_angular_16_8_ssse3;
+            hpc->pred_angular[3] = pred_angular_32_8_ssse3;
+        }
+#endif /* HAVE_SSSE3_EXTERNAL */
+#if HAVE_AVX2_EXTERNAL
+        if (EXTERNAL_AVX2(cpu_flags)) {
+            hpc->pred_angular[3] = pred_angular_32_8_avx2;
+        }
+#endif /* HAVE_AVX2_EXTERNAL */
+    } else if (bit_depth == 10) {
+        if (EXTERNAL_SSE2(cpu_flags)) {
+            hpc->pred_planar[0] = ff_hevc_pred_planar_4_10_sse2;
+            hpc->pred_planar[1] = ff_hevc_pred_planar_8_10_sse2;
+            hpc->pred_planar[2] = ff_hevc_pred_planar_16_10_sse2;
+            hpc->pred_planar[3] = ff_hevc_pred_planar_32_10_sse2;
+        }
+#if HAVE_SSSE3_EXTERNAL
+        if (EXTERNAL_SSSE3(cpu_flags)) {
+            hpc->pred_angular[0] = pred_angular_4_10_ssse3;
+            hpc->pred_angular[1] = pred_angular_8_10_ssse3;
+            hpc->pred_angular[2] = pred_angular_16_10_ssse3;
+            hpc->pred_angular[3] = pred_angular_32_10_ssse3;
+        }
+#endif /* HAVE_SSSE3_EXTERNAL */
+#if HAVE_AVX2_EXTERNAL
+        if (EXTERNAL_AVX2(cpu_flags)) {
+            hpc->pred_angular[2] = pred_angular_16_10_avx2;
+            hpc->pred_angular[3] = pred_angular_32_10_avx2;
+        }
+#endif /* HAVE_AVX2_EXTERNAL */
+    }
+#endif /* ARCH_X86_64 */
+}
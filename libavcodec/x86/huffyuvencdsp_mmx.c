@@ -35,21 +35,23 @@ static void diff_bytes_mmx(uint8_t *dst, uint8_t *src1, uint8_t *src2, int w)
 {
     x86_reg i = 0;
 
-    __asm__ volatile (
-        "1:                             \n\t"
-        "movq  (%2, %0), %%mm0          \n\t"
-        "movq  (%1, %0), %%mm1          \n\t"
-        "psubb %%mm0, %%mm1             \n\t"
-        "movq %%mm1, (%3, %0)           \n\t"
-        "movq 8(%2, %0), %%mm0          \n\t"
-        "movq 8(%1, %0), %%mm1          \n\t"
-        "psubb %%mm0, %%mm1             \n\t"
-        "movq %%mm1, 8(%3, %0)          \n\t"
-        "add $16, %0                    \n\t"
-        "cmp %4, %0                     \n\t"
-        " jb 1b                         \n\t"
-        : "+r" (i)
-        : "r" (src1), "r" (src2), "r" (dst), "r" ((x86_reg) w - 15));
+    if (w >= 16) {
+        __asm__ volatile (
+            "1:                             \n\t"
+            "movq  (%2, %0), %%mm0          \n\t"
+            "movq  (%1, %0), %%mm1          \n\t"
+            "psubb %%mm0, %%mm1             \n\t"
+            "movq %%mm1, (%3, %0)           \n\t"
+            "movq 8(%2, %0), %%mm0          \n\t"
+            "movq 8(%1, %0), %%mm1          \n\t"
+            "psubb %%mm0, %%mm1             \n\t"
+            "movq %%mm1, 8(%3, %0)          \n\t"
+            "add $16, %0                    \n\t"
+            "cmp %4, %0                     \n\t"
+            " jb 1b                         \n\t"
+            : "+r" (i)
+            : "r" (src1), "r" (src2), "r" (dst), "r" ((x86_reg) w - 15));
+    }
 
     for (; i < w; i++)
         dst[i + 0] = src1[i + 0] - src2[i + 0];
@@ -334,3 +334,217 @@ cglobal sse16, 5, 5, 8
     paddd     m7, m1
     movd     eax, m7         ; return value
     RET
+
+%if HAVE_AVX2_EXTERNAL
+; %1 = destination register number, two rows of 16 pixels
+%macro LOAD16x2 3
+    movu          xm%1, %2
+    vinserti128    m%1, m%1, %3, 1
+%endmacro
+
+; %1 = destination register number, %2 = temporary, four rows of 8 pixels
+%macro LOAD8x4 6
+    movq          xm%1, %3
+    movq          xm%2, %5
+    movhps        xm%1, %4
+    movhps        xm%2, %6
+    vinserti128    m%1, m%1, xm%2, 1
+%endmacro
+
+; %1 = destination register number, %2 = temporary, 16 pixels of each block
+%macro DIFF_PIXELS_16 4
+    pmovzxbw       m%1, %3
+    pmovzxbw       m%2, %4
+    psubw          m%1, m%2
+%endmacro
+
+INIT_YMM avx2
+; int ff_sad16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+;                   ptrdiff_t stride, int h);
+cglobal sad16, 5, 5, 5
+    lea           r0, [r3*3]
+    pxor          m0, m0
+
+.next4lines:
+    LOAD16x2       1, [r1     ], [r1+r3]
+    LOAD16x2       2, [r1+r3*2], [r1+r0]
+    LOAD16x2       3, [r2     ], [r2+r3]
+    LOAD16x2       4, [r2+r3*2], [r2+r0]
+    psadbw        m1, m3
+    psadbw        m2, m4
+    lea           r1, [r1+r3*4]
+    lea           r2, [r2+r3*4]
+    paddd         m0, m1
+    paddd         m0, m2
+    sub          r4d, 4
+    jg .next4lines
+
+    vextracti128 xm1, m0, 1
+    paddd        xm0, xm1
+    movhlps      xm1, xm0
+    paddd        xm0, xm1
+    movd         eax, xm0
+    RET
+
+; int ff_sse16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+;                   ptrdiff_t stride, int h);
+cglobal sse16, 5, 5, 7
+    lea           r0, [r3*3]
+    pxor          m0, m0         ; m0 holds the sum
+    pxor          m6, m6
+
+.next4lines:
+    LOAD16x2       1, [r1     ], [r1+r3]
+    LOAD16x2       2, [r1+r3*2], [r1+r0]
+    LOAD16x2       3, [r2     ], [r2+r3]
+    LOAD16x2       4, [r2+r3*2], [r2+r0]
+
+    ; absolute differences, zero-extended to words and squared
+    psubusb       m5, m1, m3
+    psubusb       m3, m1
+    por           m3, m5
+    psubusb       m5, m2, m4
+    psubusb       m4, m2
+    por           m4, m5
+
+    punpckhbw     m1, m3, m6
+    punpcklbw     m3, m6
+    punpckhbw     m2, m4, m6
+    punpcklbw     m4, m6
+    pmaddwd       m1, m1
+    pmaddwd       m3, m3
+    pmaddwd       m2, m2
+    pmaddwd       m4, m4
+
+    lea           r1, [r1+r3*4]
+    lea           r2, [r2+r3*4]
+
+    paddd         m1, m3
+    paddd         m2, m4
+    paddd         m0, m1
+    paddd         m0, m2
+
+    sub          r4d, 4
+    jg .next4lines
+
+    vextracti128 xm1, m0, 1
+    paddd        xm0, xm1
+    movhlps      xm1, xm0
+    paddd        xm0, xm1
+    pshuflw      xm1, xm0, q0032
+    paddd        xm0, xm1
+    movd         eax, xm0
+    RET
+
+%if ARCH_X86_64
+; %1 = width, %2 = candidate index, %3 = candidate pointer
+%macro SAD_X4_ROWS 3
+%if %1 == 16
+    LOAD16x2       6, [%3          ], [%3+strideq ]
+    LOAD16x2       7, [%3+strideq*2], [%3+stride3q]
+    psadbw        m6, m4
+    psadbw        m7, m5
+    paddd        m%2, m6
+    paddd        m%2, m7
+%else
+    LOAD8x4        6, 7, [%3], [%3+strideq], [%3+strideq*2], [%3+stride3q]
+    psadbw        m6, m4
+    paddd        m%2, m6
+%endif
+    lea           %3, [%3+strideq*4]
+%endmacro
+
+; void ff_sad16_x4_avx2(uint8_t *src, uint8_t *const ref[4], ptrdiff_t stride,
+;                       int h, int scores[4]);
+; void ff_sad8_x4_avx2(uint8_t *src, uint8_t *const ref[4], ptrdiff_t stride,
+;                      int h, int scores[4]);
+%macro SAD_X4 1
+cglobal sad%1_x4, 5, 9, 8, src, ref, stride, h, scores, ref0, ref1, ref2, ref3
+    mov        ref0q, [refq+gprsize*0]
+    mov        ref1q, [refq+gprsize*1]
+    mov        ref2q, [refq+gprsize*2]
+    mov        ref3q, [refq+gprsize*3]
+    DEFINE_ARGS src, stride3, stride, h, scores, ref0, ref1, ref2, ref3
+    lea     stride3q, [strideq*3]
+    pxor          m0, m0
+    pxor          m1, m1
+    pxor          m2, m2
+    pxor          m3, m3
+
+.next4lines:
+%if %1 == 16
+    LOAD16x2       4, [srcq          ], [srcq+strideq ]
+    LOAD16x2       5, [srcq+strideq*2], [srcq+stride3q]
+%else
+    LOAD8x4        4, 5, [srcq], [srcq+strideq], [srcq+strideq*2], [srcq+stride3q]
+%endif
+    SAD_X4_ROWS   %1, 0, ref0q
+    SAD_X4_ROWS   %1, 1, ref1q
+    SAD_X4_ROWS   %1, 2, ref2q
+    SAD_X4_ROWS   %1, 3, ref3q
+    lea         srcq, [srcq+strideq*4]
+    sub           hd, 4
+    jg .next4lines
+
+    ; each qword holds a partial sum, interleave them as dwords
+    ; and add the halves to get one sum per candidate
+    psllq         m1, 32
+    psllq         m3, 32
+    por           m0, m1
+    por           m2, m3
+    vextracti128 xm1, m0, 1
+    vextracti128 xm3, m2, 1
+    paddd        xm0, xm1
+    paddd        xm2, xm3
+    punpcklqdq   xm1, xm0, xm2
+    punpckhqdq   xm0, xm2
+    paddd        xm0, xm1
+    movu   [scoresq], xm0
+    RET
+%endmacro
+
+SAD_X4 16
+SAD_X4 8
+
+; int ff_hadamard8_diff16_avx2(MpegEncContext *s, uint8_t *src1,
+;                              uint8_t *src2, ptrdiff_t stride, int h);
+; the left and right 8x8 blocks are transformed in the two lanes, each
+; block sum saturating like in the 8x8 functions above
+cglobal hadamard8_diff16, 5, 7, 10
+    lea           r0, [r3*3]
+    xor          r5d, r5d
+
+.next8lines:
+    DIFF_PIXELS_16 0, 8, [r1     ], [r2     ]
+    DIFF_PIXELS_16 1, 8, [r1+r3  ], [r2+r3  ]
+    DIFF_PIXELS_16 2, 8, [r1+r3*2], [r2+r3*2]
+    DIFF_PIXELS_16 3, 8, [r1+r0  ], [r2+r0  ]
+    lea           r1, [r1+r3*4]
+    lea           r2, [r2+r3*4]
+    DIFF_PIXELS_16 4, 8, [r1     ], [r2     ]
+    DIFF_PIXELS_16 5, 8, [r1+r3  ], [r2+r3  ]
+    DIFF_PIXELS_16 6, 8, [r1+r3*2], [r2+r3*2]
+    DIFF_PIXELS_16 7, 8, [r1+r0  ], [r2+r0  ]
+    lea           r1, [r1+r3*4]
+    lea           r2, [r2+r3*4]
+
+    HADAMARD8
+    TRANSPOSE8x8W  0, 1, 2, 3, 4, 5, 6, 7, 8
+    HADAMARD8
+    ABS_SUM_8x8_64 0
+
+    vextracti128 xm1, m0, 1
+    HSUM         xm0, xm2, r6d
+    movzx        r6d, r6w
+    add          r5d, r6d
+    HSUM         xm1, xm2, r6d
+    movzx        r6d, r6w
+    add          r5d, r6d
+
+    sub          r4d, 8
+    jg .next8lines
+
+    mov          eax, r5d
+    RET
+%endif ; ARCH_X86_64
+%endif ; HAVE_AVX2_EXTERNAL
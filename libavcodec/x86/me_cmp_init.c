@@ -1229,6 +1229,17 @@ hadamard_func(mmxext)
 hadamard_func(sse2)
 hadamard_func(ssse3)
 
+int ff_sad16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+                  ptrdiff_t stride, int h);
+int ff_sse16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+                  ptrdiff_t stride, int h);
+int ff_hadamard8_diff16_avx2(MpegEncContext *s, uint8_t *src1,
+                             uint8_t *src2, ptrdiff_t stride, int h);
+void ff_sad16_x4_avx2(uint8_t *src, uint8_t *const ref[4], ptrdiff_t stride,
+                      int h, int scores[4]);
+void ff_sad8_x4_avx2(uint8_t *src, uint8_t *const ref[4], ptrdiff_t stride,
+                     int h, int scores[4]);
+
 av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
 {
     int cpu_flags = av_get_cpu_flags();
@@ -1322,4 +1333,16 @@ av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
         c->hadamard8_diff[0] = ff_hadamard8_diff16_ssse3;
         c->hadamard8_diff[1] = ff_hadamard8_diff_ssse3;
     }
+
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        c->sad[0] = ff_sad16_avx2;
+        c->sse[0] = ff_sse16_avx2;
+
+#if ARCH_X86_64
+        c->hadamard8_diff[0] = ff_hadamard8_diff16_avx2;
+
+        c->sad_x4[0] = ff_sad16_x4_avx2;
+        c->sad_x4[1] = ff_sad8_x4_avx2;
+#endif
+    }
 }
@@ -93,3 +93,163 @@ cglobal pix_norm1, 2, 4
     movd        eax, m1
     RET
 
+
+%if ARCH_X86_64
+
+; broadcast a 32-bit general purpose register to all the dwords of a register
+%macro SPLATD_GPR 2 ; dst, src
+    movd           xm%1, %2
+%if cpuflag(avx2)
+    vpbroadcastd    m%1, xm%1
+%else
+    pshufd          m%1, m%1, 0
+%endif
+%endmacro
+
+%macro TRELLIS_LEVELS 0
+; int ff_trellis_levels(int level[2][64], int count[64], int *max,
+;                       const int16_t *block, const int *qmat,
+;                       int bias, int shift, const uint8_t *scantable, int start)
+; the whole block is processed
+cglobal trellis_levels, 9, 10, 13, level, count, max, block, qmat, bias, shift, scan, start
+    movd           xm3, shiftd
+    SPLATD_GPR      2, biasd
+    pcmpeqd         m0, m0
+    psrld           m0, 31                  ; 1
+    paddd           m1, m0, m0              ; 2
+    ; threshold1 = (1 << shift) - bias - 1, threshold2 = threshold1 << 1,
+    ; offset by 1 << 31 to do the unsigned comparison with pcmpgtd
+    pslld           m4, m0, xm3
+    psubd           m4, m2
+    psubd           m4, m0
+    pslld           m5, m4, 1
+    pcmpeqd         m7, m7
+    pslld           m7, 31
+    pxor            m4, m7
+    pxor            m5, m7
+    pxor            m6, m6                  ; max
+    xor            r9d, r9d
+.loop:
+    pmovsxwd        m8, [blockq+r9*2]
+    movu            m9, [qmatq+r9*4]
+    pmulld          m8, m9                  ; block * qmat
+    paddd           m9, m8, m4
+    pcmpgtd         m9, m5                  ; outside of the dead zone
+    psrad          m10, m8, 31
+    por            m10, m0                  ; sign
+    pabsd           m8, m8
+    paddd           m8, m2
+    psrad           m8, xm3
+    pand            m8, m9
+    por             m6, m8
+    pandn          m11, m9, m0
+    por             m8, m11                 ; |level|, 1 in the dead zone
+    pminsd         m11, m8, m1
+    pand           m11, m9
+    psignd         m12, m8, m10
+    psubd           m8, m0
+    psignd          m8, m10
+    movu [levelq+r9*4], m12
+    movu [levelq+r9*4+256], m8
+    movu [countq+r9*4], m11
+    add             r9, mmsize/4
+    cmp             r9, 64
+    jl .loop
+%if mmsize == 32
+    vextracti128   xm7, m6, 1
+    por            xm6, xm7
+%endif
+    pshufd         xm7, xm6, q1032
+    por            xm6, xm7
+    pshufd         xm7, xm6, q2301
+    por            xm6, xm7
+    movd        [maxq], xm6
+    movd           r9d, xm6
+    ; last coefficient outside of the dead zone in scan order
+    mov            eax, startd
+    dec            eax
+    test           r9d, r9d
+    jz .end
+    mov            eax, 63
+.scan:
+    movzx          r9d, byte [scanq+rax]
+    cmp dword [countq+r9*4], 0
+    jne .end
+    dec            eax
+    cmp            eax, startd
+    jge .scan
+.end:
+    RET
+%endmacro
+
+%macro TRELLIS_DISTORTION 1 ; odd
+; void ff_trellis_distortion[_odd](int dist[2][64], const int level[64],
+;                                  const int16_t *block,
+;                                  const uint16_t *dct_scale,
+;                                  const uint16_t *matrix,
+;                                  int mul, int add, int shift,
+;                                  const uint8_t *scantable,
+;                                  int start, int last)
+; the whole block is processed, scantable, start and last are not used
+%if %1
+cglobal trellis_distortion_odd, 8, 9, 10, dist, level, block, scale, matrix, mul, add, shift
+%else
+cglobal trellis_distortion, 8, 9, 10, dist, level, block, scale, matrix, mul, add, shift
+%endif
+    SPLATD_GPR      0, muld
+    SPLATD_GPR      1, addd
+    movd           xm2, shiftd
+    pcmpeqd         m3, m3
+    psrld           m3, 31                  ; 1
+    xor            r8d, r8d
+.loop:
+    pmovsxwd        m4, [blockq+r8*2]
+    pmovzxwd        m5, [scaleq+r8*2]
+    pabsd           m4, m4
+    pmulld          m4, m5
+    psrad           m4, 12
+    paddd           m4, m4                  ; 2 * |coefficient|
+    pmovzxwd        m5, [matrixq+r8*2]
+    movu            m6, [levelq+r8*4]
+    pabsd           m6, m6
+    pmulld          m6, m0
+    paddd           m6, m1                  ; |level| * mul + add
+    psubd           m7, m6, m0              ; (|level| - 1) * mul + add
+    pmulld          m6, m5
+    pmulld          m7, m5
+    psrad           m6, xm2
+    psrad           m7, xm2
+%if %1
+    psubd           m6, m3
+    psubd           m7, m3
+    por             m6, m3
+    por             m7, m3
+    pslld           m6, 3
+    pslld           m7, 3
+%endif
+    ; (u - c)^2 - c^2 = u * (u - 2 * c)
+    psubd           m8, m6, m4
+    psubd           m9, m7, m4
+    pmulld          m6, m8
+    pmulld          m7, m9
+    movu [distq+r8*4], m6
+    movu [distq+r8*4+256], m7
+    add             r8, mmsize/4
+    cmp             r8, 64
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+TRELLIS_LEVELS
+TRELLIS_DISTORTION 0
+TRELLIS_DISTORTION 1
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+TRELLIS_LEVELS
+TRELLIS_DISTORTION 0
+TRELLIS_DISTORTION 1
+%endif
+
+%endif ; ARCH_X86_64
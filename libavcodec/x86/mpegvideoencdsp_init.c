@@ -25,6 +25,29 @@
 int ff_pix_sum16_mmx(uint8_t *pix, int line_size);
 int ff_pix_norm1_mmx(uint8_t *pix, int line_size);
 
+#define TRELLIS_FUNCS(opt)                                                   \
+int ff_trellis_levels_ ## opt(int level[2][64], int count[64], int *max,     \
+                              const int16_t *block, const int *qmat,         \
+                              int bias, int shift,                           \
+                              const uint8_t *scantable, int start);          \
+void ff_trellis_distortion_ ## opt(int dist[2][64], const int level[64],     \
+                                   const int16_t *block,                     \
+                                   const uint16_t *dct_scale,                \
+                                   const uint16_t *matrix,                   \
+                                   int mul, int add, int shift,              \
+                                   const uint8_t *scantable,                 \
+                                   int start, int last);                     \
+void ff_trellis_distortion_odd_ ## opt(int dist[2][64], const int level[64], \
+                                       const int16_t *block,                 \
+                                       const uint16_t *dct_scale,            \
+                                       const uint16_t *matrix,               \
+                                       int mul, int add, int shift,          \
+                                       const uint8_t *scantable,             \
+                                       int start, int last);
+
+TRELLIS_FUNCS(sse4)
+TRELLIS_FUNCS(avx2)
+
 #if HAVE_INLINE_ASM
 
 #define PHADDD(a, t)                            \
@@ -200,6 +223,20 @@ av_cold void ff_mpegvideoencdsp_init_x86(MpegvideoEncDSPContext *c,
         c->pix_norm1 = ff_pix_norm1_mmx;
     }
 
+#if ARCH_X86_64
+    if (EXTERNAL_SSE4(cpu_flags)) {
+        c->trellis_levels        = ff_trellis_levels_sse4;
+        c->trellis_distortion[0] = ff_trellis_distortion_sse4;
+        c->trellis_distortion[1] = ff_trellis_distortion_odd_sse4;
+    }
+
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        c->trellis_levels        = ff_trellis_levels_avx2;
+        c->trellis_distortion[0] = ff_trellis_distortion_avx2;
+        c->trellis_distortion[1] = ff_trellis_distortion_odd_avx2;
+    }
+#endif /* ARCH_X86_64 */
+
 #if HAVE_INLINE_ASM
 
     if (INLINE_MMX(cpu_flags)) {
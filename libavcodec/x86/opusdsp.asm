@@ -0,0 +1,235 @@
+;******************************************************************************
+;* SIMD optimized Opus decoder DSP functions
+;*
+;* This file is part of Libav.
+;*
+;* Libav is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* Libav is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with Libav; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+ps_deemph_coeff:  times 4 dd 0.850006104
+ps_deemph_coeff2: times 4 dd 0.722510397
+ps_deemph_coeff4: times 4 dd 0.522021234
+ps_deemph_powers:       dd 1.0, 0.850006104, 0.722510397, 0.614138246
+ps_deemph_scale:  times 4 dd 0.000030517578125
+ps_p1:            times 4 dd 1.0
+ps_m1:            times 4 dd -1.0
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_opus_postfilter(float *data, int period, const float *gains, int len)
+;------------------------------------------------------------------------------
+; the period is at least 15, so a vector of output samples never depends on
+; another sample of itself; the sums are done in the order of the C version
+%macro POSTFILTER 0
+cglobal opus_postfilter, 4, 4, 8, data, x, gains, len
+    VBROADCASTSS m0, [gainsq]
+    VBROADCASTSS m1, [gainsq + 4]
+    VBROADCASTSS m2, [gainsq + 8]
+    movsxdifnidn xq, xd
+    movsxdifnidn lenq, lend
+    shl          xq, 2
+    shl        lenq, 2
+    add       dataq, lenq
+    neg          xq
+    add          xq, dataq
+    neg        lenq
+.loop:
+    movu         m3, [xq + lenq - 8]
+    movu         m4, [xq + lenq - 4]
+    movu         m5, [xq + lenq]
+    movu         m6, [xq + lenq + 4]
+    movu         m7, [xq + lenq + 8]
+    mulps        m5, m0
+    addps        m4, m6
+    mulps        m4, m1
+    addps        m3, m7
+    mulps        m3, m2
+    addps        m5, m4
+    addps        m5, m3
+    movu         m3, [dataq + lenq]
+    addps        m3, m5
+    movu [dataq + lenq], m3
+    add        lenq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse
+POSTFILTER
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+POSTFILTER
+%endif
+
+%if ARCH_X86_64
+;------------------------------------------------------------------------------
+; float ff_opus_deemphasis(float *out, const float *in, int len, float coeff)
+;------------------------------------------------------------------------------
+; y[i] = x[i] + c * y[i - 1] is computed 4 samples at a time as a prefix sum of
+; the input plus the powers of c times the state; the next state only depends
+; on the current one through a multiplication by c^4 and an addition
+INIT_XMM sse2
+%if WIN64
+cglobal opus_deemphasis, 4, 4, 4, out, in, len, coeff
+    movaps     xmm0, xmm3
+%else
+cglobal opus_deemphasis, 3, 3, 4, out, in, len
+%endif
+    shufps       m0, m0, 0
+    movsxdifnidn lenq, lend
+    shl        lenq, 2
+    add         inq, lenq
+    add        outq, lenq
+    neg        lenq
+.loop:
+    movu         m1, [inq + lenq]
+    pslldq       m2, m1, 4
+    mulps        m2, [ps_deemph_coeff]
+    addps        m1, m2
+    pslldq       m2, m1, 8
+    mulps        m2, [ps_deemph_coeff2]
+    addps        m1, m2
+    shufps       m2, m1, m1, q3333
+    mulps        m2, [ps_deemph_coeff]
+    mulps        m3, m0, [ps_deemph_powers]
+    addps        m1, m3
+    mulps        m0, [ps_deemph_coeff4]
+    addps        m0, m2
+    mulps        m1, [ps_deemph_scale]
+    movu [outq + lenq], m1
+    add        lenq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_opus_lpc_synthesis(float *dst, float *lpc, const float *res,
+;                            const float *coeffs, int order, int len,
+;                            float gain)
+;------------------------------------------------------------------------------
+; 4 samples are computed at once: first the sums of the terms of the previous
+; samples, then the terms of the samples of the block itself are added with
+; the impulse response of the filter over 4 samples; the last 8 outputs stay
+; in m0 and m1, and the broadcast coefficients, the impulse response and the
+; gain are on the stack
+cglobal opus_lpc_synthesis, 6, 8, 7, -20 * mmsize, dst, lpc, res, coeffs, order, len, gain, k
+%if WIN64
+    movss        m0, gainm
+%endif
+    shufps       m0, m0, 0
+    mova [rsp + 19 * mmsize], m0
+
+    movsxdifnidn orderq, orderd
+    mov          kq, orderq
+.coefs:
+    movss        m0, [coeffsq + kq * 4 - 4]
+    shufps       m0, m0, 0
+    mov       gainq, kq
+    shl       gainq, 4
+    mova [rsp + gainq - mmsize], m0
+    dec          kq
+    jg .coefs
+
+    ; h1 = c0, h2 = c0 * h1 + c1, h3 = c0 * h2 + c1 * h1 + c2
+    movss        m0, [coeffsq]
+    movss        m1, [coeffsq + 4]
+    movss        m2, [coeffsq + 8]
+    movaps       m3, m0
+    mulss        m3, m0
+    addss        m3, m1
+    movaps       m4, m3
+    mulss        m4, m0
+    mulss        m1, m0
+    addss        m4, m1
+    addss        m4, m2
+    unpcklps     m0, m3
+    movlhps      m0, m4
+    pslldq       m1, m0, 4
+    pslldq       m2, m0, 8
+    pslldq       m0, 12
+    mova [rsp + 16 * mmsize], m1
+    mova [rsp + 17 * mmsize], m2
+    mova [rsp + 18 * mmsize], m0
+
+    neg      orderq
+    movsxdifnidn lenq, lend
+    shl        lenq, 2
+    add        dstq, lenq
+    add        resq, lenq
+    neg        lenq
+    movu         m0, [lpcq - 16]
+    movu         m1, [lpcq - 32]
+.loop:
+    movu         m2, [resq + lenq]
+    mulps        m2, [rsp + 19 * mmsize]
+    mov          kq, -8
+    lea       gainq, [rsp + 7 * mmsize]
+.loop_coefs:
+    movu         m3, [lpcq + kq * 4]
+    mulps        m3, [gainq]
+    addps        m2, m3
+    add       gainq, mmsize
+    dec          kq
+    cmp          kq, orderq
+    jge .loop_coefs
+
+    ; the terms of the last 7 samples, the lanes of the samples of the block
+    ; itself are zero
+    psrldq       m3, m0, 12
+    mulps        m3, [rsp]
+    psrldq       m4, m0, 8
+    mulps        m4, [rsp + mmsize]
+    addps        m3, m4
+    psrldq       m4, m0, 4
+    mulps        m4, [rsp + 2 * mmsize]
+    mulps        m5, m0, [rsp + 3 * mmsize]
+    addps        m4, m5
+    addps        m3, m4
+    shufps       m6, m1, m0, q0033
+    shufps       m4, m6, m0, q2120
+    mulps        m4, [rsp + 4 * mmsize]
+    shufps       m5, m1, m0, q1032
+    mulps        m5, [rsp + 5 * mmsize]
+    addps        m4, m5
+    shufps       m5, m1, m6, q2021
+    mulps        m5, [rsp + 6 * mmsize]
+    addps        m2, m5
+    addps        m2, m4
+    addps        m2, m3
+
+    shufps       m3, m2, m2, q0000
+    mulps        m3, [rsp + 16 * mmsize]
+    shufps       m4, m2, m2, q1111
+    mulps        m4, [rsp + 17 * mmsize]
+    shufps       m5, m2, m2, q2222
+    mulps        m5, [rsp + 18 * mmsize]
+    addps        m3, m4
+    addps        m2, m5
+    addps        m2, m3
+    movu     [lpcq], m2
+    mova         m1, m0
+    mova         m0, m2
+    maxps        m2, [ps_m1]
+    minps        m2, [ps_p1]
+    movu [dstq + lenq], m2
+    add        lpcq, mmsize
+    add        lenq, mmsize
+    jl .loop
+    RET
+%endif
@@ -0,0 +1,49 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/opusdsp.h"
+
+void ff_opus_postfilter_sse(float *data, int period, const float *gains,
+                            int len);
+void ff_opus_postfilter_avx(float *data, int period, const float *gains,
+                            int len);
+float ff_opus_deemphasis_sse2(float *out, const float *in, int len,
+                              float coeff);
+void ff_opus_lpc_synthesis_sse2(float *dst, float *lpc, const float *res,
+                                const float *coeffs, int order, int len,
+                                float gain);
+
+av_cold void ff_opus_dsp_init_x86(OpusDSPContext *s)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE(cpu_flags))
+        s->postfilter = ff_opus_postfilter_sse;
+
+    if (ARCH_X86_64 && EXTERNAL_SSE2(cpu_flags)) {
+        s->deemphasis    = ff_opus_deemphasis_sse2;
+        s->lpc_synthesis = ff_opus_lpc_synthesis_sse2;
+    }
+
+    if (EXTERNAL_AVX_FAST(cpu_flags))
+        s->postfilter = ff_opus_postfilter_avx;
+}
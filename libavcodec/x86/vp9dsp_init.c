@@ -241,6 +241,51 @@ lpf_funcs(88, 16, avx);
 
 #undef lpf_funcs
 
+#define itxfm_func(typea, typeb, size, opt) \
+void ff_vp9_##typea##_##typeb##_##size##x##size##_add_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                            int16_t *block, int eob)
+#define itxfm_funcs(size, opt)            \
+    itxfm_func(idct,  idct,  size, opt); \
+    itxfm_func(iadst, idct,  size, opt); \
+    itxfm_func(idct,  iadst, size, opt); \
+    itxfm_func(iadst, iadst, size, opt)
+
+itxfm_func(iwht, iwht, 4, sse2);
+itxfm_funcs(4, ssse3);
+itxfm_funcs(4, avx);
+#if ARCH_X86_64
+itxfm_funcs(8, ssse3);
+itxfm_funcs(8, avx);
+itxfm_funcs(16, ssse3);
+itxfm_funcs(16, avx);
+itxfm_func(idct, idct, 32, ssse3);
+itxfm_func(idct, idct, 32, avx);
+#endif
+
+#undef itxfm_funcs
+#undef itxfm_func
+
+#define ipred_func(type, size, opt) \
+void ff_vp9_ipred_##type##_##size##x##size##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                   const uint8_t *left,           \
+                                                   const uint8_t *top)
+#define ipred_funcs(size, opt)      \
+    ipred_func(dc,      size, opt); \
+    ipred_func(dc_left, size, opt); \
+    ipred_func(dc_top,  size, opt); \
+    ipred_func(v,       size, opt); \
+    ipred_func(h,       size, opt); \
+    ipred_func(tm,      size, opt)
+
+ipred_funcs(4,  sse2);
+ipred_funcs(8,  sse2);
+ipred_funcs(16, sse2);
+ipred_funcs(32, sse2);
+ipred_funcs(32, avx2);
+
+#undef ipred_funcs
+#undef ipred_func
+
 #endif /* HAVE_X86ASM */
 
 av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
@@ -291,6 +336,29 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
     dsp->loop_filter_mix2[1][1][1] = ff_vp9_loop_filter_v_88_16_##opt; \
 } while (0)
 
+#define init_itxfm(tx, sz, opt) do { \
+    dsp->itxfm_add[tx][DCT_DCT]   = ff_vp9_idct_idct_##sz##_add_##opt;   \
+    dsp->itxfm_add[tx][DCT_ADST]  = ff_vp9_iadst_idct_##sz##_add_##opt;  \
+    dsp->itxfm_add[tx][ADST_DCT]  = ff_vp9_idct_iadst_##sz##_add_##opt;  \
+    dsp->itxfm_add[tx][ADST_ADST] = ff_vp9_iadst_iadst_##sz##_add_##opt; \
+} while (0)
+
+#define init_idct(tx, nm) do { \
+    dsp->itxfm_add[tx][DCT_DCT]   = \
+    dsp->itxfm_add[tx][DCT_ADST]  = \
+    dsp->itxfm_add[tx][ADST_DCT]  = \
+    dsp->itxfm_add[tx][ADST_ADST] = nm; \
+} while (0)
+
+#define init_ipred(tx, sz, opt) do { \
+    dsp->intra_pred[tx][VERT_PRED]    = ff_vp9_ipred_v_##sz##_##opt;       \
+    dsp->intra_pred[tx][HOR_PRED]     = ff_vp9_ipred_h_##sz##_##opt;       \
+    dsp->intra_pred[tx][DC_PRED]      = ff_vp9_ipred_dc_##sz##_##opt;      \
+    dsp->intra_pred[tx][TM_VP8_PRED]  = ff_vp9_ipred_tm_##sz##_##opt;      \
+    dsp->intra_pred[tx][LEFT_DC_PRED] = ff_vp9_ipred_dc_left_##sz##_##opt; \
+    dsp->intra_pred[tx][TOP_DC_PRED]  = ff_vp9_ipred_dc_top_##sz##_##opt;  \
+} while (0)
+
     if (EXTERNAL_MMX(cpu_flags)) {
         init_fpel(4, 0,  4, put, mmx);
         init_fpel(3, 0,  8, put, mmx);
@@ -316,23 +384,41 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
         init_fpel(1, 1, 32, avg, sse2);
         init_fpel(0, 1, 64, avg, sse2);
         init_lpf(sse2);
+        init_idct(4 /* lossless */, ff_vp9_iwht_iwht_4x4_add_sse2);
+        init_ipred(TX_4X4,   4x4,   sse2);
+        init_ipred(TX_8X8,   8x8,   sse2);
+        init_ipred(TX_16X16, 16x16, sse2);
+        init_ipred(TX_32X32, 32x32, sse2);
     }
 
     if (EXTERNAL_SSSE3(cpu_flags)) {
         init_subpel3(0, put, ssse3);
         init_subpel3(1, avg, ssse3);
         init_lpf(ssse3);
+        init_itxfm(TX_4X4, 4x4, ssse3);
+#if ARCH_X86_64
+        init_itxfm(TX_8X8,   8x8,   ssse3);
+        init_itxfm(TX_16X16, 16x16, ssse3);
+        init_idct(TX_32X32, ff_vp9_idct_idct_32x32_add_ssse3);
+#endif
     }
 
     if (EXTERNAL_AVX(cpu_flags)) {
         init_fpel(1, 0, 32, put, avx);
         init_fpel(0, 0, 64, put, avx);
         init_lpf(avx);
+        init_itxfm(TX_4X4, 4x4, avx);
+#if ARCH_X86_64
+        init_itxfm(TX_8X8,   8x8,   avx);
+        init_itxfm(TX_16X16, 16x16, avx);
+        init_idct(TX_32X32, ff_vp9_idct_idct_32x32_add_avx);
+#endif
     }
 
     if (EXTERNAL_AVX2(cpu_flags)) {
         init_fpel(1, 1, 32, avg, avx2);
         init_fpel(0, 1, 64, avg, avx2);
+        init_ipred(TX_32X32, 32x32, avx2);
 
 #if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
         init_subpel3_32_64(0, put, avx2);
@@ -344,6 +430,10 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
 #undef init_subpel1
 #undef init_subpel2
 #undef init_subpel3
+#undef init_lpf
+#undef init_itxfm
+#undef init_idct
+#undef init_ipred
 
 #endif /* HAVE_X86ASM */
 }
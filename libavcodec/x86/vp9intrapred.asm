@@ -0,0 +1,268 @@
+;******************************************************************************
+;* VP9 intra prediction x86 SIMD optimizations
+;*
+;* This file is part of Libav.
+;*
+;* Libav is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* Libav is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with Libav; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+cextern pw_2
+cextern pw_4
+cextern pw_8
+cextern pw_16
+cextern pw_32
+
+SECTION .text
+
+; store m%3 to the row of %1 pixels at %2, for 32 pixels in xmm registers
+; the right half is taken from m%4
+%macro VP9_STORE_ROW 3-4 ; size, address, register, register for pixels 16-31
+%if %1 == 4
+    movd          [%2], xm%3
+%elif %1 == 8
+    movq          [%2], xm%3
+%elif %1 == 16 || mmsize == 32
+    mova          [%2], m%3
+%else
+    mova          [%2], m%3
+    mova     [%2 + 16], m%4
+%endif
+%endmacro
+
+; store the same row to all the %1 rows of dst
+%macro VP9_IPRED_FILL 2-3 ; size, register, register for pixels 16-31
+    lea       stride3q, [strideq * 3]
+    mov           cntd, %1 / 4
+.fill_loop:
+    VP9_STORE_ROW   %1, dstq, %2, %3
+    VP9_STORE_ROW   %1, dstq + strideq, %2, %3
+    VP9_STORE_ROW   %1, dstq + strideq * 2, %2, %3
+    VP9_STORE_ROW   %1, dstq + stride3q, %2, %3
+    lea           dstq, [dstq + strideq * 4]
+    dec           cntd
+    jg .fill_loop
+%endmacro
+
+; sums of the %1 pixels at %2 in the qwords of m%3, clobbers m%4,
+; m%5 must be zero
+%macro VP9_SUM_PX 5 ; size, address, dst, tmp, zero
+%if %1 == 4
+    movd           m%3, [%2]
+%elif %1 == 8
+    movq           m%3, [%2]
+%elif %1 == 16 || mmsize == 32
+    movu           m%3, [%2]
+%else
+    movu           m%3, [%2]
+    movu           m%4, [%2 + 16]
+    psadbw         m%4, m%5
+%endif
+    psadbw         m%3, m%5
+%if %1 == 32 && mmsize == 16
+    paddw          m%3, m%4
+%endif
+%endmacro
+
+; (sum + (%2 >> 1)) >> log2(%2) of the pixel sums in m%1, splatted to all
+; bytes of m%1, m%3 must be zero
+%macro VP9_DC_SPLAT 3 ; sums, number of pixels, zero
+%if mmsize == 32
+    vextracti128  xm%3, m%1, 1
+    paddw         xm%1, xm%3
+    pxor          xm%3, xm%3
+%endif
+%if %2 > 8
+    movhlps       xm%3, xm%1
+    paddw         xm%1, xm%3
+    pxor          xm%3, xm%3
+%endif
+%if %2 == 4
+    paddw         xm%1, [pw_2]
+    psrlw         xm%1, 2
+%elif %2 == 8
+    paddw         xm%1, [pw_4]
+    psrlw         xm%1, 3
+%elif %2 == 16
+    paddw         xm%1, [pw_8]
+    psrlw         xm%1, 4
+%elif %2 == 32
+    paddw         xm%1, [pw_16]
+    psrlw         xm%1, 5
+%else
+    paddw         xm%1, [pw_32]
+    psrlw         xm%1, 6
+%endif
+%if cpuflag(avx2)
+    vpbroadcastb   m%1, xm%1
+%elif cpuflag(ssse3)
+    pshufb         m%1, m%3
+%else
+    punpcklbw      m%1, m%1
+    SPLATW         m%1, m%1
+%endif
+%endmacro
+
+; void ff_vp9_ipred_<mode>_<size>x<size>_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                              const uint8_t *left,
+;                                              const uint8_t *top)
+
+%macro VP9_IPRED_DC_FUNCS 1 ; size
+cglobal vp9_ipred_dc_%1x%1, 4, 6, 4, dst, stride, left, top, stride3, cnt
+    pxor            m2, m2
+    VP9_SUM_PX      %1, leftq, 0, 1, 2
+    VP9_SUM_PX      %1, topq,  1, 3, 2
+    paddw           m0, m1
+    VP9_DC_SPLAT     0, %1 * 2, 2
+    VP9_IPRED_FILL  %1, 0, 0
+    RET
+
+cglobal vp9_ipred_dc_left_%1x%1, 3, 6, 3, dst, stride, left, top, stride3, cnt
+    pxor            m2, m2
+    VP9_SUM_PX      %1, leftq, 0, 1, 2
+    VP9_DC_SPLAT     0, %1, 2
+    VP9_IPRED_FILL  %1, 0, 0
+    RET
+
+cglobal vp9_ipred_dc_top_%1x%1, 4, 6, 3, dst, stride, left, top, stride3, cnt
+    pxor            m2, m2
+    VP9_SUM_PX      %1, topq, 0, 1, 2
+    VP9_DC_SPLAT     0, %1, 2
+    VP9_IPRED_FILL  %1, 0, 0
+    RET
+%endmacro
+
+%macro VP9_IPRED_V 1 ; size
+cglobal vp9_ipred_v_%1x%1, 4, 6, 2, dst, stride, left, top, stride3, cnt
+%if %1 == 4
+    movd            m0, [topq]
+%elif %1 == 8
+    movq            m0, [topq]
+%else
+    movu            m0, [topq]
+%if %1 == 32 && mmsize == 16
+    movu            m1, [topq + 16]
+%endif
+%endif
+    VP9_IPRED_FILL  %1, 0, 1
+    RET
+%endmacro
+
+%macro VP9_IPRED_H 1 ; size
+cglobal vp9_ipred_h_%1x%1, 3, 5, 4, dst, stride, left, stride3, cnt
+    lea       stride3q, [strideq * 3]
+    mov           cntd, %1 / 4
+.loop:
+%if cpuflag(avx2)
+    vpbroadcastb    m0, [leftq + 0]
+    vpbroadcastb    m1, [leftq + 1]
+    vpbroadcastb    m2, [leftq + 2]
+    vpbroadcastb    m3, [leftq + 3]
+%else
+    movd            m3, [leftq]
+    punpcklbw       m3, m3
+    punpcklwd       m3, m3
+    pshufd          m0, m3, q0000
+    pshufd          m1, m3, q1111
+    pshufd          m2, m3, q2222
+    pshufd          m3, m3, q3333
+%endif
+    VP9_STORE_ROW   %1, dstq, 0, 0
+    VP9_STORE_ROW   %1, dstq + strideq, 1, 1
+    VP9_STORE_ROW   %1, dstq + strideq * 2, 2, 2
+    VP9_STORE_ROW   %1, dstq + stride3q, 3, 3
+    add          leftq, 4
+    lea           dstq, [dstq + strideq * 4]
+    dec           cntd
+    jg .loop
+    RET
+%endmacro
+
+; dst[x] = clip(top[x] + left[y] - top[-1]), done in words
+%macro VP9_IPRED_TM 1 ; size
+cglobal vp9_ipred_tm_%1x%1, 4, 6, 8, dst, stride, left, top, cnt, px
+    pxor            m7, m7
+    movzx          pxd, byte [topq - 1]
+    movd           xm6, pxd
+    SPLATW          m6, xm6
+%if %1 == 4
+    movd            m0, [topq]
+    punpcklbw       m0, m7
+%elif %1 == 8
+    movq            m0, [topq]
+    punpcklbw       m0, m7
+%else
+    movu            m1, [topq]
+    punpckhbw       m2, m1, m7
+    punpcklbw       m1, m7
+    psubw           m2, m6
+%if %1 == 32 && mmsize == 16
+    movu            m3, [topq + 16]
+    punpckhbw       m4, m3, m7
+    punpcklbw       m3, m7
+    psubw           m3, m6
+    psubw           m4, m6
+%endif
+    SWAP             0, 1
+    SWAP             1, 2
+    SWAP             2, 3
+    SWAP             3, 4
+%endif
+    psubw           m0, m6
+    xor           cntd, cntd
+.loop:
+    movzx          pxd, byte [leftq + cntq]
+    movd           xm6, pxd
+    SPLATW          m6, xm6
+    paddw           m4, m0, m6
+%if %1 >= 16
+    paddw           m5, m1, m6
+    packuswb        m4, m5
+%else
+    packuswb        m4, m4
+%endif
+%if %1 == 32 && mmsize == 16
+    paddw           m5, m2, m6
+    paddw           m6, m3
+    packuswb        m5, m6
+%endif
+    VP9_STORE_ROW   %1, dstq, 4, 5
+    add           dstq, strideq
+    inc           cntd
+    cmp           cntd, %1
+    jl .loop
+    RET
+%endmacro
+
+%macro VP9_IPRED_FUNCS 1 ; size
+VP9_IPRED_DC_FUNCS %1
+VP9_IPRED_V        %1
+VP9_IPRED_H        %1
+VP9_IPRED_TM       %1
+%endmacro
+
+INIT_XMM sse2
+VP9_IPRED_FUNCS  4
+VP9_IPRED_FUNCS  8
+VP9_IPRED_FUNCS 16
+VP9_IPRED_FUNCS 32
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+VP9_IPRED_FUNCS 32
+%endif
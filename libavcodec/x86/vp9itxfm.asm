@@ -0,0 +1,968 @@
+;******************************************************************************
+;* VP9 inverse transform x86 SIMD optimizations
+;*
+;* This file is part of Libav.
+;*
+;* Libav is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* Libav is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with Libav; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+cextern pw_512
+
+pw_1024:    times 8 dw 1024
+pw_2048:    times 8 dw 2048
+pw_11585x2: times 8 dw 23170
+pd_8192:    times 4 dd 8192
+
+; the multiplier pairs for pmaddwd on interleaved words (a, b), the result
+; being a * c0 + b * c1 for the pair pw_<c0>_<c1>, m marks a negative value
+%macro COEF_PAIR 2
+pw_%1_%2:   times 4 dw  %1,  %2
+pw_%1_m%2:  times 4 dw  %1, -%2
+pw_m%1_m%2: times 4 dw -%1, -%2
+%endmacro
+
+COEF_PAIR 11585, 11585
+COEF_PAIR  6270, 15137
+COEF_PAIR 15137,  6270
+COEF_PAIR  3196, 16069
+COEF_PAIR 16069,  3196
+COEF_PAIR  9102, 13623
+COEF_PAIR 13623,  9102
+
+; 4x4 adst
+COEF_PAIR     0, 13377
+COEF_PAIR  5283, 15212
+COEF_PAIR  9929,  5283
+COEF_PAIR 13377,  5283
+COEF_PAIR 13377,  9929
+COEF_PAIR 13377, 13377
+COEF_PAIR 13377, 15212
+COEF_PAIR 15212,  9929
+
+; 8x8 adst, 16x16 idct
+COEF_PAIR  1606, 16305
+COEF_PAIR 16305,  1606
+COEF_PAIR 10394, 12665
+COEF_PAIR 12665, 10394
+COEF_PAIR  7723, 14449
+COEF_PAIR 14449,  7723
+COEF_PAIR  4756, 15679
+COEF_PAIR 15679,  4756
+
+; 16x16 adst, 32x32 idct
+COEF_PAIR   804, 16364
+COEF_PAIR 16364,   804
+COEF_PAIR 11003, 12140
+COEF_PAIR 12140, 11003
+COEF_PAIR  3981, 15893
+COEF_PAIR 15893,  3981
+COEF_PAIR  8423, 14053
+COEF_PAIR 14053,  8423
+COEF_PAIR  7005, 14811
+COEF_PAIR 14811,  7005
+COEF_PAIR  5520, 15426
+COEF_PAIR 15426,  5520
+COEF_PAIR  9760, 13160
+COEF_PAIR 13160,  9760
+COEF_PAIR  2404, 16207
+COEF_PAIR 16207,  2404
+
+SECTION .text
+
+; round the dwords of m%1 and m%2 by 14 bits and pack them into m%1
+%macro VP9_RND_SH_PACK 2 ; low dwords/dst, high dwords
+    paddd          m%1, [pd_8192]
+    paddd          m%2, [pd_8192]
+    psrad          m%1, 14
+    psrad          m%2, 14
+    packssdw       m%1, m%2
+%endmacro
+
+; multiply the interleaved words of m%1 (a) and m%2 (b) by the pairs %5 and
+; %6, leaving the dwords of a * %5[0] + b * %5[1] in m%1 (low) and m%3 (high),
+; and a * %6[0] + b * %6[1] in m%2 (low) and m%4 (high)
+%macro VP9_MUL_2D 6 ; a, b, tmp1, tmp2, coef pair 1, coef pair 2
+    punpckhwd      m%3, m%1, m%2
+    punpcklwd      m%1, m%2
+    pmaddwd        m%4, m%3, [pw_%6]
+    pmaddwd        m%3, [pw_%5]
+    pmaddwd        m%2, m%1, [pw_%6]
+    pmaddwd        m%1, [pw_%5]
+%endmacro
+
+; m%1 = (a * %5[0] + b * %5[1] + (1 << 13)) >> 14,
+; m%2 = (a * %6[0] + b * %6[1] + (1 << 13)) >> 14
+%macro VP9_MUL_2W 6 ; a, b, tmp1, tmp2, coef pair 1, coef pair 2
+    VP9_MUL_2D      %1, %2, %3, %4, %5, %6
+    VP9_RND_SH_PACK %1, %3
+    VP9_RND_SH_PACK %2, %4
+%endmacro
+
+; with the dwords of A in m%1/m%2 and of B in m%3/m%4 (low/high),
+; m%1 = (A + B + (1 << 13)) >> 14 and m%3 = (A - B + (1 << 13)) >> 14
+%macro VP9_RND_SUMSUB_PACK 5 ; A low, A high, B low, B high, tmp
+    psubd          m%5, m%1, m%3
+    paddd          m%1, m%3
+    psubd          m%3, m%2, m%4
+    paddd          m%2, m%4
+    VP9_RND_SH_PACK %1, %2
+    VP9_RND_SH_PACK %5, %3
+    SWAP            %3, %5
+%endmacro
+
+; m%1 = -m%1, using m%2 (zero) and m%3 as temporaries
+%macro VP9_NEG 3
+    psubw          m%3, m%2, m%1
+    SWAP            %1, %3
+%endmacro
+
+; add the 8 words of m%1 to the pixels at %2, m%3 is zero, clobbers m%4
+%macro VP9_ADD_8PX 4
+    movh           m%4, %2
+    punpcklbw      m%4, m%3
+    paddw          m%4, m%1
+    packuswb       m%4, m%4
+    movh            %2, m%4
+%endmacro
+
+; dc-only path of the idct/idct functions:
+; block[0] scaled twice by 11585 / 2^14, rounded by the pmulhrsw constant %2
+; and added to the %1x%1 pixels of dst, the 4x4 version needs rowq
+%macro VP9_IDCT_DC_ADD 2 ; size, rounding constant
+    movd            m0, [blockq]
+    mov word [blockq], 0
+    pmulhrsw        m0, [pw_11585x2]
+    pmulhrsw        m0, [pw_11585x2]
+    pmulhrsw        m0, [%2]
+    SPLATW          m0, m0
+    ; dst + dc is done with saturating byte adds of max(dc, 0) and -min(dc, 0)
+    pxor            m1, m1
+    psubw           m1, m0
+    packuswb        m0, m0
+    packuswb        m1, m1
+%if %1 == 4
+    movd            m2, [dstq]
+    movd            m3, [dstq + strideq]
+    punpckldq       m2, m3
+    lea           rowq, [dstq + strideq * 2]
+    movd            m3, [rowq]
+    movd            m4, [rowq + strideq]
+    punpckldq       m3, m4
+    punpcklqdq      m2, m3
+    paddusb         m2, m0
+    psubusb         m2, m1
+    movd        [dstq], m2
+    psrldq          m2, 4
+    movd [dstq + strideq], m2
+    psrldq          m2, 4
+    movd        [rowq], m2
+    psrldq          m2, 4
+    movd [rowq + strideq], m2
+%else
+    mov           eobd, %1
+.dc_loop:
+%if %1 == 8
+    movh            m2, [dstq]
+%else
+    mova            m2, [dstq]
+%if %1 == 32
+    mova            m3, [dstq + 16]
+    paddusb         m3, m0
+    psubusb         m3, m1
+    mova   [dstq + 16], m3
+%endif
+%endif
+    paddusb         m2, m0
+    psubusb         m2, m1
+%if %1 == 8
+    movh        [dstq], m2
+%else
+    mova        [dstq], m2
+%endif
+    add           dstq, strideq
+    dec           eobd
+    jg .dc_loop
+%endif
+%endmacro
+
+;------------------------------------------------------------------------------
+; 4x4
+;------------------------------------------------------------------------------
+
+; The 4x4 transforms work on words interleaved as (in0, in2) pairs in m0 and
+; (in1, in3) pairs in m1 for each of the 4 columns, and return the rows
+; [out0, out1] in m0 and [out2, out3] in m1.
+
+%macro VP9_IDCT4_1D 0
+    pmaddwd         m2, m0, [pw_11585_11585]    ; t0
+    pmaddwd         m0, [pw_11585_m11585]       ; t1
+    pmaddwd         m3, m1, [pw_15137_6270]     ; t3
+    pmaddwd         m1, [pw_6270_m15137]        ; t2
+    mova            m4, [pd_8192]
+    paddd           m0, m4
+    paddd           m1, m4
+    paddd           m2, m4
+    paddd           m3, m4
+    psrad           m0, 14
+    psrad           m1, 14
+    psrad           m2, 14
+    psrad           m3, 14
+    SUMSUB_BA        d, 3, 2, 4                 ; out0, out3
+    SUMSUB_BA        d, 1, 0, 4                 ; out1, out2
+    packssdw        m3, m1
+    packssdw        m0, m2
+    SWAP             0, 3
+    SWAP             1, 3
+%endmacro
+
+%macro VP9_IADST4_1D 0
+    pmaddwd         m2, m0, [pw_5283_15212]
+    pmaddwd         m3, m1, [pw_13377_9929]
+    paddd           m2, m3                      ; out0
+    pmaddwd         m3, m0, [pw_9929_m5283]
+    pmaddwd         m4, m1, [pw_13377_m15212]
+    paddd           m3, m4                      ; out1
+    pmaddwd         m4, m0, [pw_13377_m13377]
+    pmaddwd         m5, m1, [pw_0_13377]
+    paddd           m4, m5                      ; out2
+    pmaddwd         m0, [pw_15212_9929]
+    pmaddwd         m1, [pw_m13377_m5283]
+    paddd           m0, m1                      ; out3
+    mova            m5, [pd_8192]
+    paddd           m2, m5
+    paddd           m3, m5
+    paddd           m4, m5
+    paddd           m0, m5
+    psrad           m2, 14
+    psrad           m3, 14
+    psrad           m4, 14
+    psrad           m0, 14
+    packssdw        m2, m3
+    packssdw        m4, m0
+    SWAP             0, 2
+    SWAP             1, 4
+%endmacro
+
+; turn the rows [r0, r1] in m0 and [r2, r3] in m1 into the column pairs
+; expected by the 1D transforms
+%macro VP9_TRANSPOSE_4x4 0
+    punpckhwd       m2, m0, m1
+    punpcklwd       m0, m1
+    punpckhwd       m1, m0, m2
+    punpcklwd       m0, m2
+    punpckhwd       m2, m0, m1
+    punpcklwd       m0, m1
+    SWAP             1, 2
+%endmacro
+
+; void ff_vp9_<type1>_<type2>_4x4_add_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                           int16_t *block, int eob)
+%macro VP9_ITXFM_4x4 4 ; pass 1 name, pass 1 macro, pass 2 name, pass 2 macro
+cglobal vp9_%1_%3_4x4_add, 4, 5, 6, dst, stride, block, eob, row
+%ifidn %1_%3, idct_idct
+    cmp           eobd, 1
+    jne .full
+    VP9_IDCT_DC_ADD  4, pw_2048
+    RET
+.full:
+%endif
+    mova            m0, [blockq]
+    mova            m1, [blockq + 16]
+    punpckhwd       m2, m0, m1
+    punpcklwd       m0, m1
+    SWAP             1, 2
+    VP9_%2_1D
+    VP9_TRANSPOSE_4x4
+    VP9_%4_1D
+    pxor            m4, m4
+    mova      [blockq], m4
+    mova [blockq + 16], m4
+    pmulhrsw        m0, [pw_2048]
+    pmulhrsw        m1, [pw_2048]
+    movd            m2, [dstq]
+    movd            m3, [dstq + strideq]
+    punpckldq       m2, m3
+    punpcklbw       m2, m4
+    paddw           m0, m2
+    lea           rowq, [dstq + strideq * 2]
+    movd            m2, [rowq]
+    movd            m3, [rowq + strideq]
+    punpckldq       m2, m3
+    punpcklbw       m2, m4
+    paddw           m1, m2
+    packuswb        m0, m1
+    movd        [dstq], m0
+    psrldq          m0, 4
+    movd [dstq + strideq], m0
+    psrldq          m0, 4
+    movd        [rowq], m0
+    psrldq          m0, 4
+    movd [rowq + strideq], m0
+    RET
+%endmacro
+
+%macro VP9_ITXFM_4x4_FUNCS 0
+VP9_ITXFM_4x4 idct,  IDCT4,  idct,  IDCT4
+VP9_ITXFM_4x4 iadst, IADST4, idct,  IDCT4
+VP9_ITXFM_4x4 idct,  IDCT4,  iadst, IADST4
+VP9_ITXFM_4x4 iadst, IADST4, iadst, IADST4
+%endmacro
+
+; lossless walsh-hadamard transform of t0-t3 in the low halves of m0-m3,
+; returning out0-out3 in the same registers
+%macro VP9_IWHT4_1D 0
+    paddw           m0, m2                      ; t0 += t2
+    psubw           m3, m1                      ; t3 -= t1
+    psubw           m4, m0, m3
+    psraw           m4, 1                       ; t4 = (t0 - t3) >> 1
+    psubw           m5, m4, m1                  ; t1 = t4 - t1
+    psubw           m4, m2                      ; t2 = t4 - t2
+    SWAP             1, 5
+    SWAP             2, 4
+    psubw           m0, m1                      ; t0 -= t1
+    paddw           m3, m2                      ; t3 += t2
+%endmacro
+
+; void ff_vp9_iwht_iwht_4x4_add_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                     int16_t *block, int eob)
+INIT_XMM sse2
+cglobal vp9_iwht_iwht_4x4_add, 3, 4, 6, dst, stride, block, row
+    movh            m0, [blockq + 0]
+    movh            m1, [blockq + 24]
+    movh            m2, [blockq + 8]
+    movh            m3, [blockq + 16]
+    psraw           m0, 2
+    psraw           m1, 2
+    psraw           m2, 2
+    psraw           m3, 2
+    VP9_IWHT4_1D
+    ; transpose, and load t0-t3 for the second pass from in0, in3, in1, in2
+    punpcklwd       m0, m1
+    punpcklwd       m2, m3
+    punpckhdq       m1, m0, m2
+    punpckldq       m0, m2
+    movhlps         m2, m0
+    movhlps         m3, m1
+    SWAP             1, 3
+    VP9_IWHT4_1D
+    pxor            m4, m4
+    mova      [blockq], m4
+    mova [blockq + 16], m4
+    punpcklqdq      m0, m1
+    punpcklqdq      m2, m3
+    movd            m1, [dstq]
+    movd            m3, [dstq + strideq]
+    punpckldq       m1, m3
+    punpcklbw       m1, m4
+    paddw           m0, m1
+    lea           rowq, [dstq + strideq * 2]
+    movd            m1, [rowq]
+    movd            m3, [rowq + strideq]
+    punpckldq       m1, m3
+    punpcklbw       m1, m4
+    paddw           m2, m1
+    packuswb        m0, m2
+    movd        [dstq], m0
+    psrldq          m0, 4
+    movd [dstq + strideq], m0
+    psrldq          m0, 4
+    movd        [rowq], m0
+    psrldq          m0, 4
+    movd [rowq + strideq], m0
+    RET
+
+INIT_XMM ssse3
+VP9_ITXFM_4x4_FUNCS
+INIT_XMM avx
+VP9_ITXFM_4x4_FUNCS
+
+%if ARCH_X86_64
+
+;------------------------------------------------------------------------------
+; 8x8
+;------------------------------------------------------------------------------
+
+; The 8 point transforms take in0-in7 in m0-m7 and return out0-out7 in m0-m7,
+; clobbering m8-m12.
+
+%macro VP9_IDCT8_1D 0
+    VP9_MUL_2W       0, 4, 8, 9, 11585_11585, 11585_m11585  ; t0a, t1a
+    VP9_MUL_2W       2, 6, 8, 9, 6270_m15137, 15137_6270    ; t2a, t3a
+    VP9_MUL_2W       1, 7, 8, 9, 3196_m16069, 16069_3196    ; t4a, t7a
+    VP9_MUL_2W       5, 3, 8, 9, 13623_m9102, 9102_13623    ; t5a, t6a
+    SUMSUB_BA        w, 6, 0, 8                             ; t0, t3
+    SUMSUB_BA        w, 2, 4, 8                             ; t1, t2
+    SUMSUB_BA        w, 5, 1, 8                             ; t4, t5a
+    SUMSUB_BA        w, 3, 7, 8                             ; t7, t6a
+    VP9_MUL_2W       7, 1, 8, 9, 11585_m11585, 11585_11585  ; t5, t6
+    SUMSUB_BA        w, 3, 6, 8                             ; out0, out7
+    SUMSUB_BA        w, 1, 2, 8                             ; out1, out6
+    SUMSUB_BA        w, 7, 4, 8                             ; out2, out5
+    SUMSUB_BA        w, 5, 0, 8                             ; out3, out4
+    SWAP             0, 3
+    SWAP             2, 7
+    SWAP             3, 5
+    SWAP             4, 5
+    SWAP             6, 7
+%endmacro
+
+%macro VP9_IADST8_1D 0
+    VP9_MUL_2D       7, 0, 8, 9, 16305_1606, 1606_m16305    ; t0a, t1a
+    VP9_MUL_2D       3, 4, 10, 11, 10394_12665, 12665_m10394 ; t4a, t5a
+    VP9_RND_SUMSUB_PACK 7, 8, 3, 10, 12                     ; t0, t4
+    VP9_RND_SUMSUB_PACK 0, 9, 4, 11, 12                     ; t1, t5
+    VP9_MUL_2D       5, 2, 8, 9, 14449_7723, 7723_m14449    ; t2a, t3a
+    VP9_MUL_2D       1, 6, 10, 11, 4756_15679, 15679_m4756  ; t6a, t7a
+    VP9_RND_SUMSUB_PACK 5, 8, 1, 10, 12                     ; t2, t6
+    VP9_RND_SUMSUB_PACK 2, 9, 6, 11, 12                     ; t3, t7
+    VP9_MUL_2D       3, 4, 8, 9, 15137_6270, 6270_m15137    ; t4a, t5a
+    VP9_MUL_2D       6, 1, 10, 11, 15137_m6270, 6270_15137  ; t6a, t7a
+    VP9_RND_SUMSUB_PACK 3, 8, 6, 10, 12                     ; -out1, t6
+    VP9_RND_SUMSUB_PACK 4, 9, 1, 11, 12                     ; out6, t7
+    SUMSUB_BA        w, 5, 7, 8                             ; out0, t2
+    SUMSUB_BA        w, 2, 0, 8                             ; -out7, t3
+    VP9_MUL_2W       7, 0, 8, 9, 11585_11585, 11585_m11585  ; -out3, out4
+    VP9_MUL_2W       6, 1, 8, 9, 11585_11585, 11585_m11585  ; out2, -out5
+    pxor             m8, m8
+    VP9_NEG          3, 8, 9
+    VP9_NEG          2, 8, 9
+    VP9_NEG          7, 8, 9
+    VP9_NEG          1, 8, 9
+    SWAP             0, 5
+    SWAP             1, 3
+    SWAP             2, 6
+    SWAP             3, 7
+    SWAP             4, 5
+    SWAP             5, 7
+    SWAP             6, 7
+%endmacro
+
+; void ff_vp9_<type1>_<type2>_8x8_add_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                           int16_t *block, int eob)
+%macro VP9_ITXFM_8x8 4 ; pass 1 name, pass 1 macro, pass 2 name, pass 2 macro
+cglobal vp9_%1_%3_8x8_add, 4, 4, 13, dst, stride, block, eob
+%ifidn %1_%3, idct_idct
+    cmp           eobd, 1
+    jne .full
+    VP9_IDCT_DC_ADD  8, pw_1024
+    RET
+.full:
+%endif
+%assign %%i 0
+%rep 8
+    mova         m %+ %%i, [blockq + %%i * 16]
+%assign %%i %%i + 1
+%endrep
+    VP9_%2_1D
+    TRANSPOSE8x8W    0, 1, 2, 3, 4, 5, 6, 7, 8
+    VP9_%4_1D
+    pxor            m8, m8
+%assign %%i 0
+%rep 8
+    mova [blockq + %%i * 16], m8
+    pmulhrsw     m %+ %%i, [pw_1024]
+    VP9_ADD_8PX     %%i, [dstq], 8, 9
+    add           dstq, strideq
+%assign %%i %%i + 1
+%endrep
+    RET
+%endmacro
+
+%macro VP9_ITXFM_8x8_FUNCS 0
+VP9_ITXFM_8x8 idct,  IDCT8,  idct,  IDCT8
+VP9_ITXFM_8x8 iadst, IADST8, idct,  IDCT8
+VP9_ITXFM_8x8 idct,  IDCT8,  iadst, IADST8
+VP9_ITXFM_8x8 iadst, IADST8, iadst, IADST8
+%endmacro
+
+INIT_XMM ssse3
+VP9_ITXFM_8x8_FUNCS
+INIT_XMM avx
+VP9_ITXFM_8x8_FUNCS
+
+;------------------------------------------------------------------------------
+; 16x16
+;------------------------------------------------------------------------------
+
+; out[n] = even[n] + odd[n], out[15 - n] = even[n] - odd[n] for the odd value
+; in m%1, with the even half at %3 and the output at %4
+%macro VP9_IDCT16_OUT 4 ; odd register, n, even, dst
+    mova            m8, [%3 + %2 * 16]
+    paddw           m9, m8, m%1
+    psubw           m8, m%1
+    mova [%4 + %2 * 16], m9
+    mova [%4 + (15 - %2) * 16], m8
+%endmacro
+
+; The 16 point transforms work on 8 columns at a time: they read in0-in15
+; from [%1 + n * %2] and write out0-out15 to [%3 + n * 16], using 256 bytes of
+; scratch space at %4.
+
+%macro VP9_IDCT16_1D 4 ; src, src stride, dst, scratch
+    ; the even half is the 8 point idct of in0, in2, ..., in14
+%assign %%i 0
+%rep 8
+    mova         m %+ %%i, [%1 + %%i * 2 * %2]
+%assign %%i %%i + 1
+%endrep
+    VP9_IDCT8_1D
+%assign %%i 0
+%rep 8
+    mova [%4 + %%i * 16], m %+ %%i
+%assign %%i %%i + 1
+%endrep
+
+    mova            m0, [%1 +  1 * %2]
+    mova            m1, [%1 + 15 * %2]
+    mova            m2, [%1 +  9 * %2]
+    mova            m3, [%1 +  7 * %2]
+    mova            m4, [%1 +  5 * %2]
+    mova            m5, [%1 + 11 * %2]
+    mova            m6, [%1 + 13 * %2]
+    mova            m7, [%1 +  3 * %2]
+    VP9_MUL_2W       0, 1, 8, 9, 1606_m16305, 16305_1606    ; t8a, t15a
+    VP9_MUL_2W       2, 3, 8, 9, 12665_m10394, 10394_12665  ; t9a, t14a
+    VP9_MUL_2W       4, 5, 8, 9, 7723_m14449, 14449_7723    ; t10a, t13a
+    VP9_MUL_2W       6, 7, 8, 9, 15679_m4756, 4756_15679    ; t11a, t12a
+    SUMSUB_BA        w, 2, 0, 8                             ; t8, t9
+    SUMSUB_BA        w, 4, 6, 8                             ; t11, t10
+    SUMSUB_BA        w, 5, 7, 8                             ; t12, t13
+    SUMSUB_BA        w, 3, 1, 8                             ; t15, t14
+    VP9_MUL_2W       1, 0, 8, 9, 6270_m15137, 15137_6270    ; t9a, t14a
+    VP9_MUL_2W       7, 6, 8, 9, m15137_m6270, 6270_m15137  ; t10a, t13a
+    SUMSUB_BA        w, 4, 2, 8                             ; t8a, t11a
+    SUMSUB_BA        w, 7, 1, 8                             ; t9, t10
+    SUMSUB_BA        w, 5, 3, 8                             ; t15a, t12a
+    SUMSUB_BA        w, 6, 0, 8                             ; t14, t13
+    VP9_MUL_2W       0, 1, 8, 9, 11585_m11585, 11585_11585  ; t10a, t13a
+    VP9_MUL_2W       3, 2, 8, 9, 11585_m11585, 11585_11585  ; t11, t12
+
+    ; out[n] = even[n] + odd[n], out[15 - n] = even[n] - odd[n]
+    VP9_IDCT16_OUT   5, 0, %4, %3
+    VP9_IDCT16_OUT   6, 1, %4, %3
+    VP9_IDCT16_OUT   1, 2, %4, %3
+    VP9_IDCT16_OUT   2, 3, %4, %3
+    VP9_IDCT16_OUT   3, 4, %4, %3
+    VP9_IDCT16_OUT   0, 5, %4, %3
+    VP9_IDCT16_OUT   7, 6, %4, %3
+    VP9_IDCT16_OUT   4, 7, %4, %3
+%endmacro
+
+; load in(%3), in(%4), in(%5) and in(%6) into m0-m3
+%macro VP9_LOAD_4ROWS 6 ; src, src stride, 4x row index
+    mova            m0, [%1 + %3 * %2]
+    mova            m1, [%1 + %4 * %2]
+    mova            m2, [%1 + %5 * %2]
+    mova            m3, [%1 + %6 * %2]
+%endmacro
+
+%macro VP9_IADST16_1D 4 ; src, src stride, dst, scratch
+    VP9_LOAD_4ROWS %1, %2, 15, 0, 7, 8
+    VP9_MUL_2D       0, 1, 4, 5, 16364_804, 804_m16364      ; t0, t1
+    VP9_MUL_2D       2, 3, 6, 7, 11003_12140, 12140_m11003  ; t8, t9
+    VP9_RND_SUMSUB_PACK 0, 4, 2, 6, 8                       ; t0a, t8a
+    VP9_RND_SUMSUB_PACK 1, 5, 3, 7, 8                       ; t1a, t9a
+    mova  [%4 +  0 * 16], m0
+    mova  [%4 +  1 * 16], m1
+    mova  [%4 +  8 * 16], m2
+    mova  [%4 +  9 * 16], m3
+    VP9_LOAD_4ROWS %1, %2, 13, 2, 5, 10
+    VP9_MUL_2D       0, 1, 4, 5, 15893_3981, 3981_m15893    ; t2, t3
+    VP9_MUL_2D       2, 3, 6, 7, 8423_14053, 14053_m8423    ; t10, t11
+    VP9_RND_SUMSUB_PACK 0, 4, 2, 6, 8                       ; t2a, t10a
+    VP9_RND_SUMSUB_PACK 1, 5, 3, 7, 8                       ; t3a, t11a
+    mova  [%4 +  2 * 16], m0
+    mova  [%4 +  3 * 16], m1
+    mova  [%4 + 10 * 16], m2
+    mova  [%4 + 11 * 16], m3
+    VP9_LOAD_4ROWS %1, %2, 11, 4, 3, 12
+    VP9_MUL_2D       0, 1, 4, 5, 14811_7005, 7005_m14811    ; t4, t5
+    VP9_MUL_2D       2, 3, 6, 7, 5520_15426, 15426_m5520    ; t12, t13
+    VP9_RND_SUMSUB_PACK 0, 4, 2, 6, 8                       ; t4a, t12a
+    VP9_RND_SUMSUB_PACK 1, 5, 3, 7, 8                       ; t5a, t13a
+    mova  [%4 +  4 * 16], m0
+    mova  [%4 +  5 * 16], m1
+    mova  [%4 + 12 * 16], m2
+    mova  [%4 + 13 * 16], m3
+    VP9_LOAD_4ROWS %1, %2, 9, 6, 1, 14
+    VP9_MUL_2D       0, 1, 4, 5, 13160_9760, 9760_m13160    ; t6, t7
+    VP9_MUL_2D       2, 3, 6, 7, 2404_16207, 16207_m2404    ; t14, t15
+    VP9_RND_SUMSUB_PACK 0, 4, 2, 6, 8                       ; t6a, t14a
+    VP9_RND_SUMSUB_PACK 1, 5, 3, 7, 8                       ; t7a, t15a
+    mova  [%4 +  6 * 16], m0
+    mova  [%4 +  7 * 16], m1
+    mova  [%4 + 14 * 16], m2
+    mova  [%4 + 15 * 16], m3
+
+    ; outputs 0, 3, 4, 7, 8, 11, 12 and 15 from t0a-t7a
+%assign %%i 0
+%rep 8
+    mova         m %+ %%i, [%4 + %%i * 16]
+%assign %%i %%i + 1
+%endrep
+    SUMSUB_BA        w, 4, 0, 8                             ; t0, t4
+    SUMSUB_BA        w, 5, 1, 8                             ; t1, t5
+    SUMSUB_BA        w, 6, 2, 8                             ; t2, t6
+    SUMSUB_BA        w, 7, 3, 8                             ; t3, t7
+    VP9_MUL_2D       0, 1, 8, 9, 15137_6270, 6270_m15137    ; t4a, t5a
+    VP9_MUL_2D       3, 2, 10, 11, 15137_m6270, 6270_15137  ; t6a, t7a
+    VP9_RND_SUMSUB_PACK 0, 8, 3, 10, 12                     ; -out3, t6
+    VP9_RND_SUMSUB_PACK 1, 9, 2, 11, 12                     ; out12, t7
+    SUMSUB_BA        w, 6, 4, 8                             ; out0, t2a
+    SUMSUB_BA        w, 7, 5, 8                             ; -out15, t3a
+    VP9_MUL_2W       4, 5, 8, 9, m11585_m11585, 11585_m11585 ; out7, out8
+    VP9_MUL_2W       2, 3, 8, 9, 11585_11585, 11585_m11585  ; out4, out11
+    pxor            m8, m8
+    VP9_NEG          0, 8, 9
+    VP9_NEG          7, 8, 9
+    mova  [%3 +  0 * 16], m6
+    mova  [%3 +  3 * 16], m0
+    mova  [%3 +  4 * 16], m2
+    mova  [%3 +  7 * 16], m4
+    mova  [%3 +  8 * 16], m5
+    mova  [%3 + 11 * 16], m3
+    mova  [%3 + 12 * 16], m1
+    mova  [%3 + 15 * 16], m7
+
+    ; outputs 1, 2, 5, 6, 9, 10, 13 and 14 from t8a-t15a
+%assign %%i 0
+%rep 8
+    mova         m %+ %%i, [%4 + (%%i + 8) * 16]
+%assign %%i %%i + 1
+%endrep
+    VP9_MUL_2D       0, 1, 8, 9, 16069_3196, 3196_m16069    ; t8, t9
+    VP9_MUL_2D       5, 4, 10, 11, 16069_m3196, 3196_16069  ; t12, t13
+    VP9_RND_SUMSUB_PACK 0, 8, 5, 10, 12                     ; t8a, t12a
+    VP9_RND_SUMSUB_PACK 1, 9, 4, 11, 12                     ; t9a, t13a
+    VP9_MUL_2D       2, 3, 8, 9, 9102_13623, 13623_m9102    ; t10, t11
+    VP9_MUL_2D       7, 6, 10, 11, 9102_m13623, 13623_9102  ; t14, t15
+    VP9_RND_SUMSUB_PACK 2, 8, 7, 10, 12                     ; t10a, t14a
+    VP9_RND_SUMSUB_PACK 3, 9, 6, 11, 12                     ; t11a, t15a
+    VP9_MUL_2D       5, 4, 8, 9, 15137_6270, 6270_m15137    ; t12, t13
+    VP9_MUL_2D       6, 7, 10, 11, 15137_m6270, 6270_15137  ; t14, t15
+    VP9_RND_SUMSUB_PACK 5, 8, 6, 10, 12                     ; out2, t14a
+    VP9_RND_SUMSUB_PACK 4, 9, 7, 11, 12                     ; -out13, t15a
+    SUMSUB_BA        w, 2, 0, 8                             ; -out1, t10
+    SUMSUB_BA        w, 3, 1, 8                             ; out14, t11
+    VP9_MUL_2W       1, 0, 8, 9, 11585_11585, 11585_m11585  ; out6, out9
+    VP9_MUL_2W       6, 7, 8, 9, m11585_m11585, 11585_m11585 ; out5, out10
+    pxor            m8, m8
+    VP9_NEG          2, 8, 9
+    VP9_NEG          4, 8, 9
+    mova  [%3 +  1 * 16], m2
+    mova  [%3 +  2 * 16], m5
+    mova  [%3 +  5 * 16], m6
+    mova  [%3 +  6 * 16], m1
+    mova  [%3 +  9 * 16], m0
+    mova  [%3 + 10 * 16], m7
+    mova  [%3 + 13 * 16], m4
+    mova  [%3 + 14 * 16], m3
+%endmacro
+
+; transpose the 8x8 words at [%1 + n * 16] into the rows [%2 + n * %3]
+%macro VP9_TRANSPOSE_STORE_8x8 3 ; src, dst, dst stride
+%assign %%i 0
+%rep 8
+    mova         m %+ %%i, [%1 + %%i * 16]
+%assign %%i %%i + 1
+%endrep
+    TRANSPOSE8x8W    0, 1, 2, 3, 4, 5, 6, 7, 8
+%assign %%i 0
+%rep 8
+    mova [%2 + %%i * %3], m %+ %%i
+%assign %%i %%i + 1
+%endrep
+%endmacro
+
+; round the %1 rows of 8 words at [%2 + n * 16] by the pmulhrsw constant %3
+; and add them to 8 pixels of %1 rows of dst, using rowq as the row pointer
+%macro VP9_ROUND_ADD_8xN 3 ; rows, src, rounding constant
+    mov           rowq, dstq
+    pxor            m8, m8
+%assign %%i 0
+%rep %1
+    mova            m0, [%2 + %%i * 16]
+    pmulhrsw        m0, [%3]
+    VP9_ADD_8PX      0, [rowq], 8, 9
+    add           rowq, strideq
+%assign %%i %%i + 1
+%endrep
+%endmacro
+
+; zero %1 rows of 16 bytes at [%2 + n * %3]
+%macro VP9_ZERO_ROWS 3 ; rows, dst, stride
+    pxor            m0, m0
+%assign %%i 0
+%rep %1
+    mova [%2 + %%i * %3], m0
+%assign %%i %%i + 1
+%endrep
+%endmacro
+
+; void ff_vp9_<type1>_<type2>_16x16_add_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                             int16_t *block, int eob)
+;
+; With an eob up to %5, all the non-zero coefficients are in the left 8
+; columns, which is the only strip of the first pass that needs to be done.
+%macro VP9_ITXFM_16x16 5 ; pass 1 name, pass 1 macro, pass 2 name, pass 2 macro, eob limit
+cglobal vp9_%1_%3_16x16_add, 4, 7, 13, 512 + 256 + 256, dst, stride, block, eob, cnt, tmp, row
+%define %%tmp     rsp
+%define %%out     rsp + 512
+%define %%scratch rsp + 768
+%ifidn %1_%3, idct_idct
+    cmp           eobd, 1
+    jne .full
+    VP9_IDCT_DC_ADD 16, pw_512
+    RET
+.full:
+%endif
+    mov           cntd, 2
+    cmp           eobd, %5
+    jg .pass1
+    VP9_ZERO_ROWS   16, %%tmp + 256, 16
+    mov           cntd, 1
+.pass1:
+    lea           tmpq, [%%tmp]
+.pass1_loop:
+    VP9_%2_1D   blockq, 32, %%out, %%scratch
+    VP9_ZERO_ROWS   16, blockq, 32
+    VP9_TRANSPOSE_STORE_8x8 %%out, tmpq, 32
+    VP9_TRANSPOSE_STORE_8x8 %%out + 128, tmpq + 16, 32
+    add         blockq, 16
+    add           tmpq, 256
+    dec           cntd
+    jg .pass1_loop
+
+    mov           cntd, 2
+    lea           tmpq, [%%tmp]
+.pass2_loop:
+    VP9_%4_1D     tmpq, 32, %%out, %%scratch
+    VP9_ROUND_ADD_8xN 16, %%out, pw_512
+    add           tmpq, 16
+    add           dstq, 8
+    dec           cntd
+    jg .pass2_loop
+    RET
+%endmacro
+
+%macro VP9_ITXFM_16x16_FUNCS 0
+VP9_ITXFM_16x16 idct,  IDCT16,  idct,  IDCT16,  38
+VP9_ITXFM_16x16 iadst, IADST16, idct,  IDCT16,  17
+VP9_ITXFM_16x16 idct,  IDCT16,  iadst, IADST16, 66
+VP9_ITXFM_16x16 iadst, IADST16, iadst, IADST16, 38
+%endmacro
+
+INIT_XMM ssse3
+VP9_ITXFM_16x16_FUNCS
+INIT_XMM avx
+VP9_ITXFM_16x16_FUNCS
+
+;------------------------------------------------------------------------------
+; 32x32
+;------------------------------------------------------------------------------
+
+; out[n] = even[n] + odd[n], out[31 - n] = even[n] - odd[n] for the odd value
+; in m%1, with the even half at %2 and the output at %3
+%macro VP9_IDCT32_OUT 4 ; odd register, n, even, dst
+    mova           m10, [%3 + %2 * 16]
+    paddw          m11, m10, m%1
+    psubw          m10, m%1
+    mova [%4 + %2 * 16], m11
+    mova [%4 + (31 - %2) * 16], m10
+%endmacro
+
+; the odd half of the 32 point idct, from in1, in3, ..., in31 at
+; [%1 + n * %2], combined with the even half at %3 into out0-out31 at %4,
+; using 128 bytes of scratch space at %5
+%macro VP9_IDCT32_ODD_1D 5 ; src, src stride, even, dst, scratch
+    mova            m0, [%1 +  1 * %2]
+    mova            m1, [%1 + 31 * %2]
+    mova            m2, [%1 + 17 * %2]
+    mova            m3, [%1 + 15 * %2]
+    mova            m4, [%1 +  9 * %2]
+    mova            m5, [%1 + 23 * %2]
+    mova            m6, [%1 + 25 * %2]
+    mova            m7, [%1 +  7 * %2]
+    VP9_MUL_2W       0, 1, 8, 9, 804_m16364, 16364_804      ; t16a, t31a
+    VP9_MUL_2W       2, 3, 8, 9, 12140_m11003, 11003_12140  ; t17a, t30a
+    VP9_MUL_2W       4, 5, 8, 9, 7005_m14811, 14811_7005    ; t18a, t29a
+    VP9_MUL_2W       6, 7, 8, 9, 15426_m5520, 5520_15426    ; t19a, t28a
+    SUMSUB_BA        w, 2, 0, 8                             ; t16, t17
+    SUMSUB_BA        w, 3, 1, 8                             ; t31, t30
+    SUMSUB_BA        w, 4, 6, 8                             ; t19, t18
+    SUMSUB_BA        w, 5, 7, 8                             ; t28, t29
+    VP9_MUL_2W       1, 0, 8, 9, 3196_m16069, 16069_3196    ; t17a, t30a
+    VP9_MUL_2W       7, 6, 8, 9, m16069_m3196, 3196_m16069  ; t18a, t29a
+    SUMSUB_BA        w, 4, 2, 8                             ; t16a, t19a
+    SUMSUB_BA        w, 7, 1, 8                             ; t17, t18
+    SUMSUB_BA        w, 5, 3, 8                             ; t31a, t28a
+    SUMSUB_BA        w, 6, 0, 8                             ; t30, t29
+    VP9_MUL_2W       0, 1, 8, 9, 6270_m15137, 15137_6270    ; t18a, t29a
+    VP9_MUL_2W       3, 2, 8, 9, 6270_m15137, 15137_6270    ; t19, t28
+    mova  [%5 + 0 * 16], m4
+    mova  [%5 + 1 * 16], m5
+    mova  [%5 + 2 * 16], m7
+    mova  [%5 + 3 * 16], m6
+    mova  [%5 + 4 * 16], m0
+    mova  [%5 + 5 * 16], m1
+    mova  [%5 + 6 * 16], m3
+    mova  [%5 + 7 * 16], m2
+
+    mova            m0, [%1 +  5 * %2]
+    mova            m1, [%1 + 27 * %2]
+    mova            m2, [%1 + 21 * %2]
+    mova            m3, [%1 + 11 * %2]
+    mova            m4, [%1 + 13 * %2]
+    mova            m5, [%1 + 19 * %2]
+    mova            m6, [%1 + 29 * %2]
+    mova            m7, [%1 +  3 * %2]
+    VP9_MUL_2W       0, 1, 8, 9, 3981_m15893, 15893_3981    ; t20a, t27a
+    VP9_MUL_2W       2, 3, 8, 9, 14053_m8423, 8423_14053    ; t21a, t26a
+    VP9_MUL_2W       4, 5, 8, 9, 9760_m13160, 13160_9760    ; t22a, t25a
+    VP9_MUL_2W       6, 7, 8, 9, 16207_m2404, 2404_16207    ; t23a, t24a
+    SUMSUB_BA        w, 2, 0, 8                             ; t20, t21
+    SUMSUB_BA        w, 3, 1, 8                             ; t27, t26
+    SUMSUB_BA        w, 4, 6, 8                             ; t23, t22
+    SUMSUB_BA        w, 5, 7, 8                             ; t24, t25
+    VP9_MUL_2W       1, 0, 8, 9, 13623_m9102, 9102_13623    ; t21a, t26a
+    VP9_MUL_2W       7, 6, 8, 9, m9102_m13623, 13623_m9102  ; t22a, t25a
+    SUMSUB_BA        w, 2, 4, 8                             ; t23a, t20a
+    SUMSUB_BA        w, 1, 7, 8                             ; t22, t21
+    SUMSUB_BA        w, 3, 5, 8                             ; t24a, t27a
+    SUMSUB_BA        w, 0, 6, 8                             ; t25, t26
+    VP9_MUL_2W       5, 4, 8, 9, m15137_m6270, 6270_m15137  ; t20, t27
+    VP9_MUL_2W       6, 7, 8, 9, m15137_m6270, 6270_m15137  ; t21a, t26a
+
+    mova            m8, [%5 + 0 * 16]                       ; t16a
+    mova            m9, [%5 + 1 * 16]                       ; t31a
+    SUMSUB_BA        w, 2, 8, 10                            ; t16, t23
+    SUMSUB_BA        w, 3, 9, 10                            ; t31, t24
+    VP9_MUL_2W       9, 8, 10, 11, 11585_m11585, 11585_11585 ; t23a, t24a
+    VP9_IDCT32_OUT   3,  0, %3, %4
+    VP9_IDCT32_OUT   8,  7, %3, %4
+    VP9_IDCT32_OUT   9,  8, %3, %4
+    VP9_IDCT32_OUT   2, 15, %3, %4
+
+    mova            m8, [%5 + 2 * 16]                       ; t17
+    mova            m9, [%5 + 3 * 16]                       ; t30
+    SUMSUB_BA        w, 1, 8, 10                            ; t17a, t22a
+    SUMSUB_BA        w, 0, 9, 10                            ; t30a, t25a
+    VP9_MUL_2W       9, 8, 10, 11, 11585_m11585, 11585_11585 ; t22, t25
+    VP9_IDCT32_OUT   0,  1, %3, %4
+    VP9_IDCT32_OUT   8,  6, %3, %4
+    VP9_IDCT32_OUT   9,  9, %3, %4
+    VP9_IDCT32_OUT   1, 14, %3, %4
+
+    mova            m8, [%5 + 4 * 16]                       ; t18a
+    mova            m9, [%5 + 5 * 16]                       ; t29a
+    SUMSUB_BA        w, 6, 8, 10                            ; t18, t21
+    SUMSUB_BA        w, 7, 9, 10                            ; t29, t26
+    VP9_MUL_2W       9, 8, 10, 11, 11585_m11585, 11585_11585 ; t21a, t26a
+    VP9_IDCT32_OUT   7,  2, %3, %4
+    VP9_IDCT32_OUT   8,  5, %3, %4
+    VP9_IDCT32_OUT   9, 10, %3, %4
+    VP9_IDCT32_OUT   6, 13, %3, %4
+
+    mova            m8, [%5 + 6 * 16]                       ; t19
+    mova            m9, [%5 + 7 * 16]                       ; t28
+    SUMSUB_BA        w, 5, 8, 10                            ; t19a, t20a
+    SUMSUB_BA        w, 4, 9, 10                            ; t28a, t27a
+    VP9_MUL_2W       9, 8, 10, 11, 11585_m11585, 11585_11585 ; t20, t27
+    VP9_IDCT32_OUT   4,  3, %3, %4
+    VP9_IDCT32_OUT   8,  4, %3, %4
+    VP9_IDCT32_OUT   9, 11, %3, %4
+    VP9_IDCT32_OUT   5, 12, %3, %4
+%endmacro
+
+; void ff_vp9_idct_idct_32x32_add_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                       int16_t *block, int eob)
+;
+; The eob limits of the default scan under which only the left 8, 16 or 24
+; columns of coefficients can be non-zero select how many strips of the
+; first pass are done.
+%macro VP9_IDCT_IDCT_32x32 0
+cglobal vp9_idct_idct_32x32_add, 4, 7, 13, 2048 + 512 + 256 + 256, dst, stride, block, eob, cnt, tmp, row
+%define %%tmp     rsp
+%define %%out     rsp + 2048
+%define %%even    rsp + 2560
+%define %%scratch rsp + 2816
+    cmp           eobd, 1
+    jne .full
+    VP9_IDCT_DC_ADD 32, pw_512
+    RET
+.full:
+    mov           cntd, 4
+    cmp           eobd, 336
+    jg .pass1
+    mov           cntd, 3
+    cmp           eobd, 135
+    jg .zero
+    mov           cntd, 2
+    cmp           eobd, 34
+    jg .zero
+    mov           cntd, 1
+.zero:
+    ; clear the first pass output of the skipped strips
+    mov           tmpd, cntd
+    shl           tmpd, 9
+    add           tmpq, rsp
+    lea           rowq, [%%tmp + 2048]
+    pxor            m0, m0
+.zero_loop:
+    mova   [tmpq +  0], m0
+    mova   [tmpq + 16], m0
+    mova   [tmpq + 32], m0
+    mova   [tmpq + 48], m0
+    add           tmpq, 64
+    cmp           tmpq, rowq
+    jb .zero_loop
+.pass1:
+    lea           tmpq, [%%tmp]
+.pass1_loop:
+    VP9_IDCT16_1D   blockq, 128, %%even, %%scratch
+    VP9_IDCT32_ODD_1D blockq, 64, %%even, %%out, %%scratch
+    VP9_ZERO_ROWS   32, blockq, 64
+    VP9_TRANSPOSE_STORE_8x8 %%out,       tmpq,      64
+    VP9_TRANSPOSE_STORE_8x8 %%out + 128, tmpq + 16, 64
+    VP9_TRANSPOSE_STORE_8x8 %%out + 256, tmpq + 32, 64
+    VP9_TRANSPOSE_STORE_8x8 %%out + 384, tmpq + 48, 64
+    add         blockq, 16
+    add           tmpq, 512
+    dec           cntd
+    jg .pass1_loop
+
+    mov           cntd, 4
+    lea           tmpq, [%%tmp]
+.pass2_loop:
+    VP9_IDCT16_1D     tmpq, 128, %%even, %%scratch
+    VP9_IDCT32_ODD_1D tmpq, 64, %%even, %%out, %%scratch
+    VP9_ROUND_ADD_8xN 32, %%out, pw_512
+    add           tmpq, 16
+    add           dstq, 8
+    dec           cntd
+    jg .pass2_loop
+    RET
+%endmacro
+
+INIT_XMM ssse3
+VP9_IDCT_IDCT_32x32
+INIT_XMM avx
+VP9_IDCT_IDCT_32x32
+
+%endif ; ARCH_X86_64
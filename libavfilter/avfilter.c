@@ -31,6 +31,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/trace.h"
 
 #include "audio.h"
 #include "avfilter.h"
@@ -643,6 +644,7 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
     int (*filter_frame)(AVFilterLink *, AVFrame *);
     AVFilterPad *dst = link->dstpad;
     AVFrame *out = NULL;
+    int64_t frame_number;
     int ret;
 
     FF_DPRINTF_START(NULL, filter_frame);
@@ -695,7 +697,12 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
     } else
         out = frame;
 
-    return filter_frame(link, out);
+    frame_number = link->dst->internal->frame_count_in++;
+    av_trace_begin(link->dst, "filter_frame", -1, frame_number);
+    ret = filter_frame(link, out);
+    av_trace_end(link->dst, "filter_frame", -1, frame_number);
+
+    return ret;
 
 fail:
     av_frame_free(&out);
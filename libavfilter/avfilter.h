@@ -604,6 +604,20 @@ typedef struct AVFilterGraph {
      * platform and build options.
      */
     avfilter_execute_func *execute;
+
+    /**
+     * Thread pool created with av_thread_pool_alloc(), shared with other
+     * filter graphs or codec contexts. When set, the slice threading jobs of
+     * the filters in this graph run on the workers of the pool instead of on
+     * threads private to the graph, and nb_threads only limits the number of
+     * jobs of one filter running at the same time. Ignored when execute is
+     * set.
+     *
+     * May be set by the caller before adding any filters to the filtergraph.
+     * The reference is owned by libavfilter after that, and is released by
+     * avfilter_graph_free().
+     */
+    AVBufferRef *thread_pool;
 } AVFilterGraph;
 
 /**
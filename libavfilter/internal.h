@@ -133,6 +133,8 @@ struct AVFilterGraphInternal {
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    /* number of frames passed to the inputs of the filter, for tracing */
+    int64_t frame_count_in;
 };
 
 /** Tell is a format is contained in the provided list terminated by -1. */
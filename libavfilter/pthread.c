@@ -26,6 +26,7 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
+#include "libavutil/threadpool.h"
 
 #include "avfilter.h"
 #include "internal.h"
@@ -97,6 +98,9 @@ static void slice_thread_uninit(ThreadContext *c)
 {
     int i;
 
+    if (!c->workers)
+        return;
+
     pthread_mutex_lock(&c->current_job_lock);
     c->done = 1;
     pthread_cond_broadcast(&c->current_job_cond);
@@ -150,6 +154,43 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
     return 0;
 }
 
+/* the jobs of a pool_execute() call */
+typedef struct PoolJobs {
+    AVFilterContext *ctx;
+    avfilter_action_func *func;
+    void *arg;
+    int *rets;
+    int nb_jobs;
+} PoolJobs;
+
+static void pool_job(void *opaque, int job, int thread)
+{
+    PoolJobs *p = opaque;
+    int ret = p->func(p->ctx, p->arg, job, p->nb_jobs);
+
+    if (p->rets)
+        p->rets[job] = ret;
+}
+
+static int pool_execute(AVFilterContext *ctx, avfilter_action_func *func,
+                        void *arg, int *ret, int nb_jobs)
+{
+    AVFilterGraph *graph = ctx->graph;
+    PoolJobs p = {
+        .ctx     = ctx,
+        .func    = func,
+        .arg     = arg,
+        .rets    = ret,
+        .nb_jobs = nb_jobs,
+    };
+
+    if (nb_jobs <= 0)
+        return 0;
+
+    return av_thread_pool_execute(graph->thread_pool, pool_job, &p,
+                                  nb_jobs, graph->nb_threads);
+}
+
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
     int i, ret;
@@ -168,6 +209,11 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
         return 1;
 
     c->nb_threads = nb_threads;
+
+    /* the jobs run on the workers of the shared pool */
+    if (c->graph->thread_pool)
+        return nb_threads;
+
     c->workers = av_mallocz(sizeof(*c->workers) * nb_threads);
     if (!c->workers)
         return AVERROR(ENOMEM);
@@ -212,6 +258,7 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->internal->thread = av_mallocz(sizeof(ThreadContext));
     if (!graph->internal->thread)
         return AVERROR(ENOMEM);
+    ((ThreadContext *)graph->internal->thread)->graph = graph;
 
     ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
     if (ret <= 1) {
@@ -222,7 +269,8 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     }
     graph->nb_threads = ret;
 
-    graph->internal->thread_execute = thread_execute;
+    graph->internal->thread_execute = graph->thread_pool ? pool_execute :
+                                                           thread_execute;
 
     return 0;
 }
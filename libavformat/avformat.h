@@ -1038,6 +1038,13 @@ typedef struct AVFormatContext {
  * This flag is mainly intended for testing.
  */
 #define AVFMT_FLAG_BITEXACT         0x0400
+/**
+ * Allocate the packet payloads from pools of reusable buffers instead of
+ * allocating a new buffer for each packet, which avoids going through the
+ * memory allocator at high packet rates. The buffers stay allocated until
+ * the context is closed and all the packets are freed.
+ */
+#define AVFMT_FLAG_POOL_PACKETS     0x0800
 
     /**
      * Maximum size of the data read from input for determining
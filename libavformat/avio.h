@@ -177,6 +177,13 @@ typedef struct AVIOContext {
     enum AVIODataMarkerType current_type;
     int64_t last_time;
     int64_t written;
+
+    /**
+     * Internal, not meant to be used from outside of libavformat.
+     * Packet pool of the demuxer reading from this context, used by
+     * av_get_packet().
+     */
+    struct PacketPool *packet_pool;
 } AVIOContext;
 
 /**
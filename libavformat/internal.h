@@ -43,6 +43,8 @@ typedef struct CodecMime{
     enum AVCodecID id;
 } CodecMime;
 
+typedef struct PacketPool PacketPool;
+
 struct AVFormatInternal {
     /**
      * Number of streams relevant for interleaving.
@@ -94,6 +96,12 @@ struct AVFormatInternal {
 #if FF_API_COMPUTE_PKT_FIELDS2
     int missing_ts_warning;
 #endif
+
+    /**
+     * Packet payload buffers, with AVFMT_FLAG_POOL_PACKETS.
+     * Demuxing only.
+     */
+    PacketPool *packet_pool;
 };
 
 struct AVStreamInternal {
@@ -381,6 +389,14 @@ int ff_framehash_write_header(AVFormatContext *s);
  */
 int ff_read_packet(AVFormatContext *s, AVPacket *pkt);
 
+/**
+ * Allocate a buffer for packet payloads, from the packet pool of the
+ * context when AVFMT_FLAG_POOL_PACKETS is set.
+ *
+ * @return the buffer, NULL on failure
+ */
+AVBufferRef *ff_packet_buffer_alloc(AVFormatContext *s, int size);
+
 /**
  * Interleave a packet per dts in an output media file.
  *
@@ -34,6 +34,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/time.h"
+#include "libavutil/trace.h"
 #include "riff.h"
 #include "audiointerleave.h"
 #include "url.h"
@@ -338,7 +339,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
 static int write_packet(AVFormatContext *s, AVPacket *pkt)
 {
-    int ret;
+    int64_t frame_number;
+    int stream_index, ret;
     // If the timestamp offsetting below is adjusted, adjust
     // ff_interleaved_peek similarly.
     if (s->avoid_negative_ts > 0) {
@@ -366,7 +368,11 @@ static int write_packet(AVFormatContext *s, AVPacket *pkt)
                    pkt->dts, pkt->stream_index);
         }
     }
+    stream_index = pkt->stream_index;
+    frame_number = s->streams[stream_index]->nb_frames;
+    av_trace_begin(s, "write_packet", stream_index, frame_number);
     ret = s->oformat->write_packet(s, pkt);
+    av_trace_end(s, "write_packet", stream_index, frame_number);
 
     if (s->pb && ret >= 0) {
         if (s->flags & AVFMT_FLAG_FLUSH_PACKETS)
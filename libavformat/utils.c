@@ -28,6 +28,7 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/dict.h"
 #include "libavutil/internal.h"
 #include "libavutil/mathematics.h"
@@ -74,6 +75,104 @@ const char *avformat_license(void)
 /* an arbitrarily chosen "sane" max packet size -- 50M */
 #define SANE_CHUNK_SIZE (50000000)
 
+/* size classes of the packet pool, larger packets are not pooled */
+#define PACKET_POOL_MIN_LOG2  9
+#define PACKET_POOL_MAX_LOG2 22
+
+/* Payload buffers for AVFMT_FLAG_POOL_PACKETS, one AVBufferPool per power
+ * of two size. */
+struct PacketPool {
+    AVBufferPool *pools[PACKET_POOL_MAX_LOG2 - PACKET_POOL_MIN_LOG2 + 1];
+};
+
+static void packet_pool_free(PacketPool **ppool)
+{
+    PacketPool *pool = *ppool;
+    int i;
+
+    if (!pool)
+        return;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(pool->pools); i++)
+        av_buffer_pool_uninit(&pool->pools[i]);
+    av_freep(ppool);
+}
+
+/* Get a buffer of size bytes, at most 1 << PACKET_POOL_MAX_LOG2. */
+static AVBufferRef *packet_pool_get(PacketPool *pool, int size)
+{
+    int idx = FFMAX(av_log2(size - 1) + 1, PACKET_POOL_MIN_LOG2) -
+              PACKET_POOL_MIN_LOG2;
+    AVBufferRef *buf;
+
+    if (!pool->pools[idx]) {
+        pool->pools[idx] = av_buffer_pool_init(1 << (idx + PACKET_POOL_MIN_LOG2),
+                                               NULL);
+        if (!pool->pools[idx])
+            return NULL;
+    }
+
+    buf = av_buffer_pool_get(pool->pools[idx]);
+    if (buf)
+        buf->size = size;
+    return buf;
+}
+
+AVBufferRef *ff_packet_buffer_alloc(AVFormatContext *s, int size)
+{
+    if (!s->internal->packet_pool || size <= 0 ||
+        size > 1 << PACKET_POOL_MAX_LOG2)
+        return av_buffer_alloc(size);
+    return packet_pool_get(s->internal->packet_pool, size);
+}
+
+/* Same as av_new_packet(), but with a buffer from the pool. */
+static int packet_pool_new_packet(PacketPool *pool, AVPacket *pkt, int size)
+{
+    AVBufferRef *buf;
+
+    if (size < 0 || size >= INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR(EINVAL);
+
+    /* larger packets are reallocatable, so that they can grow in place */
+    if (size + AV_INPUT_BUFFER_PADDING_SIZE > 1 << PACKET_POOL_MAX_LOG2)
+        return av_new_packet(pkt, size);
+
+    buf = packet_pool_get(pool, size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!buf)
+        return AVERROR(ENOMEM);
+    memset(buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    av_init_packet(pkt);
+    pkt->buf  = buf;
+    pkt->data = buf->data;
+    pkt->size = size;
+
+    return 0;
+}
+
+/* Copy the data of a packet which is not reference counted to a buffer
+ * from the pool, keeping the other fields. */
+static int packet_pool_make_refcounted(PacketPool *pool, AVPacket *pkt)
+{
+    AVPacket tmp;
+    int ret;
+
+    if (pkt->buf)
+        return 0;
+
+    ret = packet_pool_new_packet(pool, &tmp, pkt->size);
+    if (ret < 0)
+        return ret;
+    if (pkt->size)
+        memcpy(tmp.data, pkt->data, pkt->size);
+
+    pkt->buf  = tmp.buf;
+    pkt->data = tmp.data;
+
+    return 0;
+}
+
 /* Read the data in sane-sized chunks and append to pkt.
  * Return the number of bytes read or an error. */
 static int append_packet_chunked(AVIOContext *s, AVPacket *pkt, int size)
@@ -95,7 +194,10 @@ static int append_packet_chunked(AVIOContext *s, AVPacket *pkt, int size)
         }
         read_size = FFMIN(size, chunk_size);
 
-        ret = av_grow_packet(pkt, read_size);
+        if (!pkt->size && s->packet_pool)
+            ret = packet_pool_new_packet(s->packet_pool, pkt, read_size);
+        else
+            ret = av_grow_packet(pkt, read_size);
         if (ret < 0)
             break;
 
@@ -444,6 +546,17 @@ int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
         pkt->data = NULL;
         pkt->size = 0;
         av_init_packet(pkt);
+
+        if (s->flags & AVFMT_FLAG_POOL_PACKETS) {
+            if (!s->internal->packet_pool) {
+                s->internal->packet_pool = av_mallocz(sizeof(*s->internal->packet_pool));
+                if (!s->internal->packet_pool)
+                    return AVERROR(ENOMEM);
+            }
+            if (s->pb)
+                s->pb->packet_pool = s->internal->packet_pool;
+        }
+
         ret = s->iformat->read_packet(s, pkt);
         if (ret < 0) {
             if (!pktl || ret == AVERROR(EAGAIN))
@@ -457,7 +570,11 @@ int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
             continue;
         }
 
-        if (!pkt->buf) {
+        if (s->internal->packet_pool) {
+            ret = packet_pool_make_refcounted(s->internal->packet_pool, pkt);
+            if (ret < 0)
+                return ret;
+        } else if (!pkt->buf) {
             AVPacket tmp = { 0 };
             ret = av_packet_ref(&tmp, pkt);
             if (ret < 0)
@@ -883,9 +1000,18 @@ static int parse_packet(AVFormatContext *s, AVPacket *pkt, int stream_index)
                                0, 0, AVINDEX_KEYFRAME);
         }
 
-        if ((ret = add_to_pktbuf(&s->internal->parse_queue, &out_pkt,
-                                 &s->internal->parse_queue_end,
-                                 1))) {
+        if (s->internal->packet_pool) {
+            /* move the output to a pooled buffer instead of letting
+             * add_to_pktbuf() copy it to a new one */
+            ret = packet_pool_make_refcounted(s->internal->packet_pool, &out_pkt);
+            if (!ret)
+                ret = add_to_pktbuf(&s->internal->parse_queue, &out_pkt,
+                                    &s->internal->parse_queue_end, 0);
+        } else {
+            ret = add_to_pktbuf(&s->internal->parse_queue, &out_pkt,
+                                &s->internal->parse_queue_end, 1);
+        }
+        if (ret) {
             av_packet_unref(&out_pkt);
             goto fail;
         }
@@ -2726,6 +2852,7 @@ void avformat_free_context(AVFormatContext *s)
     av_freep(&s->chapters);
     av_dict_free(&s->metadata);
     av_freep(&s->streams);
+    packet_pool_free(&s->internal->packet_pool);
     av_freep(&s->internal);
     av_free(s);
 }
@@ -2745,6 +2872,10 @@ void avformat_close_input(AVFormatContext **ps)
         if (s->iformat->read_close)
             s->iformat->read_close(s);
 
+    /* the context may be user-supplied and outlive the pool */
+    if (s->pb && s->pb->packet_pool == s->internal->packet_pool)
+        s->pb->packet_pool = NULL;
+
     avformat_free_context(s);
 
     *ps = NULL;
@@ -0,0 +1,128 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program runs the jobs of several callers on a pool with fewer
+ * workers, each job waiting for the previous one of its batch to finish,
+ * and checks that every job runs once with a thread index which is not in
+ * use by another job of the same batch.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+#include "libavutil/time.h"
+
+#define NB_CALLERS 4
+#define NB_ROUNDS  200
+#define MAX_JOBS   40
+
+typedef struct Batch {
+    atomic_int done[MAX_JOBS];
+    atomic_int busy[MAX_JOBS];
+    int max_threads;
+    atomic_int errors;
+} Batch;
+
+typedef struct Caller {
+    AVBufferRef *pool;
+    int id;
+    int errors;
+} Caller;
+
+static void job_func(void *opaque, int job, int thread)
+{
+    Batch *b = opaque;
+
+    if (thread < 0 || thread >= b->max_threads ||
+        atomic_exchange(&b->busy[thread], 1)) {
+        atomic_fetch_add(&b->errors, 1);
+        return;
+    }
+    if (job > 0)
+        while (!atomic_load(&b->done[job - 1]))
+            av_usleep(0);
+    if (atomic_exchange(&b->done[job], 1))
+        atomic_fetch_add(&b->errors, 1);
+    atomic_store(&b->busy[thread], 0);
+}
+
+static void *caller_main(void *arg)
+{
+    Caller *c = arg;
+    int round, i;
+
+    for (round = 0; round < NB_ROUNDS; round++) {
+        Batch b;
+        int nb_jobs = 1 + (round * 7 + c->id) % MAX_JOBS;
+
+        b.max_threads = 1 + (round + c->id) % 8;
+        atomic_init(&b.errors, 0);
+        for (i = 0; i < MAX_JOBS; i++) {
+            atomic_init(&b.done[i], 0);
+            atomic_init(&b.busy[i], 0);
+        }
+
+        av_thread_pool_execute(c->pool, job_func, &b, nb_jobs, b.max_threads);
+
+        for (i = 0; i < MAX_JOBS; i++)
+            if (atomic_load(&b.done[i]) != (i < nb_jobs))
+                c->errors++;
+        c->errors += atomic_load(&b.errors);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    Caller callers[NB_CALLERS];
+    pthread_t threads[NB_CALLERS];
+    AVBufferRef *pool;
+    int i, ret, errors = 0;
+
+    pool = av_thread_pool_alloc(2);
+    if (!pool) {
+        fprintf(stderr, "av_thread_pool_alloc failed.\n");
+        return 1;
+    }
+
+    for (i = 0; i < NB_CALLERS; i++) {
+        callers[i].pool   = pool;
+        callers[i].id     = i;
+        callers[i].errors = 0;
+        if ((ret = pthread_create(&threads[i], NULL, caller_main, &callers[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            return 1;
+        }
+    }
+    for (i = 0; i < NB_CALLERS; i++) {
+        pthread_join(threads[i], NULL);
+        errors += callers[i].errors;
+    }
+
+    av_buffer_unref(&pool);
+
+    if (errors) {
+        fprintf(stderr, "%d errors.\n", errors);
+        return 2;
+    }
+    return 0;
+}
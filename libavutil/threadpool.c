@@ -0,0 +1,254 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <stdint.h>
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#endif
+
+#include "buffer.h"
+#include "common.h"
+#include "cpu.h"
+#include "internal.h"
+#include "mem.h"
+#include "threadpool.h"
+
+#define MAX_BATCH_THREADS 64
+
+/* the jobs of one av_thread_pool_execute() call, which lives on the stack
+ * of the calling thread */
+typedef struct ThreadPoolBatch {
+    av_thread_pool_job_func *func;
+    void *opaque;
+    int nb_jobs;
+    int next_job;          ///< index of the next job to start
+    int nb_done;
+    uint64_t threads;      ///< thread indexes in use
+    uint64_t all_threads;  ///< all the thread indexes the batch may use
+    struct ThreadPoolBatch *next;
+} ThreadPoolBatch;
+
+typedef struct ThreadPool {
+    int nb_threads;
+#if HAVE_THREADS
+    pthread_t *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    /* the batches with jobs left to start, served in round-robin order */
+    ThreadPoolBatch *first;
+    ThreadPoolBatch *last;
+    int quit;
+#endif
+} ThreadPool;
+
+#if HAVE_THREADS
+/* take the next job of a batch and move the batch to the end of the queue,
+ * or remove it once all of its jobs are started */
+static int batch_next_job(ThreadPool *pool, ThreadPoolBatch *b)
+{
+    ThreadPoolBatch **p = &pool->first, *prev = NULL;
+    int job = b->next_job++;
+
+    while (*p != b) {
+        prev = *p;
+        p    = &prev->next;
+    }
+    *p = b->next;
+    if (pool->last == b)
+        pool->last = prev;
+    b->next = NULL;
+
+    if (b->next_job < b->nb_jobs) {
+        if (pool->last)
+            pool->last->next = b;
+        else
+            pool->first = b;
+        pool->last = b;
+    }
+    return job;
+}
+
+static void *attribute_align_arg worker(void *arg)
+{
+    ThreadPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        ThreadPoolBatch *b;
+        int job, thread;
+
+        for (b = pool->first; b; b = b->next)
+            if (b->threads != b->all_threads)
+                break;
+        if (!b) {
+            if (pool->quit)
+                break;
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+            continue;
+        }
+
+        for (thread = 1; b->threads & (UINT64_C(1) << thread); thread++);
+        b->threads |= UINT64_C(1) << thread;
+        job = batch_next_job(pool, b);
+        pthread_mutex_unlock(&pool->lock);
+
+        b->func(b->opaque, job, thread);
+
+        pthread_mutex_lock(&pool->lock);
+        b->threads &= ~(UINT64_C(1) << thread);
+        if (b->next_job < b->nb_jobs)
+            pthread_cond_signal(&pool->work_cond);
+        if (++b->nb_done == b->nb_jobs)
+            pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static void thread_pool_stop(ThreadPool *pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->workers[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    av_freep(&pool->workers);
+}
+#endif
+
+static void thread_pool_free(void *opaque, uint8_t *data)
+{
+    ThreadPool *pool = (ThreadPool *)data;
+
+#if HAVE_THREADS
+    if (pool->workers)
+        thread_pool_stop(pool);
+#endif
+    av_free(pool);
+}
+
+AVBufferRef *av_thread_pool_alloc(int nb_threads)
+{
+    ThreadPool *pool;
+    AVBufferRef *buf;
+
+    if (nb_threads < 0)
+        return NULL;
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    buf = av_buffer_create((uint8_t *)pool, sizeof(*pool),
+                           thread_pool_free, NULL, 0);
+    if (!buf) {
+        av_free(pool);
+        return NULL;
+    }
+
+#if HAVE_THREADS
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+    pool->workers = av_mallocz_array(nb_threads, sizeof(*pool->workers));
+    if (!pool->workers)
+        goto fail;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    for (; pool->nb_threads < nb_threads; pool->nb_threads++) {
+        if (pthread_create(&pool->workers[pool->nb_threads], NULL,
+                           worker, pool))
+            goto fail;
+    }
+#endif
+
+    return buf;
+#if HAVE_THREADS
+fail:
+    av_buffer_unref(&buf);
+    return NULL;
+#endif
+}
+
+int av_thread_pool_execute(AVBufferRef *pool_ref, av_thread_pool_job_func *func,
+                           void *opaque, int nb_jobs, int max_threads)
+{
+    ThreadPool *pool = (ThreadPool *)pool_ref->data;
+    int job;
+
+#if HAVE_THREADS
+    max_threads = FFMIN3(max_threads, nb_jobs, MAX_BATCH_THREADS);
+    max_threads = FFMIN(max_threads, pool->nb_threads + 1);
+    if (max_threads > 1) {
+        ThreadPoolBatch b = {
+            .func        = func,
+            .opaque      = opaque,
+            .nb_jobs     = nb_jobs,
+            /* the calling thread keeps index 0 */
+            .threads     = 1,
+            .all_threads = max_threads == MAX_BATCH_THREADS ? UINT64_MAX :
+                           (UINT64_C(1) << max_threads) - 1,
+        };
+
+        pthread_mutex_lock(&pool->lock);
+        if (pool->last)
+            pool->last->next = &b;
+        else
+            pool->first = &b;
+        pool->last = &b;
+        pthread_cond_broadcast(&pool->work_cond);
+
+        while (b.next_job < b.nb_jobs) {
+            job = batch_next_job(pool, &b);
+            pthread_mutex_unlock(&pool->lock);
+
+            func(opaque, job, 0);
+
+            pthread_mutex_lock(&pool->lock);
+            b.nb_done++;
+        }
+        while (b.nb_done < b.nb_jobs)
+            pthread_cond_wait(&pool->done_cond, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+
+        return 0;
+    }
+#endif
+
+    for (job = 0; job < nb_jobs; job++)
+        func(opaque, job, 0);
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Worker thread pool shared by several codec and filter graph instances
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+#include "buffer.h"
+
+/**
+ * @defgroup lavu_threadpool Thread pool
+ * @ingroup lavu_misc
+ *
+ * A thread pool runs the parallel jobs of any number of callers on a fixed
+ * set of worker threads. Attaching the same pool to several AVCodecContext
+ * and AVFilterGraph instances bounds the total number of threads they use,
+ * instead of each one creating its own.
+ *
+ * The pool is reference-counted with the AVBuffer mechanism. The worker
+ * threads are stopped when the last reference is released.
+ *
+ * @{
+ */
+
+/**
+ * Function run for each job of av_thread_pool_execute().
+ *
+ * @param opaque the opaque pointer passed to av_thread_pool_execute()
+ * @param job    the index of the job, in [0, nb_jobs)
+ * @param thread an index in [0, max_threads) which no other job of the same
+ *               av_thread_pool_execute() call uses while this one runs
+ */
+typedef void (av_thread_pool_job_func)(void *opaque, int job, int thread);
+
+/**
+ * Allocate a thread pool.
+ *
+ * Without thread support the pool has no workers and the jobs run one after
+ * the other on the calling thread.
+ * @param nb_threads number of worker threads, 0 to use the number of
+ *                   logical CPUs
+ * @return a reference to the pool, NULL on failure or if nb_threads is
+ *         negative
+ */
+AVBufferRef *av_thread_pool_alloc(int nb_threads);
+
+/**
+ * Run jobs on a thread pool and wait for all of them to finish.
+ *
+ * The jobs are started in increasing index order, so a job may wait for a
+ * job with a lower index. The calling thread runs jobs as well, with thread
+ * index 0, which guarantees progress when all the workers are busy with the
+ * jobs of other callers. The workers take the jobs of the concurrent
+ * callers in turn.
+ *
+ * @param pool        a reference to the pool
+ * @param func        function called for each job
+ * @param opaque      passed to func
+ * @param nb_jobs     number of jobs
+ * @param max_threads maximum number of jobs of this call which run at the
+ *                    same time, at most 64
+ * @return 0
+ */
+int av_thread_pool_execute(AVBufferRef *pool, av_thread_pool_job_func *func,
+                           void *opaque, int nb_jobs, int max_threads);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_THREADPOOL_H */
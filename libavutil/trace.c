@@ -0,0 +1,185 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "log.h"
+#include "mem.h"
+#include "thread.h"
+#include "time.h"
+#include "trace.h"
+
+typedef struct TraceContext {
+    AVMutex lock;
+    FILE *f;
+    int nb_events;
+#if HAVE_PTHREADS
+    /* the index of a thread in this table is its id in the trace */
+    pthread_t *threads;
+    int nb_threads;
+#endif
+} TraceContext;
+
+static atomic_int trace_enabled = ATOMIC_VAR_INIT(0);
+static AVOnce trace_once = AV_ONCE_INIT;
+static TraceContext trace;
+
+static void trace_init(void)
+{
+    ff_mutex_init(&trace.lock, NULL);
+}
+
+static int thread_id(void)
+{
+#if HAVE_PTHREADS
+    pthread_t self = pthread_self();
+    int i;
+
+    for (i = 0; i < trace.nb_threads; i++)
+        if (pthread_equal(trace.threads[i], self))
+            return i;
+    if (av_reallocp_array(&trace.threads, trace.nb_threads + 1,
+                          sizeof(*trace.threads)) < 0) {
+        trace.nb_threads = 0;
+        return -1;
+    }
+    trace.threads[trace.nb_threads] = self;
+    return trace.nb_threads++;
+#else
+    return 0;
+#endif
+}
+
+static void write_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", *s);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void trace_event(void *avcl, const char *name, char phase,
+                        int stream_index, int64_t frame_number)
+{
+    AVClass *avc = avcl ? *(AVClass **)avcl : NULL;
+    int64_t ts   = av_gettime_relative();
+    int tid;
+
+    ff_mutex_lock(&trace.lock);
+    /* tracing may have been stopped since the caller checked */
+    if (!trace.f)
+        goto end;
+    tid = thread_id();
+    if (tid < 0)
+        goto end;
+
+    fprintf(trace.f, "%s\n{\"name\":", trace.nb_events++ ? "," : "");
+    write_string(trace.f, name);
+    fprintf(trace.f, ",\"cat\":");
+    write_string(trace.f, avc ? avc->item_name(avcl) : "libav");
+    fprintf(trace.f, ",\"ph\":\"%c\",\"ts\":%"PRId64",\"pid\":1,\"tid\":%d",
+            phase, ts, tid);
+    if (stream_index >= 0 || frame_number >= 0) {
+        fprintf(trace.f, ",\"args\":{");
+        if (stream_index >= 0)
+            fprintf(trace.f, "\"stream\":%d%s", stream_index,
+                    frame_number >= 0 ? "," : "");
+        if (frame_number >= 0)
+            fprintf(trace.f, "\"frame\":%"PRId64, frame_number);
+        fputc('}', trace.f);
+    }
+    fputc('}', trace.f);
+
+end:
+    ff_mutex_unlock(&trace.lock);
+}
+
+int av_trace_start(const char *filename)
+{
+    int ret = 0;
+
+    ff_thread_once(&trace_once, trace_init);
+
+    ff_mutex_lock(&trace.lock);
+    if (trace.f) {
+        ret = AVERROR(EBUSY);
+        goto end;
+    }
+    trace.f = fopen(filename, "w");
+    if (!trace.f) {
+        ret = AVERROR(errno);
+        av_log(NULL, AV_LOG_ERROR, "Cannot open trace file %s.\n", filename);
+        goto end;
+    }
+    trace.nb_events = 0;
+    fprintf(trace.f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    atomic_store(&trace_enabled, 1);
+end:
+    ff_mutex_unlock(&trace.lock);
+    return ret;
+}
+
+void av_trace_stop(void)
+{
+    if (!atomic_load(&trace_enabled))
+        return;
+
+    ff_mutex_lock(&trace.lock);
+    atomic_store(&trace_enabled, 0);
+    if (trace.f) {
+        fprintf(trace.f, "\n]}\n");
+        fclose(trace.f);
+        trace.f = NULL;
+    }
+#if HAVE_PTHREADS
+    av_freep(&trace.threads);
+    trace.nb_threads = 0;
+#endif
+    ff_mutex_unlock(&trace.lock);
+}
+
+int av_trace_enabled(void)
+{
+    return atomic_load_explicit(&trace_enabled, memory_order_relaxed);
+}
+
+void av_trace_begin(void *avcl, const char *name,
+                    int stream_index, int64_t frame_number)
+{
+    if (av_trace_enabled())
+        trace_event(avcl, name, 'B', stream_index, frame_number);
+}
+
+void av_trace_end(void *avcl, const char *name,
+                  int stream_index, int64_t frame_number)
+{
+    if (av_trace_enabled())
+        trace_event(avcl, name, 'E', stream_index, frame_number);
+}
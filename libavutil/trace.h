@@ -0,0 +1,96 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Runtime tracing of the processing steps of the libraries
+ */
+
+#ifndef AVUTIL_TRACE_H
+#define AVUTIL_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * @defgroup lavu_trace Tracing
+ * @ingroup lavu_misc
+ *
+ * The libraries mark the start and the end of their main processing steps,
+ * such as sending a packet to a decoder, decoding in a frame thread, passing
+ * a frame to a filter or writing a packet to a muxer. While tracing is
+ * enabled, these events are written to a file in the Chrome trace event JSON
+ * format, which chrome://tracing and the Perfetto UI can display as a
+ * timeline per thread.
+ *
+ * Tracing is process-wide. When it is disabled, marking an event only costs
+ * a function call and an atomic load.
+ *
+ * @{
+ */
+
+/**
+ * Start writing trace events to a file.
+ *
+ * @param filename name of the file to create
+ * @return 0 on success, a negative AVERROR code on failure, including when
+ *         tracing is already enabled
+ */
+int av_trace_start(const char *filename);
+
+/**
+ * Stop tracing and close the trace file.
+ *
+ * Does nothing if tracing is not enabled.
+ */
+void av_trace_stop(void);
+
+/**
+ * @return nonzero if tracing is enabled
+ */
+int av_trace_enabled(void);
+
+/**
+ * Mark the start of a processing step on the calling thread.
+ *
+ * Each call must be matched by a call to av_trace_end() with the same name
+ * on the same thread, and the steps must be nested.
+ *
+ * @param avcl         a pointer to an arbitrary struct of which the first
+ *                     field is a pointer to an AVClass struct, whose item
+ *                     name is used as the category of the event; may be NULL
+ * @param name         name of the step; must be a static string
+ * @param stream_index index of the stream the step works on, -1 if unknown
+ * @param frame_number number of the frame or packet the step works on,
+ *                     -1 if unknown
+ */
+void av_trace_begin(void *avcl, const char *name,
+                    int stream_index, int64_t frame_number);
+
+/**
+ * Mark the end of a processing step started with av_trace_begin().
+ *
+ * The parameters have the same meaning as for av_trace_begin().
+ */
+void av_trace_end(void *avcl, const char *name,
+                  int stream_index, int64_t frame_number);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_TRACE_H */
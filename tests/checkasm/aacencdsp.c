@@ -0,0 +1,128 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavcodec/aacencdsp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+
+/* coefficients of all magnitudes an MDCT of 16-bit samples produces,
+ * including zeros of both signs */
+#define randomize_coefs(buf, size)                                      \
+    do {                                                                \
+        int i;                                                          \
+        for (i = 0; i < size; i++) {                                    \
+            float f = ldexpf((float)rnd() / UINT_MAX, rnd() % 24 - 8);  \
+            buf[i] = rnd() % 16 ? f : 0.0f;                             \
+            if (rnd() & 1)                                              \
+                buf[i] = -buf[i];                                       \
+        }                                                               \
+    } while (0)
+
+/* band sizes, the whole frame, and an offset of a multiple of 4 coefficients
+ * like the band starts have */
+static int random_size(int *offset)
+{
+    int size = rnd() % 3 ? 4 * (1 + rnd() % 24) : BUF_SIZE;
+
+    *offset = 4 * (rnd() % ((BUF_SIZE - size) / 4 + 1));
+    return size;
+}
+
+static void check_abs_pow34(AACEncDSPContext *c)
+{
+    LOCAL_ALIGNED_32(float, in,      [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out_new, [BUF_SIZE]);
+    int n;
+
+    declare_func(void, float *out, const float *in, int size);
+
+    if (check_func(c->abs_pow34, "abs_pow34")) {
+        for (n = 0; n < 8; n++) {
+            int offset, size = random_size(&offset);
+
+            randomize_coefs(in, BUF_SIZE);
+            memset(out_ref, 0, BUF_SIZE * sizeof(*out_ref));
+            memset(out_new, 0, BUF_SIZE * sizeof(*out_new));
+            call_ref(out_ref + offset, in + offset, size);
+            call_new(out_new + offset, in + offset, size);
+            if (memcmp(out_ref, out_new, BUF_SIZE * sizeof(*out_ref)))
+                fail();
+        }
+        bench_new(out_new, in, BUF_SIZE);
+    }
+}
+
+static void check_quant_bands(AACEncDSPContext *c)
+{
+    LOCAL_ALIGNED_32(float, in,      [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, scaled,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int,   out_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int,   out_new, [BUF_SIZE]);
+    static const int maxvals[] = { 1, 2, 4, 7, 12, 16 };
+    int i, n;
+
+    declare_func(void, int *out, const float *in, const float *scaled,
+                 int size, float Q34, int is_signed, int maxval);
+
+    if (check_func(c->quant_bands, "quant_bands")) {
+        for (n = 0; n < 16; n++) {
+            int offset, size = random_size(&offset);
+            int is_signed = n & 1;
+            int maxval    = maxvals[rnd() % FF_ARRAY_ELEMS(maxvals)];
+            /* the 3/4 power of the scalefactor gains */
+            float Q34     = exp2f((int)(rnd() % 256 - 128) * 0.1875f);
+
+            randomize_coefs(in, BUF_SIZE);
+            for (i = 0; i < BUF_SIZE; i++) {
+                float a = fabsf(in[i]);
+                scaled[i] = sqrtf(a * sqrtf(a));
+            }
+            memset(out_ref, 0, BUF_SIZE * sizeof(*out_ref));
+            memset(out_new, 0, BUF_SIZE * sizeof(*out_new));
+            call_ref(out_ref + offset, in + offset, scaled + offset, size,
+                     Q34, is_signed, maxval);
+            call_new(out_new + offset, in + offset, scaled + offset, size,
+                     Q34, is_signed, maxval);
+            if (memcmp(out_ref, out_new, BUF_SIZE * sizeof(*out_ref)))
+                fail();
+        }
+        bench_new(out_new, in, scaled, 16, 1.0f, 1, 16);
+    }
+}
+
+void checkasm_check_aacencdsp(void)
+{
+    AACEncDSPContext c;
+
+    ff_aacenc_dsp_init(&c);
+
+    check_abs_pow34(&c);
+    report("abs_pow34");
+
+    check_quant_bands(&c);
+    report("quant_bands");
+}
@@ -64,6 +64,9 @@ static const struct {
     const char *name;
     void (*func)(void);
 } tests[] = {
+#if CONFIG_AAC_ENCODER
+    { "aacencdsp", checkasm_check_aacencdsp },
+#endif
 #if CONFIG_AUDIODSP
     { "audiodsp", checkasm_check_audiodsp },
 #endif
@@ -77,6 +80,9 @@ static const struct {
     { "dcadsp", checkasm_check_dcadsp },
     { "synth_filter", checkasm_check_synth_filter },
 #endif
+#if CONFIG_FLACDSP
+    { "flacdsp", checkasm_check_flacdsp },
+#endif
 #if CONFIG_FMTCONVERT
     { "fmtconvert", checkasm_check_fmtconvert },
 #endif
@@ -93,10 +99,21 @@ static const struct {
     { "hevc_add_res", checkasm_check_hevc_add_res },
     { "hevc_idct", checkasm_check_hevc_idct },
     { "hevc_mc", checkasm_check_hevc_mc },
+    { "hevc_pred", checkasm_check_hevc_pred },
+    { "hevc_sao", checkasm_check_hevc_sao },
 #endif
 #if CONFIG_HUFFYUVDSP
     { "huffyuvdsp", checkasm_check_huffyuvdsp },
 #endif
+#if CONFIG_ME_CMP
+    { "me_cmp", checkasm_check_me_cmp },
+#endif
+#if CONFIG_MPEGVIDEOENC
+    { "mpegvideoencdsp", checkasm_check_mpegvideoencdsp },
+#endif
+#if CONFIG_OPUS_DECODER
+    { "opusdsp", checkasm_check_opusdsp },
+#endif
 #if CONFIG_V210_ENCODER
     { "v210enc", checkasm_check_v210enc },
 #endif
@@ -0,0 +1,178 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavcodec/flacdsp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 4608
+
+/* any block size, including the tiny last block of a stream */
+static int random_len(void)
+{
+    return rnd() % 4 ? 1 + rnd() % BUF_SIZE : 1 + rnd() % 16;
+}
+
+static void check_decorrelate(void)
+{
+    static const struct {
+        enum AVSampleFormat fmt;
+        int bits;
+    } fmts[] = { { AV_SAMPLE_FMT_S16, 16 }, { AV_SAMPLE_FMT_S32, 32 } };
+    static const char *const modes[] = { "indep", "ls", "rs", "ms" };
+    LOCAL_ALIGNED_32(int32_t, in0,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, in1,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out_ref, [BUF_SIZE * 8]);
+    LOCAL_ALIGNED_32(uint8_t, out_new, [BUF_SIZE * 8]);
+    int32_t *in[2] = { in0, in1 };
+    uint8_t *dst_ref[1] = { out_ref }, *dst_new[1] = { out_new };
+    FLACDSPContext c;
+    int f, mode, n, i;
+
+    declare_func(void, uint8_t **out, int32_t **in, int channels, int len,
+                 int shift);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(fmts); f++) {
+        int bits = fmts[f].bits;
+
+        ff_flacdsp_init(&c, fmts[f].fmt, bits);
+
+        for (mode = 0; mode < FF_ARRAY_ELEMS(modes); mode++) {
+            if (check_func(c.decorrelate[mode], "decorrelate_%s_%d",
+                           modes[mode], bits)) {
+                for (n = 0; n < 8; n++) {
+                    int len   = random_len();
+                    /* the side channel has one more bit */
+                    int bps   = bits == 16 ? 8 + rnd() % 9 : 8 + rnd() % 25;
+                    int shift = bits - bps;
+
+                    for (i = 0; i < BUF_SIZE; i++) {
+                        in0[i] = (int32_t)rnd() >> (32 - bps);
+                        in1[i] = (int32_t)rnd() >> (31 - bps);
+                    }
+                    memset(out_ref, 0, BUF_SIZE * 8);
+                    memset(out_new, 0, BUF_SIZE * 8);
+                    call_ref(dst_ref, in, 2, len, shift);
+                    call_new(dst_new, in, 2, len, shift);
+                    if (memcmp(out_ref, out_new, BUF_SIZE * 8))
+                        fail();
+                }
+                bench_new(dst_new, in, 2, BUF_SIZE, 0);
+            }
+        }
+    }
+    report("decorrelate");
+}
+
+static void check_lpc(void)
+{
+    LOCAL_ALIGNED_32(int32_t, dec_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dec_new, [BUF_SIZE]);
+    int coeffs[32];
+    FLACDSPContext c;
+    int bps, n, i;
+
+    declare_func(void, int32_t *samples, const int coeffs[32], int order,
+                 int qlevel, int len);
+
+    for (bps = 16; bps <= 24; bps += 8) {
+        ff_flacdsp_init(&c, AV_SAMPLE_FMT_S32, bps);
+
+        if (check_func(c.lpc, "lpc_%d", bps)) {
+            for (n = 0; n < 16; n++) {
+                int order     = 1 + rnd() % 32;
+                int len       = order + random_len() % (BUF_SIZE - order);
+                int precision = 1 + rnd() % (bps == 16 ? 11 : 15);
+                int qlevel    = precision - 1 + rnd() % 2;
+
+                /* a gain of at most 1 and small residuals keep the
+                 * reconstructed samples in range */
+                for (i = 0; i < order; i++) {
+                    dec_ref[i] = (int32_t)rnd() >> (32 - bps);
+                    coeffs[i]  = ((int32_t)rnd() >> (32 - precision)) / order;
+                }
+                for (; i < BUF_SIZE; i++)
+                    dec_ref[i] = (int32_t)rnd() >> (40 - bps);
+                memcpy(dec_new, dec_ref, BUF_SIZE * sizeof(*dec_ref));
+
+                call_ref(dec_ref, coeffs, order, qlevel, len);
+                call_new(dec_new, coeffs, order, qlevel, len);
+                if (memcmp(dec_ref, dec_new, BUF_SIZE * sizeof(*dec_ref)))
+                    fail();
+            }
+            for (i = 0; i < 32; i++)
+                coeffs[i] = ((int32_t)rnd() >> 22) / 32;
+            bench_new(dec_new, coeffs, 32, 10, BUF_SIZE);
+        }
+    }
+    report("lpc");
+}
+
+static void check_lpc_encode(void)
+{
+    LOCAL_ALIGNED_32(int32_t, smp,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, res_ref, [BUF_SIZE + 1]);
+    LOCAL_ALIGNED_32(int32_t, res_new, [BUF_SIZE + 1]);
+    int32_t coefs[32];
+    FLACDSPContext c;
+    int bps, n, i;
+
+    declare_func(void, int32_t *res, const int32_t *smp, int len, int order,
+                 const int32_t *coefs, int shift);
+
+    for (bps = 16; bps <= 24; bps += 8) {
+        ff_flacdsp_init(&c, AV_SAMPLE_FMT_S32, bps);
+
+        if (check_func(c.lpc_encode, "lpc_encode_%d", bps)) {
+            for (n = 0; n < 16; n++) {
+                int order     = 1 + rnd() % 32;
+                int len       = order + random_len() % (BUF_SIZE - order);
+                int precision = 1 + rnd() % (bps == 16 ? 11 : 15);
+                int shift     = rnd() % (precision + 1);
+
+                /* keep the sums of the 16-bit version within 32 bits */
+                for (i = 0; i < BUF_SIZE; i++)
+                    smp[i] = (int32_t)rnd() >> (32 - bps);
+                for (i = 0; i < order; i++)
+                    coefs[i] = (int32_t)rnd() >> (32 - precision);
+
+                call_ref(res_ref, smp, len, order, coefs, shift);
+                call_new(res_new, smp, len, order, coefs, shift);
+                /* the C version may also write one residual past the end */
+                if (memcmp(res_ref, res_new, len * sizeof(*res_ref)))
+                    fail();
+            }
+            for (i = 0; i < 32; i++)
+                coefs[i] = (int32_t)rnd() >> 22;
+            bench_new(res_new, smp, BUF_SIZE, 32, coefs, 12);
+        }
+    }
+    report("lpc_encode");
+}
+
+void checkasm_check_flacdsp(void)
+{
+    check_decorrelate();
+    check_lpc();
+    check_lpc_encode();
+}
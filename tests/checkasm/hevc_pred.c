@@ -0,0 +1,130 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdec.h"
+
+#include "checkasm.h"
+
+/* neighbouring samples: top[-1] (== left[-1]) up to top[2 * size - 1],
+ * with some padding for the SIMD loads */
+#define EDGE_SIZE (2 * MAX_TB_SIZE + 16)
+#define BUF_SIZE  (MAX_TB_SIZE * MAX_TB_SIZE * 2)
+
+#define randomize_edges(bit_depth)                              \
+    do {                                                        \
+        int j;                                                  \
+        for (j = 0; j < EDGE_SIZE; j++) {                       \
+            int t = rnd() & ((1 << (bit_depth)) - 1);           \
+            int l = rnd() & ((1 << (bit_depth)) - 1);           \
+            if (bit_depth > 8) {                                \
+                AV_WN16A(top_buf  + j * 2, t);                  \
+                AV_WN16A(left_buf + j * 2, l);                  \
+            } else {                                            \
+                top_buf[j]  = t;                                \
+                left_buf[j] = l;                                \
+            }                                                   \
+        }                                                       \
+        /* the top-left sample is shared */                     \
+        memcpy(left_buf, top_buf, (bit_depth) > 8 ? 2 : 1);     \
+    } while (0)
+
+static void check_pred_planar(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                              uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int ps = bit_depth > 8;
+    const uint8_t *top  = top_buf  + (1 << ps);
+    const uint8_t *left = left_buf + (1 << ps);
+    int i;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+
+        if (check_func(h->pred_planar[i], "hevc_pred_planar_%dx%d_%d", size, size, bit_depth)) {
+            randomize_edges(bit_depth);
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(dst0, top, left, MAX_TB_SIZE);
+            call_new(dst1, top, left, MAX_TB_SIZE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+            bench_new(dst1, top, left, MAX_TB_SIZE);
+        }
+    }
+}
+
+static void check_pred_angular(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                               uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int ps = bit_depth > 8;
+    const uint8_t *top  = top_buf  + (1 << ps);
+    const uint8_t *left = left_buf + (1 << ps);
+    int i, mode, c_idx;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int c_idx, int mode);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+
+        for (mode = 2; mode <= 34; mode++) {
+            if (check_func(h->pred_angular[i], "hevc_pred_angular_%dx%d_mode%d_%d",
+                           size, size, mode, bit_depth)) {
+                for (c_idx = 0; c_idx <= 1; c_idx++) {
+                    randomize_edges(bit_depth);
+                    memset(dst0, 0, BUF_SIZE);
+                    memset(dst1, 0, BUF_SIZE);
+                    call_ref(dst0, top, left, MAX_TB_SIZE, c_idx, mode);
+                    call_new(dst1, top, left, MAX_TB_SIZE, c_idx, mode);
+                    if (memcmp(dst0, dst1, BUF_SIZE))
+                        fail();
+                }
+                bench_new(dst1, top, left, MAX_TB_SIZE, 0, mode);
+            }
+        }
+    }
+}
+
+void checkasm_check_hevc_pred(void)
+{
+    LOCAL_ALIGNED(32, uint8_t, dst0,     [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1,     [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, top_buf,  [EDGE_SIZE * 2]);
+    LOCAL_ALIGNED(32, uint8_t, left_buf, [EDGE_SIZE * 2]);
+    HEVCPredContext h;
+    int bit_depth;
+
+    /* only 8 and 10 bit have SIMD versions */
+    for (bit_depth = 8; bit_depth <= 10; bit_depth += 2) {
+        ff_hevc_pred_init(&h, bit_depth);
+        check_pred_planar(&h, dst0, dst1, top_buf, left_buf, bit_depth);
+    }
+    report("pred_planar");
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth += 2) {
+        ff_hevc_pred_init(&h, bit_depth);
+        check_pred_angular(&h, dst0, dst1, top_buf, left_buf, bit_depth);
+    }
+    report("pred_angular");
+}
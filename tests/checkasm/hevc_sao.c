@@ -0,0 +1,123 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+/* a 64x64 CTB with a one pixel border for the edge filter, and some padding
+ * on the right for the SIMD loads */
+#define MAX_SIZE   64
+#define STRIDE     ((MAX_SIZE + 2 + 32) * 2)
+#define BUF_SIZE   (STRIDE * (MAX_SIZE + 2))
+
+static const int sizes[][2] = {
+    { 64, 64 }, { 32, 32 }, { 16, 16 }, { 8, 8 },
+    { 58, 60 }, { 29, 30 }, { 61, 57 }, {  3, 5 },
+};
+
+#define randomize_buffers(buf, size, bit_depth)                 \
+    do {                                                        \
+        int j;                                                  \
+        for (j = 0; j < (size); j += 2) {                       \
+            int r = rnd() & ((1 << (bit_depth)) - 1);           \
+            if ((bit_depth) > 8)                                \
+                AV_WN16A(buf + j, r);                           \
+            else                                                \
+                AV_WN16A(buf + j, r | (rnd() & 0xff) << 8);     \
+        }                                                       \
+    } while (0)
+
+static void randomize_offsets(int *offset_val, int bit_depth)
+{
+    int max = (1 << (FFMIN(bit_depth, 10) - 5)) - 1;
+    int i;
+
+    offset_val[0] = 0;
+    for (i = 1; i < 5; i++)
+        offset_val[i] = (int)(rnd() % (2 * max + 1)) - max;
+}
+
+static void check_sao(HEVCDSPContext *h, uint8_t *src, uint8_t *dst0,
+                      uint8_t *dst1, int bit_depth)
+{
+    int ps = bit_depth > 8;
+    uint8_t *src_ctb  = src  + STRIDE + (1 << ps);
+    uint8_t *dst0_ctb = dst0 + STRIDE + (1 << ps);
+    uint8_t *dst1_ctb = dst1 + STRIDE + (1 << ps);
+    int offset_val[5];
+    int i, class;
+
+    declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+                 int *sao_offset_val, int class, int width, int height);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        int width  = sizes[i][0];
+        int height = sizes[i][1];
+
+        if (check_func(h->sao_band_filter, "hevc_sao_band_%dx%d_%d",
+                       width, height, bit_depth)) {
+            for (class = 0; class < 32; class++) {
+                randomize_buffers(src,  BUF_SIZE, bit_depth);
+                randomize_buffers(dst0, BUF_SIZE, bit_depth);
+                memcpy(dst1, dst0, BUF_SIZE);
+                randomize_offsets(offset_val, bit_depth);
+                call_ref(dst0_ctb, src_ctb, STRIDE, offset_val, class, width, height);
+                call_new(dst1_ctb, src_ctb, STRIDE, offset_val, class, width, height);
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+            }
+            bench_new(dst1_ctb, src_ctb, STRIDE, offset_val, 0, width, height);
+        }
+
+        if (check_func(h->sao_edge_filter, "hevc_sao_edge_%dx%d_%d",
+                       width, height, bit_depth)) {
+            for (class = 0; class < 4; class++) {
+                randomize_buffers(src,  BUF_SIZE, bit_depth);
+                randomize_buffers(dst0, BUF_SIZE, bit_depth);
+                memcpy(dst1, dst0, BUF_SIZE);
+                randomize_offsets(offset_val, bit_depth);
+                call_ref(dst0_ctb, src_ctb, STRIDE, offset_val, class, width, height);
+                call_new(dst1_ctb, src_ctb, STRIDE, offset_val, class, width, height);
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+            }
+            bench_new(dst1_ctb, src_ctb, STRIDE, offset_val, 0, width, height);
+        }
+    }
+}
+
+void checkasm_check_hevc_sao(void)
+{
+    LOCAL_ALIGNED(32, uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED(32, uint8_t, dst1, [BUF_SIZE]);
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_sao(&h, src, dst0, dst1, bit_depth);
+    }
+    report("sao");
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stddef.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavcodec/me_cmp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#include "checkasm.h"
+
+#define STRIDE   64
+#define BUF_SIZE (STRIDE * 24)
+
+/* the SIMD hadamard functions saturate the sum of each 8x8 block to 16 bits,
+ * differences of up to 127 keep it below that */
+#define randomize_buffers(mask)                 \
+    do {                                        \
+        int i;                                  \
+        for (i = 0; i < BUF_SIZE; i++) {        \
+            src[i] = rnd() & (mask);            \
+            ref[i] = rnd() & (mask);            \
+        }                                       \
+    } while (0)
+
+static void check_cmp(me_cmp_func *tab, const char *name, int mask,
+                      uint8_t *src, uint8_t *ref)
+{
+    static const struct {
+        int width, h;
+    } sizes[] = { { 16, 16 }, { 16, 8 }, { 8, 8 } };
+    int i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, struct MpegEncContext *c,
+                      uint8_t *blk1, uint8_t *blk2, ptrdiff_t stride, int h);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        int width = sizes[i].width, h = sizes[i].h;
+
+        if (check_func(tab[width == 8], "%s_%dx%d", name, width, h)) {
+            /* the candidate block is not aligned */
+            int offset = 1 + rnd() % (STRIDE - width - 1) +
+                         STRIDE * (rnd() % 4);
+            int res_ref, res_new;
+
+            randomize_buffers(mask);
+            res_ref = call_ref(NULL, src, ref + offset, STRIDE, h);
+            res_new = call_new(NULL, src, ref + offset, STRIDE, h);
+            if (res_ref != res_new)
+                fail();
+            bench_new(NULL, src, ref + offset, STRIDE, h);
+        }
+    }
+}
+
+static void check_sad_x4(MECmpContext *c, uint8_t *src, uint8_t *ref)
+{
+    static const struct {
+        int width, h;
+    } sizes[] = { { 16, 16 }, { 16, 8 }, { 8, 8 }, { 8, 4 } };
+    int i, j;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *src,
+                      uint8_t *const ref[4], ptrdiff_t stride, int h,
+                      int scores[4]);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        int width = sizes[i].width, h = sizes[i].h;
+
+        if (check_func(c->sad_x4[width == 8], "sad_x4_%dx%d", width, h)) {
+            uint8_t *cand[4];
+            int scores_ref[4], scores_new[4];
+
+            for (j = 0; j < 4; j++)
+                cand[j] = ref + rnd() % (STRIDE - width) +
+                          STRIDE * (rnd() % 4);
+
+            randomize_buffers(0xFF);
+            call_ref(src, cand, STRIDE, h, scores_ref);
+            call_new(src, cand, STRIDE, h, scores_new);
+            for (j = 0; j < 4; j++)
+                if (scores_ref[j] != scores_new[j])
+                    fail();
+            bench_new(src, cand, STRIDE, h, scores_new);
+        }
+    }
+}
+
+void checkasm_check_me_cmp(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, ref, [BUF_SIZE]);
+    AVCodecContext *avctx;
+    MECmpContext c;
+
+    avctx = avcodec_alloc_context3(NULL);
+    if (!avctx)
+        return;
+
+    ff_me_cmp_init_static();
+    ff_me_cmp_init(&c, avctx);
+
+    check_cmp(c.sad, "sad", 0xFF, src, ref);
+    report("sad");
+
+    check_cmp(c.sse, "sse", 0xFF, src, ref);
+    report("sse");
+
+    check_cmp(c.hadamard8_diff, "hadamard8_diff", 0x7F, src, ref);
+    report("hadamard8_diff");
+
+    check_sad_x4(&c, src, ref);
+    report("sad_x4");
+
+    avcodec_free_context(&avctx);
+}
@@ -0,0 +1,192 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavcodec/aandcttab.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/mathops.h"
+#include "libavcodec/mpegvideoencdsp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#include "checkasm.h"
+
+#define QMAT_SHIFT 22
+
+static void check_trellis_levels(MpegvideoEncDSPContext *c)
+{
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
+    LOCAL_ALIGNED_16(int, qmat, [64]);
+    int level_ref[2][64], level_new[2][64];
+    int count_ref[64], count_new[64];
+    static const int biases[] = {
+        0, 1 << (QMAT_SHIFT - 1), -(1 << (QMAT_SHIFT - 2))
+    };
+    int i, b, n;
+
+    declare_func(int, int level[2][64], int count[64], int *max,
+                 const int16_t *block, const int *qmat, int bias, int shift,
+                 const uint8_t *scantable, int start);
+
+    if (check_func(c->trellis_levels, "trellis_levels")) {
+        for (n = 0; n < 4 * FF_ARRAY_ELEMS(biases); n++) {
+            int qscale = 1 + rnd() % 4;
+            int start  = rnd() & 1;
+            int max_ref, max_new, last_ref, last_new;
+            int nb;
+
+            /* empty block, only the first coefficient, any number of them
+             * or the whole block */
+            switch (n & 3) {
+            case 0:
+                nb = start;
+                break;
+            case 1:
+                nb = start + 1;
+                break;
+            case 2:
+                nb = start + 1 + rnd() % (63 - start);
+                break;
+            default:
+                nb = 64;
+                break;
+            }
+            b = n >> 2;
+
+            /* coefficients of all magnitudes, many of them in the dead zone,
+             * and only zeros after the first nb ones in scan order, the
+             * last of which is outside of the dead zone */
+            for (i = 0; i < 64; i++) {
+                int j = ff_zigzag_direct[i];
+
+                block[j] = i < start || i >= nb ? 0 :
+                           (int)(rnd() % 8191) - 4095 >> (rnd() % 12);
+                qmat[j]  = (1 << QMAT_SHIFT) / (qscale * (16 + rnd() % 240));
+            }
+            if (nb > start)
+                block[ff_zigzag_direct[nb - 1]] = 2048 + rnd() % 2048;
+
+            last_ref = call_ref(level_ref, count_ref, &max_ref, block, qmat,
+                                biases[b], QMAT_SHIFT, ff_zigzag_direct, start);
+            last_new = call_new(level_new, count_new, &max_new, block, qmat,
+                                biases[b], QMAT_SHIFT, ff_zigzag_direct, start);
+            if (last_ref != last_new || max_ref != max_new)
+                fail();
+            for (i = start; i <= last_ref; i++) {
+                int j = ff_zigzag_direct[i];
+                if (count_ref[j] != count_new[j] ||
+                    level_ref[0][j] != level_new[0][j] ||
+                    (count_ref[j] == 2 && level_ref[1][j] != level_new[1][j]))
+                    fail();
+            }
+            bench_new(level_new, count_new, &max_new, block, qmat,
+                      biases[b], QMAT_SHIFT, ff_zigzag_direct, start);
+        }
+    }
+}
+
+static void check_trellis_distortion(MpegvideoEncDSPContext *c)
+{
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
+    LOCAL_ALIGNED_16(uint16_t, matrix, [64]);
+    LOCAL_ALIGNED_16(uint16_t, unit_scale, [64]);
+    int level[64];
+    int dist_ref[2][64], dist_new[2][64];
+    int i, odd;
+
+    declare_func(void, int dist[2][64], const int level[64],
+                 const int16_t *block, const uint16_t *dct_scale,
+                 const uint16_t *matrix, int mul, int add, int shift,
+                 const uint8_t *scantable, int start, int last);
+
+    for (i = 0; i < 64; i++)
+        unit_scale[i] = 4096;
+
+    for (odd = 0; odd < 2; odd++) {
+        if (check_func(c->trellis_distortion[odd], "trellis_distortion%s",
+                       odd ? "_odd" : "")) {
+            const uint16_t *scale = rnd() & 1 ? ff_inv_aanscales : unit_scale;
+            int qscale = 1 + rnd() % 31;
+            int intra  = rnd() & 1;
+            int start  = intra;
+            int last   = start + rnd() % (64 - start);
+            int mul, add, shift;
+
+            if (!odd) {
+                /* H.263 */
+                mul   = qscale * 16;
+                add   = intra ? 0 : ((qscale - 1) | 1) * 8;
+                shift = 0;
+            } else if (intra) {
+                mul   = qscale;
+                add   = 0;
+                shift = 3;
+            } else {
+                mul   = 2 * qscale;
+                add   = qscale;
+                shift = 4;
+            }
+
+            /* the distortions fit in an int for these ranges */
+            for (i = 0; i < 64; i++) {
+                int alevel = 1 + rnd() % 16;
+
+                block[i]  = (int)(rnd() % 4095) - 2047;
+                level[i]  = rnd() & 1 ? -alevel : alevel;
+                matrix[i] = odd ? 8 + rnd() % 57 : 1;
+            }
+
+            /* the intra DC level is not set by trellis_levels */
+            if (start)
+                level[ff_zigzag_direct[0]] = INT_MIN;
+
+            call_ref(dist_ref, level, block, scale, matrix, mul, add, shift,
+                     ff_zigzag_direct, start, last);
+            call_new(dist_new, level, block, scale, matrix, mul, add, shift,
+                     ff_zigzag_direct, start, last);
+            for (i = start; i <= last; i++) {
+                int j = ff_zigzag_direct[i];
+                if (dist_ref[0][j] != dist_new[0][j] ||
+                    (FFABS(level[j]) > 1 && dist_ref[1][j] != dist_new[1][j]))
+                    fail();
+            }
+            bench_new(dist_new, level, block, scale, matrix, mul, add, shift,
+                      ff_zigzag_direct, 0, 63);
+        }
+    }
+}
+
+void checkasm_check_mpegvideoencdsp(void)
+{
+    AVCodecContext *avctx;
+    MpegvideoEncDSPContext c;
+
+    avctx = avcodec_alloc_context3(NULL);
+    if (!avctx)
+        return;
+
+    ff_mpegvideoencdsp_init(&c, avctx);
+
+    check_trellis_levels(&c);
+    report("trellis_levels");
+
+    check_trellis_distortion(&c);
+    report("trellis_distortion");
+
+    avcodec_free_context(&avctx);
+}
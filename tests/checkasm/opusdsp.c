@@ -0,0 +1,267 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with Libav; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavcodec/opusdsp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#include "checkasm.h"
+
+#define MAX_PERIOD 1024
+#define MAX_LEN    960
+
+/* samples in the range of the CELT iMDCT output */
+#define randomize_buffer(buf, len, scale)                               \
+    do {                                                                \
+        int i;                                                          \
+        for (i = 0; i < len; i++)                                       \
+            buf[i] = ((float)rnd() / UINT_MAX * 2 - 1) * (scale);       \
+    } while (0)
+
+static void check_postfilter(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_32(float, buf_ref, [MAX_PERIOD + MAX_LEN + 8]);
+    LOCAL_ALIGNED_32(float, buf_new, [MAX_PERIOD + MAX_LEN + 8]);
+    float *data_ref = buf_ref + MAX_PERIOD + 8;
+    float *data_new = buf_new + MAX_PERIOD + 8;
+    float gains[3];
+    int n;
+
+    declare_func(void, float *data, int period, const float *gains, int len);
+
+    if (check_func(s->postfilter, "postfilter")) {
+        for (n = 0; n < 8; n++) {
+            /* the lengths of the 10 ms and 20 ms frames */
+            int len    = n & 1 ? 240 : 720;
+            int period = 15 + rnd() % (MAX_PERIOD - 15 + 1);
+            float gain = (float)rnd() / UINT_MAX * 0.75f;
+
+            gains[0] = gain * 0.3066406250f;
+            gains[1] = gain * 0.2170410156f;
+            gains[2] = gain * 0.1296386719f;
+
+            randomize_buffer(buf_ref, MAX_PERIOD + MAX_LEN + 8, 32768.0f);
+            memcpy(buf_new, buf_ref, (MAX_PERIOD + MAX_LEN + 8) * sizeof(*buf_ref));
+            call_ref(data_ref, period, gains, len);
+            call_new(data_new, period, gains, len);
+            if (!float_near_abs_eps_array(data_ref, data_new, 0.01f, len))
+                fail();
+        }
+        bench_new(data_new, 100, gains, 720);
+    }
+}
+
+static void check_deemphasis(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_32(float, in,      [MAX_LEN]);
+    LOCAL_ALIGNED_32(float, out_ref, [MAX_LEN]);
+    LOCAL_ALIGNED_32(float, out_new, [MAX_LEN]);
+    int n;
+
+    declare_func(float, float *out, const float *in, int len, float coeff);
+
+    if (check_func(s->deemphasis, "deemphasis")) {
+        for (n = 0; n < 8; n++) {
+            /* the frame sizes from 2.5 ms to 20 ms */
+            int len     = 120 << (n & 3);
+            float coeff = ((float)rnd() / UINT_MAX * 2 - 1) * 32768.0f;
+            float coeff_ref, coeff_new;
+
+            randomize_buffer(in, len, 32768.0f);
+            coeff_ref = call_ref(out_ref, in, len, coeff);
+            coeff_new = call_new(out_new, in, len, coeff);
+            if (!float_near_abs_eps_array(out_ref, out_new, 1.0e-5f, len) ||
+                !float_near_abs_eps(coeff_ref / 32768, coeff_new / 32768, 1.0e-5f))
+                fail();
+        }
+        bench_new(out_new, in, MAX_LEN, 0.0f);
+    }
+}
+
+/* a stable filter, built from reflection coefficients like the SILK LPC
+ * coefficients are */
+static void random_lpc(float *coeffs, int order)
+{
+    float tmp[16];
+    int i, j;
+
+    for (i = 0; i < order; i++) {
+        float k = ((float)rnd() / UINT_MAX * 2 - 1) * 0.7f;
+
+        for (j = 0; j < i; j++)
+            tmp[j] = coeffs[j] - k * coeffs[i - 1 - j];
+        memcpy(coeffs, tmp, i * sizeof(*coeffs));
+        coeffs[i] = k;
+    }
+}
+
+static void check_lpc_synthesis(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_16(float, lpc_ref, [16 + 80]);
+    LOCAL_ALIGNED_16(float, lpc_new, [16 + 80]);
+    LOCAL_ALIGNED_16(float, dst_ref, [80]);
+    LOCAL_ALIGNED_16(float, dst_new, [80]);
+    LOCAL_ALIGNED_16(float, res,     [80]);
+    float coeffs[16], eps;
+    int i, n;
+
+    declare_func(void, float *dst, float *lpc, const float *res,
+                 const float *coeffs, int order, int len, float gain);
+
+    if (check_func(s->lpc_synthesis, "lpc_synthesis")) {
+        for (n = 0; n < 12; n++) {
+            /* the subframe lengths of the narrowband, mediumband and wideband
+             * modes, with their filter orders */
+            int len    = 40 + 20 * (n % 3);
+            int order  = n % 3 == 2 ? 16 : 10;
+            float gain = (float)rnd() / UINT_MAX * 0.5f;
+
+            random_lpc(coeffs, order);
+            randomize_buffer(res, len, 1.0f);
+            randomize_buffer(lpc_ref, 16, 0.5f);
+            memcpy(lpc_new, lpc_ref, 16 * sizeof(*lpc_ref));
+            call_ref(dst_ref, lpc_ref + 16, res, coeffs, order, len, gain);
+            call_new(dst_new, lpc_new + 16, res, coeffs, order, len, gain);
+
+            /* the rounding errors of the sums, which the SIMD versions may
+             * reorder, grow with the gain of the filter */
+            eps = 0.0f;
+            for (i = 0; i < len; i++)
+                eps = FFMAX(eps, fabsf(lpc_ref[16 + i]));
+            eps = 1.0e-4f * FFMAX(eps, 1.0f);
+
+            if (!float_near_abs_eps_array(lpc_ref + 16, lpc_new + 16, eps, len) ||
+                !float_near_abs_eps_array(dst_ref, dst_new, eps, len))
+                fail();
+        }
+        bench_new(dst_new, lpc_new + 16, res, coeffs, 16, 80, 0.25f);
+    }
+}
+
+/* the CELT bands hold from 1 to 176 coefficients, at any offset */
+#define MAX_BAND 176
+
+static void check_scale(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_16(float, buf_ref, [MAX_BAND + 4]);
+    LOCAL_ALIGNED_16(float, buf_new, [MAX_BAND + 4]);
+    int n;
+
+    declare_func(void, float *X, int len, float gain);
+
+    if (check_func(s->scale, "scale")) {
+        for (n = 0; n < 16; n++) {
+            int len    = 1 + rnd() % MAX_BAND;
+            int offset = rnd() & 3;
+            float gain = (float)rnd() / UINT_MAX * 65536.0f;
+
+            randomize_buffer(buf_ref, MAX_BAND + 4, 1.0f);
+            memcpy(buf_new, buf_ref, (MAX_BAND + 4) * sizeof(*buf_ref));
+            call_ref(buf_ref + offset, len, gain);
+            call_new(buf_new + offset, len, gain);
+            /* the coefficients around the band must be left alone */
+            if (memcmp(buf_ref, buf_new, (MAX_BAND + 4) * sizeof(*buf_ref)))
+                fail();
+        }
+        bench_new(buf_new, MAX_BAND, 0.5f);
+    }
+}
+
+static void check_normalize_residual(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_16(float, buf_ref, [MAX_BAND + 4]);
+    LOCAL_ALIGNED_16(float, buf_new, [MAX_BAND + 4]);
+    int iy[MAX_BAND];
+    int i, n;
+
+    declare_func(void, float *X, const int *iy, int len, float gain);
+
+    if (check_func(s->normalize_residual, "normalize_residual")) {
+        for (n = 0; n < 16; n++) {
+            int len    = 1 + rnd() % MAX_BAND;
+            int offset = rnd() & 3;
+            float gain = (float)rnd() / UINT_MAX;
+
+            for (i = 0; i < len; i++)
+                iy[i] = (int)(rnd() % 257) - 128;
+            randomize_buffer(buf_ref, MAX_BAND + 4, 1.0f);
+            memcpy(buf_new, buf_ref, (MAX_BAND + 4) * sizeof(*buf_ref));
+            call_ref(buf_ref + offset, iy, len, gain);
+            call_new(buf_new + offset, iy, len, gain);
+            if (memcmp(buf_ref, buf_new, (MAX_BAND + 4) * sizeof(*buf_ref)))
+                fail();
+        }
+        bench_new(buf_new, iy, MAX_BAND, 0.5f);
+    }
+}
+
+static void check_renormalize(OpusDSPContext *s)
+{
+    LOCAL_ALIGNED_16(float, buf_ref, [MAX_BAND + 4]);
+    LOCAL_ALIGNED_16(float, buf_new, [MAX_BAND + 4]);
+    int n;
+
+    declare_func(void, float *X, int len, float gain);
+
+    if (check_func(s->renormalize, "renormalize")) {
+        for (n = 0; n < 16; n++) {
+            int len    = 1 + rnd() % MAX_BAND;
+            int offset = rnd() & 3;
+            float gain = (float)rnd() / UINT_MAX;
+
+            randomize_buffer(buf_ref, MAX_BAND + 4, 1.0f);
+            memcpy(buf_new, buf_ref, (MAX_BAND + 4) * sizeof(*buf_ref));
+            call_ref(buf_ref + offset, len, gain);
+            call_new(buf_new + offset, len, gain);
+            /* the energy sums may be reordered, the outputs are at most
+             * gain in magnitude */
+            if (!float_near_abs_eps_array(buf_ref, buf_new, 1.0e-6f, MAX_BAND + 4))
+                fail();
+        }
+        bench_new(buf_new, MAX_BAND, 1.0f);
+    }
+}
+
+void checkasm_check_opusdsp(void)
+{
+    OpusDSPContext s;
+
+    ff_opus_dsp_init(&s);
+
+    check_postfilter(&s);
+    report("postfilter");
+
+    check_deemphasis(&s);
+    report("deemphasis");
+
+    check_lpc_synthesis(&s);
+    report("lpc_synthesis");
+
+    check_scale(&s);
+    report("scale");
+
+    check_normalize_residual(&s);
+    report("normalize_residual");
+
+    check_renormalize(&s);
+    report("renormalize");
+}
@@ -243,6 +243,66 @@ static int iszero(const int16_t *c, int sz)
     return 1;
 }
 
+static void check_ipred(void)
+{
+    static const char *const mode_names[N_INTRA_PRED_MODES] = {
+        [VERT_PRED]            = "vert",
+        [HOR_PRED]             = "hor",
+        [DC_PRED]              = "dc",
+        [DIAG_DOWN_LEFT_PRED]  = "diag_downleft",
+        [DIAG_DOWN_RIGHT_PRED] = "diag_downright",
+        [VERT_RIGHT_PRED]      = "vert_right",
+        [HOR_DOWN_PRED]        = "hor_down",
+        [VERT_LEFT_PRED]       = "vert_left",
+        [HOR_UP_PRED]          = "hor_up",
+        [TM_VP8_PRED]          = "tm",
+        [LEFT_DC_PRED]         = "dc_left",
+        [TOP_DC_PRED]          = "dc_top",
+        [DC_128_PRED]          = "dc_128",
+        [DC_127_PRED]          = "dc_127",
+        [DC_129_PRED]          = "dc_129",
+    };
+    /* top[-1] up to top[63] for the top-right of the directional modes */
+    LOCAL_ALIGNED_32(uint8_t, top_buf, [32 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [32 + 1]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [32 * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [32 * 32]);
+    const uint8_t *top  = top_buf + 32;
+    /* the decoder's left edge is not aligned */
+    const uint8_t *left = left_buf + 1;
+    VP9DSPContext dsp;
+    int tx, mode, i;
+
+    declare_func(void, uint8_t *dst, ptrdiff_t stride,
+                 const uint8_t *left, const uint8_t *top);
+
+    ff_vp9dsp_init(&dsp);
+
+    for (tx = TX_4X4; tx < N_TXFM_SIZES; tx++) {
+        int sz = 4 << tx;
+
+        for (mode = 0; mode < N_INTRA_PRED_MODES; mode++) {
+            if (check_func(dsp.intra_pred[tx][mode], "vp9_%s_%dx%d",
+                           mode_names[mode], sz, sz)) {
+                for (i = 0; i < 32 + 64; i++)
+                    top_buf[i] = rnd();
+                for (i = 0; i < 32 + 1; i++)
+                    left_buf[i] = rnd();
+                for (i = 0; i < 32 * 32; i++)
+                    dst0[i] = dst1[i] = rnd();
+
+                call_ref(dst0, 32, left, top);
+                call_new(dst1, 32, left, top);
+                if (memcmp(dst0, dst1, 32 * 32))
+                    fail();
+
+                bench_new(dst1, 32, left, top);
+            }
+        }
+    }
+    report("ipred");
+}
+
 #define SIZEOF_COEF (2 * ((BIT_DEPTH + 7) / 8))
 
 static void check_itxfm(void)
@@ -269,12 +329,11 @@ static void check_itxfm(void)
         int n_txtps = tx < TX_32X32 ? N_TXFM_TYPES : 1;
 
         for (txtp = 0; txtp < n_txtps; txtp++) {
-            // skip testing sub-IDCTs for WHT or ADST since they don't
-            // implement it in any of the SIMD functions. If they do,
-            // consider changing this to ensure we have complete test
-            // coverage. Test sub=1 for dc-only, then 2, 4, 8, 12, etc,
-            // since the arm version can distinguish them at that level.
-            for (sub = (txtp == 0 && tx < 4) ? 1 : sz; sub <= sz;
+            // skip testing sub-IDCTs for WHT since no SIMD function
+            // implements it, the ADST ones have eob-limited paths too.
+            // Test sub=1 for dc-only, then 2, 4, 8, 12, etc, since the
+            // arm version can distinguish them at that level.
+            for (sub = tx < 4 ? 1 : sz; sub <= sz;
                  sub < 4 ? (sub <<= 1) : (sub += 4)) {
                 if (check_func(dsp.itxfm_add[tx][txtp],
                                "vp9_inv_%s_%dx%d_sub%d_add",
@@ -559,6 +618,7 @@ static void check_mc(void)
 
 void checkasm_check_vp9dsp(void)
 {
+    check_ipred();
     check_itxfm();
     check_loopfilter();
     check_mc();
@@ -1,7 +1,9 @@
-FATE_CHECKASM = fate-checkasm-audiodsp                                  \
+FATE_CHECKASM = fate-checkasm-aacencdsp                                 \
+                fate-checkasm-audiodsp                                  \
                 fate-checkasm-blockdsp                                  \
                 fate-checkasm-bswapdsp                                  \
                 fate-checkasm-dcadsp                                    \
+                fate-checkasm-flacdsp                                   \
                 fate-checkasm-fmtconvert                                \
                 fate-checkasm-h264dsp                                   \
                 fate-checkasm-h264pred                                  \
@@ -9,7 +11,12 @@ FATE_CHECKASM = fate-checkasm-audiodsp                                  \
                 fate-checkasm-hevc_add_res                              \
                 fate-checkasm-hevc_idct                                 \
                 fate-checkasm-hevc_mc                                   \
+                fate-checkasm-hevc_pred                                 \
+                fate-checkasm-hevc_sao                                  \
                 fate-checkasm-huffyuvdsp                                \
+                fate-checkasm-me_cmp                                    \
+                fate-checkasm-mpegvideoencdsp                           \
+                fate-checkasm-opusdsp                                   \
                 fate-checkasm-synth_filter                              \
                 fate-checkasm-v210enc                                   \
                 fate-checkasm-vp8dsp                                    \
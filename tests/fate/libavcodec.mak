@@ -1,3 +1,23 @@
+FATE_LIBAVCODEC-yes += fate-bitstream
+fate-bitstream: libavcodec/tests/bitstream$(EXESUF)
+fate-bitstream: CMD = run libavcodec/tests/bitstream
+fate-bitstream: CMP = null
+
+FATE_LIBAVCODEC-yes += fate-encode-threads
+fate-encode-threads: libavcodec/tests/encode_threads$(EXESUF)
+fate-encode-threads: CMD = run libavcodec/tests/encode_threads
+fate-encode-threads: CMP = null
+
+FATE_LIBAVCODEC-yes += fate-framecache
+fate-framecache: libavcodec/tests/framecache$(EXESUF)
+fate-framecache: CMD = run libavcodec/tests/framecache
+fate-framecache: CMP = null
+
+FATE_LIBAVCODEC-yes += fate-put_bits
+fate-put_bits: libavcodec/tests/put_bits$(EXESUF)
+fate-put_bits: CMD = run libavcodec/tests/put_bits
+fate-put_bits: CMP = null
+
 FATE_LIBAVCODEC-$(CONFIG_GOLOMB) += fate-golomb
 fate-golomb: libavcodec/tests/golomb$(EXESUF)
 fate-golomb: CMD = run libavcodec/tests/golomb
@@ -123,7 +123,9 @@ fate-seek-vsynth2-mpeg2-thread-ivlc: SRC = fate/vsynth2-mpeg2-thread-ivlc.mpeg2v
 fate-seek-vsynth2-mpeg4:             SRC = fate/vsynth2-mpeg4.mp4
 fate-seek-vsynth2-mpeg4-adap:        SRC = fate/vsynth2-mpeg4-adap.avi
 fate-seek-vsynth2-mpeg4-adv:         SRC = fate/vsynth2-mpeg4-adv.avi
+fate-seek-vsynth2-mpeg4-bstrategy:   SRC = fate/vsynth2-mpeg4-bstrategy.avi
 fate-seek-vsynth2-mpeg4-error:       SRC = fate/vsynth2-mpeg4-error.avi
+fate-seek-vsynth2-mpeg4-hier:        SRC = fate/vsynth2-mpeg4-hier.avi
 fate-seek-vsynth2-mpeg4-nr:          SRC = fate/vsynth2-mpeg4-nr.avi
 fate-seek-vsynth2-mpeg4-qpel:        SRC = fate/vsynth2-mpeg4-qpel.avi
 fate-seek-vsynth2-mpeg4-qprd:        SRC = fate/vsynth2-mpeg4-qprd.avi
@@ -138,6 +138,8 @@ FATE_MPEG4_AVI = mpeg4-rc                                               \
                  mpeg4-adv                                              \
                  mpeg4-qprd                                             \
                  mpeg4-adap                                             \
+                 mpeg4-bstrategy                                        \
+                 mpeg4-hier                                             \
                  mpeg4-qpel                                             \
                  mpeg4-thread                                           \
                  mpeg4-error                                            \
@@ -158,10 +160,16 @@ fate-vsynth%-mpeg4-adv:          ENCOPTS = -qscale 9 -flags +mv4+aic       \
                                            -data_partitioning 1 -trellis 1 \
                                            -mbd bits -ps 200
 
+fate-vsynth%-mpeg4-bstrategy:    ENCOPTS = -qscale 7 -flags +mv4 -bf 2 \
+                                           -b_strategy 2 -threads 2
+
 fate-vsynth%-mpeg4-error:        ENCOPTS = -qscale 7 -flags +mv4+aic    \
                                            -data_partitioning 1 -mbd rd \
                                            -ps 250 -error_rate 10
 
+fate-vsynth%-mpeg4-hier:         ENCOPTS = -qscale 7 -flags +mv4 -bf 2 \
+                                           -me_hier 2 -threads 2 -slices 2
+
 fate-vsynth%-mpeg4-nr:           ENCOPTS = -qscale 8 -flags +mv4 -mbd rd \
                                            -noise_reduction 200
 
@@ -185,6 +193,11 @@ fate-vsynth%-msmpeg4:            ENCOPTS = -qscale 10
 FATE_VCODEC-$(call ENCDEC, MSMPEG4V2, AVI) += msmpeg4v2
 fate-vsynth%-msmpeg4v2:          ENCOPTS = -qscale 10
 
+FATE_VCODEC-$(call ENCDEC, PNG, AVI) += png png-strips
+fate-vsynth%-png:                ENCOPTS = -frames 10
+# one strip per slice thread, decodes to the same image as vsynth%-png
+fate-vsynth%-png-strips:         ENCOPTS = -threads 4 -frames 10
+
 FATE_VCODEC-$(call ENCDEC, PRORES, MOV) += prores
 fate-vsynth%-prores:             ENCOPTS = -profile hq
 fate-vsynth%-prores:             FMT     = mov
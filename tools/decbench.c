@@ -0,0 +1,414 @@
+/*
+ * This file is part of Libav.
+ *
+ * Libav is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * Libav is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Libav; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Decoder benchmark: decodes the streams of a file from memory with every
+ * decoder supporting them, for each threading mode and thread count, and
+ * prints one CSV line per run.
+ */
+
+#include "config.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+#if HAVE_FORK
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+
+enum BenchMode {
+    MODE_NONE,
+    MODE_SLICE,
+    MODE_FRAME,
+    NB_MODES,
+};
+
+static const struct {
+    const char *name;
+    int thread_type;
+    int caps;
+} modes[NB_MODES] = {
+    [MODE_NONE]  = { "none",  0 },
+    [MODE_SLICE] = { "slice", FF_THREAD_SLICE, AV_CODEC_CAP_SLICE_THREADS },
+    [MODE_FRAME] = { "frame", FF_THREAD_FRAME, AV_CODEC_CAP_FRAME_THREADS },
+};
+
+typedef struct BenchResult {
+    int ret;
+    int active_thread_type; ///< threading method picked by the decoder
+    int nb_frames;
+    int nb_errors;
+    int64_t time;           ///< microseconds
+    int64_t latency[4];     ///< p50, p90, p99 and max, in microseconds
+    int64_t maxrss;         ///< peak memory growth during the run, in kB
+} BenchResult;
+
+/* the decoder may use another method than the one requested, or none */
+static const char *active_name(int active_thread_type)
+{
+    switch (active_thread_type) {
+    case FF_THREAD_SLICE: return modes[MODE_SLICE].name;
+    case FF_THREAD_FRAME: return modes[MODE_FRAME].name;
+    default:              return modes[MODE_NONE].name;
+    }
+}
+
+static int64_t getmaxrss(void)
+{
+#if HAVE_GETRUSAGE && HAVE_STRUCT_RUSAGE_RU_MAXRSS
+    struct rusage rusage;
+    getrusage(RUSAGE_SELF, &rusage);
+    return rusage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    int64_t va = *(const int64_t *)a, vb = *(const int64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+static int receive_frames(AVCodecContext *avctx, AVFrame *frame,
+                          const int64_t *send_time, int nb_packets,
+                          int64_t **latency, int *nb_latency)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_frame(avctx, frame)) >= 0) {
+        int64_t idx = frame->reordered_opaque;
+
+        if (!(*nb_latency & (*nb_latency - 1))) {
+            int64_t *tmp = av_realloc_array(*latency, 2 * *nb_latency + 1,
+                                            sizeof(**latency));
+            if (!tmp)
+                return AVERROR(ENOMEM);
+            *latency = tmp;
+        }
+        (*latency)[(*nb_latency)++] = idx >= 0 && idx < nb_packets ?
+                                      av_gettime_relative() - send_time[idx] : 0;
+        av_frame_unref(frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static void run_decoder(const AVCodec *codec, const AVCodecParameters *par,
+                        AVPacket *packets, int nb_packets,
+                        int thread_type, int threads, BenchResult *res)
+{
+    AVCodecContext *avctx = NULL;
+    AVFrame *frame        = NULL;
+    int64_t *send_time    = NULL;
+    int64_t *latency      = NULL;
+    int64_t maxrss        = getmaxrss();
+    int nb_latency = 0;
+    int ret, i;
+
+    memset(res, 0, sizeof(*res));
+
+    avctx     = avcodec_alloc_context3(codec);
+    frame     = av_frame_alloc();
+    send_time = av_malloc_array(nb_packets, sizeof(*send_time));
+    if (!avctx || !frame || !send_time) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = avcodec_parameters_to_context(avctx, par);
+    if (ret < 0)
+        goto end;
+    avctx->thread_count = threads;
+    avctx->thread_type  = thread_type;
+
+    ret = avcodec_open2(avctx, codec, NULL);
+    if (ret < 0)
+        goto end;
+    res->active_thread_type = avctx->active_thread_type;
+
+    res->time = av_gettime_relative();
+    for (i = 0; i <= nb_packets; i++) {
+        AVPacket *pkt = i < nb_packets ? &packets[i] : NULL;
+
+        avctx->reordered_opaque = i;
+        if (i < nb_packets)
+            send_time[i] = av_gettime_relative();
+
+        while ((ret = avcodec_send_packet(avctx, pkt)) == AVERROR(EAGAIN)) {
+            ret = receive_frames(avctx, frame, send_time, nb_packets,
+                                 &latency, &nb_latency);
+            if (ret < 0)
+                goto end;
+        }
+        if (ret < 0)
+            res->nb_errors++;
+
+        ret = receive_frames(avctx, frame, send_time, nb_packets,
+                             &latency, &nb_latency);
+        if (ret == AVERROR(ENOMEM))
+            goto end;
+        if (ret < 0)
+            res->nb_errors++;
+    }
+    res->time = av_gettime_relative() - res->time;
+    ret = 0;
+
+    res->nb_frames = nb_latency;
+    if (nb_latency) {
+        qsort(latency, nb_latency, sizeof(*latency), cmp_int64);
+        res->latency[0] = latency[nb_latency * 50 / 100];
+        res->latency[1] = latency[nb_latency * 90 / 100];
+        res->latency[2] = latency[nb_latency * 99 / 100];
+        res->latency[3] = latency[nb_latency - 1];
+    }
+
+end:
+    avcodec_free_context(&avctx);
+    av_frame_free(&frame);
+    av_free(send_time);
+    av_free(latency);
+    res->maxrss = getmaxrss() - maxrss;
+    res->ret    = ret;
+}
+
+/* Run each configuration in a child process when possible, so that the peak
+ * memory usage of a run is not hidden by the peaks of the previous ones. */
+static void bench(const AVCodec *codec, const AVCodecParameters *par,
+                  AVPacket *packets, int nb_packets,
+                  int thread_type, int threads, BenchResult *res)
+{
+#if HAVE_FORK
+    int fds[2];
+    pid_t pid;
+
+    if (!pipe(fds)) {
+        pid = fork();
+        if (!pid) {
+            close(fds[0]);
+            run_decoder(codec, par, packets, nb_packets, thread_type, threads, res);
+            if (write(fds[1], res, sizeof(*res)) != sizeof(*res))
+                _exit(1);
+            _exit(0);
+        }
+        close(fds[1]);
+        if (pid > 0) {
+            int status, ok = read(fds[0], res, sizeof(*res)) == sizeof(*res);
+
+            close(fds[0]);
+            waitpid(pid, &status, 0);
+            if (!ok) {
+                memset(res, 0, sizeof(*res));
+                res->ret = AVERROR_BUG;
+            }
+            return;
+        }
+        close(fds[0]);
+    }
+#endif
+    run_decoder(codec, par, packets, nb_packets, thread_type, threads, res);
+}
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-c decoder] [-s stream] [-t max_threads] [-m modes] "
+            "[-r repeats] [-n max_packets] input_file\n", argv0);
+    fprintf(stderr, "-c\tonly benchmark the named decoder\n");
+    fprintf(stderr, "-s\tonly benchmark the given stream index\n");
+    fprintf(stderr, "-t\thighest thread count, the number of CPUs by default\n");
+    fprintf(stderr, "-m\tthreading modes among none,slice,frame, all by default\n");
+    fprintf(stderr, "-r\tnumber of runs for each configuration, the fastest is kept\n");
+    fprintf(stderr, "-n\tonly decode the first max_packets packets of each stream\n");
+    fprintf(stderr, "Prints one CSV line for each decoder, mode and thread count.\n");
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL, *decoder = NULL, *mode_list = NULL;
+    int max_threads = 0, repeats = 1, max_packets = 0, stream = -1;
+    AVFormatContext *fmt = NULL;
+    AVPacket **packets = NULL;
+    int *nb_packets    = NULL;
+    AVPacket pkt;
+    int ret, mode, i;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            decoder = argv[++i];
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            stream = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            mode_list = argv[++i];
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            max_packets = atoi(argv[++i]);
+        } else if (!input) {
+            input = argv[i];
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (!input)
+        return usage(argv[0], 1);
+    if (max_threads <= 0)
+        max_threads = av_cpu_count();
+    repeats = FFMAX(repeats, 1);
+
+    av_register_all();
+    av_log_set_level(AV_LOG_ERROR);
+
+    ret = avformat_open_input(&fmt, input, NULL, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Cannot open %s\n", input);
+        return 1;
+    }
+    ret = avformat_find_stream_info(fmt, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Cannot find the stream parameters of %s\n", input);
+        goto end;
+    }
+
+    /* read everything beforehand, so that the demuxer is not benchmarked */
+    packets    = av_mallocz_array(fmt->nb_streams, sizeof(*packets));
+    nb_packets = av_mallocz_array(fmt->nb_streams, sizeof(*nb_packets));
+    if (!packets || !nb_packets) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    while (av_read_frame(fmt, &pkt) >= 0) {
+        int idx = pkt.stream_index;
+
+        if ((stream >= 0 && idx != stream) ||
+            (max_packets > 0 && nb_packets[idx] >= max_packets)) {
+            av_packet_unref(&pkt);
+            continue;
+        }
+        if (!(nb_packets[idx] & (nb_packets[idx] - 1))) {
+            AVPacket *tmp = av_realloc_array(packets[idx], 2 * nb_packets[idx] + 1,
+                                             sizeof(*tmp));
+            if (!tmp) {
+                av_packet_unref(&pkt);
+                ret = AVERROR(ENOMEM);
+                goto end;
+            }
+            packets[idx] = tmp;
+        }
+        packets[idx][nb_packets[idx]++] = pkt;
+    }
+
+    printf("file,stream,decoder,mode,active,threads,frames,errors,seconds,fps,"
+           "speedup,latency_p50_ms,latency_p90_ms,latency_p99_ms,"
+           "latency_max_ms,maxrss_kb\n");
+
+    for (i = 0; i < fmt->nb_streams; i++) {
+        const AVCodecParameters *par = fmt->streams[i]->codecpar;
+        AVCodec *codec = NULL;
+
+        if (!nb_packets[i])
+            continue;
+
+        while ((codec = av_codec_next(codec))) {
+            double base_time = 0;
+
+            if (!av_codec_is_decoder(codec) || codec->id != par->codec_id)
+                continue;
+            if (decoder && strcmp(codec->name, decoder))
+                continue;
+
+            for (mode = 0; mode < NB_MODES; mode++) {
+                int threads;
+
+                if ((codec->capabilities & modes[mode].caps) != modes[mode].caps)
+                    continue;
+                if (mode_list && !strstr(mode_list, modes[mode].name))
+                    continue;
+
+                for (threads = mode == MODE_NONE ? 1 : 2;
+                     threads <= (mode == MODE_NONE ? 1 : max_threads); threads++) {
+                    BenchResult res, best = { 0 };
+                    double seconds;
+                    int run;
+
+                    for (run = 0; run < repeats; run++) {
+                        bench(codec, par, packets[i], nb_packets[i],
+                              modes[mode].thread_type, threads, &res);
+                        if (res.ret < 0) {
+                            best = res;
+                            break;
+                        }
+                        if (!run || res.time < best.time)
+                            best = res;
+                    }
+                    if (best.ret < 0) {
+                        char errbuf[128];
+                        av_strerror(best.ret, errbuf, sizeof(errbuf));
+                        fprintf(stderr, "%s, stream %d, %s with %d threads: %s\n",
+                                codec->name, i, modes[mode].name, threads, errbuf);
+                        break;
+                    }
+
+                    seconds = best.time / 1000000.0;
+                    if (mode == MODE_NONE)
+                        base_time = seconds;
+                    printf("%s,%d,%s,%s,%s,%d,%d,%d,%.6f,%.2f,%.3f,"
+                           "%.3f,%.3f,%.3f,%.3f,%"PRId64"\n",
+                           input, i, codec->name, modes[mode].name,
+                           active_name(best.active_thread_type), threads,
+                           best.nb_frames, best.nb_errors, seconds,
+                           seconds > 0 ? best.nb_frames / seconds : 0,
+                           base_time > 0 && seconds > 0 ? base_time / seconds : 0,
+                           best.latency[0] / 1000.0, best.latency[1] / 1000.0,
+                           best.latency[2] / 1000.0, best.latency[3] / 1000.0,
+                           best.maxrss);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    ret = 0;
+
+end:
+    if (packets) {
+        for (i = 0; i < fmt->nb_streams; i++) {
+            int j;
+            for (j = 0; j < nb_packets[i]; j++)
+                av_packet_unref(&packets[i][j]);
+            av_free(packets[i]);
+        }
+    }
+    av_free(packets);
+    av_free(nb_packets);
+    avformat_close_input(&fmt);
+
+    return ret < 0;
+}